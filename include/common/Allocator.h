@@ -7,14 +7,33 @@
 
 #include <stddef.h>
 
-#include "Platform.h"
+#include "CStandardCompatibility.h"
 
+/**
+ * Allocator used by every container for its own bookkeeping memory
+ * (nodes, bucket arrays, iterator state) and for user data cleanup/copying.
+ *
+ * Two families of allocation hooks are supported:
+ *   - Plain hooks (allocate/deallocate/reallocate) compatible with malloc/free/realloc.
+ *   - Context hooks (ctx_allocate/ctx_deallocate/ctx_reallocate) that receive the
+ *     user supplied ctx pointer plus the size of the block being released or resized.
+ *     These allow arenas, pools and other stateful allocators without globals.
+ *
+ * When ctx_allocate is set the context hooks take precedence over the plain hooks.
+ * data_free and copy always operate on user data and never receive the context.
+ */
 typedef struct ANVAllocator
 {
     void* (*allocate)(size_t size);
     void (*deallocate)(void* ptr);
     void (*data_free)(void* ptr);
     void* (*copy)(const void* data);
+    void* (*reallocate)(void* ptr, size_t size);
+
+    void* ctx;
+    void* (*ctx_allocate)(void* ctx, size_t size);
+    void (*ctx_deallocate)(void* ctx, void* ptr, size_t size);
+    void* (*ctx_reallocate)(void* ctx, void* ptr, size_t old_size, size_t new_size);
 } ANVAllocator;
 
 //==============================================================================
@@ -38,6 +57,35 @@ typedef void* (*alloc_func)(size_t size);
  */
 typedef void (*dealloc_func)(void* ptr);
 
+/**
+ * Context-aware allocation function.
+ *
+ * @param ctx User supplied allocator context
+ * @param size Number of bytes to allocate
+ * @return Pointer to allocated memory, or NULL on failure
+ */
+typedef void* (*ctx_alloc_func)(void* ctx, size_t size);
+
+/**
+ * Context-aware deallocation function.
+ *
+ * @param ctx User supplied allocator context
+ * @param ptr Pointer to memory to be freed
+ * @param size Size of the block as originally requested, or 0 if unknown
+ */
+typedef void (*ctx_dealloc_func)(void* ctx, void* ptr, size_t size);
+
+/**
+ * Context-aware reallocation function compatible with realloc semantics.
+ *
+ * @param ctx User supplied allocator context
+ * @param ptr Pointer to the existing block (may be NULL)
+ * @param old_size Current size of the block, or 0 if unknown
+ * @param new_size Requested size of the block
+ * @return Pointer to the resized block, or NULL on failure (original block untouched)
+ */
+typedef void* (*ctx_realloc_func)(void* ctx, void* ptr, size_t old_size, size_t new_size);
+
 /**
  * Function to free user data stored in the list.
  * Used when destroying or removing nodes.
@@ -95,6 +143,31 @@ ANV_API ANVAllocator anv_alloc_default(void);
 ANV_API ANVAllocator anv_alloc_custom(alloc_func alloc_func, dealloc_func dealloc_func,
                                       data_free_func data_free_func, copy_func copy_func);
 
+/**
+ * Create a context-carrying allocator.
+ * Every container allocation is routed to the context hooks together with ctx,
+ * so a whole container can live in a caller-owned region (arena, pool, ...).
+ *
+ * @param ctx User context passed to every allocation hook (can be NULL)
+ * @param alloc_func Context-aware allocation function (required)
+ * @param dealloc_func Context-aware deallocation function (can be NULL for region allocators)
+ * @param realloc_func Context-aware reallocation function (can be NULL, falls back to alloc+copy+free)
+ * @param data_free_func User data cleanup function (can be NULL)
+ * @param copy_func Data copying function (can be NULL)
+ * @return ANVAllocator struct using the context hooks
+ */
+ANV_API ANVAllocator anv_alloc_context(void* ctx, ctx_alloc_func alloc_func, ctx_dealloc_func dealloc_func,
+                                       ctx_realloc_func realloc_func, data_free_func data_free_func,
+                                       copy_func copy_func);
+
+/**
+ * Check whether the allocator is able to allocate memory.
+ *
+ * @param alloc Pointer to ANVAllocator struct
+ * @return true if either a plain or a context allocation hook is set
+ */
+ANV_API bool anv_alloc_is_valid(const ANVAllocator* alloc);
+
 /**
  * Allocate memory using the allocator's allocation function.
  *
@@ -112,6 +185,31 @@ ANV_API void* anv_alloc_malloc(const ANVAllocator* alloc, size_t size);
  */
 ANV_API void anv_alloc_free(const ANVAllocator* alloc, void* ptr);
 
+/**
+ * Free memory whose size is known to the caller.
+ * Context allocators receive the size, which lets pools and size-class
+ * allocators release blocks without storing a header.
+ *
+ * @param alloc Pointer to ANVAllocator struct
+ * @param ptr Pointer to memory to free
+ * @param size Size originally requested for ptr
+ */
+ANV_API void anv_alloc_free_sized(const ANVAllocator* alloc, void* ptr, size_t size);
+
+/**
+ * Resize a block previously obtained from the allocator.
+ * Uses the reallocate hook when available, otherwise allocates a new block,
+ * copies min(old_size, new_size) bytes and frees the old block.
+ * On failure the original block is left untouched.
+ *
+ * @param alloc Pointer to ANVAllocator struct
+ * @param ptr Pointer to existing block (NULL behaves like anv_alloc_malloc)
+ * @param old_size Current size of the block
+ * @param new_size Requested size of the block
+ * @return Pointer to resized block, or NULL on failure
+ */
+ANV_API void* anv_alloc_realloc(const ANVAllocator* alloc, void* ptr, size_t old_size, size_t new_size);
+
 /**
  * Free user data using the allocator's data free function.
  * Does nothing if data_free_func is NULL.
@@ -47,6 +47,13 @@ extern "C" {
 #define ANVIL_NORETURN
 #endif
 
+/* Thread-local storage */
+#if defined(_MSC_VER)
+#define ANVIL_THREAD_LOCAL __declspec(thread)
+#else
+#define ANVIL_THREAD_LOCAL _Thread_local
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -114,6 +114,15 @@ ANV_API size_t anv_arraylist_capacity(const ANVArrayList* list);
  */
 ANV_API int anv_arraylist_is_empty(const ANVArrayList* list);
 
+/**
+ * Get the number of bytes owned by the ArrayList for the list struct and its element pointer array,
+ * excluding user data.
+ *
+ * @param list The ArrayList to query
+ * @return Bytes owned, or 0 if list is NULL
+ */
+ANV_API size_t anv_arraylist_memory_usage(const ANVArrayList* list);
+
 /**
  * Find the first element matching data using the comparison function.
  *
@@ -113,6 +113,15 @@ ANV_API size_t anv_bst_size(const ANVBinarySearchTree* tree);
  */
 ANV_API int anv_bst_is_empty(const ANVBinarySearchTree* tree);
 
+/**
+ * Get the number of bytes owned by the tree for the tree struct and its nodes,
+ * excluding user data.
+ *
+ * @param tree The tree to query
+ * @return Bytes owned, or 0 if tree is NULL
+ */
+ANV_API size_t anv_bst_memory_usage(const ANVBinarySearchTree* tree);
+
 /**
  * Get the height of the tree.
  *
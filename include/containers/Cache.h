@@ -0,0 +1,299 @@
+//
+// Cache.h
+// Bounded key-value cache with LRU or CLOCK eviction.
+//
+// All storage is allocated up front: one array of capacity entries and a
+// bucket array for lookups. Each entry carries its own hash chain and
+// recency list links as 32-bit entry positions, so a put never allocates and
+// get, put and evict are O(1).
+//
+// Two eviction policies are available:
+//  - ANV_CACHE_LRU keeps the entries on a list ordered by last use and
+//    evicts the least recently used one. Every hit moves an entry to the
+//    front of the list.
+//  - ANV_CACHE_CLOCK (second chance) only sets a referenced bit on a hit.
+//    To evict, a hand sweeps the entry array, clearing referenced bits and
+//    stopping at the first entry without one. Hits write a single byte, at
+//    the cost of a coarser approximation of LRU.
+//
+// When an entry is evicted to make room, the eviction callback (if any)
+// receives its key and value, e.g. to free them. Without a callback, evicted
+// keys and values are simply dropped.
+
+#ifndef ANVIL_CACHE_H
+#define ANVIL_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "common/Allocator.h"
+#include "common/CStandardCompatibility.h"
+#include "containers/HashMap.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//==============================================================================
+// Constants
+//==============================================================================
+
+// Largest number of entries a cache can hold
+#define ANV_CACHE_MAX_CAPACITY (UINT32_MAX - 1)
+
+//==============================================================================
+// Type definitions
+//==============================================================================
+
+/**
+ * Eviction policy.
+ */
+typedef enum ANVCachePolicy
+{
+    ANV_CACHE_LRU,  // Evict the least recently used entry
+    ANV_CACHE_CLOCK // Evict the first unreferenced entry under the clock hand
+} ANVCachePolicy;
+
+/**
+ * Called with the key and value of an entry evicted to make room.
+ *
+ * @param key The evicted key
+ * @param value The evicted value
+ * @param user_data The pointer given to anv_cache_set_eviction_callback
+ */
+typedef void (*anv_cache_evict_func)(void* key, void* value, void* user_data);
+
+/**
+ * Lookup and eviction counters.
+ */
+typedef struct ANVCacheStats
+{
+    size_t hits;      // get calls that found their key
+    size_t misses;    // get calls that did not
+    size_t evictions; // Entries evicted to make room
+} ANVCacheStats;
+
+/**
+ * One cache entry. A NULL key marks a free entry.
+ */
+typedef struct ANVCacheEntry
+{
+    void* key;          // Pointer to key data, NULL when free
+    void* value;        // Pointer to value data
+    size_t hash;        // Cached hash code of key
+    uint32_t chain;     // Next entry in the same bucket
+    uint32_t prev;      // Next more recently used entry (LRU)
+    uint32_t next;      // Next less recently used entry (LRU), or next free entry
+    uint8_t referenced; // Hit since the clock hand last passed (CLOCK)
+} ANVCacheEntry;
+
+/**
+ * Bounded cache structure with custom allocator support.
+ */
+typedef struct ANVCache
+{
+    ANVCacheEntry* entries;        // capacity entries
+    uint32_t* buckets;             // First entry of each bucket chain
+    size_t capacity;               // Maximum number of entries
+    size_t bucket_count;           // Number of buckets (power of two)
+    unsigned bucket_shift;         // 64 - log2(bucket_count)
+    size_t size;                   // Number of entries in use
+    uint32_t head;                 // Most recently used entry (LRU)
+    uint32_t tail;                 // Least recently used entry (LRU)
+    uint32_t free_list;            // First free entry
+    size_t hand;                   // Next entry the clock hand examines (CLOCK)
+    ANVCachePolicy policy;         // Eviction policy
+    ANVCacheStats stats;           // Lookup and eviction counters
+    anv_cache_evict_func on_evict; // Eviction callback, or NULL
+    void* evict_user_data;         // Passed to on_evict
+    hash_func hash;                // Hash function for keys
+    key_equals_func key_equals;    // Key equality function
+    ANVAllocator* alloc;           // Custom allocator
+} ANVCache;
+
+//==============================================================================
+// Creation and destruction functions
+//==============================================================================
+
+/**
+ * Create a new cache holding at most capacity entries.
+ *
+ * @param alloc Custom allocator (required)
+ * @param hash Hash function for keys (required)
+ * @param key_equals Key equality function (required)
+ * @param capacity Maximum number of entries, 1 to ANV_CACHE_MAX_CAPACITY
+ * @param policy Eviction policy
+ * @return Pointer to new cache, or NULL on failure
+ */
+ANV_API ANVCache* anv_cache_create(ANVAllocator* alloc, hash_func hash, key_equals_func key_equals,
+                                   size_t capacity, ANVCachePolicy policy);
+
+/**
+ * Destroy the cache. The eviction callback is not called.
+ *
+ * @param cache The cache to destroy
+ * @param should_free_keys Whether to free key data using alloc->data_free
+ * @param should_free_values Whether to free value data using alloc->data_free
+ */
+ANV_API void anv_cache_destroy(ANVCache* cache, bool should_free_keys, bool should_free_values);
+
+/**
+ * Remove all entries, keeping the counters. The eviction callback is not called.
+ *
+ * @param cache The cache to clear
+ * @param should_free_keys Whether to free key data
+ * @param should_free_values Whether to free value data
+ */
+ANV_API void anv_cache_clear(ANVCache* cache, bool should_free_keys, bool should_free_values);
+
+/**
+ * Set the function called for each entry evicted to make room.
+ *
+ * @param cache The cache to configure
+ * @param on_evict Eviction callback, or NULL to drop evicted entries
+ * @param user_data Passed to every call of on_evict
+ */
+ANV_API void anv_cache_set_eviction_callback(ANVCache* cache, anv_cache_evict_func on_evict, void* user_data);
+
+//==============================================================================
+// Information functions
+//==============================================================================
+
+/**
+ * Get the number of entries in the cache.
+ *
+ * @param cache The cache to query
+ * @return Number of entries, or 0 if cache is NULL
+ */
+ANV_API size_t anv_cache_size(const ANVCache* cache);
+
+/**
+ * Get the maximum number of entries.
+ *
+ * @param cache The cache to query
+ * @return Capacity, or 0 if cache is NULL
+ */
+ANV_API size_t anv_cache_capacity(const ANVCache* cache);
+
+/**
+ * Check if the cache is empty.
+ *
+ * @param cache The cache to check
+ * @return 1 if empty or NULL, 0 if it contains elements
+ */
+ANV_API int anv_cache_is_empty(const ANVCache* cache);
+
+/**
+ * Get the number of bytes owned by the cache, excluding user data.
+ *
+ * @param cache The cache to query
+ * @return Bytes owned, or 0 if cache is NULL
+ */
+ANV_API size_t anv_cache_memory_usage(const ANVCache* cache);
+
+/**
+ * Get the lookup and eviction counters.
+ *
+ * @param cache The cache to query
+ * @return Counters, all zero if cache is NULL
+ */
+ANV_API ANVCacheStats anv_cache_stats(const ANVCache* cache);
+
+/**
+ * Reset the lookup and eviction counters to zero.
+ *
+ * @param cache The cache to modify
+ */
+ANV_API void anv_cache_reset_stats(ANVCache* cache);
+
+/**
+ * Check if the cache contains a key, without counting a hit or miss or
+ * marking the entry as used.
+ *
+ * @param cache The cache to search
+ * @param key The key to search for
+ * @return 1 if key exists, 0 if not found or on error
+ */
+ANV_API int anv_cache_contains_key(const ANVCache* cache, const void* key);
+
+//==============================================================================
+// Cache operations
+//==============================================================================
+
+/**
+ * Get the value for a key and mark the entry as used. Counts a hit or miss.
+ *
+ * @param cache The cache to search
+ * @param key The key to look up
+ * @return Pointer to associated value, or NULL if not found or on error
+ */
+ANV_API void* anv_cache_get(ANVCache* cache, const void* key);
+
+/**
+ * Get the value for a key without counting a hit or miss or marking the
+ * entry as used.
+ *
+ * @param cache The cache to search
+ * @param key The key to look up
+ * @return Pointer to associated value, or NULL if not found or on error
+ */
+ANV_API void* anv_cache_peek(const ANVCache* cache, const void* key);
+
+/**
+ * Insert or update a key-value pair and mark it as used. Inserting into a
+ * full cache first evicts an entry according to the policy.
+ *
+ * @param cache The cache to modify
+ * @param key Pointer to key data (ownership transferred to cache)
+ * @param value Pointer to value data (ownership transferred to cache)
+ * @return 0 on success, -1 on error
+ */
+ANV_API int anv_cache_put(ANVCache* cache, void* key, void* value);
+
+/**
+ * Insert or update a key-value pair, returning the old value if key exists.
+ *
+ * @param cache The cache to modify
+ * @param key Pointer to key data (ownership transferred to cache)
+ * @param value Pointer to value data (ownership transferred to cache)
+ * @param old_value_out Pointer to store the old value (NULL if key didn't exist)
+ * @return 0 on success, -1 on error
+ */
+ANV_API int anv_cache_put_replace(ANVCache* cache, void* key, void* value, void** old_value_out);
+
+/**
+ * Remove a key-value pair. The eviction callback is not called.
+ *
+ * @param cache The cache to modify
+ * @param key The key to remove
+ * @param should_free_key Whether to free the key data
+ * @param should_free_value Whether to free the value data
+ * @return 0 on success, -1 if key not found or on error
+ */
+ANV_API int anv_cache_remove(ANVCache* cache, const void* key, bool should_free_key, bool should_free_value);
+
+/**
+ * Remove a key-value pair and return the value.
+ *
+ * @param cache The cache to modify
+ * @param key The key to remove
+ * @param should_free_key Whether to free the key data
+ * @return Pointer to the removed value, or NULL if not found or on error
+ */
+ANV_API void* anv_cache_remove_get(ANVCache* cache, const void* key, bool should_free_key);
+
+/**
+ * Apply an action function to each key-value pair: from most to least
+ * recently used under LRU, in entry order under CLOCK. Does not mark
+ * entries as used.
+ *
+ * @param cache The cache to process
+ * @param action Function applied to each key-value pair
+ */
+ANV_API void anv_cache_for_each(const ANVCache* cache, void (*action)(void* key, void* value));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //ANVIL_CACHE_H
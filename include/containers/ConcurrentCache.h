@@ -0,0 +1,303 @@
+//
+// ConcurrentCache.h
+// Thread-safe bounded cache built from independently locked ANVCache shards.
+//
+// Keys are spread over a fixed number of shards by their hash. Each shard is
+// an ordinary ANVCache with its own slice of the total capacity, its own
+// recency state and its own eviction, guarded by its own ANVMutex. Threads
+// working on different shards never wait for each other, and a hit only
+// reorders the recency list of its own shard. Eviction is per shard, so the
+// entry evicted is the least recently used (or unreferenced) one of that
+// shard rather than of the whole cache. Shards are padded to a cache line so
+// neighbouring locks do not share one.
+//
+// All functions may be called concurrently, except create and destroy. The
+// hash and key equality functions are called from many threads at once, and
+// the allocator must be thread-safe (e.g. anv_alloc_default() or an
+// ANVCachingHeap). The eviction callback runs with the shard's lock held and
+// must not call back into the cache. Values returned by get stay valid only
+// as long as no other thread evicts, removes or replaces them; with a freeing
+// eviction callback, read values through get_with instead, which runs a
+// visitor while the shard is still locked.
+
+#ifndef ANVIL_CONCURRENTCACHE_H
+#define ANVIL_CONCURRENTCACHE_H
+
+#include <stddef.h>
+
+#include "common/Allocator.h"
+#include "common/CStandardCompatibility.h"
+#include "containers/Cache.h"
+#include "containers/HashMap.h"
+#include "system/Mutex.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//==============================================================================
+// Constants
+//==============================================================================
+
+// Shard count used when 0 is requested
+#define ANV_CONCURRENT_CACHE_DEFAULT_SHARDS 16
+
+// Largest number of shards (requests are rounded up to a power of two)
+#define ANV_CONCURRENT_CACHE_MAX_SHARDS 4096
+
+// Size each shard is padded to
+#define ANV_CONCURRENT_CACHE_CACHE_LINE 64
+
+//==============================================================================
+// Type definitions
+//==============================================================================
+
+/**
+ * One shard: a bounded cache and the mutex guarding it.
+ */
+typedef struct ANVConcurrentCacheShard
+{
+    ANVMutex lock;   // Guards cache
+    ANVCache* cache; // Entries whose hash selects this shard
+    char padding[ANV_CONCURRENT_CACHE_CACHE_LINE -
+                 (sizeof(ANVMutex) + sizeof(ANVCache*)) % ANV_CONCURRENT_CACHE_CACHE_LINE];
+} ANVConcurrentCacheShard;
+
+/**
+ * Concurrent cache structure with custom allocator support.
+ */
+typedef struct ANVConcurrentCache
+{
+    ANVConcurrentCacheShard* shards; // Cache-line aligned shard array
+    void* shard_block;               // Allocation holding shards
+    size_t shard_count;              // Number of shards (power of two)
+    unsigned shard_shift;            // 64 - log2(shard_count)
+    hash_func hash;                  // Hash function for keys
+    ANVAllocator* alloc;             // Custom allocator (must be thread-safe)
+} ANVConcurrentCache;
+
+/**
+ * Called by anv_concurrent_cache_get_with with the value of a hit while the
+ * shard's lock is held. Must not call back into the cache or keep value
+ * after returning.
+ *
+ * @param value The cached value
+ * @param user_data The pointer given to anv_concurrent_cache_get_with
+ */
+typedef void (*anv_concurrent_cache_visit_func)(void* value, void* user_data);
+
+//==============================================================================
+// Creation and destruction functions
+//==============================================================================
+
+/**
+ * Create a new concurrent cache. The capacity is split as evenly as possible
+ * over the shards and the shard capacities add up to exactly capacity. Every
+ * shard holds at least one entry, so the shard count is lowered to the
+ * largest power of two not above capacity where needed.
+ *
+ * @param alloc Custom allocator (required, must be thread-safe)
+ * @param hash Hash function for keys (required)
+ * @param key_equals Key equality function (required)
+ * @param capacity Total number of entries across all shards (at least 1)
+ * @param shard_count Number of shards, rounded up to a power of two and capped by capacity (0 for default)
+ * @param policy Eviction policy of every shard
+ * @return Pointer to new cache, or NULL on failure
+ */
+ANV_API ANVConcurrentCache* anv_concurrent_cache_create(ANVAllocator* alloc, hash_func hash,
+                                                        key_equals_func key_equals, size_t capacity,
+                                                        size_t shard_count, ANVCachePolicy policy);
+
+/**
+ * Destroy the cache. No other thread may use it concurrently or afterwards.
+ * The eviction callback is not called.
+ *
+ * @param cache The cache to destroy
+ * @param should_free_keys Whether to free key data using alloc->data_free
+ * @param should_free_values Whether to free value data using alloc->data_free
+ */
+ANV_API void anv_concurrent_cache_destroy(ANVConcurrentCache* cache, bool should_free_keys,
+                                          bool should_free_values);
+
+/**
+ * Remove all entries, one shard at a time, keeping the counters.
+ *
+ * @param cache The cache to clear
+ * @param should_free_keys Whether to free key data
+ * @param should_free_values Whether to free value data
+ */
+ANV_API void anv_concurrent_cache_clear(ANVConcurrentCache* cache, bool should_free_keys,
+                                        bool should_free_values);
+
+/**
+ * Set the function called for each entry evicted to make room, in every
+ * shard. Call before the cache is shared between threads.
+ *
+ * @param cache The cache to configure
+ * @param on_evict Eviction callback, or NULL to drop evicted entries
+ * @param user_data Passed to every call of on_evict
+ */
+ANV_API void anv_concurrent_cache_set_eviction_callback(ANVConcurrentCache* cache, anv_cache_evict_func on_evict,
+                                                        void* user_data);
+
+//==============================================================================
+// Information functions
+//==============================================================================
+
+/**
+ * Get the number of entries. Shards are counted one at a time, so the
+ * result may be stale while other threads are writing.
+ *
+ * @param cache The cache to query
+ * @return Number of entries, or 0 if cache is NULL
+ */
+ANV_API size_t anv_concurrent_cache_size(ANVConcurrentCache* cache);
+
+/**
+ * Get the total number of entries the shards can hold.
+ *
+ * @param cache The cache to query
+ * @return Capacity, or 0 if cache is NULL
+ */
+ANV_API size_t anv_concurrent_cache_capacity(const ANVConcurrentCache* cache);
+
+/**
+ * Get the number of shards.
+ *
+ * @param cache The cache to query
+ * @return Shard count, or 0 if cache is NULL
+ */
+ANV_API size_t anv_concurrent_cache_shard_count(const ANVConcurrentCache* cache);
+
+/**
+ * Get the number of bytes owned by the cache, excluding user data.
+ *
+ * @param cache The cache to query
+ * @return Bytes owned, or 0 if cache is NULL
+ */
+ANV_API size_t anv_concurrent_cache_memory_usage(const ANVConcurrentCache* cache);
+
+/**
+ * Get the lookup and eviction counters summed over all shards. Shards are
+ * read one at a time, so the sum may be stale while other threads are busy.
+ *
+ * @param cache The cache to query
+ * @return Counters, all zero if cache is NULL
+ */
+ANV_API ANVCacheStats anv_concurrent_cache_stats(ANVConcurrentCache* cache);
+
+/**
+ * Get the lookup and eviction counters of one shard, e.g. to spot a hot
+ * shard.
+ *
+ * @param cache The cache to query
+ * @param shard Shard index, below anv_concurrent_cache_shard_count
+ * @return Counters, all zero if cache is NULL or shard is out of range
+ */
+ANV_API ANVCacheStats anv_concurrent_cache_shard_stats(ANVConcurrentCache* cache, size_t shard);
+
+/**
+ * Reset the counters of every shard to zero.
+ *
+ * @param cache The cache to modify
+ */
+ANV_API void anv_concurrent_cache_reset_stats(ANVConcurrentCache* cache);
+
+/**
+ * Check if the cache contains a key, without counting a hit or miss or
+ * marking the entry as used.
+ *
+ * @param cache The cache to search
+ * @param key The key to search for
+ * @return 1 if key exists, 0 if not found or on error
+ */
+ANV_API int anv_concurrent_cache_contains_key(ANVConcurrentCache* cache, const void* key);
+
+//==============================================================================
+// Cache operations
+//==============================================================================
+
+/**
+ * Get the value for a key and mark the entry as used. Counts a hit or miss.
+ *
+ * @param cache The cache to search
+ * @param key The key to look up
+ * @return Pointer to associated value, or NULL if not found or on error
+ */
+ANV_API void* anv_concurrent_cache_get(ANVConcurrentCache* cache, const void* key);
+
+/**
+ * Look up a key like anv_concurrent_cache_get and, on a hit, pass the value
+ * to visit before the shard's lock is released. No other thread can evict,
+ * remove or replace the entry while visit runs, so this is the safe way to
+ * read or copy a value that an eviction callback may free.
+ *
+ * @param cache The cache to search
+ * @param key The key to look up
+ * @param visit Function called with the value on a hit (required)
+ * @param user_data Passed to visit
+ * @return 1 if the key was found and visited, 0 if not found or on error
+ */
+ANV_API int anv_concurrent_cache_get_with(ANVConcurrentCache* cache, const void* key,
+                                          anv_concurrent_cache_visit_func visit, void* user_data);
+
+/**
+ * Get the value for a key without counting a hit or miss or marking the
+ * entry as used.
+ *
+ * @param cache The cache to search
+ * @param key The key to look up
+ * @return Pointer to associated value, or NULL if not found or on error
+ */
+ANV_API void* anv_concurrent_cache_peek(ANVConcurrentCache* cache, const void* key);
+
+/**
+ * Insert or update a key-value pair and mark it as used. Inserting into a
+ * full shard first evicts an entry of that shard.
+ *
+ * @param cache The cache to modify
+ * @param key Pointer to key data (ownership transferred to cache)
+ * @param value Pointer to value data (ownership transferred to cache)
+ * @return 0 on success, -1 on error
+ */
+ANV_API int anv_concurrent_cache_put(ANVConcurrentCache* cache, void* key, void* value);
+
+/**
+ * Insert or update a key-value pair, returning the old value if key exists.
+ *
+ * @param cache The cache to modify
+ * @param key Pointer to key data (ownership transferred to cache)
+ * @param value Pointer to value data (ownership transferred to cache)
+ * @param old_value_out Pointer to store the old value (NULL if key didn't exist)
+ * @return 0 on success, -1 on error
+ */
+ANV_API int anv_concurrent_cache_put_replace(ANVConcurrentCache* cache, void* key, void* value,
+                                             void** old_value_out);
+
+/**
+ * Remove a key-value pair. The eviction callback is not called.
+ *
+ * @param cache The cache to modify
+ * @param key The key to remove
+ * @param should_free_key Whether to free the key data
+ * @param should_free_value Whether to free the value data
+ * @return 0 on success, -1 if key not found or on error
+ */
+ANV_API int anv_concurrent_cache_remove(ANVConcurrentCache* cache, const void* key,
+                                        bool should_free_key, bool should_free_value);
+
+/**
+ * Remove a key-value pair and return the value.
+ *
+ * @param cache The cache to modify
+ * @param key The key to remove
+ * @param should_free_key Whether to free the key data
+ * @return Pointer to the removed value, or NULL if not found or on error
+ */
+ANV_API void* anv_concurrent_cache_remove_get(ANVConcurrentCache* cache, const void* key, bool should_free_key);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //ANVIL_CONCURRENTCACHE_H
@@ -0,0 +1,259 @@
+//
+// ConcurrentHashMap.h
+// Thread-safe hash map built from lock-striped ANVHashMap segments.
+//
+// Keys are spread over a fixed number of segments by their hash. Each
+// segment is an ordinary ANVHashMap guarded by its own ANVMutex, so threads
+// working on different segments never wait for each other, and a segment
+// resizes on its own without stalling the rest of the map. Segments are
+// padded to a cache line so neighbouring locks do not share one.
+//
+// All functions may be called concurrently, except create and destroy. The
+// hash and key equality functions are called from many threads at once, and
+// the allocator must be thread-safe (e.g. anv_alloc_default() or an
+// ANVCachingHeap). Values returned by get stay valid only as long as no
+// other thread removes or replaces them with freeing enabled.
+
+#ifndef ANVIL_CONCURRENTHASHMAP_H
+#define ANVIL_CONCURRENTHASHMAP_H
+
+#include <stddef.h>
+
+#include "Iterator.h"
+#include "common/Allocator.h"
+#include "common/CStandardCompatibility.h"
+#include "containers/HashMap.h"
+#include "system/Mutex.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//==============================================================================
+// Constants
+//==============================================================================
+
+// Segment count used when 0 is requested
+#define ANV_CONCURRENT_HASHMAP_DEFAULT_SEGMENTS 16
+
+// Largest number of segments (requests are rounded up to a power of two)
+#define ANV_CONCURRENT_HASHMAP_MAX_SEGMENTS 4096
+
+// Size each segment is padded to
+#define ANV_CONCURRENT_HASHMAP_CACHE_LINE 64
+
+//==============================================================================
+// Type definitions
+//==============================================================================
+
+/**
+ * One lock stripe: a hash map and the mutex guarding it.
+ */
+typedef struct ANVConcurrentHashMapSegment
+{
+    ANVMutex lock;   // Guards map
+    ANVHashMap* map; // Entries whose hash selects this segment
+    char padding[ANV_CONCURRENT_HASHMAP_CACHE_LINE -
+                 (sizeof(ANVMutex) + sizeof(ANVHashMap*)) % ANV_CONCURRENT_HASHMAP_CACHE_LINE];
+} ANVConcurrentHashMapSegment;
+
+/**
+ * Concurrent hash map structure with custom allocator support.
+ */
+typedef struct ANVConcurrentHashMap
+{
+    ANVConcurrentHashMapSegment* segments; // Cache-line aligned segment array
+    void* segment_block;                   // Allocation holding segments
+    size_t segment_count;                  // Number of segments (power of two)
+    unsigned segment_shift;                // 64 - log2(segment_count)
+    hash_func hash;                        // Hash function for keys
+    key_equals_func key_equals;            // Key equality function
+    ANVAllocator* alloc;                   // Custom allocator (must be thread-safe)
+} ANVConcurrentHashMap;
+
+//==============================================================================
+// Creation and destruction functions
+//==============================================================================
+
+/**
+ * Create a new concurrent hash map.
+ *
+ * @param alloc Custom allocator (required, must be thread-safe)
+ * @param hash Hash function for keys (required)
+ * @param key_equals Key equality function (required)
+ * @param segment_count Number of lock stripes, rounded up to a power of two (0 for default)
+ * @param initial_capacity Initial number of buckets across all segments (0 for default)
+ * @return Pointer to new map, or NULL on failure
+ */
+ANV_API ANVConcurrentHashMap* anv_concurrent_hashmap_create(ANVAllocator* alloc, hash_func hash,
+                                                            key_equals_func key_equals, size_t segment_count,
+                                                            size_t initial_capacity);
+
+/**
+ * Destroy the map. No other thread may use it concurrently or afterwards.
+ *
+ * @param map The map to destroy
+ * @param should_free_keys Whether to free key data using alloc->data_free
+ * @param should_free_values Whether to free value data using alloc->data_free
+ */
+ANV_API void anv_concurrent_hashmap_destroy(ANVConcurrentHashMap* map, bool should_free_keys,
+                                            bool should_free_values);
+
+/**
+ * Remove all entries, one segment at a time.
+ *
+ * @param map The map to clear
+ * @param should_free_keys Whether to free key data
+ * @param should_free_values Whether to free value data
+ */
+ANV_API void anv_concurrent_hashmap_clear(ANVConcurrentHashMap* map, bool should_free_keys,
+                                          bool should_free_values);
+
+//==============================================================================
+// Information functions
+//==============================================================================
+
+/**
+ * Get the number of entries. Segments are counted one at a time, so the
+ * result may be stale while other threads are writing.
+ *
+ * @param map The map to query
+ * @return Number of entries, or 0 if map is NULL
+ */
+ANV_API size_t anv_concurrent_hashmap_size(ANVConcurrentHashMap* map);
+
+/**
+ * Check if the map is empty (with the same caveat as size).
+ *
+ * @param map The map to check
+ * @return 1 if empty or NULL, 0 if it contains elements
+ */
+ANV_API int anv_concurrent_hashmap_is_empty(ANVConcurrentHashMap* map);
+
+/**
+ * Get the number of lock stripes.
+ *
+ * @param map The map to query
+ * @return Segment count, or 0 if map is NULL
+ */
+ANV_API size_t anv_concurrent_hashmap_segment_count(const ANVConcurrentHashMap* map);
+
+/**
+ * Get the number of bytes owned by the map, excluding user data.
+ *
+ * @param map The map to query
+ * @return Bytes owned, or 0 if map is NULL
+ */
+ANV_API size_t anv_concurrent_hashmap_memory_usage(ANVConcurrentHashMap* map);
+
+/**
+ * Check if the map contains a key.
+ *
+ * @param map The map to search
+ * @param key The key to search for
+ * @return 1 if key exists, 0 if not found or on error
+ */
+ANV_API int anv_concurrent_hashmap_contains_key(ANVConcurrentHashMap* map, const void* key);
+
+//==============================================================================
+// Map operations
+//==============================================================================
+
+/**
+ * Insert or update a key-value pair.
+ *
+ * @param map The map to modify
+ * @param key Pointer to key data (ownership transferred to map)
+ * @param value Pointer to value data (ownership transferred to map)
+ * @return 0 on success, -1 on error
+ */
+ANV_API int anv_concurrent_hashmap_put(ANVConcurrentHashMap* map, void* key, void* value);
+
+/**
+ * Insert or update a key-value pair, returning the old value if key exists.
+ *
+ * @param map The map to modify
+ * @param key Pointer to key data (ownership transferred to map)
+ * @param value Pointer to value data (ownership transferred to map)
+ * @param old_value_out Pointer to store the old value (NULL if key didn't exist)
+ * @return 0 on success, -1 on error
+ */
+ANV_API int anv_concurrent_hashmap_put_replace(ANVConcurrentHashMap* map, void* key, void* value,
+                                               void** old_value_out);
+
+/**
+ * Insert a key-value pair only if the key is absent, as one atomic step.
+ *
+ * @param map The map to modify
+ * @param key Pointer to key data (ownership transferred to map when inserted)
+ * @param value Pointer to value data (ownership transferred to map when inserted)
+ * @param existing_out Receives the current value when the key was present (can be NULL)
+ * @return 0 if inserted, 1 if the key was already present, -1 on error
+ */
+ANV_API int anv_concurrent_hashmap_put_if_absent(ANVConcurrentHashMap* map, void* key, void* value,
+                                                 void** existing_out);
+
+/**
+ * Get the value associated with a key.
+ *
+ * @param map The map to search
+ * @param key The key to look up
+ * @return Pointer to associated value, or NULL if not found or on error
+ */
+ANV_API void* anv_concurrent_hashmap_get(ANVConcurrentHashMap* map, const void* key);
+
+/**
+ * Remove a key-value pair.
+ *
+ * @param map The map to modify
+ * @param key The key to remove
+ * @param should_free_key Whether to free the key data
+ * @param should_free_value Whether to free the value data
+ * @return 0 on success, -1 if key not found or on error
+ */
+ANV_API int anv_concurrent_hashmap_remove(ANVConcurrentHashMap* map, const void* key,
+                                          bool should_free_key, bool should_free_value);
+
+/**
+ * Remove a key-value pair and return the value.
+ *
+ * @param map The map to modify
+ * @param key The key to remove
+ * @param should_free_key Whether to free the key data
+ * @return Pointer to the removed value, or NULL if not found or on error
+ */
+ANV_API void* anv_concurrent_hashmap_remove_get(ANVConcurrentHashMap* map, const void* key,
+                                                bool should_free_key);
+
+/**
+ * Apply an action to each key-value pair. Each segment is locked while its
+ * entries are visited, so action must not call back into the map.
+ *
+ * @param map The map to process
+ * @param action Function applied to each key-value pair
+ */
+ANV_API void anv_concurrent_hashmap_for_each(ANVConcurrentHashMap* map, void (*action)(void* key, void* value));
+
+//==============================================================================
+// Iterator functions
+//==============================================================================
+
+/**
+ * Create a weakly consistent iterator yielding ANVPair structures.
+ *
+ * The iterator copies one segment's entries at a time under that segment's
+ * lock and never holds a lock between calls. It yields every entry present
+ * for the whole iteration exactly once, and may or may not yield entries
+ * added or removed while it runs. If a segment cannot be copied because an
+ * allocation fails, iteration ends there and is_valid returns false.
+ *
+ * @param map The map to iterate over
+ * @return An Iterator object for traversal
+ */
+ANV_API ANVIterator anv_concurrent_hashmap_iterator(ANVConcurrentHashMap* map);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //ANVIL_CONCURRENTHASHMAP_H
@@ -113,6 +113,15 @@ ANV_API size_t anv_dll_size(const ANVDoublyLinkedList* list);
  */
 ANV_API int anv_dll_is_empty(const ANVDoublyLinkedList* list);
 
+/**
+ * Get the number of bytes owned by the list for the list struct and its nodes,
+ * excluding user data.
+ *
+ * @param list The list to query
+ * @return Bytes owned, or 0 if list is NULL
+ */
+ANV_API size_t anv_dll_memory_usage(const ANVDoublyLinkedList* list);
+
 /**
  * Find the first node matching data using the comparison function.
  *
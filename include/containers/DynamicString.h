@@ -8,6 +8,7 @@
 #include <stdint.h>
 #include <stdio.h>
 
+#include "common/Allocator.h"
 #include "common/CStandardCompatibility.h"
 
 #ifdef __cplusplus
@@ -20,10 +21,13 @@ extern "C" {
 // Represents position not found
 #define STR_NPOS SIZE_MAX
 
+// Heap buffers come from alloc, or from malloc/free when alloc is NULL.
+// The allocator must outlive the string.
 typedef struct ANVString
 {
     size_t capacity;
     size_t size;
+    ANVAllocator* alloc;
 
     union
     {
@@ -50,8 +54,14 @@ ANV_API ANVString anv_str_create_empty(size_t initial_capacity);
 
 ANV_API ANVString anv_str_create_from_cstring(const char* cstr);
 
+// Copies use the source string's allocator
 ANV_API ANVString anv_str_create_from_string(const ANVString* str);
 
+// Creation functions that take their heap buffer from an allocator
+ANV_API ANVString anv_str_create_empty_with_alloc(ANVAllocator* alloc, size_t initial_capacity);
+
+ANV_API ANVString anv_str_create_from_cstring_with_alloc(ANVAllocator* alloc, const char* cstr);
+
 // String free method
 ANV_API void anv_str_destroy(ANVString* str);
 
@@ -105,6 +115,17 @@ ANV_API size_t anv_str_capacity(const ANVString* str);
 
 ANV_API size_t anv_str_size(const ANVString* str);
 
+// Bytes of heap storage owned by the string, 0 while the inline buffer is used
+ANV_API size_t anv_str_memory_usage(const ANVString* str);
+
+// Hash function for ANVString* keys in hash containers. Hashes the stored
+// length, so embedded null bytes are significant and no strlen is needed.
+ANV_API size_t anv_str_hash(const void* key);
+
+// Equality function for ANVString* keys in hash containers. Returns 1 if the
+// strings have the same size and bytes, 0 otherwise.
+ANV_API int anv_str_key_equals(const void* key1, const void* key2);
+
 // Finds the first character that matches any character in value and
 // returns it's position or STR_NPOS
 ANV_API size_t anv_str_find_first_of(const ANVString* str, const char* value);
@@ -0,0 +1,235 @@
+//
+// FlatMap.h
+// Open-addressing hash map with grouped control-byte probing.
+//
+// Keys and values live inline in one slot array, alongside a control byte per
+// slot that holds 7 bits of the key's hash (or an empty/deleted marker).
+// Lookups probe 16 control bytes at a time, with SSE2 where the target
+// supports it, and only touch slots whose control byte matches. No per-entry
+// allocation is made, so a lookup costs one or two cache lines instead of a
+// pointer chase per chained node.
+//
+// The API mirrors ANVHashMap. Pointers into the map (e.g. iterator pairs) are
+// invalidated by any insertion that triggers a rehash.
+
+#ifndef ANVIL_FLATMAP_H
+#define ANVIL_FLATMAP_H
+
+#include <stdint.h>
+
+#include "Iterator.h"
+#include "common/Allocator.h"
+#include "common/CStandardCompatibility.h"
+#include "containers/HashMap.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//==============================================================================
+// Constants
+//==============================================================================
+
+// Number of control bytes examined per probe step
+#define ANV_FLATMAP_GROUP_WIDTH 16
+
+//==============================================================================
+// Type definitions
+//==============================================================================
+
+/**
+ * Key-value slot stored inline in the table.
+ */
+typedef struct ANVFlatMapSlot
+{
+    void* key;   // Pointer to key data
+    void* value; // Pointer to value data
+} ANVFlatMapSlot;
+
+/**
+ * Flat hash map structure with custom allocator support.
+ * Uses open addressing over groups of ANV_FLATMAP_GROUP_WIDTH slots.
+ * Provides average O(1) insert, lookup, and delete operations.
+ */
+typedef struct ANVFlatMap
+{
+    ANVFlatMapSlot* slots;      // Slot array (capacity entries), followed in memory by ctrl
+    int8_t* ctrl;               // Control byte per slot: hash tag, empty or deleted
+    size_t capacity;            // Number of slots (power of two, multiple of the group width)
+    size_t size;                // Number of key-value pairs
+    size_t growth_left;         // Insertions into empty slots allowed before a rehash
+    hash_func hash;             // Hash function for keys
+    key_equals_func key_equals; // Key equality function
+    ANVAllocator* alloc;        // Custom allocator
+} ANVFlatMap;
+
+//==============================================================================
+// Creation and destruction functions
+//==============================================================================
+
+/**
+ * Create a new flat map with custom allocator and functions.
+ *
+ * @param alloc Custom allocator (required)
+ * @param hash Hash function for keys (required)
+ * @param key_equals Key equality function (required)
+ * @param initial_capacity Number of elements to size the table for (0 for default)
+ * @return Pointer to new flat map, or NULL on failure
+ */
+ANV_API ANVFlatMap* anv_flatmap_create(ANVAllocator* alloc, hash_func hash,
+                                       key_equals_func key_equals, size_t initial_capacity);
+
+/**
+ * Destroy the flat map and its table.
+ *
+ * @param map The flat map to destroy
+ * @param should_free_keys Whether to free key data using alloc->data_free
+ * @param should_free_values Whether to free value data using alloc->data_free
+ */
+ANV_API void anv_flatmap_destroy(ANVFlatMap* map, bool should_free_keys, bool should_free_values);
+
+/**
+ * Clear all elements from the flat map, keeping the table allocated.
+ *
+ * @param map The flat map to clear
+ * @param should_free_keys Whether to free key data
+ * @param should_free_values Whether to free value data
+ */
+ANV_API void anv_flatmap_clear(ANVFlatMap* map, bool should_free_keys, bool should_free_values);
+
+//==============================================================================
+// Information functions
+//==============================================================================
+
+/**
+ * Get the number of key-value pairs in the flat map.
+ *
+ * @param map The flat map to query
+ * @return Number of pairs, or 0 if map is NULL
+ */
+ANV_API size_t anv_flatmap_size(const ANVFlatMap* map);
+
+/**
+ * Check if the flat map is empty.
+ *
+ * @param map The flat map to check
+ * @return 1 if empty or NULL, 0 if it contains elements
+ */
+ANV_API int anv_flatmap_is_empty(const ANVFlatMap* map);
+
+/**
+ * Get the number of slots in the table.
+ *
+ * @param map The flat map to query
+ * @return Slot count, or 0 if map is NULL
+ */
+ANV_API size_t anv_flatmap_capacity(const ANVFlatMap* map);
+
+/**
+ * Get the current load factor of the flat map.
+ *
+ * @param map The flat map to query
+ * @return Load factor (size / capacity), or 0.0 if map is NULL
+ */
+ANV_API double anv_flatmap_load_factor(const ANVFlatMap* map);
+
+/**
+ * Get the number of bytes owned by the flat map for the map struct, slots and control bytes,
+ * excluding user data.
+ *
+ * @param map The flat map to query
+ * @return Bytes owned, or 0 if map is NULL
+ */
+ANV_API size_t anv_flatmap_memory_usage(const ANVFlatMap* map);
+
+/**
+ * Check if the flat map contains a key.
+ *
+ * @param map The flat map to search
+ * @param key The key to search for
+ * @return 1 if key exists, 0 if not found or on error
+ */
+ANV_API int anv_flatmap_contains_key(const ANVFlatMap* map, const void* key);
+
+//==============================================================================
+// Flat map operations
+//==============================================================================
+
+/**
+ * Insert or update a key-value pair in the flat map.
+ *
+ * @param map The flat map to modify
+ * @param key Pointer to key data (ownership transferred to map)
+ * @param value Pointer to value data (ownership transferred to map)
+ * @return 0 on success, -1 on error
+ */
+ANV_API int anv_flatmap_put(ANVFlatMap* map, void* key, void* value);
+
+/**
+ * Insert or update a key-value pair, returning the old value if key exists.
+ *
+ * @param map The flat map to modify
+ * @param key Pointer to key data (ownership transferred to map)
+ * @param value Pointer to value data (ownership transferred to map)
+ * @param old_value_out Pointer to store the old value (NULL if key didn't exist)
+ * @return 0 on success, -1 on error
+ */
+ANV_API int anv_flatmap_put_replace(ANVFlatMap* map, void* key, void* value, void** old_value_out);
+
+/**
+ * Get the value associated with a key.
+ *
+ * @param map The flat map to search
+ * @param key The key to look up
+ * @return Pointer to associated value, or NULL if not found or on error
+ */
+ANV_API void* anv_flatmap_get(const ANVFlatMap* map, const void* key);
+
+/**
+ * Remove a key-value pair from the flat map.
+ *
+ * @param map The flat map to modify
+ * @param key The key to remove
+ * @param should_free_key Whether to free the key data
+ * @param should_free_value Whether to free the value data
+ * @return 0 on success, -1 if key not found or on error
+ */
+ANV_API int anv_flatmap_remove(ANVFlatMap* map, const void* key,
+                               bool should_free_key, bool should_free_value);
+
+/**
+ * Remove a key-value pair and return the value.
+ *
+ * @param map The flat map to modify
+ * @param key The key to remove
+ * @param should_free_key Whether to free the key data
+ * @return Pointer to the removed value, or NULL if not found or on error
+ */
+ANV_API void* anv_flatmap_remove_get(ANVFlatMap* map, const void* key, bool should_free_key);
+
+/**
+ * Apply an action function to each key-value pair in the flat map.
+ *
+ * @param map The flat map to process
+ * @param action Function applied to each key-value pair
+ */
+ANV_API void anv_flatmap_for_each(const ANVFlatMap* map, void (*action)(void* key, void* value));
+
+//==============================================================================
+// Iterator functions
+//==============================================================================
+
+/**
+ * Create an iterator for the flat map (unordered traversal).
+ * Iterator yields ANVPair structures.
+ *
+ * @param map The flat map to iterate over
+ * @return An Iterator object for traversal
+ */
+ANV_API ANVIterator anv_flatmap_iterator(const ANVFlatMap* map);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //ANVIL_FLATMAP_H
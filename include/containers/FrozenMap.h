@@ -0,0 +1,184 @@
+//
+// FrozenMap.h
+// Immutable hash map built once from an iterator, indexed by a minimal
+// perfect hash.
+//
+// The map is built with hash-and-displace (as in CHD): keys are split into
+// small buckets by one hash, and each bucket is given a 32-bit seed chosen
+// so that a second hash, salted with the seed, sends every key to its own
+// slot. Buckets holding a single key skip the search and store their slot
+// directly. The entries sit in one array with exactly one slot per key, so
+// a lookup is one call to the hash function, one read of the bucket's seed
+// and one probe of the entry array, with no chains or probe sequences to
+// walk.
+//
+// Nothing changes after the build, so any number of threads may read one
+// map at the same time without locking. Building is O(n) expected time and
+// needs about 1 byte of seeds per key on top of the entries.
+
+#ifndef ANVIL_FROZENMAP_H
+#define ANVIL_FROZENMAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Iterator.h"
+#include "common/Allocator.h"
+#include "common/CStandardCompatibility.h"
+#include "containers/HashMap.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//==============================================================================
+// Constants
+//==============================================================================
+
+// Largest number of entries a frozen map can hold
+#define ANV_FROZENMAP_MAX_SIZE 0x7FFFFFFFu
+
+//==============================================================================
+// Type definitions
+//==============================================================================
+
+/**
+ * One key-value pair in the entry array.
+ */
+typedef struct ANVFrozenMapEntry
+{
+    void* key;   // Pointer to key data
+    void* value; // Pointer to value data
+    size_t hash; // Cached hash code of key
+} ANVFrozenMapEntry;
+
+/**
+ * Frozen map structure with custom allocator support. Read-only after
+ * anv_frozenmap_from_iterator returns.
+ */
+typedef struct ANVFrozenMap
+{
+    ANVFrozenMapEntry* entries; // size entries, each at the slot its key hashes to
+    size_t size;                // Number of key-value pairs
+    uint32_t* seeds;            // Per-bucket displacement seed, or slot | direct flag
+    size_t bucket_count;        // Number of buckets
+    uint64_t salt;              // Build salt mixed into both hashes
+    hash_func hash;             // Hash function for keys
+    key_equals_func key_equals; // Key equality function
+    ANVAllocator* alloc;        // Custom allocator
+} ANVFrozenMap;
+
+//==============================================================================
+// Creation and destruction functions
+//==============================================================================
+
+/**
+ * Create a new frozen map from an iterator of key-value pairs.
+ *
+ * This function consumes all elements from the provided iterator, following
+ * the same rules as anv_hashmap_from_iterator: NULL elements are skipped, and
+ * when a key appears more than once the first key is kept with the last
+ * value.
+ *
+ * @param it The source iterator (must be valid and support has_next/get/next, yields ANVPair*)
+ * @param alloc The custom allocator to use
+ * @param hash Hash function for keys
+ * @param key_equals Key equality function
+ * @param should_copy If true, creates deep copies of all keys and values using alloc->copy,
+ *                    which must accept an ANVPair* as input. If false, uses keys and values
+ *                    directly from the iterator.
+ * @return A new frozen map with elements from iterator, or NULL on error
+ *
+ * @note Two different keys with the same hash code cannot be told apart by a
+ *       perfect hash, so the build fails if the hash function collides.
+ * @note If the build fails with should_copy true, all copies are freed.
+ */
+ANV_API ANVFrozenMap* anv_frozenmap_from_iterator(ANVIterator* it, ANVAllocator* alloc,
+                                                  hash_func hash, key_equals_func key_equals, bool should_copy);
+
+/**
+ * Destroy the frozen map. No other thread may use it concurrently or
+ * afterwards.
+ *
+ * @param map The frozen map to destroy
+ * @param should_free_keys Whether to free key data using alloc->data_free
+ * @param should_free_values Whether to free value data using alloc->data_free
+ */
+ANV_API void anv_frozenmap_destroy(ANVFrozenMap* map, bool should_free_keys, bool should_free_values);
+
+//==============================================================================
+// Information functions
+//==============================================================================
+
+/**
+ * Get the number of key-value pairs in the frozen map.
+ *
+ * @param map The frozen map to query
+ * @return Number of pairs, or 0 if map is NULL
+ */
+ANV_API size_t anv_frozenmap_size(const ANVFrozenMap* map);
+
+/**
+ * Check if the frozen map is empty.
+ *
+ * @param map The frozen map to check
+ * @return 1 if empty or NULL, 0 if it contains elements
+ */
+ANV_API int anv_frozenmap_is_empty(const ANVFrozenMap* map);
+
+/**
+ * Get the number of bytes owned by the frozen map, excluding user data.
+ *
+ * @param map The frozen map to query
+ * @return Bytes owned, or 0 if map is NULL
+ */
+ANV_API size_t anv_frozenmap_memory_usage(const ANVFrozenMap* map);
+
+/**
+ * Check if the frozen map contains a key.
+ *
+ * @param map The frozen map to search
+ * @param key The key to search for
+ * @return 1 if key exists, 0 if not found or on error
+ */
+ANV_API int anv_frozenmap_contains_key(const ANVFrozenMap* map, const void* key);
+
+//==============================================================================
+// Frozen map operations
+//==============================================================================
+
+/**
+ * Get the value associated with a key.
+ *
+ * @param map The frozen map to search
+ * @param key The key to look up
+ * @return Pointer to associated value, or NULL if not found or on error
+ */
+ANV_API void* anv_frozenmap_get(const ANVFrozenMap* map, const void* key);
+
+/**
+ * Apply an action function to each key-value pair, in slot order.
+ *
+ * @param map The frozen map to process
+ * @param action Function applied to each key-value pair
+ */
+ANV_API void anv_frozenmap_for_each(const ANVFrozenMap* map, void (*action)(void* key, void* value));
+
+//==============================================================================
+// Iterator functions
+//==============================================================================
+
+/**
+ * Create an iterator over the frozen map in slot order.
+ * Iterator yields ANVPair structures and supports backward traversal.
+ *
+ * @param map The frozen map to iterate over
+ * @return An Iterator object for traversal
+ */
+ANV_API ANVIterator anv_frozenmap_iterator(const ANVFrozenMap* map);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //ANVIL_FROZENMAP_H
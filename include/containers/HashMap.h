@@ -5,6 +5,8 @@
 #ifndef ANVIL_HASHMAP_H
 #define ANVIL_HASHMAP_H
 
+#include <stdint.h>
+
 #include "Iterator.h"
 #include "common/Allocator.h"
 #include "common/CStandardCompatibility.h"
@@ -42,6 +44,7 @@ typedef struct ANVHashMapNode
 {
     void* key;                   // Pointer to key data
     void* value;                 // Pointer to value data
+    size_t hash;                 // Cached hash code of key
     struct ANVHashMapNode* next; // Next node in chain
 } ANVHashMapNode;
 
@@ -49,18 +52,48 @@ typedef struct ANVHashMapNode
  * Hash map structure with custom allocator support.
  * Uses separate chaining for collision resolution.
  * Provides average O(1) insert, lookup, and delete operations.
+ *
+ * With incremental resizing enabled, doubling the table keeps the previous
+ * bucket array in old_buckets and every put/remove migrates migrate_step of
+ * its buckets into the new array. Keys stay in their old bucket until it is
+ * migrated, so each lookup still searches a single chain.
  */
 typedef struct ANVHashMap
 {
-    ANVHashMapNode** buckets;   // Array of bucket heads
-    size_t bucket_count;        // Number of buckets
-    size_t size;                // Number of key-value pairs
+    ANVHashMapNode** buckets;     // Array of bucket heads
+    size_t bucket_count;          // Number of buckets
+    ANVHashMapNode** old_buckets; // Bucket array being migrated, or NULL
+    size_t old_bucket_count;      // Number of buckets in old_buckets
+    size_t migrate_index;         // Next old bucket to migrate
+    size_t migrate_step;          // Old buckets migrated per put/remove (0 = resize all at once)
+    bool power_of_two;            // Index by mixed hash & (bucket_count - 1) instead of modulo
+    size_t size;                  // Number of key-value pairs
     double max_load_factor;     // Maximum load factor before resize
     hash_func hash;             // Hash function for keys
     key_equals_func key_equals; // Key equality function
     ANVAllocator* alloc;        // Custom allocator
+    size_t resize_count;        // Bucket array resizes since creation
+    uint64_t rehash_nanos;      // Time spent moving nodes into resized bucket arrays
 } ANVHashMap;
 
+/**
+ * Table health figures reported by anv_hashmap_stats. A good hash function
+ * keeps max_chain_length small and mean_chain_length close to 1 at the
+ * default load factor; a poor one shows up as few used buckets holding long
+ * chains.
+ */
+typedef struct ANVHashMapStats
+{
+    size_t size;              // Number of key-value pairs
+    size_t bucket_count;      // Buckets, including any still being migrated
+    size_t used_buckets;      // Buckets holding at least one node
+    double load_factor;       // size / bucket_count, over the same buckets
+    size_t max_chain_length;  // Nodes in the longest chain
+    double mean_chain_length; // Mean nodes per non-empty chain
+    size_t resize_count;      // Bucket array resizes since creation
+    double rehash_seconds;    // Total time spent moving nodes into resized bucket arrays
+} ANVHashMapStats;
+
 //==============================================================================
 // Creation and destruction functions
 //==============================================================================
@@ -115,6 +148,15 @@ ANV_API size_t anv_hashmap_size(const ANVHashMap* map);
  */
 ANV_API int anv_hashmap_is_empty(const ANVHashMap* map);
 
+/**
+ * Get the number of bytes owned by the hash map for the map struct, bucket array and nodes,
+ * excluding user data.
+ *
+ * @param map The hash map to query
+ * @return Bytes owned, or 0 if map is NULL
+ */
+ANV_API size_t anv_hashmap_memory_usage(const ANVHashMap* map);
+
 /**
  * Get the current load factor of the hash map.
  *
@@ -123,6 +165,20 @@ ANV_API int anv_hashmap_is_empty(const ANVHashMap* map);
  */
 ANV_API double anv_hashmap_load_factor(const ANVHashMap* map);
 
+/**
+ * Collect table health figures and a chain length histogram, e.g. for
+ * export to a metrics system. Walks every bucket, so costs O(buckets).
+ *
+ * @param map The hash map to inspect
+ * @param stats_out Receives the figures (required)
+ * @param histogram Receives histogram[k] = buckets whose chain holds k nodes;
+ *                  the last element also counts every longer chain (can be NULL)
+ * @param histogram_len Number of elements in histogram
+ * @return 0 on success, -1 on error
+ */
+ANV_API int anv_hashmap_stats(const ANVHashMap* map, ANVHashMapStats* stats_out, size_t* histogram,
+                              size_t histogram_len);
+
 /**
  * Check if the hash map contains a key.
  *
@@ -170,6 +226,24 @@ ANV_API int anv_hashmap_put_replace(ANVHashMap* map, void* key, void* value, voi
  */
 ANV_API int anv_hashmap_put_with_free(ANVHashMap* map, void* key, void* value, bool should_free_old_value);
 
+/**
+ * Find or insert a key with a single hash and chain walk, and return a
+ * pointer to its value slot. A new key is inserted with a NULL value and the
+ * map takes ownership of it; for an existing key the map keeps its stored
+ * key and the caller keeps key. The slot stays valid across resizes until
+ * the key is removed or the map is cleared or destroyed.
+ *
+ * Example (word count with counts stored in the value pointer):
+ *     void** slot = anv_hashmap_entry(map, word, &inserted);
+ *     *slot = (void*)((intptr_t)*slot + 1);
+ *
+ * @param map The hash map to modify
+ * @param key Pointer to key data
+ * @param inserted_out Optional, set to true if key was inserted and false otherwise
+ * @return Pointer to the value slot, or NULL on error
+ */
+ANV_API void** anv_hashmap_entry(ANVHashMap* map, void* key, bool* inserted_out);
+
 /**
  * Get the value associated with a key.
  *
@@ -201,6 +275,113 @@ ANV_API int anv_hashmap_remove(ANVHashMap* map, const void* key,
  */
 ANV_API void* anv_hashmap_remove_get(ANVHashMap* map, const void* key, bool should_free_key);
 
+//==============================================================================
+// Batched operations
+//==============================================================================
+
+/**
+ * Look up many keys at once. Keys are hashed and their chains prefetched a
+ * batch at a time before any of them is resolved, so cache misses on large
+ * tables overlap instead of serializing one lookup after another.
+ *
+ * @param map The hash map to search
+ * @param keys Array of count keys (NULL entries are treated as not found)
+ * @param count Number of keys
+ * @param values_out Array of count slots receiving each value, or NULL if not found
+ * @return Number of keys found, or 0 on error
+ */
+ANV_API size_t anv_hashmap_get_many(const ANVHashMap* map, const void* const* keys,
+                                    size_t count, void** values_out);
+
+/**
+ * Insert or update many key-value pairs at once, prefetching chains a batch
+ * at a time. Each batch is looked up first and the table grows only for the
+ * keys that are not present yet, so updates never enlarge the table.
+ *
+ * @param map The hash map to modify
+ * @param keys Array of count keys (ownership transferred to map, none may be NULL)
+ * @param values Array of count values (ownership transferred to map)
+ * @param count Number of pairs
+ * @return 0 on success, -1 on error (pairs before the failing one remain inserted)
+ */
+ANV_API int anv_hashmap_put_many(ANVHashMap* map, void* const* keys, void* const* values, size_t count);
+
+//==============================================================================
+// Capacity management
+//==============================================================================
+
+/**
+ * Grow the bucket array so that expected_size entries fit under the maximum
+ * load factor, e.g. before a bulk load. Never shrinks the table.
+ *
+ * @param map The hash map to resize
+ * @param expected_size Number of entries to make room for
+ * @return 0 on success, -1 on error
+ */
+ANV_API int anv_hashmap_reserve(ANVHashMap* map, size_t expected_size);
+
+/**
+ * Shrink the bucket array to the smallest size that holds the current entries
+ * under the maximum load factor, returning memory after mass removals.
+ *
+ * @param map The hash map to resize
+ * @return 0 on success, -1 on error
+ */
+ANV_API int anv_hashmap_shrink_to_fit(ANVHashMap* map);
+
+//==============================================================================
+// Incremental resizing
+//==============================================================================
+
+/**
+ * Enable or disable incremental resizing. When enabled, growing the table
+ * no longer rehashes every node inside one put: the old bucket array is
+ * drained buckets_per_step buckets at a time by later puts and removes,
+ * bounding the worst-case latency of a single operation.
+ *
+ * @param map The hash map to configure
+ * @param buckets_per_step Old buckets migrated per put/remove; 0 disables incremental
+ *                         resizing and completes any migration in progress
+ * @return 0 on success, -1 on error
+ */
+ANV_API int anv_hashmap_set_incremental_resize(ANVHashMap* map, size_t buckets_per_step);
+
+/**
+ * Migrate up to bucket_count buckets of an in-progress incremental resize,
+ * e.g. from an idle loop.
+ *
+ * @param map The hash map to advance
+ * @param bucket_count Maximum number of old buckets to migrate
+ * @return 1 if migration is still in progress, 0 if not, -1 on error
+ */
+ANV_API int anv_hashmap_rehash_step(ANVHashMap* map, size_t bucket_count);
+
+/**
+ * Check whether an incremental resize is in progress.
+ *
+ * @param map The hash map to query
+ * @return true if old buckets remain to be migrated
+ */
+ANV_API bool anv_hashmap_is_rehashing(const ANVHashMap* map);
+
+//==============================================================================
+// Table indexing
+//==============================================================================
+
+/**
+ * Switch between modulo and power-of-two bucket indexing. In power-of-two
+ * mode the bucket count is rounded up to a power of two and the bucket index
+ * is a finalizer mix of the hash masked to the table size, which avoids an
+ * integer division on every operation and spreads weak hashes such as
+ * anv_hash_int and anv_hash_pointer across the table. Switching rehashes
+ * every node once.
+ *
+ * @param map The hash map to configure
+ * @param enabled true for power-of-two indexing, false for modulo indexing
+ * @return 0 on success, -1 on error
+ */
+ANV_API int anv_hashmap_set_power_of_two(ANVHashMap* map, bool enabled);
+
 //==============================================================================
 // Bulk operations
 //==============================================================================
@@ -297,12 +478,70 @@ ANV_API ANVIterator anv_hashmap_iterator(const ANVHashMap* map);
 ANV_API ANVHashMap* anv_hashmap_from_iterator(ANVIterator* it, ANVAllocator* alloc,
                                       hash_func hash, key_equals_func key_equals, bool should_copy);
 
+/**
+ * Create a new hash map from an iterator, sized up front for expected_count
+ * elements so that loading does not double the table repeatedly. Otherwise
+ * identical to anv_hashmap_from_iterator.
+ *
+ * @param it The source iterator (yields ANVPair*)
+ * @param alloc The custom allocator to use
+ * @param hash Hash function for keys
+ * @param key_equals Key equality function
+ * @param should_copy Whether to copy each pair with alloc->copy
+ * @param expected_count Expected number of elements (0 if unknown)
+ * @return A new hash map with elements from iterator, or NULL on error
+ */
+ANV_API ANVHashMap* anv_hashmap_from_iterator_sized(ANVIterator* it, ANVAllocator* alloc,
+                                            hash_func hash, key_equals_func key_equals,
+                                            bool should_copy, size_t expected_count);
+
 //==============================================================================
 // Utility hash functions
 //==============================================================================
 
 /**
- * Hash function for string keys.
+ * Get the process-wide hash seed used by anv_hash_bytes and anv_hash_string.
+ * It is chosen from the clock and address-space layout on first use, so hash
+ * values (and iteration orders) differ between runs and a colliding key set
+ * cannot be prepared in advance.
+ *
+ * @return The current seed
+ */
+ANV_API uint64_t anv_hash_seed(void);
+
+/**
+ * Replace the process-wide hash seed, e.g. for reproducible runs. Must be
+ * called before any map hashing with the seed is populated, since existing
+ * entries would no longer be found. A seed of 0 is replaced by a fixed
+ * non-zero constant.
+ *
+ * @param seed The new seed
+ */
+ANV_API void anv_hash_set_seed(uint64_t seed);
+
+/**
+ * Hash a byte range with an explicit seed. Reads 8 bytes at a time using a
+ * wyhash-style multiply-mix, so long keys hash in a fraction of the time of a
+ * byte-wise hash.
+ *
+ * @param data Pointer to the bytes (may be NULL if length is 0)
+ * @param length Number of bytes
+ * @param seed Seed value
+ * @return 64-bit hash value
+ */
+ANV_API uint64_t anv_hash_bytes_seeded(const void* data, size_t length, uint64_t seed);
+
+/**
+ * Hash a byte range with the process-wide seed.
+ *
+ * @param data Pointer to the bytes (may be NULL if length is 0)
+ * @param length Number of bytes
+ * @return Hash value
+ */
+ANV_API size_t anv_hash_bytes(const void* data, size_t length);
+
+/**
+ * Hash function for string keys, seeded with the process-wide seed.
  *
  * @param key Pointer to null-terminated string
  * @return Hash value
@@ -1,15 +1,17 @@
 //
 // HashSet.h
-// A set implementation built on top of HashMap.
+// A hash set of unique keys with its own open-addressed storage.
 //
-// This file implements a hash set for storing unique keys only.
-// Built as a wrapper around HashMap for code reuse and efficiency.
+// Keys are stored inline in one slot array next to a control byte per slot,
+// probed in groups like ANVFlatMap. There are no per-element nodes or
+// values, so an element costs a key pointer and a control byte.
 // Provides average O(1) add, remove, and contains operations.
 
 #ifndef ANVIL_HASHSET_H
 #define ANVIL_HASHSET_H
 
 #include <stddef.h>
+#include <stdint.h>
 
 #include "HashMap.h"
 #include "Iterator.h"
@@ -20,20 +22,56 @@
 extern "C" {
 #endif
 
+//==============================================================================
+// Constants
+//==============================================================================
+
+// Most worker threads used by the parallel set operations
+#define ANV_HASHSET_MAX_THREADS 64
+
 //==============================================================================
 // Type definitions
 //==============================================================================
 
 /**
 * Hash set structure with custom allocator support.
-* Uses HashMap internally with a sentinel value for all elements.
+* Uses open addressing over groups of 16 slots, keeping keys only.
 * Provides average O(1) add, remove, and contains operations.
+* Pointers into the set (e.g. iterators) are invalidated by any insertion
+* that triggers a rehash.
 */
 typedef struct ANVHashSet
 {
-    ANVHashMap* map; // Underlying hash map
+    void** keys;                // Key array (capacity entries), followed in memory by ctrl
+    int8_t* ctrl;               // Control byte per slot: hash tag, empty or deleted
+    size_t capacity;            // Number of slots (power of two, multiple of the group width)
+    size_t size;                // Number of keys
+    size_t growth_left;         // Insertions into empty slots allowed before a rehash
+    hash_func hash;             // Hash function for keys
+    key_equals_func key_equals; // Key equality function
+    ANVAllocator* alloc;        // Custom allocator
+    size_t resize_count;        // Table rebuilds since creation
+    uint64_t rehash_nanos;      // Time spent moving keys into rebuilt tables
 } ANVHashSet;
 
+/**
+* Table health figures reported by anv_hashset_stats. A key's probe length
+* is the number of groups a lookup visits past the key's home group. A good
+* hash function keeps nearly every key in its home group; a poor one shows up
+* as long probe sequences.
+*/
+typedef struct ANVHashSetStats
+{
+    size_t size;              // Number of keys
+    size_t capacity;          // Number of slots
+    size_t tombstones;        // Slots left deleted by removals
+    double load_factor;       // size / capacity
+    size_t max_probe_length;  // Longest probe length of any key
+    double mean_probe_length; // Mean probe length over all keys
+    size_t resize_count;      // Table rebuilds since creation (growth, shrinking or tombstone cleanup)
+    double rehash_seconds;    // Total time spent moving keys into rebuilt tables
+} ANVHashSetStats;
+
 //==============================================================================
 // Creation and destruction functions
 //==============================================================================
@@ -44,7 +82,7 @@ typedef struct ANVHashSet
 * @param alloc Custom allocator (required)
 * @param hash Hash function for keys (required)
 * @param key_equals Key equality function (required)
-* @param initial_capacity Initial number of buckets (0 for default)
+* @param initial_capacity Number of elements to size the table for (0 for default)
 * @return Pointer to new hash set, or NULL on failure
 */
 ANV_API ANVHashSet* anv_hashset_create(ANVAllocator* alloc, hash_func hash,
@@ -86,14 +124,67 @@ ANV_API size_t anv_hashset_size(const ANVHashSet* set);
 */
 ANV_API int anv_hashset_is_empty(const ANVHashSet* set);
 
+/**
+* Get the number of bytes owned by the hash set for the set struct, key slots and
+* control bytes, excluding user data.
+*
+* @param set The hash set to query
+* @return Bytes owned, or 0 if set is NULL
+*/
+ANV_API size_t anv_hashset_memory_usage(const ANVHashSet* set);
+
 /**
 * Get the current load factor of the hash set.
 *
 * @param set The hash set to query
-* @return Load factor (size / bucket_count), or 0.0 if set is NULL
+* @return Load factor (size / capacity), or 0.0 if set is NULL
 */
 ANV_API double anv_hashset_load_factor(const ANVHashSet* set);
 
+/**
+* Collect table health figures and a probe length histogram, e.g. for export
+* to a metrics system. Hashes every key again, so costs O(capacity) plus one
+* hash function call per key.
+*
+* @param set The hash set to inspect
+* @param stats_out Receives the figures (required)
+* @param histogram Receives histogram[k] = keys with probe length k; the last
+*                  element also counts every longer probe (can be NULL)
+* @param histogram_len Number of elements in histogram
+* @return 0 on success, -1 on error
+*/
+ANV_API int anv_hashset_stats(const ANVHashSet* set, ANVHashSetStats* stats_out, size_t* histogram,
+                              size_t histogram_len);
+
+/**
+* Get the number of slots in the table.
+*
+* @param set The hash set to query
+* @return Slot count, or 0 if set is NULL
+*/
+ANV_API size_t anv_hashset_capacity(const ANVHashSet* set);
+
+//==============================================================================
+// Capacity management
+//==============================================================================
+
+/**
+ * Grow the hash set so that expected_size elements fit without rehashing.
+ *
+ * @param set The hash set to resize
+ * @param expected_size Number of elements to make room for
+ * @return 0 on success, -1 on error
+ */
+ANV_API int anv_hashset_reserve(ANVHashSet* set, size_t expected_size);
+
+/**
+ * Shrink the hash set's table to the smallest size that holds its elements.
+ *
+ * @param set The hash set to resize
+ * @return 0 on success, -1 on error
+ */
+ANV_API int anv_hashset_shrink_to_fit(ANVHashSet* set);
+
 //==============================================================================
 // Hash set operations
 //==============================================================================
@@ -152,6 +243,7 @@ ANV_API void* anv_hashset_remove_get(ANVHashSet* set, const void* key);
 
 /**
 * Create the union of two hash sets (elements in either set).
+* The result is sized for both operands up front, so it never rehashes.
 *
 * @param set1 First hash set
 * @param set2 Second hash set
@@ -161,6 +253,7 @@ ANV_API ANVHashSet* anv_hashset_union(const ANVHashSet* set1, const ANVHashSet*
 
 /**
 * Create the intersection of two hash sets (elements in both sets).
+* Iterates the smaller set and sizes the result for it up front.
 *
 * @param set1 First hash set
 * @param set2 Second hash set
@@ -170,6 +263,7 @@ ANV_API ANVHashSet* anv_hashset_intersection(const ANVHashSet* set1, const ANVHa
 
 /**
 * Create the difference of two hash sets (elements in first but not second).
+* The result is sized for set1 up front.
 *
 * @param set1 First hash set
 * @param set2 Second hash set
@@ -177,6 +271,26 @@ ANV_API ANVHashSet* anv_hashset_intersection(const ANVHashSet* set1, const ANVHa
 */
 ANV_API ANVHashSet* anv_hashset_difference(const ANVHashSet* set1, const ANVHashSet* set2);
 
+/**
+* Add every element of src to dest in place, without allocating a third set.
+* Keys are shared with src, not copied.
+*
+* @param dest The hash set to extend
+* @param src The hash set whose elements are added
+* @return 0 on success, -1 on error (dest may hold part of src)
+*/
+ANV_API int anv_hashset_union_into(ANVHashSet* dest, const ANVHashSet* src);
+
+/**
+* Remove from set, in place, every element that is not in other.
+*
+* @param set The hash set to filter
+* @param other The hash set of elements to keep (NULL keeps nothing)
+* @param should_free_keys Whether to free removed keys using alloc->data_free
+* @return Number of elements removed
+*/
+ANV_API size_t anv_hashset_retain_all(ANVHashSet* set, const ANVHashSet* other, bool should_free_keys);
+
 /**
 * Check if one set is a subset of another.
 *
@@ -269,6 +383,74 @@ ANV_API ANVIterator anv_hashset_iterator(const ANVHashSet* set);
 ANV_API ANVHashSet* anv_hashset_from_iterator(ANVIterator* it, ANVAllocator* alloc,
                                               hash_func hash, key_equals_func key_equals, bool should_copy);
 
+#ifdef ANVIL_WITH_SYSTEM
+
+//==============================================================================
+// Parallel operations
+//==============================================================================
+
+// Only available when the system module is built (ANVIL_WITH_SYSTEM).
+// These split the result table into ranges of groups, one per worker thread,
+// and fill the ranges without locks. The hash, key equality and (for
+// should_copy) copy functions are called from several threads at once and
+// must be safe to do so. The allocator is only used on the calling thread.
+// num_threads is capped at ANV_HASHSET_MAX_THREADS and lowered for small
+// inputs. 0 or 1 runs everything on the calling thread.
+
+/**
+* Create the union of two hash sets using several threads.
+* When both sets hold equal keys, the result keeps the key from set1.
+*
+* @param set1 First hash set
+* @param set2 Second hash set
+* @param num_threads Number of worker threads to use
+* @return New hash set containing the union, or NULL on error
+*/
+ANV_API ANVHashSet* anv_hashset_union_parallel(const ANVHashSet* set1, const ANVHashSet* set2,
+                                               size_t num_threads);
+
+/**
+* Create the intersection of two hash sets using several threads.
+*
+* @param set1 First hash set
+* @param set2 Second hash set
+* @param num_threads Number of worker threads to use
+* @return New hash set containing the intersection, or NULL on error
+*/
+ANV_API ANVHashSet* anv_hashset_intersection_parallel(const ANVHashSet* set1, const ANVHashSet* set2,
+                                                      size_t num_threads);
+
+/**
+* Create the difference of two hash sets using several threads.
+*
+* @param set1 First hash set
+* @param set2 Second hash set (NULL yields a copy of set1)
+* @param num_threads Number of worker threads to use
+* @return New hash set containing the difference, or NULL on error
+*/
+ANV_API ANVHashSet* anv_hashset_difference_parallel(const ANVHashSet* set1, const ANVHashSet* set2,
+                                                    size_t num_threads);
+
+/**
+* Create a new hash set from an iterator of keys using several threads.
+* The iterator is drained on the calling thread, then the table is built in
+* parallel. Unlike anv_hashset_from_iterator, duplicate keys are dropped
+* before copying, so only the keys kept are copied.
+*
+* @param it The source iterator (yields key pointers, NULL elements are skipped)
+* @param alloc The custom allocator to use for the new HashSet
+* @param hash Hash function for keys
+* @param key_equals Key equality function
+* @param should_copy If true, the set holds copies made with alloc->copy_func
+* @param num_threads Number of worker threads to use
+* @return A new hash set with elements from iterator, or NULL on error
+*/
+ANV_API ANVHashSet* anv_hashset_from_iterator_parallel(ANVIterator* it, ANVAllocator* alloc,
+                                                       hash_func hash, key_equals_func key_equals,
+                                                       bool should_copy, size_t num_threads);
+
+#endif // ANVIL_WITH_SYSTEM
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,246 @@
+//
+// OrderedMap.h
+// Hash map that iterates in insertion order, stored as a dense entry array
+// plus a compact index table.
+//
+// Entries (key, value and cached hash) are appended to one array in the order
+// they are first inserted, so iteration is a linear scan with no pointer
+// chasing. Lookups go through a separate open-addressed table of small
+// integers, each naming an entry. The integers are 1, 2, 4 or 8 bytes wide,
+// whichever is the narrowest that can address the entry array, so the table
+// costs a few bytes per entry where a chained map spends a node per entry
+// and a bucket pointer.
+//
+// Removal leaves a hole in the entry array, which is skipped during iteration
+// and squeezed out the next time the array fills up. Updating the value of
+// an existing key keeps its position.
+//
+// Pointers into the map (e.g. iterator pairs) are invalidated by any
+// insertion that grows or compacts the entry array.
+
+#ifndef ANVIL_ORDEREDMAP_H
+#define ANVIL_ORDEREDMAP_H
+
+#include <stddef.h>
+
+#include "Iterator.h"
+#include "common/Allocator.h"
+#include "common/CStandardCompatibility.h"
+#include "containers/HashMap.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//==============================================================================
+// Type definitions
+//==============================================================================
+
+/**
+ * One key-value pair in the dense entry array. A NULL key marks a hole left
+ * by a removal.
+ */
+typedef struct ANVOrderedMapEntry
+{
+    void* key;   // Pointer to key data, NULL for a removed entry
+    void* value; // Pointer to value data
+    size_t hash; // Cached hash code of key
+} ANVOrderedMapEntry;
+
+/**
+ * Insertion-ordered hash map structure with custom allocator support.
+ * Provides average O(1) insert, lookup, and delete operations.
+ */
+typedef struct ANVOrderedMap
+{
+    ANVOrderedMapEntry* entries; // Entries in insertion order, including holes
+    size_t entry_count;          // Entries in use, including holes
+    size_t entry_capacity;       // Allocated entries
+    void* index;                 // index_capacity integers of index_width bytes: entry position + 1, or 0
+    size_t index_capacity;       // Number of index slots (power of two)
+    unsigned index_shift;        // 64 - log2(index_capacity), for home slot selection
+    unsigned index_width;        // Bytes per index slot: 1, 2, 4 or 8
+    size_t size;                 // Number of key-value pairs
+    hash_func hash;              // Hash function for keys
+    key_equals_func key_equals;  // Key equality function
+    ANVAllocator* alloc;         // Custom allocator
+} ANVOrderedMap;
+
+//==============================================================================
+// Creation and destruction functions
+//==============================================================================
+
+/**
+ * Create a new ordered map with custom allocator and functions.
+ *
+ * @param alloc Custom allocator (required)
+ * @param hash Hash function for keys (required)
+ * @param key_equals Key equality function (required)
+ * @param initial_capacity Number of elements to size the map for (0 for default)
+ * @return Pointer to new ordered map, or NULL on failure
+ */
+ANV_API ANVOrderedMap* anv_orderedmap_create(ANVAllocator* alloc, hash_func hash,
+                                             key_equals_func key_equals, size_t initial_capacity);
+
+/**
+ * Destroy the ordered map and its storage.
+ *
+ * @param map The ordered map to destroy
+ * @param should_free_keys Whether to free key data using alloc->data_free
+ * @param should_free_values Whether to free value data using alloc->data_free
+ */
+ANV_API void anv_orderedmap_destroy(ANVOrderedMap* map, bool should_free_keys, bool should_free_values);
+
+/**
+ * Clear all elements from the ordered map, keeping its storage allocated.
+ *
+ * @param map The ordered map to clear
+ * @param should_free_keys Whether to free key data
+ * @param should_free_values Whether to free value data
+ */
+ANV_API void anv_orderedmap_clear(ANVOrderedMap* map, bool should_free_keys, bool should_free_values);
+
+//==============================================================================
+// Information functions
+//==============================================================================
+
+/**
+ * Get the number of key-value pairs in the ordered map.
+ *
+ * @param map The ordered map to query
+ * @return Number of pairs, or 0 if map is NULL
+ */
+ANV_API size_t anv_orderedmap_size(const ANVOrderedMap* map);
+
+/**
+ * Check if the ordered map is empty.
+ *
+ * @param map The ordered map to check
+ * @return 1 if empty or NULL, 0 if it contains elements
+ */
+ANV_API int anv_orderedmap_is_empty(const ANVOrderedMap* map);
+
+/**
+ * Get the number of bytes owned by the ordered map for the map struct, entry
+ * array and index table, excluding user data.
+ *
+ * @param map The ordered map to query
+ * @return Bytes owned, or 0 if map is NULL
+ */
+ANV_API size_t anv_orderedmap_memory_usage(const ANVOrderedMap* map);
+
+/**
+ * Check if the ordered map contains a key.
+ *
+ * @param map The ordered map to search
+ * @param key The key to search for
+ * @return 1 if key exists, 0 if not found or on error
+ */
+ANV_API int anv_orderedmap_contains_key(const ANVOrderedMap* map, const void* key);
+
+//==============================================================================
+// Ordered map operations
+//==============================================================================
+
+/**
+ * Insert or update a key-value pair. A new key goes after every existing
+ * key; an existing key keeps its position.
+ *
+ * @param map The ordered map to modify
+ * @param key Pointer to key data (ownership transferred to map)
+ * @param value Pointer to value data (ownership transferred to map)
+ * @return 0 on success, -1 on error
+ */
+ANV_API int anv_orderedmap_put(ANVOrderedMap* map, void* key, void* value);
+
+/**
+ * Insert or update a key-value pair, returning the old value if key exists.
+ *
+ * @param map The ordered map to modify
+ * @param key Pointer to key data (ownership transferred to map)
+ * @param value Pointer to value data (ownership transferred to map)
+ * @param old_value_out Pointer to store the old value (NULL if key didn't exist)
+ * @return 0 on success, -1 on error
+ */
+ANV_API int anv_orderedmap_put_replace(ANVOrderedMap* map, void* key, void* value, void** old_value_out);
+
+/**
+ * Get the value associated with a key.
+ *
+ * @param map The ordered map to search
+ * @param key The key to look up
+ * @return Pointer to associated value, or NULL if not found or on error
+ */
+ANV_API void* anv_orderedmap_get(const ANVOrderedMap* map, const void* key);
+
+/**
+ * Remove a key-value pair from the ordered map.
+ *
+ * @param map The ordered map to modify
+ * @param key The key to remove
+ * @param should_free_key Whether to free the key data
+ * @param should_free_value Whether to free the value data
+ * @return 0 on success, -1 if key not found or on error
+ */
+ANV_API int anv_orderedmap_remove(ANVOrderedMap* map, const void* key,
+                                  bool should_free_key, bool should_free_value);
+
+/**
+ * Remove a key-value pair and return the value.
+ *
+ * @param map The ordered map to modify
+ * @param key The key to remove
+ * @param should_free_key Whether to free the key data
+ * @return Pointer to the removed value, or NULL if not found or on error
+ */
+ANV_API void* anv_orderedmap_remove_get(ANVOrderedMap* map, const void* key, bool should_free_key);
+
+/**
+ * Apply an action function to each key-value pair in insertion order.
+ *
+ * @param map The ordered map to process
+ * @param action Function applied to each key-value pair
+ */
+ANV_API void anv_orderedmap_for_each(const ANVOrderedMap* map, void (*action)(void* key, void* value));
+
+//==============================================================================
+// Capacity management
+//==============================================================================
+
+/**
+ * Make room for expected_size entries without further allocation, e.g.
+ * before a bulk load. Never shrinks the map.
+ *
+ * @param map The ordered map to resize
+ * @param expected_size Number of entries to make room for
+ * @return 0 on success, -1 on error
+ */
+ANV_API int anv_orderedmap_reserve(ANVOrderedMap* map, size_t expected_size);
+
+/**
+ * Squeeze out removed entries and shrink the entry array and index table to
+ * the smallest size that holds the current entries.
+ *
+ * @param map The ordered map to resize
+ * @return 0 on success, -1 on error
+ */
+ANV_API int anv_orderedmap_shrink_to_fit(ANVOrderedMap* map);
+
+//==============================================================================
+// Iterator functions
+//==============================================================================
+
+/**
+ * Create an iterator over the ordered map in insertion order.
+ * Iterator yields ANVPair structures and supports backward traversal.
+ *
+ * @param map The ordered map to iterate over
+ * @return An Iterator object for traversal
+ */
+ANV_API ANVIterator anv_orderedmap_iterator(const ANVOrderedMap* map);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //ANVIL_ORDEREDMAP_H
@@ -97,6 +97,15 @@ ANV_API size_t anv_queue_size(const ANVQueue* queue);
  */
 ANV_API int anv_queue_is_empty(const ANVQueue* queue);
 
+/**
+ * Get the number of bytes owned by the queue for the queue struct and its nodes,
+ * excluding user data.
+ *
+ * @param queue The queue to query
+ * @return Bytes owned, or 0 if queue is NULL
+ */
+ANV_API size_t anv_queue_memory_usage(const ANVQueue* queue);
+
 /**
  * Compare two queues for equality using the given comparison function.
  *
@@ -0,0 +1,221 @@
+//
+// RcuMap.h
+// Read-optimized concurrent hash map with lock-free lookups.
+//
+// Lookups never take a lock or write shared memory other than the calling
+// thread's own reader record, so read throughput scales with cores. Writers
+// serialize on one ANVMutex and publish every change with atomic stores:
+// new nodes are linked in front of their chain, removed nodes are unlinked,
+// and growing the table builds a complete copy that replaces the old one in
+// a single store (read-copy-update).
+//
+// Memory a reader may still be looking at is not freed right away. Writers
+// retire unlinked nodes, replaced tables and any keys or values they were
+// asked to free, and reclaim them once every reader has moved past the
+// epoch in which they were retired (epoch-based reclamation).
+//
+// Best suited to tables that are read far more often than written, such as
+// configuration or routing data. The hash and key equality functions are
+// called from many threads at once, and the allocator must be thread-safe:
+// each thread allocates a small reader record the first time it reads. The
+// record stays with the thread until anv_rcumap_release_thread, after which
+// the next thread to start reading reuses it.
+//
+// The map is opaque because its fields are C11 atomics.
+
+#ifndef ANVIL_RCUMAP_H
+#define ANVIL_RCUMAP_H
+
+#include <stddef.h>
+
+#include "common/Allocator.h"
+#include "common/CStandardCompatibility.h"
+#include "containers/HashMap.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//==============================================================================
+// Type definitions
+//==============================================================================
+
+/**
+ * Read-optimized concurrent hash map (opaque).
+ */
+typedef struct ANVRcuMap ANVRcuMap;
+
+//==============================================================================
+// Creation and destruction functions
+//==============================================================================
+
+/**
+ * Create a new read-optimized map.
+ *
+ * @param alloc Custom allocator (required, must be thread-safe)
+ * @param hash Hash function for keys (required)
+ * @param key_equals Key equality function (required)
+ * @param initial_capacity Number of entries to size the table for (0 for default)
+ * @return Pointer to new map, or NULL on failure
+ */
+ANV_API ANVRcuMap* anv_rcumap_create(ANVAllocator* alloc, hash_func hash, key_equals_func key_equals,
+                                     size_t initial_capacity);
+
+/**
+ * Destroy the map and everything still waiting to be reclaimed.
+ * No other thread may use the map concurrently or afterwards.
+ *
+ * @param map The map to destroy
+ * @param should_free_keys Whether to free key data using alloc->data_free
+ * @param should_free_values Whether to free value data using alloc->data_free
+ */
+ANV_API void anv_rcumap_destroy(ANVRcuMap* map, bool should_free_keys, bool should_free_values);
+
+//==============================================================================
+// Information functions
+//==============================================================================
+
+/**
+ * Get the number of key-value pairs.
+ *
+ * @param map The map to query
+ * @return Number of pairs, or 0 if map is NULL
+ */
+ANV_API size_t anv_rcumap_size(const ANVRcuMap* map);
+
+/**
+ * Check if the map is empty.
+ *
+ * @param map The map to check
+ * @return 1 if empty or NULL, 0 if it contains elements
+ */
+ANV_API int anv_rcumap_is_empty(const ANVRcuMap* map);
+
+/**
+ * Get the number of retired nodes, tables and user data blocks that are
+ * waiting for readers to move on before they can be freed.
+ *
+ * @param map The map to query
+ * @return Number of pending blocks, or 0 if map is NULL
+ */
+ANV_API size_t anv_rcumap_retired_count(ANVRcuMap* map);
+
+/**
+ * Check if the map contains a key. Lock-free.
+ *
+ * @param map The map to search
+ * @param key The key to search for
+ * @return 1 if key exists, 0 if not found or on error
+ */
+ANV_API int anv_rcumap_contains_key(ANVRcuMap* map, const void* key);
+
+//==============================================================================
+// Read-side critical sections
+//==============================================================================
+
+/**
+ * Enter a read-side critical section on the calling thread. Values and keys
+ * obtained from the map inside the section are not reclaimed before the
+ * matching anv_rcumap_read_unlock. Sections nest and never block writers.
+ *
+ * @param map The map to read
+ */
+ANV_API void anv_rcumap_read_lock(ANVRcuMap* map);
+
+/**
+ * Leave the innermost read-side critical section of the calling thread.
+ *
+ * @param map The map being read
+ */
+ANV_API void anv_rcumap_read_unlock(ANVRcuMap* map);
+
+/**
+ * Release the calling thread's reader record so that another thread can
+ * reuse it. Call before a thread that read the map exits; threads that come
+ * and go would otherwise leave one record each behind until destroy. The
+ * thread may read the map again later and will then claim a record anew.
+ *
+ * @param map The map the calling thread has read
+ * @return 0 on success or if the thread holds no record, -1 if map is NULL or
+ *         the thread is inside a read-side section
+ */
+ANV_API int anv_rcumap_release_thread(ANVRcuMap* map);
+
+//==============================================================================
+// Map operations
+//==============================================================================
+
+/**
+ * Get the value associated with a key. Lock-free.
+ * If other threads may remove the key with should_free_value set, call this
+ * inside anv_rcumap_read_lock/unlock for as long as the value is used.
+ *
+ * @param map The map to search
+ * @param key The key to look up
+ * @return Pointer to associated value, or NULL if not found or on error
+ */
+ANV_API void* anv_rcumap_get(ANVRcuMap* map, const void* key);
+
+/**
+ * Insert or update a key-value pair. Serializes with other writers.
+ *
+ * @param map The map to modify
+ * @param key Pointer to key data (ownership transferred to map)
+ * @param value Pointer to value data (ownership transferred to map)
+ * @return 0 on success, -1 on error
+ */
+ANV_API int anv_rcumap_put(ANVRcuMap* map, void* key, void* value);
+
+/**
+ * Insert or update a key-value pair, returning the old value if key exists.
+ * Readers may still hold the old value, so it must not be freed right away;
+ * use anv_rcumap_put_with_free to have the map free it safely.
+ *
+ * @param map The map to modify
+ * @param key Pointer to key data (ownership transferred to map)
+ * @param value Pointer to value data (ownership transferred to map)
+ * @param old_value_out Pointer to store the old value (NULL if key didn't exist)
+ * @return 0 on success, -1 on error
+ */
+ANV_API int anv_rcumap_put_replace(ANVRcuMap* map, void* key, void* value, void** old_value_out);
+
+/**
+ * Insert or update a key-value pair, retiring the replaced value.
+ * Fails without changing the map if there is no memory to defer the free.
+ *
+ * @param map The map to modify
+ * @param key Pointer to key data (ownership transferred to map)
+ * @param value Pointer to value data (ownership transferred to map)
+ * @param should_free_old_value Whether to free the replaced value once no reader can see it
+ * @return 0 on success, -1 on error
+ */
+ANV_API int anv_rcumap_put_with_free(ANVRcuMap* map, void* key, void* value, bool should_free_old_value);
+
+/**
+ * Remove a key-value pair. Key and value are freed once no reader can see them.
+ * Fails without changing the map if there is no memory to defer the frees.
+ *
+ * @param map The map to modify
+ * @param key The key to remove
+ * @param should_free_key Whether to free the key data
+ * @param should_free_value Whether to free the value data
+ * @return 0 on success, -1 if key not found or on error
+ */
+ANV_API int anv_rcumap_remove(ANVRcuMap* map, const void* key, bool should_free_key, bool should_free_value);
+
+/**
+ * Remove a key-value pair and return the value. Readers may still hold the
+ * value, so it must not be freed right away.
+ *
+ * @param map The map to modify
+ * @param key The key to remove
+ * @param should_free_key Whether to free the key data
+ * @return Pointer to the removed value, or NULL if not found or on error
+ */
+ANV_API void* anv_rcumap_remove_get(ANVRcuMap* map, const void* key, bool should_free_key);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //ANVIL_RCUMAP_H
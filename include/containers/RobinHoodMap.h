@@ -0,0 +1,282 @@
+//
+// RobinHoodMap.h
+// Open-addressing hash map with Robin Hood probing and backward-shift deletion.
+//
+// Keys and values live inline in one slot array. Each slot also keeps one
+// byte with its distance from the key's home slot and one byte of the key's
+// hash. On insertion an entry displaces any entry that is closer to its own
+// home, so the distances stay short and evenly spread even at a 0.9 load
+// factor. A lookup stops as soon as it reaches an entry closer to home than
+// the probe itself, so misses are as cheap as hits. Removal shifts the rest
+// of the run back by one slot instead of leaving a tombstone, so the table
+// never degrades after a churn of inserts and removes.
+//
+// Pointers into the map (e.g. iterator pairs) are invalidated by any
+// insertion or removal, since both may move other entries.
+
+#ifndef ANVIL_ROBINHOODMAP_H
+#define ANVIL_ROBINHOODMAP_H
+
+#include <stdint.h>
+
+#include "Iterator.h"
+#include "common/Allocator.h"
+#include "common/CStandardCompatibility.h"
+#include "containers/HashMap.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//==============================================================================
+// Constants
+//==============================================================================
+
+// Load factor at which the table doubles, unless changed per map
+#define ANV_ROBINHOODMAP_DEFAULT_MAX_LOAD 0.9
+
+// Longest distance an entry may sit from its home slot; the table grows
+// before any entry would be pushed further
+#define ANV_ROBINHOODMAP_MAX_PROBE 254
+
+//==============================================================================
+// Type definitions
+//==============================================================================
+
+/**
+ * Key-value slot stored inline in the table.
+ */
+typedef struct ANVRobinHoodSlot
+{
+    void* key;   // Pointer to key data
+    void* value; // Pointer to value data
+} ANVRobinHoodSlot;
+
+/**
+ * Robin Hood hash map structure with custom allocator support.
+ * Provides average O(1) insert, lookup, and delete operations.
+ */
+typedef struct ANVRobinHoodMap
+{
+    ANVRobinHoodSlot* slots;    // Slot array (capacity entries), followed in memory by dists and tags
+    uint8_t* dists;             // Per slot: 0 if empty, else distance from home slot + 1
+    uint8_t* tags;              // Per slot: low byte of the key's hash
+    size_t capacity;            // Number of slots (power of two)
+    unsigned shift;             // 64 - log2(capacity), for home slot selection
+    size_t size;                // Number of key-value pairs
+    size_t max_size;            // Size at which the table grows
+    double max_load_factor;     // Fraction of slots that may be full
+    hash_func hash;             // Hash function for keys
+    key_equals_func key_equals; // Key equality function
+    ANVAllocator* alloc;        // Custom allocator
+} ANVRobinHoodMap;
+
+//==============================================================================
+// Creation and destruction functions
+//==============================================================================
+
+/**
+ * Create a new Robin Hood map with custom allocator and functions.
+ *
+ * @param alloc Custom allocator (required)
+ * @param hash Hash function for keys (required)
+ * @param key_equals Key equality function (required)
+ * @param initial_capacity Number of elements to size the table for (0 for default)
+ * @return Pointer to new map, or NULL on failure
+ */
+ANV_API ANVRobinHoodMap* anv_robinhoodmap_create(ANVAllocator* alloc, hash_func hash,
+                                                 key_equals_func key_equals, size_t initial_capacity);
+
+/**
+ * Destroy the map and its table.
+ *
+ * @param map The map to destroy
+ * @param should_free_keys Whether to free key data using alloc->data_free
+ * @param should_free_values Whether to free value data using alloc->data_free
+ */
+ANV_API void anv_robinhoodmap_destroy(ANVRobinHoodMap* map, bool should_free_keys, bool should_free_values);
+
+/**
+ * Clear all elements from the map, keeping the table allocated.
+ *
+ * @param map The map to clear
+ * @param should_free_keys Whether to free key data
+ * @param should_free_values Whether to free value data
+ */
+ANV_API void anv_robinhoodmap_clear(ANVRobinHoodMap* map, bool should_free_keys, bool should_free_values);
+
+//==============================================================================
+// Information functions
+//==============================================================================
+
+/**
+ * Get the number of key-value pairs in the map.
+ *
+ * @param map The map to query
+ * @return Number of pairs, or 0 if map is NULL
+ */
+ANV_API size_t anv_robinhoodmap_size(const ANVRobinHoodMap* map);
+
+/**
+ * Check if the map is empty.
+ *
+ * @param map The map to check
+ * @return 1 if empty or NULL, 0 if it contains elements
+ */
+ANV_API int anv_robinhoodmap_is_empty(const ANVRobinHoodMap* map);
+
+/**
+ * Get the number of slots in the table.
+ *
+ * @param map The map to query
+ * @return Slot count, or 0 if map is NULL
+ */
+ANV_API size_t anv_robinhoodmap_capacity(const ANVRobinHoodMap* map);
+
+/**
+ * Get the current load factor of the map.
+ *
+ * @param map The map to query
+ * @return Load factor (size / capacity), or 0.0 if map is NULL
+ */
+ANV_API double anv_robinhoodmap_load_factor(const ANVRobinHoodMap* map);
+
+/**
+ * Get the number of bytes owned by the map for the map struct and its table,
+ * excluding user data.
+ *
+ * @param map The map to query
+ * @return Bytes owned, or 0 if map is NULL
+ */
+ANV_API size_t anv_robinhoodmap_memory_usage(const ANVRobinHoodMap* map);
+
+/**
+ * Check if the map contains a key.
+ *
+ * @param map The map to search
+ * @param key The key to search for
+ * @return 1 if key exists, 0 if not found or on error
+ */
+ANV_API int anv_robinhoodmap_contains_key(const ANVRobinHoodMap* map, const void* key);
+
+//==============================================================================
+// Capacity management
+//==============================================================================
+
+/**
+ * Set the load factor at which the table grows. Takes effect on the next
+ * insertion; a lower value than the current load does not shrink the table.
+ *
+ * @param map The map to configure
+ * @param max_load_factor Fraction of slots that may be full, in [0.5, 0.95]
+ * @return 0 on success, -1 if map is NULL or the value is out of range
+ */
+ANV_API int anv_robinhoodmap_set_max_load_factor(ANVRobinHoodMap* map, double max_load_factor);
+
+//==============================================================================
+// Robin Hood map operations
+//==============================================================================
+
+/**
+ * Insert or update a key-value pair in the map.
+ *
+ * @param map The map to modify
+ * @param key Pointer to key data (ownership transferred to map)
+ * @param value Pointer to value data (ownership transferred to map)
+ * @return 0 on success, -1 on error
+ */
+ANV_API int anv_robinhoodmap_put(ANVRobinHoodMap* map, void* key, void* value);
+
+/**
+ * Insert or update a key-value pair, returning the old value if key exists.
+ *
+ * @param map The map to modify
+ * @param key Pointer to key data (ownership transferred to map)
+ * @param value Pointer to value data (ownership transferred to map)
+ * @param old_value_out Pointer to store the old value (NULL if key didn't exist)
+ * @return 0 on success, -1 on error
+ */
+ANV_API int anv_robinhoodmap_put_replace(ANVRobinHoodMap* map, void* key, void* value, void** old_value_out);
+
+/**
+ * Get the value associated with a key.
+ *
+ * @param map The map to search
+ * @param key The key to look up
+ * @return Pointer to associated value, or NULL if not found or on error
+ */
+ANV_API void* anv_robinhoodmap_get(const ANVRobinHoodMap* map, const void* key);
+
+/**
+ * Remove a key-value pair from the map.
+ *
+ * @param map The map to modify
+ * @param key The key to remove
+ * @param should_free_key Whether to free the key data
+ * @param should_free_value Whether to free the value data
+ * @return 0 on success, -1 if key not found or on error
+ */
+ANV_API int anv_robinhoodmap_remove(ANVRobinHoodMap* map, const void* key,
+                                    bool should_free_key, bool should_free_value);
+
+/**
+ * Remove a key-value pair and return the value.
+ *
+ * @param map The map to modify
+ * @param key The key to remove
+ * @param should_free_key Whether to free the key data
+ * @return Pointer to the removed value, or NULL if not found or on error
+ */
+ANV_API void* anv_robinhoodmap_remove_get(ANVRobinHoodMap* map, const void* key, bool should_free_key);
+
+/**
+ * Apply an action function to each key-value pair in the map.
+ *
+ * @param map The map to process
+ * @param action Function applied to each key-value pair
+ */
+ANV_API void anv_robinhoodmap_for_each(const ANVRobinHoodMap* map, void (*action)(void* key, void* value));
+
+//==============================================================================
+// Probe statistics
+//==============================================================================
+
+/**
+ * Count entries by probe length, the number of slots an entry sits past its
+ * home slot (0 for an entry in its home slot). A successful lookup of an
+ * entry compares probe length + 1 slots.
+ *
+ * @param map The map to inspect
+ * @param counts Receives counts[k] = entries with probe length k; the last
+ *               element also counts every longer probe (can be NULL)
+ * @param count_len Number of elements in counts
+ * @return Longest probe length in the map, or 0 if map is NULL or empty
+ */
+ANV_API size_t anv_robinhoodmap_probe_histogram(const ANVRobinHoodMap* map, size_t* counts, size_t count_len);
+
+/**
+ * Get the mean probe length over all entries.
+ *
+ * @param map The map to inspect
+ * @return Mean probe length, or 0.0 if map is NULL or empty
+ */
+ANV_API double anv_robinhoodmap_mean_probe_length(const ANVRobinHoodMap* map);
+
+//==============================================================================
+// Iterator functions
+//==============================================================================
+
+/**
+ * Create an iterator for the map (unordered traversal).
+ * Iterator yields ANVPair structures.
+ *
+ * @param map The map to iterate over
+ * @return An Iterator object for traversal
+ */
+ANV_API ANVIterator anv_robinhoodmap_iterator(const ANVRobinHoodMap* map);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //ANVIL_ROBINHOODMAP_H
@@ -125,6 +125,15 @@ ANV_API size_t anv_sll_size(const ANVSinglyLinkedList* list);
  */
 ANV_API int anv_sll_is_empty(const ANVSinglyLinkedList* list);
 
+/**
+ * Get the number of bytes owned by the list for the list struct and its nodes,
+ * excluding user data.
+ *
+ * @param list The list to query
+ * @return Bytes owned, or 0 if list is NULL
+ */
+ANV_API size_t anv_sll_memory_usage(const ANVSinglyLinkedList* list);
+
 /**
  * Find first node matching data using compare function.
  *
@@ -96,6 +96,15 @@ ANV_API size_t anv_stack_size(const ANVStack* stack);
  */
 ANV_API int anv_stack_is_empty(const ANVStack* stack);
 
+/**
+ * Get the number of bytes owned by the stack for the stack struct and its nodes,
+ * excluding user data.
+ *
+ * @param stack The stack to query
+ * @return Bytes owned, or 0 if stack is NULL
+ */
+ANV_API size_t anv_stack_memory_usage(const ANVStack* stack);
+
 /**
  * Compare two stacks for equality using the given comparison function.
  *
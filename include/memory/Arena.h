@@ -0,0 +1,172 @@
+//
+// Arena.h
+// Bump-pointer region allocator.
+//
+// An arena hands out memory by bumping an offset inside large chunks that
+// are obtained from a backing ANVAllocator. Individual allocations are never
+// freed; instead the whole arena is reset in O(1) or rolled back to a
+// previously taken checkpoint. Chunks are chained and reused after a reset,
+// so a steady-state request loop performs no backing allocations at all.
+//
+// anv_arena_allocator() exposes the arena as an ANVAllocator so any container
+// can place its nodes, buckets and iterator state inside the arena.
+
+#ifndef ANVIL_ARENA_H
+#define ANVIL_ARENA_H
+
+#include <stddef.h>
+
+#include "common/Allocator.h"
+#include "common/CStandardCompatibility.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//==============================================================================
+// Type definitions
+//==============================================================================
+
+/**
+ * A single chunk of arena memory. Chunks form a singly linked chain.
+ */
+typedef struct ANVArenaChunk
+{
+    struct ANVArenaChunk* next; // Next chunk in the chain
+    size_t capacity;            // Usable bytes in data[]
+    size_t used;                // Bytes consumed from data[]
+    unsigned char data[];       // Chunk payload
+} ANVArenaChunk;
+
+/**
+ * Bump-pointer arena with chunk chaining.
+ */
+typedef struct ANVArena
+{
+    ANVArenaChunk* head;    // First chunk in the chain
+    ANVArenaChunk* current; // Chunk currently being bumped
+    size_t chunk_size;      // Default payload size for new chunks
+    size_t chunk_count;     // Number of chunks owned by the arena
+    ANVAllocator* backing;  // Allocator used for chunks and the arena itself
+} ANVArena;
+
+/**
+ * Saved arena position used for rollback.
+ */
+typedef struct ANVArenaCheckpoint
+{
+    ANVArenaChunk* chunk; // Chunk that was current when the checkpoint was taken
+    size_t used;          // Offset within that chunk
+} ANVArenaCheckpoint;
+
+//==============================================================================
+// Creation and destruction functions
+//==============================================================================
+
+/**
+ * Create a new arena.
+ *
+ * @param backing Allocator used to obtain chunks (required)
+ * @param chunk_size Payload size of each chunk in bytes (0 for default)
+ * @return Pointer to new arena, or NULL on failure
+ */
+ANV_API ANVArena* anv_arena_create(ANVAllocator* backing, size_t chunk_size);
+
+/**
+ * Destroy the arena and release all chunks back to the backing allocator.
+ *
+ * @param arena The arena to destroy
+ */
+ANV_API void anv_arena_destroy(ANVArena* arena);
+
+//==============================================================================
+// Allocation functions
+//==============================================================================
+
+/**
+ * Allocate memory from the arena, aligned for any fundamental type.
+ *
+ * @param arena The arena to allocate from
+ * @param size Number of bytes to allocate
+ * @return Pointer to memory, or NULL if size is 0 or on failure
+ */
+ANV_API void* anv_arena_alloc(ANVArena* arena, size_t size);
+
+/**
+ * Allocate memory from the arena with an explicit alignment.
+ *
+ * @param arena The arena to allocate from
+ * @param size Number of bytes to allocate
+ * @param alignment Required alignment (must be a power of two)
+ * @return Pointer to memory, or NULL on failure
+ */
+ANV_API void* anv_arena_alloc_aligned(ANVArena* arena, size_t size, size_t alignment);
+
+/**
+ * Release every allocation in O(1). Chunks are kept for reuse.
+ *
+ * @param arena The arena to reset
+ */
+ANV_API void anv_arena_reset(ANVArena* arena);
+
+/**
+ * Capture the current arena position.
+ *
+ * @param arena The arena to query
+ * @return Checkpoint that can later be passed to anv_arena_rollback
+ */
+ANV_API ANVArenaCheckpoint anv_arena_checkpoint(const ANVArena* arena);
+
+/**
+ * Release every allocation made after the checkpoint was taken.
+ * Checkpoints taken after this one become invalid.
+ *
+ * @param arena The arena to roll back
+ * @param checkpoint A checkpoint previously returned by anv_arena_checkpoint
+ */
+ANV_API void anv_arena_rollback(ANVArena* arena, ANVArenaCheckpoint checkpoint);
+
+//==============================================================================
+// Information functions
+//==============================================================================
+
+/**
+ * Get the number of payload bytes handed out since the last reset,
+ * including alignment padding.
+ *
+ * @param arena The arena to query
+ * @return Bytes in use, or 0 if arena is NULL
+ */
+ANV_API size_t anv_arena_bytes_used(const ANVArena* arena);
+
+/**
+ * Get the total payload capacity of all chunks owned by the arena.
+ *
+ * @param arena The arena to query
+ * @return Bytes reserved, or 0 if arena is NULL
+ */
+ANV_API size_t anv_arena_bytes_reserved(const ANVArena* arena);
+
+//==============================================================================
+// Allocator view
+//==============================================================================
+
+/**
+ * Get an ANVAllocator that allocates from the arena.
+ *
+ * Frees are no-ops except for the most recent allocation, which is popped
+ * so LIFO usage reclaims space. Reallocating the most recent allocation
+ * grows it in place when the current chunk has room.
+ * data_free is NULL and copy is the default shallow copy; callers may
+ * override either field on the returned struct.
+ *
+ * @param arena The arena to allocate from (must outlive every user of the allocator)
+ * @return ANVAllocator backed by the arena
+ */
+ANV_API ANVAllocator anv_arena_allocator(ANVArena* arena);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //ANVIL_ARENA_H
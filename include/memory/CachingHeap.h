@@ -0,0 +1,163 @@
+//
+// CachingHeap.h
+// Thread-caching front-end allocator.
+//
+// A caching heap keeps a private free list per size class for every thread
+// that uses it, so the common allocate/free path takes no lock. Threads
+// refill their caches in batches from a shared central heap guarded by an
+// ANVMutex, and return batches when a cache grows past its limit.
+//
+// Blocks are interchangeable within a size class, so memory allocated on
+// one thread may be freed on any other thread: the block simply joins the
+// freeing thread's cache and flows back to the central heap on overflow.
+// Requests larger than the biggest size class bypass the caches and go
+// straight to the backing allocator.
+
+#ifndef ANVIL_CACHINGHEAP_H
+#define ANVIL_CACHINGHEAP_H
+
+#include <stddef.h>
+
+#include "common/Allocator.h"
+#include "common/CStandardCompatibility.h"
+#include "system/Mutex.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//==============================================================================
+// Constants
+//==============================================================================
+
+// Number of small-object size classes
+#define ANV_CACHING_HEAP_CLASS_COUNT 12
+
+// Largest request served from the size classes (bytes)
+#define ANV_CACHING_HEAP_MAX_SMALL 1024
+
+//==============================================================================
+// Type definitions
+//==============================================================================
+
+struct ANVThreadCache;
+struct ANVCachingHeapSpan;
+
+/**
+ * Shared heap behind the per-thread caches.
+ */
+typedef struct ANVCachingHeap
+{
+    ANVMutex lock;                                          // Guards every field below except id
+    void* central[ANV_CACHING_HEAP_CLASS_COUNT];            // Central free list per size class
+    size_t central_count[ANV_CACHING_HEAP_CLASS_COUNT];     // Blocks in each central list
+    struct ANVCachingHeapSpan* spans;                       // Memory carved into small blocks
+    struct ANVThreadCache* caches;                          // Every thread cache created for this heap
+    struct ANVThreadCache* idle_caches;                     // Flushed caches waiting for a thread to claim them
+    size_t cache_count;                                     // Number of thread caches
+    size_t refills;                                         // Batches moved central -> thread
+    size_t flushes;                                         // Batches moved thread -> central
+    size_t large_allocations;                               // Requests served by the backing allocator
+    size_t span_count;                                      // Spans obtained from the backing allocator
+    size_t id;                                              // Unique id used to validate thread-local lookups
+    ANVAllocator* backing;                                  // Allocator for spans, caches and large blocks
+    struct ANVCachingHeap* next_live;                       // Next heap in the process-wide list of live heaps
+} ANVCachingHeap;
+
+/**
+ * Snapshot of caching heap statistics.
+ */
+typedef struct ANVCachingHeapStats
+{
+    size_t thread_caches;     // Thread caches created
+    size_t idle_caches;       // Thread caches flushed and waiting to be claimed by a thread
+    size_t refills;           // Batches moved from the central heap to thread caches
+    size_t flushes;           // Batches returned from thread caches to the central heap
+    size_t large_allocations; // Requests that bypassed the size classes
+    size_t spans;             // Spans obtained from the backing allocator
+    size_t central_blocks;    // Free blocks currently held centrally
+} ANVCachingHeapStats;
+
+//==============================================================================
+// Creation and destruction functions
+//==============================================================================
+
+/**
+ * Create a new caching heap.
+ *
+ * @param backing Allocator used for spans and large requests (required, must be thread-safe)
+ * @return Pointer to new heap, or NULL on failure
+ */
+ANV_API ANVCachingHeap* anv_caching_heap_create(ANVAllocator* backing);
+
+/**
+ * Destroy the heap, all thread caches and all spans.
+ * No thread may use the heap concurrently or afterwards.
+ * Large blocks that were never freed are not reclaimed.
+ *
+ * @param heap The heap to destroy
+ */
+ANV_API void anv_caching_heap_destroy(ANVCachingHeap* heap);
+
+//==============================================================================
+// Allocation functions
+//==============================================================================
+
+/**
+ * Allocate memory, aligned for any fundamental type.
+ *
+ * @param heap The heap to allocate from
+ * @param size Number of bytes to allocate
+ * @return Pointer to memory, or NULL if size is 0 or on failure
+ */
+ANV_API void* anv_caching_heap_alloc(ANVCachingHeap* heap, size_t size);
+
+/**
+ * Free memory obtained from the heap. May be called from any thread.
+ *
+ * @param heap The heap the block came from
+ * @param ptr Pointer to free (NULL is ignored)
+ */
+ANV_API void anv_caching_heap_free(ANVCachingHeap* heap, void* ptr);
+
+/**
+ * Return every block cached by the calling thread to the central heap and
+ * hand the cache itself back for the next new thread to claim. Call before
+ * a worker thread exits so neither its blocks nor its cache are stranded.
+ *
+ * @param heap The heap whose cache should be flushed
+ */
+ANV_API void anv_caching_heap_flush_thread(ANVCachingHeap* heap);
+
+//==============================================================================
+// Information functions
+//==============================================================================
+
+/**
+ * Retrieve heap statistics.
+ *
+ * @param heap The heap to query
+ * @param stats_out Receives the statistics
+ * @return 0 on success, -1 on error
+ */
+ANV_API int anv_caching_heap_stats(ANVCachingHeap* heap, ANVCachingHeapStats* stats_out);
+
+//==============================================================================
+// Allocator view
+//==============================================================================
+
+/**
+ * Get an ANVAllocator backed by the caching heap.
+ * data_free is NULL and copy is the default shallow copy; callers may
+ * override either field on the returned struct.
+ *
+ * @param heap The heap to allocate from (must outlive every user of the allocator)
+ * @return ANVAllocator backed by the heap
+ */
+ANV_API ANVAllocator anv_caching_heap_allocator(ANVCachingHeap* heap);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //ANVIL_CACHINGHEAP_H
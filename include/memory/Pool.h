@@ -0,0 +1,157 @@
+//
+// Pool.h
+// Fixed-size object pool (slab + free list).
+//
+// A pool carves equally sized objects out of large slabs obtained from a
+// backing ANVAllocator and recycles released objects through an intrusive
+// free list. It is intended for container nodes: creating a linked container
+// with anv_pool_allocator() makes every node come from a few contiguous slabs
+// instead of one malloc per node.
+//
+// Requests larger than the pool's object size are forwarded to the backing
+// allocator, so a single pool allocator can back an entire container
+// (struct, bucket arrays and iterator state included).
+
+#ifndef ANVIL_POOL_H
+#define ANVIL_POOL_H
+
+#include <stddef.h>
+
+#include "common/Allocator.h"
+#include "common/CStandardCompatibility.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//==============================================================================
+// Type definitions
+//==============================================================================
+
+/**
+ * Header placed at the start of every slab. Slabs form a singly linked chain.
+ */
+typedef struct ANVPoolSlab
+{
+    struct ANVPoolSlab* next; // Next slab in the chain
+} ANVPoolSlab;
+
+/**
+ * Fixed-size object pool.
+ */
+typedef struct ANVPool
+{
+    ANVPoolSlab* slabs;        // Chain of slabs owned by the pool
+    void* free_list;           // Intrusive list of released objects
+    unsigned char* bump;       // Next never-used object in the newest slab
+    unsigned char* bump_end;   // End of the newest slab
+    size_t object_size;        // Requested object size
+    size_t stride;             // Object size rounded up for alignment
+    size_t objects_per_slab;   // Objects carved from each slab
+    size_t slab_count;         // Number of slabs
+    size_t live_objects;       // Objects currently handed out
+    size_t high_water;         // Maximum live_objects ever observed
+    ANVAllocator* backing;     // Allocator for slabs and oversized requests
+} ANVPool;
+
+/**
+ * Snapshot of pool statistics.
+ */
+typedef struct ANVPoolStats
+{
+    size_t object_size;      // Requested object size
+    size_t stride;           // Bytes used per object inside a slab
+    size_t live_objects;     // Objects currently handed out
+    size_t high_water;       // Maximum number of simultaneously live objects
+    size_t slab_count;       // Number of slabs allocated
+    size_t capacity;         // Total objects the current slabs can hold
+    size_t bytes_reserved;   // Total bytes obtained from the backing allocator for slabs
+} ANVPoolStats;
+
+//==============================================================================
+// Creation and destruction functions
+//==============================================================================
+
+/**
+ * Create a new pool for objects of a fixed size.
+ *
+ * @param backing Allocator used for slabs and oversized requests (required)
+ * @param object_size Size of each object in bytes (must be > 0)
+ * @param objects_per_slab Objects per slab (0 for default)
+ * @return Pointer to new pool, or NULL on failure
+ */
+ANV_API ANVPool* anv_pool_create(ANVAllocator* backing, size_t object_size, size_t objects_per_slab);
+
+/**
+ * Destroy the pool and release all slabs.
+ * Objects still handed out become invalid.
+ *
+ * @param pool The pool to destroy
+ */
+ANV_API void anv_pool_destroy(ANVPool* pool);
+
+//==============================================================================
+// Allocation functions
+//==============================================================================
+
+/**
+ * Take one object from the pool.
+ *
+ * @param pool The pool to allocate from
+ * @return Pointer to an object of pool->object_size bytes, or NULL on failure
+ */
+ANV_API void* anv_pool_alloc(ANVPool* pool);
+
+/**
+ * Return an object to the pool.
+ *
+ * @param pool The pool the object came from
+ * @param ptr Object previously returned by anv_pool_alloc (NULL is ignored)
+ */
+ANV_API void anv_pool_free(ANVPool* pool, void* ptr);
+
+/**
+ * Check whether a pointer lies inside one of the pool's slabs.
+ *
+ * @param pool The pool to query
+ * @param ptr Pointer to test
+ * @return true if ptr was carved from this pool
+ */
+ANV_API bool anv_pool_owns(const ANVPool* pool, const void* ptr);
+
+//==============================================================================
+// Information functions
+//==============================================================================
+
+/**
+ * Retrieve pool statistics.
+ *
+ * @param pool The pool to query
+ * @param stats_out Receives the statistics
+ * @return 0 on success, -1 on error
+ */
+ANV_API int anv_pool_stats(const ANVPool* pool, ANVPoolStats* stats_out);
+
+//==============================================================================
+// Allocator view
+//==============================================================================
+
+/**
+ * Get an ANVAllocator backed by the pool.
+ *
+ * Requests up to pool->object_size bytes are served from the pool; larger
+ * requests go to the backing allocator. Pass the result to a container's
+ * create function to opt that container's nodes into the pool.
+ * data_free is NULL and copy is the default shallow copy; callers may
+ * override either field on the returned struct.
+ *
+ * @param pool The pool to allocate from (must outlive every user of the allocator)
+ * @return ANVAllocator backed by the pool
+ */
+ANV_API ANVAllocator anv_pool_allocator(ANVPool* pool);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //ANVIL_POOL_H
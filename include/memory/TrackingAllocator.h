@@ -0,0 +1,112 @@
+//
+// TrackingAllocator.h
+// Instrumented allocator wrapper.
+//
+// A tracking allocator forwards every request to an inner ANVAllocator and
+// records allocation/free counts, bytes in flight, the peak of bytes in
+// flight and a power-of-two histogram of request sizes. Each block carries
+// a small header with its size, so accounting stays exact even when a
+// container frees memory without passing a size.
+//
+// The counters are plain fields and are not synchronized; use one tracking
+// allocator per thread or guard it externally.
+
+#ifndef ANVIL_TRACKINGALLOCATOR_H
+#define ANVIL_TRACKINGALLOCATOR_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "common/Allocator.h"
+#include "common/CStandardCompatibility.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//==============================================================================
+// Constants
+//==============================================================================
+
+// Histogram bucket i counts requests of size <= 2^(i + 4); the last bucket is open ended
+#define ANV_TRACKING_HISTOGRAM_BUCKETS 16
+
+//==============================================================================
+// Type definitions
+//==============================================================================
+
+/**
+ * Allocation statistics collected by a tracking allocator.
+ */
+typedef struct ANVTrackingAllocator
+{
+    ANVAllocator* inner;                                 // Allocator that performs the real work
+    size_t allocations;                                  // Successful allocations (including realloc moves)
+    size_t frees;                                        // Blocks released
+    size_t reallocations;                                // Successful realloc calls
+    size_t failed_allocations;                           // Allocation requests that returned NULL
+    size_t bytes_in_flight;                              // Bytes currently allocated (excluding headers)
+    size_t peak_bytes;                                   // Maximum of bytes_in_flight
+    size_t total_bytes;                                  // Bytes requested over the allocator's lifetime
+    size_t histogram[ANV_TRACKING_HISTOGRAM_BUCKETS];    // Request sizes by power-of-two bucket
+} ANVTrackingAllocator;
+
+//==============================================================================
+// Creation and destruction functions
+//==============================================================================
+
+/**
+ * Initialize a tracking allocator around an inner allocator.
+ *
+ * @param tracker The tracking allocator to initialize
+ * @param inner Allocator to forward requests to (required)
+ * @return 0 on success, -1 on error
+ */
+ANV_API int anv_tracking_init(ANVTrackingAllocator* tracker, ANVAllocator* inner);
+
+/**
+ * Reset every counter except bytes_in_flight, which keeps describing
+ * the blocks that are still live. peak_bytes restarts from bytes_in_flight.
+ *
+ * @param tracker The tracking allocator to reset
+ */
+ANV_API void anv_tracking_reset_stats(ANVTrackingAllocator* tracker);
+
+//==============================================================================
+// Information functions
+//==============================================================================
+
+/**
+ * Get the inclusive upper size limit of a histogram bucket.
+ *
+ * @param bucket Bucket index
+ * @return Largest request size counted in the bucket, or SIZE_MAX for the last bucket
+ */
+ANV_API size_t anv_tracking_bucket_limit(size_t bucket);
+
+/**
+ * Print a human readable report of the statistics.
+ *
+ * @param tracker The tracking allocator to report on
+ * @param stream Output stream (e.g. stdout)
+ */
+ANV_API void anv_tracking_print(const ANVTrackingAllocator* tracker, FILE* stream);
+
+//==============================================================================
+// Allocator view
+//==============================================================================
+
+/**
+ * Get an ANVAllocator that records statistics and forwards to the inner allocator.
+ * data_free and copy are inherited from the inner allocator.
+ *
+ * @param tracker The tracking allocator (must outlive every user of the allocator)
+ * @return Instrumented ANVAllocator
+ */
+ANV_API ANVAllocator anv_tracking_allocator(ANVTrackingAllocator* tracker);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //ANVIL_TRACKINGALLOCATOR_H
@@ -3,6 +3,7 @@
 //
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "Allocator.h"
 
@@ -29,7 +30,8 @@ ANV_API ANVAllocator anv_alloc_default(void)
         .allocate = malloc,
         .deallocate = free,
         .data_free = free,
-        .copy = default_copy
+        .copy = default_copy,
+        .reallocate = realloc
     };
     return alloc;
 }
@@ -46,9 +48,39 @@ ANV_API ANVAllocator anv_alloc_custom(const alloc_func alloc_func, const dealloc
     return alloc;
 }
 
+ANV_API ANVAllocator anv_alloc_context(void* ctx, const ctx_alloc_func alloc_func, const ctx_dealloc_func dealloc_func,
+                                       const ctx_realloc_func realloc_func, const data_free_func data_free_func,
+                                       const copy_func copy_func)
+{
+    const ANVAllocator alloc = {
+        .data_free = data_free_func,
+        .copy = copy_func ? copy_func : default_copy,
+        .ctx = ctx,
+        .ctx_allocate = alloc_func,
+        .ctx_deallocate = dealloc_func,
+        .ctx_reallocate = realloc_func
+    };
+    return alloc;
+}
+
+ANV_API bool anv_alloc_is_valid(const ANVAllocator* alloc)
+{
+    return alloc && (alloc->ctx_allocate || alloc->allocate);
+}
+
 ANV_API void* anv_alloc_malloc(const ANVAllocator* alloc, const size_t size)
 {
-    if (!alloc || !alloc->allocate)
+    if (!alloc)
+    {
+        return NULL;
+    }
+
+    if (alloc->ctx_allocate)
+    {
+        return alloc->ctx_allocate(alloc->ctx, size);
+    }
+
+    if (!alloc->allocate)
     {
         return NULL;
     }
@@ -57,12 +89,65 @@ ANV_API void* anv_alloc_malloc(const ANVAllocator* alloc, const size_t size)
 
 ANV_API void anv_alloc_free(const ANVAllocator* alloc, void* ptr)
 {
-    if (alloc && alloc->deallocate && ptr)
+    anv_alloc_free_sized(alloc, ptr, 0);
+}
+
+ANV_API void anv_alloc_free_sized(const ANVAllocator* alloc, void* ptr, const size_t size)
+{
+    if (!alloc || !ptr)
+    {
+        return;
+    }
+
+    if (alloc->ctx_allocate)
+    {
+        if (alloc->ctx_deallocate)
+        {
+            alloc->ctx_deallocate(alloc->ctx, ptr, size);
+        }
+        return;
+    }
+
+    if (alloc->deallocate)
     {
         alloc->deallocate(ptr);
     }
 }
 
+ANV_API void* anv_alloc_realloc(const ANVAllocator* alloc, void* ptr, const size_t old_size, const size_t new_size)
+{
+    if (!alloc || new_size == 0)
+    {
+        return NULL;
+    }
+
+    if (!ptr)
+    {
+        return anv_alloc_malloc(alloc, new_size);
+    }
+
+    if (alloc->ctx_allocate && alloc->ctx_reallocate)
+    {
+        return alloc->ctx_reallocate(alloc->ctx, ptr, old_size, new_size);
+    }
+
+    if (!alloc->ctx_allocate && alloc->reallocate)
+    {
+        return alloc->reallocate(ptr, new_size);
+    }
+
+    // Generic fallback: allocate, copy and release the old block
+    void* new_ptr = anv_alloc_malloc(alloc, new_size);
+    if (!new_ptr)
+    {
+        return NULL;
+    }
+
+    memcpy(new_ptr, ptr, old_size < new_size ? old_size : new_size);
+    anv_alloc_free_sized(alloc, ptr, old_size);
+    return new_ptr;
+}
+
 ANV_API void anv_alloc_data_free(const ANVAllocator* alloc, void* ptr)
 {
     if (alloc && alloc->data_free && ptr)
@@ -3,7 +3,6 @@
 //
 
 #include <stdint.h>
-#include <string.h>
 
 #include "ArrayList.h"
 
@@ -51,22 +50,14 @@ static int ensure_capacity(ANVArrayList* list, const size_t min_capacity)
         new_capacity = next_capacity;
     }
 
-    // Reallocate the data array
-    void** new_data = anv_alloc_malloc(list->alloc, new_capacity * sizeof(void*));
+    // Reallocate the data array (grows in place when the allocator supports it)
+    void** new_data = anv_alloc_realloc(list->alloc, list->data, list->capacity * sizeof(void*),
+                                        new_capacity * sizeof(void*));
     if (!new_data)
     {
         return -1;
     }
 
-    // Copy existing data
-    if (list->data && list->size > 0)
-    {
-        memcpy(new_data, list->data, list->size * sizeof(void*));
-    }
-
-    // Free old data array
-    anv_alloc_free(list->alloc, list->data);
-
     list->data = new_data;
     list->capacity = new_capacity;
     return 0;
@@ -144,7 +135,7 @@ ANV_API ANVArrayList* anv_arraylist_create(ANVAllocator* alloc, const size_t ini
     {
         if (ensure_capacity(list, initial_capacity) != 0)
         {
-            anv_alloc_free(alloc, list);
+            anv_alloc_free_sized(alloc, list, sizeof(ANVArrayList));
             return NULL;
         }
     }
@@ -161,8 +152,8 @@ ANV_API void anv_arraylist_destroy(ANVArrayList* list, const bool should_free_da
 
     anv_arraylist_clear(list, should_free_data);
 
-    anv_alloc_free(list->alloc, list->data);
-    anv_alloc_free(list->alloc, list);
+    anv_alloc_free_sized(list->alloc, list->data, list->capacity * sizeof(void*));
+    anv_alloc_free_sized(list->alloc, list, sizeof(ANVArrayList));
 }
 
 ANV_API void anv_arraylist_clear(ANVArrayList* list, const bool should_free_data)
@@ -205,6 +196,16 @@ ANV_API int anv_arraylist_is_empty(const ANVArrayList* list)
     return !list || list->size == 0;
 }
 
+ANV_API size_t anv_arraylist_memory_usage(const ANVArrayList* list)
+{
+    if (!list)
+    {
+        return 0;
+    }
+
+    return sizeof(ANVArrayList) + list->capacity * sizeof(void*);
+}
+
 ANV_API size_t anv_arraylist_find(const ANVArrayList* list, const void* data, const cmp_func compare)
 {
     if (!list || !data || !compare)
@@ -407,7 +408,7 @@ ANV_API int anv_arraylist_reserve(ANVArrayList* list, const size_t new_capacity)
 
 ANV_API int anv_arraylist_shrink_to_fit(ANVArrayList* list)
 {
-    if (!list || !list->alloc || !list->alloc->allocate)
+    if (!list || !anv_alloc_is_valid(list->alloc))
     {
         return -1;
     }
@@ -422,26 +423,20 @@ ANV_API int anv_arraylist_shrink_to_fit(ANVArrayList* list)
         // Free the data array if empty
         if (list->data)
         {
-            anv_alloc_free(list->alloc, list->data);
+            anv_alloc_free_sized(list->alloc, list->data, list->capacity * sizeof(void*));
         }
         list->data = NULL;
         list->capacity = 0;
         return 0;
     }
 
-    void** new_data = anv_alloc_malloc(list->alloc, list->size * sizeof(void*));
+    void** new_data = anv_alloc_realloc(list->alloc, list->data, list->capacity * sizeof(void*),
+                                        list->size * sizeof(void*));
     if (!new_data)
     {
         return -1;
     }
 
-    memcpy(new_data, list->data, list->size * sizeof(void*));
-
-    if (list->data)
-    {
-        anv_alloc_free(list->alloc, list->data);
-    }
-
     list->data = new_data;
     list->capacity = list->size;
     return 0;
@@ -467,7 +462,7 @@ ANV_API int anv_arraylist_sort(ANVArrayList* list, const cmp_func compare)
 
     merge_sort_recursive(list->data, temp, 0, list->size - 1, compare);
 
-    anv_alloc_free(list->alloc, temp);
+    anv_alloc_free_sized(list->alloc, temp, list->size * sizeof(void*));
 
     return 0;
 }
@@ -826,7 +821,7 @@ static void arraylist_iter_destroy(ANVIterator* iter)
         const ArrayListIterState* state = iter->data_state;
         if (state->list)
         {
-            anv_alloc_free(state->list->alloc, iter->data_state);
+            anv_alloc_free_sized(state->list->alloc, iter->data_state, sizeof(ArrayListIterState));
         }
     }
     iter->data_state = NULL;
@@ -845,7 +840,7 @@ ANV_API ANVIterator anv_arraylist_iterator(const ANVArrayList* list)
     iter.is_valid = arraylist_iter_is_valid;
     iter.destroy = arraylist_iter_destroy;
 
-    if (!list || !list->alloc || !list->alloc->allocate)
+    if (!list || !anv_alloc_is_valid(list->alloc))
     {
         return iter;
     }
@@ -879,7 +874,7 @@ ANV_API ANVIterator anv_arraylist_iterator_reverse(const ANVArrayList* list)
     it.is_valid = arraylist_iter_is_valid;
     it.destroy = arraylist_iter_destroy;
 
-    if (!list || !list->alloc || !list->alloc->allocate)
+    if (!list || !anv_alloc_is_valid(list->alloc))
     {
         return it;
     }
@@ -51,7 +51,7 @@ static void anv_bst_node_destroy_recursive(ANVBinarySearchTreeNode* node, ANVAll
     }
 
     // Free the node itself
-    anv_alloc_free(alloc, node);
+    anv_alloc_free_sized(alloc, node, sizeof(ANVBinarySearchTreeNode));
 }
 
 /**
@@ -168,7 +168,7 @@ static void anv_bst_node_remove_with_parent(ANVBinarySearchTree* tree, ANVBinary
     }
 
     // Free the node itself
-    anv_alloc_free(tree->alloc, node);
+    anv_alloc_free_sized(tree->alloc, node, sizeof(ANVBinarySearchTreeNode));
 }
 
 /**
@@ -254,7 +254,7 @@ ANV_API void anv_bst_destroy(ANVBinarySearchTree* tree, const bool should_free_d
     }
 
     anv_bst_node_destroy_recursive(tree->root, tree->alloc, should_free_data);
-    anv_alloc_free(tree->alloc, tree);
+    anv_alloc_free_sized(tree->alloc, tree, sizeof(ANVBinarySearchTree));
 }
 
 ANV_API void anv_bst_clear(ANVBinarySearchTree* tree, const bool should_free_data)
@@ -279,6 +279,16 @@ ANV_API int anv_bst_is_empty(const ANVBinarySearchTree* tree)
     return !tree || tree->size == 0;
 }
 
+ANV_API size_t anv_bst_memory_usage(const ANVBinarySearchTree* tree)
+{
+    if (!tree)
+    {
+        return 0;
+    }
+
+    return sizeof(ANVBinarySearchTree) + tree->size * sizeof(ANVBinarySearchTreeNode);
+}
+
 ANV_API size_t anv_bst_height(const ANVBinarySearchTree* tree)
 {
     return tree ? anv_bst_node_height(tree->root) : 0;
@@ -804,7 +814,7 @@ static void bst_iterator_destroy(ANVIterator* it)
     {
         anv_stack_destroy(state->stack, false); // Don't free node data
     }
-    anv_alloc_free(it->alloc, state);
+    anv_alloc_free_sized(it->alloc, state, sizeof(BSTIteratorState));
     it->data_state = NULL;
 }
 
@@ -844,7 +854,7 @@ static ANVIterator bst_create_iterator(const ANVBinarySearchTree* tree, const BS
     state->stack = anv_stack_create(tree->alloc);
     if (!state->stack)
     {
-        anv_alloc_free(tree->alloc, state);
+        anv_alloc_free_sized(tree->alloc, state, sizeof(BSTIteratorState));
         return it;
     }
 
@@ -0,0 +1,566 @@
+//
+// Cache.c
+// Implementation of the bounded LRU/CLOCK cache.
+//
+// Entries are addressed by 32-bit position, with NIL (UINT32_MAX) as the null
+// link. Each bucket heads a chain through the entries' chain links. Free
+// entries form a singly linked list through their next links, which under
+// LRU otherwise point towards the tail of the recency list. Under CLOCK the
+// recency list is not maintained at all.
+
+#include <string.h>
+
+#include "Cache.h"
+#include "CacheHashed.h"
+
+//==============================================================================
+// Private constants
+//==============================================================================
+
+#define NIL UINT32_MAX
+#define MIN_BUCKETS 8
+
+//==============================================================================
+// Static helper functions
+//==============================================================================
+
+static size_t bucket_of(const ANVCache* cache, const size_t hash)
+{
+    return (size_t)(((uint64_t)hash * 0x9E3779B97F4A7C15ULL) >> cache->bucket_shift);
+}
+
+/**
+ * Find the entry holding key, or NIL.
+ */
+static uint32_t find_entry(const ANVCache* cache, const void* key, const size_t hash)
+{
+    uint32_t index = cache->buckets[bucket_of(cache, hash)];
+    while (index != NIL)
+    {
+        const ANVCacheEntry* entry = &cache->entries[index];
+        if (entry->hash == hash && cache->key_equals(entry->key, key))
+        {
+            return index;
+        }
+        index = entry->chain;
+    }
+    return NIL;
+}
+
+static void list_unlink(ANVCache* cache, const uint32_t index)
+{
+    const ANVCacheEntry* entry = &cache->entries[index];
+    if (entry->prev != NIL)
+    {
+        cache->entries[entry->prev].next = entry->next;
+    }
+    else
+    {
+        cache->head = entry->next;
+    }
+
+    if (entry->next != NIL)
+    {
+        cache->entries[entry->next].prev = entry->prev;
+    }
+    else
+    {
+        cache->tail = entry->prev;
+    }
+}
+
+static void list_push_front(ANVCache* cache, const uint32_t index)
+{
+    ANVCacheEntry* entry = &cache->entries[index];
+    entry->prev = NIL;
+    entry->next = cache->head;
+    if (cache->head != NIL)
+    {
+        cache->entries[cache->head].prev = index;
+    }
+    else
+    {
+        cache->tail = index;
+    }
+    cache->head = index;
+}
+
+/**
+ * Record a use of an entry.
+ */
+static void touch(ANVCache* cache, const uint32_t index)
+{
+    if (cache->policy == ANV_CACHE_CLOCK)
+    {
+        cache->entries[index].referenced = 1;
+    }
+    else if (cache->head != index)
+    {
+        list_unlink(cache, index);
+        list_push_front(cache, index);
+    }
+}
+
+/**
+ * Unlink an entry from its bucket and the recency list and free it.
+ */
+static void release_entry(ANVCache* cache, const uint32_t index)
+{
+    ANVCacheEntry* entry = &cache->entries[index];
+
+    uint32_t* link = &cache->buckets[bucket_of(cache, entry->hash)];
+    while (*link != index)
+    {
+        link = &cache->entries[*link].chain;
+    }
+    *link = entry->chain;
+
+    if (cache->policy == ANV_CACHE_LRU)
+    {
+        list_unlink(cache, index);
+    }
+
+    entry->key = NULL;
+    entry->next = cache->free_list;
+    cache->free_list = index;
+    cache->size--;
+}
+
+/**
+ * Pick the entry to evict from a full cache.
+ */
+static uint32_t choose_victim(ANVCache* cache)
+{
+    if (cache->policy == ANV_CACHE_LRU)
+    {
+        return cache->tail;
+    }
+
+    // Give every referenced entry a second chance; terminates within two sweeps
+    for (;;)
+    {
+        const uint32_t index = (uint32_t)cache->hand;
+        ANVCacheEntry* entry = &cache->entries[index];
+        cache->hand = cache->hand + 1 == cache->capacity ? 0 : cache->hand + 1;
+
+        if (entry->referenced)
+        {
+            entry->referenced = 0;
+        }
+        else
+        {
+            return index;
+        }
+    }
+}
+
+/**
+ * Evict one entry to make room, handing it to the eviction callback.
+ */
+static void evict(ANVCache* cache)
+{
+    const uint32_t victim = choose_victim(cache);
+    void* key = cache->entries[victim].key;
+    void* value = cache->entries[victim].value;
+
+    release_entry(cache, victim);
+    cache->stats.evictions++;
+
+    if (cache->on_evict)
+    {
+        cache->on_evict(key, value, cache->evict_user_data);
+    }
+}
+
+/**
+ * Shared insert path for put and put_replace.
+ */
+static int insert(ANVCache* cache, void* key, void* value, void** old_value_out, const size_t hash)
+{
+    const uint32_t existing = find_entry(cache, key, hash);
+    if (existing != NIL)
+    {
+        if (old_value_out)
+        {
+            *old_value_out = cache->entries[existing].value;
+        }
+        cache->entries[existing].value = value;
+        touch(cache, existing);
+        return 0;
+    }
+
+    if (cache->free_list == NIL)
+    {
+        evict(cache);
+    }
+
+    const uint32_t index = cache->free_list;
+    ANVCacheEntry* entry = &cache->entries[index];
+    cache->free_list = entry->next;
+
+    const size_t bucket = bucket_of(cache, hash);
+    entry->key = key;
+    entry->value = value;
+    entry->hash = hash;
+    entry->chain = cache->buckets[bucket];
+    entry->referenced = 0;
+    cache->buckets[bucket] = index;
+
+    if (cache->policy == ANV_CACHE_LRU)
+    {
+        list_push_front(cache, index);
+    }
+    cache->size++;
+    return 0;
+}
+
+/**
+ * Empty every bucket and put every entry on the free list.
+ */
+static void reset_entries(ANVCache* cache)
+{
+    memset(cache->buckets, 0xFF, cache->bucket_count * sizeof(uint32_t));
+    for (size_t i = 0; i < cache->capacity; i++)
+    {
+        cache->entries[i].key = NULL;
+        cache->entries[i].next = i + 1 < cache->capacity ? (uint32_t)(i + 1) : NIL;
+    }
+    cache->free_list = 0;
+    cache->head = NIL;
+    cache->tail = NIL;
+    cache->hand = 0;
+    cache->size = 0;
+}
+
+//==============================================================================
+// Creation and destruction functions
+//==============================================================================
+
+ANV_API ANVCache* anv_cache_create(ANVAllocator* alloc, const hash_func hash, const key_equals_func key_equals,
+                                   const size_t capacity, const ANVCachePolicy policy)
+{
+    if (!alloc || !hash || !key_equals || capacity == 0 || capacity > ANV_CACHE_MAX_CAPACITY ||
+        (policy != ANV_CACHE_LRU && policy != ANV_CACHE_CLOCK))
+    {
+        return NULL;
+    }
+
+    size_t bucket_count = MIN_BUCKETS;
+    unsigned bits = 3;
+    while (bucket_count < capacity)
+    {
+        bucket_count *= 2;
+        bits++;
+    }
+
+    ANVCache* cache = anv_alloc_malloc(alloc, sizeof(ANVCache));
+    if (!cache)
+    {
+        return NULL;
+    }
+    memset(cache, 0, sizeof(ANVCache));
+
+    cache->entries = anv_alloc_malloc(alloc, capacity * sizeof(ANVCacheEntry));
+    cache->buckets = anv_alloc_malloc(alloc, bucket_count * sizeof(uint32_t));
+    if (!cache->entries || !cache->buckets)
+    {
+        anv_alloc_free_sized(alloc, cache->entries, capacity * sizeof(ANVCacheEntry));
+        anv_alloc_free_sized(alloc, cache->buckets, bucket_count * sizeof(uint32_t));
+        anv_alloc_free_sized(alloc, cache, sizeof(ANVCache));
+        return NULL;
+    }
+
+    cache->capacity = capacity;
+    cache->bucket_count = bucket_count;
+    cache->bucket_shift = 64 - bits;
+    cache->policy = policy;
+    cache->hash = hash;
+    cache->key_equals = key_equals;
+    cache->alloc = alloc;
+    reset_entries(cache);
+    return cache;
+}
+
+ANV_API void anv_cache_destroy(ANVCache* cache, const bool should_free_keys, const bool should_free_values)
+{
+    if (!cache)
+    {
+        return;
+    }
+
+    anv_cache_clear(cache, should_free_keys, should_free_values);
+
+    anv_alloc_free_sized(cache->alloc, cache->entries, cache->capacity * sizeof(ANVCacheEntry));
+    anv_alloc_free_sized(cache->alloc, cache->buckets, cache->bucket_count * sizeof(uint32_t));
+    anv_alloc_free_sized(cache->alloc, cache, sizeof(ANVCache));
+}
+
+ANV_API void anv_cache_clear(ANVCache* cache, const bool should_free_keys, const bool should_free_values)
+{
+    if (!cache)
+    {
+        return;
+    }
+
+    if (should_free_keys || should_free_values)
+    {
+        for (size_t i = 0; i < cache->capacity; i++)
+        {
+            if (!cache->entries[i].key)
+            {
+                continue;
+            }
+
+            if (should_free_keys)
+            {
+                anv_alloc_data_free(cache->alloc, cache->entries[i].key);
+            }
+            if (should_free_values && cache->entries[i].value)
+            {
+                anv_alloc_data_free(cache->alloc, cache->entries[i].value);
+            }
+        }
+    }
+
+    reset_entries(cache);
+}
+
+ANV_API void anv_cache_set_eviction_callback(ANVCache* cache, const anv_cache_evict_func on_evict, void* user_data)
+{
+    if (!cache)
+    {
+        return;
+    }
+
+    cache->on_evict = on_evict;
+    cache->evict_user_data = user_data;
+}
+
+//==============================================================================
+// Information functions
+//==============================================================================
+
+ANV_API size_t anv_cache_size(const ANVCache* cache)
+{
+    return cache ? cache->size : 0;
+}
+
+ANV_API size_t anv_cache_capacity(const ANVCache* cache)
+{
+    return cache ? cache->capacity : 0;
+}
+
+ANV_API int anv_cache_is_empty(const ANVCache* cache)
+{
+    return !cache || cache->size == 0;
+}
+
+ANV_API size_t anv_cache_memory_usage(const ANVCache* cache)
+{
+    if (!cache)
+    {
+        return 0;
+    }
+
+    return sizeof(ANVCache) + cache->capacity * sizeof(ANVCacheEntry) + cache->bucket_count * sizeof(uint32_t);
+}
+
+ANV_API ANVCacheStats anv_cache_stats(const ANVCache* cache)
+{
+    if (!cache)
+    {
+        const ANVCacheStats empty = {0, 0, 0};
+        return empty;
+    }
+
+    return cache->stats;
+}
+
+ANV_API void anv_cache_reset_stats(ANVCache* cache)
+{
+    if (!cache)
+    {
+        return;
+    }
+
+    memset(&cache->stats, 0, sizeof(ANVCacheStats));
+}
+
+ANV_API int anv_cache_contains_key(const ANVCache* cache, const void* key)
+{
+    if (!cache || !key)
+    {
+        return 0;
+    }
+
+    return anv_cache_contains_key_hashed(cache, key, cache->hash(key));
+}
+
+int anv_cache_contains_key_hashed(const ANVCache* cache, const void* key, const size_t hash)
+{
+    return find_entry(cache, key, hash) != NIL;
+}
+
+//==============================================================================
+// Cache operations
+//==============================================================================
+
+ANV_API void* anv_cache_get(ANVCache* cache, const void* key)
+{
+    if (!cache || !key)
+    {
+        return NULL;
+    }
+
+    return anv_cache_get_hashed(cache, key, cache->hash(key));
+}
+
+void* anv_cache_get_hashed(ANVCache* cache, const void* key, const size_t hash)
+{
+    const uint32_t index = find_entry(cache, key, hash);
+    if (index == NIL)
+    {
+        cache->stats.misses++;
+        return NULL;
+    }
+
+    cache->stats.hits++;
+    touch(cache, index);
+    return cache->entries[index].value;
+}
+
+ANV_API void* anv_cache_peek(const ANVCache* cache, const void* key)
+{
+    if (!cache || !key)
+    {
+        return NULL;
+    }
+
+    return anv_cache_peek_hashed(cache, key, cache->hash(key));
+}
+
+void* anv_cache_peek_hashed(const ANVCache* cache, const void* key, const size_t hash)
+{
+    const uint32_t index = find_entry(cache, key, hash);
+    return index != NIL ? cache->entries[index].value : NULL;
+}
+
+ANV_API int anv_cache_put(ANVCache* cache, void* key, void* value)
+{
+    if (!cache || !key)
+    {
+        return -1;
+    }
+
+    return insert(cache, key, value, NULL, cache->hash(key));
+}
+
+int anv_cache_put_hashed(ANVCache* cache, void* key, void* value, const size_t hash)
+{
+    return insert(cache, key, value, NULL, hash);
+}
+
+ANV_API int anv_cache_put_replace(ANVCache* cache, void* key, void* value, void** old_value_out)
+{
+    if (!cache || !key || !old_value_out)
+    {
+        return -1;
+    }
+
+    return anv_cache_put_replace_hashed(cache, key, value, old_value_out, cache->hash(key));
+}
+
+int anv_cache_put_replace_hashed(ANVCache* cache, void* key, void* value, void** old_value_out, const size_t hash)
+{
+    *old_value_out = NULL;
+    return insert(cache, key, value, old_value_out, hash);
+}
+
+ANV_API int anv_cache_remove(ANVCache* cache, const void* key, const bool should_free_key,
+                             const bool should_free_value)
+{
+    if (!cache || !key)
+    {
+        return -1;
+    }
+
+    return anv_cache_remove_hashed(cache, key, cache->hash(key), should_free_key, should_free_value);
+}
+
+int anv_cache_remove_hashed(ANVCache* cache, const void* key, const size_t hash, const bool should_free_key,
+                            const bool should_free_value)
+{
+    const uint32_t index = find_entry(cache, key, hash);
+    if (index == NIL)
+    {
+        return -1; // Key not found
+    }
+
+    void* stored_key = cache->entries[index].key;
+    void* value = cache->entries[index].value;
+    release_entry(cache, index);
+
+    if (should_free_key)
+    {
+        anv_alloc_data_free(cache->alloc, stored_key);
+    }
+    if (should_free_value && value)
+    {
+        anv_alloc_data_free(cache->alloc, value);
+    }
+    return 0;
+}
+
+ANV_API void* anv_cache_remove_get(ANVCache* cache, const void* key, const bool should_free_key)
+{
+    if (!cache || !key)
+    {
+        return NULL;
+    }
+
+    return anv_cache_remove_get_hashed(cache, key, cache->hash(key), should_free_key);
+}
+
+void* anv_cache_remove_get_hashed(ANVCache* cache, const void* key, const size_t hash, const bool should_free_key)
+{
+    const uint32_t index = find_entry(cache, key, hash);
+    if (index == NIL)
+    {
+        return NULL; // Key not found
+    }
+
+    void* stored_key = cache->entries[index].key;
+    void* value = cache->entries[index].value;
+    release_entry(cache, index);
+
+    if (should_free_key)
+    {
+        anv_alloc_data_free(cache->alloc, stored_key);
+    }
+    return value;
+}
+
+ANV_API void anv_cache_for_each(const ANVCache* cache, void (*action)(void* key, void* value))
+{
+    if (!cache || !action)
+    {
+        return;
+    }
+
+    if (cache->policy == ANV_CACHE_LRU)
+    {
+        for (uint32_t index = cache->head; index != NIL; index = cache->entries[index].next)
+        {
+            action(cache->entries[index].key, cache->entries[index].value);
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < cache->capacity; i++)
+    {
+        if (cache->entries[i].key)
+        {
+            action(cache->entries[i].key, cache->entries[i].value);
+        }
+    }
+}
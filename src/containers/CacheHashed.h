@@ -0,0 +1,34 @@
+//
+// CacheHashed.h
+// ANVCache operations that take the key's hash from the caller.
+//
+// Private to the library (Cache.c and ConcurrentCache.c). ConcurrentCache
+// hashes a key once to pick its shard and passes that hash on, so the key is
+// not hashed a second time under the shard's lock. Each function behaves like
+// its public counterpart in Cache.h; hash must be cache->hash(key), and the
+// caller has already checked cache and key (and old_value_out) for NULL.
+
+#ifndef ANVIL_CACHEHASHED_H
+#define ANVIL_CACHEHASHED_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "Cache.h"
+
+int anv_cache_contains_key_hashed(const ANVCache* cache, const void* key, size_t hash);
+
+void* anv_cache_get_hashed(ANVCache* cache, const void* key, size_t hash);
+
+void* anv_cache_peek_hashed(const ANVCache* cache, const void* key, size_t hash);
+
+int anv_cache_put_hashed(ANVCache* cache, void* key, void* value, size_t hash);
+
+int anv_cache_put_replace_hashed(ANVCache* cache, void* key, void* value, void** old_value_out, size_t hash);
+
+int anv_cache_remove_hashed(ANVCache* cache, const void* key, size_t hash, bool should_free_key,
+                            bool should_free_value);
+
+void* anv_cache_remove_get_hashed(ANVCache* cache, const void* key, size_t hash, bool should_free_key);
+
+#endif // ANVIL_CACHEHASHED_H
@@ -0,0 +1,421 @@
+//
+// ConcurrentCache.c
+// Implementation of the sharded concurrent cache.
+//
+// Each shard's ANVCache picks buckets from the top bits of a Fibonacci
+// multiply of the key's hash. Selecting the shard from those same bits
+// would leave every key of a shard with the same top bucket bits, crowding
+// each shard into a fraction of its buckets, so the shard comes from the top
+// bits of a multiply by a different odd constant instead.
+
+#include <stdint.h>
+#include <string.h>
+
+#include "CacheHashed.h"
+#include "ConcurrentCache.h"
+
+//==============================================================================
+// Private helper functions
+//==============================================================================
+
+static ANVConcurrentCacheShard* shard_for(const ANVConcurrentCache* cache, const size_t hash)
+{
+    if (cache->shard_count == 1)
+    {
+        return cache->shards;
+    }
+    const uint64_t mixed = (uint64_t)hash * 0xC2B2AE3D27D4EB4FULL;
+    return &cache->shards[mixed >> cache->shard_shift];
+}
+
+static size_t shard_block_bytes(const size_t shard_count)
+{
+    return shard_count * sizeof(ANVConcurrentCacheShard) + ANV_CONCURRENT_CACHE_CACHE_LINE - 1;
+}
+
+/**
+ * Tear down the first count shards and the cache itself.
+ */
+static void release_cache(ANVConcurrentCache* cache, const size_t count,
+                          const bool should_free_keys, const bool should_free_values)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        anv_cache_destroy(cache->shards[i].cache, should_free_keys, should_free_values);
+        anv_mutex_destroy(&cache->shards[i].lock);
+    }
+    anv_alloc_free_sized(cache->alloc, cache->shard_block, shard_block_bytes(cache->shard_count));
+    anv_alloc_free_sized(cache->alloc, cache, sizeof(ANVConcurrentCache));
+}
+
+//==============================================================================
+// Creation and destruction functions
+//==============================================================================
+
+ANV_API ANVConcurrentCache* anv_concurrent_cache_create(ANVAllocator* alloc, const hash_func hash,
+                                                        const key_equals_func key_equals, const size_t capacity,
+                                                        size_t shard_count, const ANVCachePolicy policy)
+{
+    if (!alloc || !hash || !key_equals || capacity == 0 || shard_count > ANV_CONCURRENT_CACHE_MAX_SHARDS)
+    {
+        return NULL;
+    }
+
+    if (shard_count == 0)
+    {
+        shard_count = ANV_CONCURRENT_CACHE_DEFAULT_SHARDS;
+    }
+    unsigned bits = 0;
+    while (((size_t)1 << bits) < shard_count)
+    {
+        bits++;
+    }
+    // Every shard holds at least one entry, so never use more shards than entries
+    while (bits > 0 && ((size_t)1 << bits) > capacity)
+    {
+        bits--;
+    }
+    shard_count = (size_t)1 << bits;
+
+    // The first capacity % shard_count shards take one extra entry, so the
+    // shard capacities add up to exactly the requested capacity
+    const size_t base_capacity = capacity / shard_count;
+    const size_t extra = capacity % shard_count;
+    if (base_capacity + (extra != 0) > ANV_CACHE_MAX_CAPACITY)
+    {
+        return NULL;
+    }
+
+    ANVConcurrentCache* cache = anv_alloc_malloc(alloc, sizeof(ANVConcurrentCache));
+    if (!cache)
+    {
+        return NULL;
+    }
+
+    cache->shard_block = anv_alloc_malloc(alloc, shard_block_bytes(shard_count));
+    if (!cache->shard_block)
+    {
+        anv_alloc_free_sized(alloc, cache, sizeof(ANVConcurrentCache));
+        return NULL;
+    }
+
+    // Align the array by hand, allocators only guarantee fundamental alignment
+    const uintptr_t line = ANV_CONCURRENT_CACHE_CACHE_LINE;
+    cache->shards = (ANVConcurrentCacheShard*)(((uintptr_t)cache->shard_block + line - 1) & ~(line - 1));
+    cache->shard_count = shard_count;
+    cache->shard_shift = 64 - bits;
+    cache->hash = hash;
+    cache->alloc = alloc;
+
+    for (size_t i = 0; i < shard_count; i++)
+    {
+        ANVConcurrentCacheShard* shard = &cache->shards[i];
+        shard->cache = anv_cache_create(alloc, hash, key_equals, base_capacity + (i < extra), policy);
+        if (!shard->cache)
+        {
+            release_cache(cache, i, false, false);
+            return NULL;
+        }
+        if (anv_mutex_init(&shard->lock) != 0)
+        {
+            anv_cache_destroy(shard->cache, false, false);
+            release_cache(cache, i, false, false);
+            return NULL;
+        }
+    }
+
+    return cache;
+}
+
+ANV_API void anv_concurrent_cache_destroy(ANVConcurrentCache* cache, const bool should_free_keys,
+                                          const bool should_free_values)
+{
+    if (!cache)
+    {
+        return;
+    }
+
+    release_cache(cache, cache->shard_count, should_free_keys, should_free_values);
+}
+
+ANV_API void anv_concurrent_cache_clear(ANVConcurrentCache* cache, const bool should_free_keys,
+                                        const bool should_free_values)
+{
+    if (!cache)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < cache->shard_count; i++)
+    {
+        ANVConcurrentCacheShard* shard = &cache->shards[i];
+        anv_mutex_lock(&shard->lock);
+        anv_cache_clear(shard->cache, should_free_keys, should_free_values);
+        anv_mutex_unlock(&shard->lock);
+    }
+}
+
+ANV_API void anv_concurrent_cache_set_eviction_callback(ANVConcurrentCache* cache, const anv_cache_evict_func on_evict,
+                                                        void* user_data)
+{
+    if (!cache)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < cache->shard_count; i++)
+    {
+        ANVConcurrentCacheShard* shard = &cache->shards[i];
+        anv_mutex_lock(&shard->lock);
+        anv_cache_set_eviction_callback(shard->cache, on_evict, user_data);
+        anv_mutex_unlock(&shard->lock);
+    }
+}
+
+//==============================================================================
+// Information functions
+//==============================================================================
+
+ANV_API size_t anv_concurrent_cache_size(ANVConcurrentCache* cache)
+{
+    if (!cache)
+    {
+        return 0;
+    }
+
+    size_t size = 0;
+    for (size_t i = 0; i < cache->shard_count; i++)
+    {
+        ANVConcurrentCacheShard* shard = &cache->shards[i];
+        anv_mutex_lock(&shard->lock);
+        size += anv_cache_size(shard->cache);
+        anv_mutex_unlock(&shard->lock);
+    }
+    return size;
+}
+
+ANV_API size_t anv_concurrent_cache_capacity(const ANVConcurrentCache* cache)
+{
+    if (!cache)
+    {
+        return 0;
+    }
+
+    // Shard capacities never change, so no lock is needed
+    size_t capacity = 0;
+    for (size_t i = 0; i < cache->shard_count; i++)
+    {
+        capacity += anv_cache_capacity(cache->shards[i].cache);
+    }
+    return capacity;
+}
+
+ANV_API size_t anv_concurrent_cache_shard_count(const ANVConcurrentCache* cache)
+{
+    return cache ? cache->shard_count : 0;
+}
+
+ANV_API size_t anv_concurrent_cache_memory_usage(const ANVConcurrentCache* cache)
+{
+    if (!cache)
+    {
+        return 0;
+    }
+
+    // A cache owns a fixed amount of memory from creation on
+    size_t usage = sizeof(ANVConcurrentCache) + shard_block_bytes(cache->shard_count);
+    for (size_t i = 0; i < cache->shard_count; i++)
+    {
+        usage += anv_cache_memory_usage(cache->shards[i].cache);
+    }
+    return usage;
+}
+
+ANV_API ANVCacheStats anv_concurrent_cache_stats(ANVConcurrentCache* cache)
+{
+    ANVCacheStats total = {0, 0, 0};
+    if (!cache)
+    {
+        return total;
+    }
+
+    for (size_t i = 0; i < cache->shard_count; i++)
+    {
+        ANVConcurrentCacheShard* shard = &cache->shards[i];
+        anv_mutex_lock(&shard->lock);
+        const ANVCacheStats stats = anv_cache_stats(shard->cache);
+        anv_mutex_unlock(&shard->lock);
+
+        total.hits += stats.hits;
+        total.misses += stats.misses;
+        total.evictions += stats.evictions;
+    }
+    return total;
+}
+
+ANV_API ANVCacheStats anv_concurrent_cache_shard_stats(ANVConcurrentCache* cache, const size_t shard)
+{
+    if (!cache || shard >= cache->shard_count)
+    {
+        const ANVCacheStats empty = {0, 0, 0};
+        return empty;
+    }
+
+    anv_mutex_lock(&cache->shards[shard].lock);
+    const ANVCacheStats stats = anv_cache_stats(cache->shards[shard].cache);
+    anv_mutex_unlock(&cache->shards[shard].lock);
+    return stats;
+}
+
+ANV_API void anv_concurrent_cache_reset_stats(ANVConcurrentCache* cache)
+{
+    if (!cache)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < cache->shard_count; i++)
+    {
+        ANVConcurrentCacheShard* shard = &cache->shards[i];
+        anv_mutex_lock(&shard->lock);
+        anv_cache_reset_stats(shard->cache);
+        anv_mutex_unlock(&shard->lock);
+    }
+}
+
+ANV_API int anv_concurrent_cache_contains_key(ANVConcurrentCache* cache, const void* key)
+{
+    if (!cache || !key)
+    {
+        return 0;
+    }
+
+    const size_t hash = cache->hash(key);
+    ANVConcurrentCacheShard* shard = shard_for(cache, hash);
+    anv_mutex_lock(&shard->lock);
+    const int found = anv_cache_contains_key_hashed(shard->cache, key, hash);
+    anv_mutex_unlock(&shard->lock);
+    return found;
+}
+
+//==============================================================================
+// Cache operations
+//==============================================================================
+
+ANV_API void* anv_concurrent_cache_get(ANVConcurrentCache* cache, const void* key)
+{
+    if (!cache || !key)
+    {
+        return NULL;
+    }
+
+    const size_t hash = cache->hash(key);
+    ANVConcurrentCacheShard* shard = shard_for(cache, hash);
+    anv_mutex_lock(&shard->lock);
+    void* value = anv_cache_get_hashed(shard->cache, key, hash);
+    anv_mutex_unlock(&shard->lock);
+    return value;
+}
+
+ANV_API int anv_concurrent_cache_get_with(ANVConcurrentCache* cache, const void* key,
+                                          const anv_concurrent_cache_visit_func visit, void* user_data)
+{
+    if (!cache || !key || !visit)
+    {
+        return 0;
+    }
+
+    const size_t hash = cache->hash(key);
+    ANVConcurrentCacheShard* shard = shard_for(cache, hash);
+    anv_mutex_lock(&shard->lock);
+
+    // Values may be NULL, so tell a hit from a miss by the hit counter
+    const size_t hits = shard->cache->stats.hits;
+    void* value = anv_cache_get_hashed(shard->cache, key, hash);
+    const int found = shard->cache->stats.hits != hits;
+    if (found)
+    {
+        visit(value, user_data);
+    }
+
+    anv_mutex_unlock(&shard->lock);
+    return found;
+}
+
+ANV_API void* anv_concurrent_cache_peek(ANVConcurrentCache* cache, const void* key)
+{
+    if (!cache || !key)
+    {
+        return NULL;
+    }
+
+    const size_t hash = cache->hash(key);
+    ANVConcurrentCacheShard* shard = shard_for(cache, hash);
+    anv_mutex_lock(&shard->lock);
+    void* value = anv_cache_peek_hashed(shard->cache, key, hash);
+    anv_mutex_unlock(&shard->lock);
+    return value;
+}
+
+ANV_API int anv_concurrent_cache_put(ANVConcurrentCache* cache, void* key, void* value)
+{
+    if (!cache || !key)
+    {
+        return -1;
+    }
+
+    const size_t hash = cache->hash(key);
+    ANVConcurrentCacheShard* shard = shard_for(cache, hash);
+    anv_mutex_lock(&shard->lock);
+    const int result = anv_cache_put_hashed(shard->cache, key, value, hash);
+    anv_mutex_unlock(&shard->lock);
+    return result;
+}
+
+ANV_API int anv_concurrent_cache_put_replace(ANVConcurrentCache* cache, void* key, void* value,
+                                             void** old_value_out)
+{
+    if (!cache || !key || !old_value_out)
+    {
+        return -1;
+    }
+
+    const size_t hash = cache->hash(key);
+    ANVConcurrentCacheShard* shard = shard_for(cache, hash);
+    anv_mutex_lock(&shard->lock);
+    const int result = anv_cache_put_replace_hashed(shard->cache, key, value, old_value_out, hash);
+    anv_mutex_unlock(&shard->lock);
+    return result;
+}
+
+ANV_API int anv_concurrent_cache_remove(ANVConcurrentCache* cache, const void* key,
+                                        const bool should_free_key, const bool should_free_value)
+{
+    if (!cache || !key)
+    {
+        return -1;
+    }
+
+    const size_t hash = cache->hash(key);
+    ANVConcurrentCacheShard* shard = shard_for(cache, hash);
+    anv_mutex_lock(&shard->lock);
+    const int result = anv_cache_remove_hashed(shard->cache, key, hash, should_free_key, should_free_value);
+    anv_mutex_unlock(&shard->lock);
+    return result;
+}
+
+ANV_API void* anv_concurrent_cache_remove_get(ANVConcurrentCache* cache, const void* key,
+                                              const bool should_free_key)
+{
+    if (!cache || !key)
+    {
+        return NULL;
+    }
+
+    const size_t hash = cache->hash(key);
+    ANVConcurrentCacheShard* shard = shard_for(cache, hash);
+    anv_mutex_lock(&shard->lock);
+    void* value = anv_cache_remove_get_hashed(shard->cache, key, hash, should_free_key);
+    anv_mutex_unlock(&shard->lock);
+    return value;
+}
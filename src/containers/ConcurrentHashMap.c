@@ -0,0 +1,525 @@
+//
+// ConcurrentHashMap.c
+// Implementation of the lock-striped concurrent hash map.
+//
+// The segment for a key comes from the top bits of its hash after a
+// Fibonacci multiply. Each segment's ANVHashMap indexes with the low bits of
+// the same hash, so segment selection does not crowd a segment's keys into
+// a few of its buckets.
+
+#include <stdint.h>
+#include <string.h>
+
+#include "ConcurrentHashMap.h"
+#include "Pair.h"
+
+//==============================================================================
+// Private helper functions
+//==============================================================================
+
+static ANVConcurrentHashMapSegment* segment_for(const ANVConcurrentHashMap* map, const void* key)
+{
+    if (map->segment_count == 1)
+    {
+        return map->segments;
+    }
+    const uint64_t mixed = (uint64_t)map->hash(key) * 0x9E3779B97F4A7C15ULL;
+    return &map->segments[mixed >> map->segment_shift];
+}
+
+static size_t segment_block_bytes(const size_t segment_count)
+{
+    return segment_count * sizeof(ANVConcurrentHashMapSegment) + ANV_CONCURRENT_HASHMAP_CACHE_LINE - 1;
+}
+
+/**
+ * Tear down the first count segments and the map itself.
+ */
+static void release_map(ANVConcurrentHashMap* map, const size_t count,
+                        const bool should_free_keys, const bool should_free_values)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        anv_hashmap_destroy(map->segments[i].map, should_free_keys, should_free_values);
+        anv_mutex_destroy(&map->segments[i].lock);
+    }
+    anv_alloc_free_sized(map->alloc, map->segment_block, segment_block_bytes(map->segment_count));
+    anv_alloc_free_sized(map->alloc, map, sizeof(ANVConcurrentHashMap));
+}
+
+//==============================================================================
+// Creation and destruction functions
+//==============================================================================
+
+ANV_API ANVConcurrentHashMap* anv_concurrent_hashmap_create(ANVAllocator* alloc, const hash_func hash,
+                                                            const key_equals_func key_equals,
+                                                            size_t segment_count, const size_t initial_capacity)
+{
+    if (!alloc || !hash || !key_equals || segment_count > ANV_CONCURRENT_HASHMAP_MAX_SEGMENTS)
+    {
+        return NULL;
+    }
+
+    if (segment_count == 0)
+    {
+        segment_count = ANV_CONCURRENT_HASHMAP_DEFAULT_SEGMENTS;
+    }
+    unsigned bits = 0;
+    while (((size_t)1 << bits) < segment_count)
+    {
+        bits++;
+    }
+    segment_count = (size_t)1 << bits;
+
+    ANVConcurrentHashMap* map = anv_alloc_malloc(alloc, sizeof(ANVConcurrentHashMap));
+    if (!map)
+    {
+        return NULL;
+    }
+
+    map->segment_block = anv_alloc_malloc(alloc, segment_block_bytes(segment_count));
+    if (!map->segment_block)
+    {
+        anv_alloc_free_sized(alloc, map, sizeof(ANVConcurrentHashMap));
+        return NULL;
+    }
+
+    // Align the array by hand, allocators only guarantee fundamental alignment
+    const uintptr_t line = ANV_CONCURRENT_HASHMAP_CACHE_LINE;
+    map->segments = (ANVConcurrentHashMapSegment*)(((uintptr_t)map->segment_block + line - 1) & ~(line - 1));
+    map->segment_count = segment_count;
+    map->segment_shift = 64 - bits;
+    map->hash = hash;
+    map->key_equals = key_equals;
+    map->alloc = alloc;
+
+    const size_t buckets = (initial_capacity + segment_count - 1) / segment_count;
+    for (size_t i = 0; i < segment_count; i++)
+    {
+        ANVConcurrentHashMapSegment* segment = &map->segments[i];
+        segment->map = anv_hashmap_create(alloc, hash, key_equals, buckets);
+        if (!segment->map)
+        {
+            release_map(map, i, false, false);
+            return NULL;
+        }
+        if (anv_mutex_init(&segment->lock) != 0)
+        {
+            anv_hashmap_destroy(segment->map, false, false);
+            release_map(map, i, false, false);
+            return NULL;
+        }
+    }
+
+    return map;
+}
+
+ANV_API void anv_concurrent_hashmap_destroy(ANVConcurrentHashMap* map, const bool should_free_keys,
+                                            const bool should_free_values)
+{
+    if (!map)
+    {
+        return;
+    }
+
+    release_map(map, map->segment_count, should_free_keys, should_free_values);
+}
+
+ANV_API void anv_concurrent_hashmap_clear(ANVConcurrentHashMap* map, const bool should_free_keys,
+                                          const bool should_free_values)
+{
+    if (!map)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < map->segment_count; i++)
+    {
+        ANVConcurrentHashMapSegment* segment = &map->segments[i];
+        anv_mutex_lock(&segment->lock);
+        anv_hashmap_clear(segment->map, should_free_keys, should_free_values);
+        anv_mutex_unlock(&segment->lock);
+    }
+}
+
+//==============================================================================
+// Information functions
+//==============================================================================
+
+ANV_API size_t anv_concurrent_hashmap_size(ANVConcurrentHashMap* map)
+{
+    if (!map)
+    {
+        return 0;
+    }
+
+    size_t size = 0;
+    for (size_t i = 0; i < map->segment_count; i++)
+    {
+        ANVConcurrentHashMapSegment* segment = &map->segments[i];
+        anv_mutex_lock(&segment->lock);
+        size += segment->map->size;
+        anv_mutex_unlock(&segment->lock);
+    }
+    return size;
+}
+
+ANV_API int anv_concurrent_hashmap_is_empty(ANVConcurrentHashMap* map)
+{
+    return anv_concurrent_hashmap_size(map) == 0;
+}
+
+ANV_API size_t anv_concurrent_hashmap_segment_count(const ANVConcurrentHashMap* map)
+{
+    return map ? map->segment_count : 0;
+}
+
+ANV_API size_t anv_concurrent_hashmap_memory_usage(ANVConcurrentHashMap* map)
+{
+    if (!map)
+    {
+        return 0;
+    }
+
+    size_t usage = sizeof(ANVConcurrentHashMap) + segment_block_bytes(map->segment_count);
+    for (size_t i = 0; i < map->segment_count; i++)
+    {
+        ANVConcurrentHashMapSegment* segment = &map->segments[i];
+        anv_mutex_lock(&segment->lock);
+        usage += anv_hashmap_memory_usage(segment->map);
+        anv_mutex_unlock(&segment->lock);
+    }
+    return usage;
+}
+
+ANV_API int anv_concurrent_hashmap_contains_key(ANVConcurrentHashMap* map, const void* key)
+{
+    if (!map || !key)
+    {
+        return 0;
+    }
+
+    ANVConcurrentHashMapSegment* segment = segment_for(map, key);
+    anv_mutex_lock(&segment->lock);
+    const int found = anv_hashmap_contains_key(segment->map, key);
+    anv_mutex_unlock(&segment->lock);
+    return found;
+}
+
+//==============================================================================
+// Map operations
+//==============================================================================
+
+ANV_API int anv_concurrent_hashmap_put(ANVConcurrentHashMap* map, void* key, void* value)
+{
+    if (!map || !key)
+    {
+        return -1;
+    }
+
+    ANVConcurrentHashMapSegment* segment = segment_for(map, key);
+    anv_mutex_lock(&segment->lock);
+    const int result = anv_hashmap_put(segment->map, key, value);
+    anv_mutex_unlock(&segment->lock);
+    return result;
+}
+
+ANV_API int anv_concurrent_hashmap_put_replace(ANVConcurrentHashMap* map, void* key, void* value,
+                                               void** old_value_out)
+{
+    if (!map || !key)
+    {
+        return -1;
+    }
+
+    ANVConcurrentHashMapSegment* segment = segment_for(map, key);
+    anv_mutex_lock(&segment->lock);
+    const int result = anv_hashmap_put_replace(segment->map, key, value, old_value_out);
+    anv_mutex_unlock(&segment->lock);
+    return result;
+}
+
+ANV_API int anv_concurrent_hashmap_put_if_absent(ANVConcurrentHashMap* map, void* key, void* value,
+                                                 void** existing_out)
+{
+    if (!map || !key)
+    {
+        return -1;
+    }
+
+    ANVConcurrentHashMapSegment* segment = segment_for(map, key);
+    anv_mutex_lock(&segment->lock);
+    bool inserted = false;
+    void** slot = anv_hashmap_entry(segment->map, key, &inserted);
+    if (slot)
+    {
+        if (inserted)
+        {
+            *slot = value;
+        }
+        else if (existing_out)
+        {
+            *existing_out = *slot;
+        }
+    }
+    anv_mutex_unlock(&segment->lock);
+
+    if (!slot)
+    {
+        return -1;
+    }
+    return inserted ? 0 : 1;
+}
+
+ANV_API void* anv_concurrent_hashmap_get(ANVConcurrentHashMap* map, const void* key)
+{
+    if (!map || !key)
+    {
+        return NULL;
+    }
+
+    ANVConcurrentHashMapSegment* segment = segment_for(map, key);
+    anv_mutex_lock(&segment->lock);
+    void* value = anv_hashmap_get(segment->map, key);
+    anv_mutex_unlock(&segment->lock);
+    return value;
+}
+
+ANV_API int anv_concurrent_hashmap_remove(ANVConcurrentHashMap* map, const void* key,
+                                          const bool should_free_key, const bool should_free_value)
+{
+    if (!map || !key)
+    {
+        return -1;
+    }
+
+    ANVConcurrentHashMapSegment* segment = segment_for(map, key);
+    anv_mutex_lock(&segment->lock);
+    const int result = anv_hashmap_remove(segment->map, key, should_free_key, should_free_value);
+    anv_mutex_unlock(&segment->lock);
+    return result;
+}
+
+ANV_API void* anv_concurrent_hashmap_remove_get(ANVConcurrentHashMap* map, const void* key,
+                                                const bool should_free_key)
+{
+    if (!map || !key)
+    {
+        return NULL;
+    }
+
+    ANVConcurrentHashMapSegment* segment = segment_for(map, key);
+    anv_mutex_lock(&segment->lock);
+    void* value = anv_hashmap_remove_get(segment->map, key, should_free_key);
+    anv_mutex_unlock(&segment->lock);
+    return value;
+}
+
+ANV_API void anv_concurrent_hashmap_for_each(ANVConcurrentHashMap* map, void (*action)(void* key, void* value))
+{
+    if (!map || !action)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < map->segment_count; i++)
+    {
+        ANVConcurrentHashMapSegment* segment = &map->segments[i];
+        anv_mutex_lock(&segment->lock);
+        anv_hashmap_for_each(segment->map, action);
+        anv_mutex_unlock(&segment->lock);
+    }
+}
+
+//==============================================================================
+// Iterator implementation
+//==============================================================================
+
+typedef struct ConcurrentHashMapIteratorState
+{
+    ANVConcurrentHashMap* map;
+    size_t next_segment; // Next segment to snapshot
+    ANVPair* snapshot;   // Entries of the current segment
+    size_t capacity;     // Pairs the snapshot can hold
+    size_t count;        // Pairs in the snapshot
+    size_t position;     // Current pair, or count when the snapshot is used up
+    bool failed;         // A segment could not be copied, iteration ended early
+} ConcurrentHashMapIteratorState;
+
+/**
+ * Copy the entries of the next non-empty segment into the snapshot. Leaves
+ * the snapshot empty once every segment has been visited, or when a segment
+ * cannot be copied, in which case the iterator is marked failed.
+ */
+static void load_next_segment(ConcurrentHashMapIteratorState* state)
+{
+    ANVConcurrentHashMap* map = state->map;
+    state->count = 0;
+    state->position = 0;
+
+    while (state->count == 0 && state->next_segment < map->segment_count)
+    {
+        ANVConcurrentHashMapSegment* segment = &map->segments[state->next_segment++];
+        anv_mutex_lock(&segment->lock);
+
+        const size_t size = segment->map->size;
+        if (size > state->capacity)
+        {
+            ANVPair* grown = anv_alloc_realloc(map->alloc, state->snapshot, state->capacity * sizeof(ANVPair),
+                                               size * sizeof(ANVPair));
+            if (!grown)
+            {
+                anv_mutex_unlock(&segment->lock);
+                state->failed = true;
+                return;
+            }
+            state->snapshot = grown;
+            state->capacity = size;
+        }
+
+        ANVIterator entries = anv_hashmap_iterator(segment->map);
+        if (!entries.is_valid(&entries))
+        {
+            anv_mutex_unlock(&segment->lock);
+            state->failed = true;
+            return;
+        }
+        while (entries.has_next(&entries) && state->count < size)
+        {
+            const ANVPair* pair = entries.get(&entries);
+            if (pair)
+            {
+                state->snapshot[state->count++] = *pair;
+            }
+            entries.next(&entries);
+        }
+        entries.destroy(&entries);
+
+        anv_mutex_unlock(&segment->lock);
+    }
+}
+
+static void* concurrent_hashmap_iterator_get(const ANVIterator* it)
+{
+    if (!it || !it->data_state)
+    {
+        return NULL;
+    }
+
+    ConcurrentHashMapIteratorState* state = it->data_state;
+    return state->position < state->count ? &state->snapshot[state->position] : NULL;
+}
+
+static int concurrent_hashmap_iterator_has_next(const ANVIterator* it)
+{
+    if (!it || !it->data_state)
+    {
+        return 0;
+    }
+
+    const ConcurrentHashMapIteratorState* state = it->data_state;
+    return state->position < state->count;
+}
+
+static int concurrent_hashmap_iterator_next(const ANVIterator* it)
+{
+    if (!it || !it->data_state)
+    {
+        return -1;
+    }
+
+    ConcurrentHashMapIteratorState* state = it->data_state;
+    if (state->position >= state->count)
+    {
+        return -1;
+    }
+
+    if (++state->position == state->count)
+    {
+        load_next_segment(state);
+    }
+    return 0;
+}
+
+static int concurrent_hashmap_iterator_has_prev(const ANVIterator* it)
+{
+    (void)it;
+    return 0; // Concurrent map iterator doesn't support backward iteration
+}
+
+static int concurrent_hashmap_iterator_prev(const ANVIterator* it)
+{
+    (void)it;
+    return -1; // Concurrent map iterator doesn't support backward iteration
+}
+
+static void concurrent_hashmap_iterator_reset(const ANVIterator* it)
+{
+    if (!it || !it->data_state)
+    {
+        return;
+    }
+
+    ConcurrentHashMapIteratorState* state = it->data_state;
+    state->next_segment = 0;
+    state->failed = false;
+    load_next_segment(state);
+}
+
+static int concurrent_hashmap_iterator_is_valid(const ANVIterator* it)
+{
+    if (!it || !it->data_state)
+    {
+        return 0;
+    }
+
+    const ConcurrentHashMapIteratorState* state = it->data_state;
+    return !state->failed;
+}
+
+static void concurrent_hashmap_iterator_destroy(ANVIterator* it)
+{
+    if (!it || !it->data_state)
+    {
+        return;
+    }
+
+    ConcurrentHashMapIteratorState* state = it->data_state;
+    const ANVAllocator* alloc = state->map->alloc;
+    anv_alloc_free_sized(alloc, state->snapshot, state->capacity * sizeof(ANVPair));
+    anv_alloc_free_sized(alloc, state, sizeof(ConcurrentHashMapIteratorState));
+    it->data_state = NULL;
+}
+
+ANV_API ANVIterator anv_concurrent_hashmap_iterator(ANVConcurrentHashMap* map)
+{
+    ANVIterator it = {0};
+
+    it.get = concurrent_hashmap_iterator_get;
+    it.has_next = concurrent_hashmap_iterator_has_next;
+    it.next = concurrent_hashmap_iterator_next;
+    it.has_prev = concurrent_hashmap_iterator_has_prev;
+    it.prev = concurrent_hashmap_iterator_prev;
+    it.reset = concurrent_hashmap_iterator_reset;
+    it.is_valid = concurrent_hashmap_iterator_is_valid;
+    it.destroy = concurrent_hashmap_iterator_destroy;
+
+    if (!map || !map->alloc)
+    {
+        return it;
+    }
+
+    ConcurrentHashMapIteratorState* state = anv_alloc_malloc(map->alloc, sizeof(ConcurrentHashMapIteratorState));
+    if (!state)
+    {
+        return it;
+    }
+
+    memset(state, 0, sizeof(ConcurrentHashMapIteratorState));
+    state->map = map;
+    load_next_segment(state);
+
+    it.alloc = map->alloc;
+    it.data_state = state;
+    return it;
+}
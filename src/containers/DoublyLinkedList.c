@@ -171,7 +171,7 @@ ANV_API void anv_dll_destroy(ANVDoublyLinkedList* list, const bool should_free_d
     if (list)
     {
         anv_dll_clear(list, should_free_data);
-        anv_alloc_free(list->alloc, list);
+        anv_alloc_free_sized(list->alloc, list, sizeof(ANVDoublyLinkedList));
     }
 }
 
@@ -191,7 +191,7 @@ ANV_API void anv_dll_clear(ANVDoublyLinkedList* list, const bool should_free_dat
             anv_alloc_data_free(list->alloc, node->data);
         }
 
-        anv_alloc_free(list->alloc, node);
+        anv_alloc_free_sized(list->alloc, node, sizeof(ANVDoublyLinkedNode));
         node = next;
     }
 
@@ -219,6 +219,16 @@ ANV_API int anv_dll_is_empty(const ANVDoublyLinkedList* list)
     return !list || list->size == 0;
 }
 
+ANV_API size_t anv_dll_memory_usage(const ANVDoublyLinkedList* list)
+{
+    if (!list)
+    {
+        return 0;
+    }
+
+    return sizeof(ANVDoublyLinkedList) + list->size * sizeof(ANVDoublyLinkedNode);
+}
+
 ANV_API ANVDoublyLinkedNode* anv_dll_find(ANVDoublyLinkedList* list, const void* data, const cmp_func compare)
 {
     if (!list || !compare)
@@ -448,7 +458,7 @@ ANV_API int anv_dll_remove(ANVDoublyLinkedList* list, const void* data, const cm
             {
                 anv_alloc_data_free(list->alloc, curr->data);
             }
-            anv_alloc_free(list->alloc, curr);
+            anv_alloc_free_sized(list->alloc, curr, sizeof(ANVDoublyLinkedNode));
             list->size--;
 
             return 0;
@@ -505,7 +515,7 @@ ANV_API int anv_dll_remove_at(ANVDoublyLinkedList* list, const size_t pos, const
     {
         anv_alloc_data_free(list->alloc, node_to_remove->data);
     }
-    anv_alloc_free(list->alloc, node_to_remove);
+    anv_alloc_free_sized(list->alloc, node_to_remove, sizeof(ANVDoublyLinkedNode));
     list->size--;
 
     return 0;
@@ -536,7 +546,7 @@ ANV_API int anv_dll_pop_front(ANVDoublyLinkedList* list, const bool should_free_
         anv_alloc_data_free(list->alloc, node_to_remove->data);
     }
 
-    anv_alloc_free(list->alloc, node_to_remove);
+    anv_alloc_free_sized(list->alloc, node_to_remove, sizeof(ANVDoublyLinkedNode));
     list->size--;
 
     return 0;
@@ -568,7 +578,7 @@ ANV_API int anv_dll_pop_back(ANVDoublyLinkedList* list, const bool should_free_d
     }
 
     // Free the node memory using the allocator's dealloc function
-    anv_alloc_free(list->alloc, node_to_remove);
+    anv_alloc_free_sized(list->alloc, node_to_remove, sizeof(ANVDoublyLinkedNode));
     list->size--;
     return 0;
 }
@@ -1191,7 +1201,7 @@ static void anv_dll_iterator_destroy(ANVIterator* it)
 
     if (it->alloc)
     {
-        anv_alloc_free(it->alloc, it->data_state);
+        anv_alloc_free_sized(it->alloc, it->data_state, sizeof(ListIteratorState));
     }
     it->data_state = NULL;
 }
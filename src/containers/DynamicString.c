@@ -8,54 +8,75 @@
 #include <string.h>
 
 #include "DynamicString.h"
+#include "HashMap.h"
 
-#define SAFE_FREE(ptr) do { if ((ptr)) { free((ptr)); (ptr) = NULL; } } while(0)
 #define GROW_CAPACITY(cap) ((cap) + ((cap) >> 1))
 
 #define STR_DATA(str) ((str)->capacity == STR_MIN_INIT_CAP ? (str)->small_data : (str)->data)
 #define ZERO_MEM(ptr, size) memset((ptr), 0, (size))
 
-// Helper function to allocate zeroed memory
-static char* mem_calloc(const size_t num_elements)
+// Buffer helpers: a NULL allocator means the C heap
+static char* buffer_alloc(ANVAllocator* alloc, const size_t size)
 {
-    return calloc(num_elements, sizeof(char));
+    return alloc ? anv_alloc_malloc(alloc, size) : malloc(size);
 }
 
-// Centralized buffer management helper
+static void buffer_free(ANVAllocator* alloc, char* ptr, const size_t size)
+{
+    if (alloc)
+    {
+        anv_alloc_free_sized(alloc, ptr, size);
+    }
+    else
+    {
+        free(ptr);
+    }
+}
+
+static char* buffer_realloc(ANVAllocator* alloc, char* ptr, const size_t old_size, const size_t new_size)
+{
+    return alloc ? anv_alloc_realloc(alloc, ptr, old_size, new_size) : realloc(ptr, new_size);
+}
+
+// Centralized buffer management helper. The buffer is always kept
+// null-terminated at size, so only size + 1 bytes ever need to move.
 static bool anv_str_realloc(ANVString* str, const size_t new_capacity)
 {
-    const char* old_data = STR_DATA(str);
-    const size_t copy_size = str->size;
+    const size_t copy_size = str->size + 1;
 
     if (new_capacity <= STR_MIN_INIT_CAP)
     {
-        char* temp = calloc(copy_size + 1, sizeof(char));
-        if (!temp && copy_size > 0)
+        if (str->capacity == STR_MIN_INIT_CAP)
         {
-            return false; // Failed to allocate temporary buffer
+            return true;
         }
 
-        memcpy(temp, old_data, copy_size);
-        SAFE_FREE(str->data);
-
-        // Move to small buffer
-        ZERO_MEM(str->small_data, STR_MIN_INIT_CAP);
-        memcpy(str->small_data, temp, copy_size);
+        // Move to small buffer; save the pointer first since it shares storage
+        char* heap_data = str->data;
+        const size_t heap_capacity = str->capacity;
+        memcpy(str->small_data, heap_data, copy_size);
+        buffer_free(str->alloc, heap_data, heap_capacity);
         str->capacity = STR_MIN_INIT_CAP;
-        free(temp);
     }
-    else
+    else if (str->capacity == STR_MIN_INIT_CAP)
     {
-        char* new_data = mem_calloc(new_capacity);
+        char* new_data = buffer_alloc(str->alloc, new_capacity);
         if (!new_data)
         {
             return false; // Failed to allocate new buffer
         }
 
-        memcpy(new_data, old_data, copy_size);
-        if (str->capacity > STR_MIN_INIT_CAP && str->data)
+        memcpy(new_data, str->small_data, copy_size);
+        str->data = new_data;
+        str->capacity = new_capacity;
+    }
+    else
+    {
+        // Heap to heap: let the allocator extend the block in place when it can
+        char* new_data = buffer_realloc(str->alloc, str->data, str->capacity, new_capacity);
+        if (!new_data)
         {
-            SAFE_FREE(str->data);
+            return false; // Failed to allocate new buffer
         }
 
         str->data = new_data;
@@ -82,6 +103,11 @@ static bool anv_str_ensure_capacity(ANVString* str, const size_t required_capaci
 }
 
 ANV_API ANVString anv_str_create_empty(const size_t initial_capacity)
+{
+    return anv_str_create_empty_with_alloc(NULL, initial_capacity);
+}
+
+ANV_API ANVString anv_str_create_empty_with_alloc(ANVAllocator* alloc, const size_t initial_capacity)
 {
     ANVString result;
 
@@ -89,11 +115,16 @@ ANV_API ANVString anv_str_create_empty(const size_t initial_capacity)
 
     result.capacity = capacity;
     result.size = 0;
+    result.alloc = alloc;
 
     if (capacity > STR_MIN_INIT_CAP)
     {
-        result.data = mem_calloc(capacity);
-        if (!result.data)
+        result.data = buffer_alloc(alloc, capacity);
+        if (result.data)
+        {
+            result.data[0] = '\0';
+        }
+        else
         {
             // Fallback to small buffer on allocation failure
             result.capacity = STR_MIN_INIT_CAP;
@@ -104,23 +135,32 @@ ANV_API ANVString anv_str_create_empty(const size_t initial_capacity)
     {
         // Use the small_data buffer for small initial capacities
         ZERO_MEM(result.small_data, STR_MIN_INIT_CAP);
-        result.data = NULL;
     }
 
     return result;
 }
 
 ANV_API ANVString anv_str_create_from_cstring(const char* cstr)
+{
+    return anv_str_create_from_cstring_with_alloc(NULL, cstr);
+}
+
+ANV_API ANVString anv_str_create_from_cstring_with_alloc(ANVAllocator* alloc, const char* cstr)
 {
     if (!cstr)
     {
-        return anv_str_create_empty(0);
+        return anv_str_create_empty_with_alloc(alloc, 0);
     }
 
     const size_t length = strlen(cstr);
-    ANVString result = anv_str_create_empty(length + 1); // +1 for the null-terminator
+    ANVString result = anv_str_create_empty_with_alloc(alloc, length + 1); // +1 for the null-terminator
+    if (length + 1 > result.capacity)
+    {
+        return result; // Allocation failed, leave the string empty
+    }
+
     char* data_to_use = STR_DATA(&result);
-    memcpy(data_to_use, cstr, length);
+    memcpy(data_to_use, cstr, length + 1);
     result.size = length;
 
     return result;
@@ -134,7 +174,7 @@ ANV_API ANVString anv_str_create_from_string(const ANVString* str)
     }
 
     const char* data_to_use = STR_DATA(str);
-    return anv_str_create_from_cstring(data_to_use);
+    return anv_str_create_from_cstring_with_alloc(str->alloc, data_to_use);
 }
 
 ANV_API void anv_str_destroy(ANVString* str)
@@ -144,9 +184,9 @@ ANV_API void anv_str_destroy(ANVString* str)
         return;
     }
 
-    if (str->capacity != STR_MIN_INIT_CAP)
+    if (str->capacity != STR_MIN_INIT_CAP && str->data)
     {
-        free(str->data);
+        buffer_free(str->alloc, str->data, str->capacity);
     }
     str->size = 0;
     str->capacity = 0;
@@ -186,6 +226,7 @@ ANV_API void anv_str_assign_char(ANVString* str, const char value)
     anv_str_clear(str);
     char* data_to_use = STR_DATA(str);
     data_to_use[0] = value;
+    data_to_use[1] = '\0';
     str->size = 1;
 }
 
@@ -198,7 +239,10 @@ ANV_API void anv_str_assign_cstring(ANVString* str, const char* cstr)
 
     anv_str_clear(str);
     const size_t length = strlen(cstr);
-    anv_str_ensure_capacity(str, length + 1); // +1 for the null-terminator
+    if (!anv_str_ensure_capacity(str, length + 1)) // +1 for the null-terminator
+    {
+        return;
+    }
     char* data_to_use = STR_DATA(str);
     memcpy(data_to_use, cstr, length + 1);
     str->size = length;
@@ -227,18 +271,15 @@ ANV_API void anv_str_push_back(ANVString* str, const char value)
         return;
     }
 
-    anv_str_ensure_capacity(str, str->size + 1); // Ensure enough capacity for the new character
-
-    if (str->capacity == STR_MIN_INIT_CAP)
-    {
-        str->small_data[str->size] = value;
-    }
-    else
+    // Ensure enough capacity for the new character and the null-terminator
+    if (!anv_str_ensure_capacity(str, str->size + 2))
     {
-        str->data[str->size] = value;
+        return;
     }
 
-    ++str->size;
+    char* data_to_use = STR_DATA(str);
+    data_to_use[str->size] = value;
+    data_to_use[++str->size] = '\0';
 }
 
 ANV_API void anv_str_append_char(ANVString* str, const char value)
@@ -259,12 +300,23 @@ ANV_API void anv_str_append_cstring(ANVString* str, const char* cstr)
     }
 
     const size_t length = strlen(cstr);
-    anv_str_ensure_capacity(str, str->size + length + 1); // Ensure enough capacity for the entire C-string
+
+    // cstr may point into this string's own buffer, which growth can move
+    const char* old_data = STR_DATA(str);
+    const bool aliased = cstr >= old_data && cstr <= old_data + str->size;
+    const size_t offset = aliased ? (size_t)(cstr - old_data) : 0;
+
+    // Ensure enough capacity for the entire C-string
+    if (!anv_str_ensure_capacity(str, str->size + length + 1))
+    {
+        return;
+    }
 
     char* data_to_use = STR_DATA(str);
-    memcpy(data_to_use + str->size, cstr, length);
+    memmove(data_to_use + str->size, aliased ? data_to_use + offset : cstr, length);
 
     str->size += length;
+    data_to_use[str->size] = '\0';
 }
 
 ANV_API void anv_str_append_string(ANVString* str, const ANVString* from)
@@ -290,24 +342,15 @@ ANV_API void anv_str_insert_char(ANVString* str, const size_t pos, const char va
         return;
     }
 
-    if (str->size + 1 > str->capacity - 1)
+    if (!anv_str_ensure_capacity(str, str->size + 2))
     {
-        anv_str_realloc(str, GROW_CAPACITY(str->capacity));
+        return;
     }
 
+    // Shift the tail, including the null-terminator, one position right
     char* data_to_use = STR_DATA(str);
-    if (pos == str->size)
-    {
-        data_to_use[str->size] = value;
-    }
-    else
-    {
-        for (size_t i = str->size; i > pos; i--)
-        {
-            data_to_use[i] = data_to_use[i - 1];
-        }
-        data_to_use[pos] = value;
-    }
+    memmove(data_to_use + pos + 1, data_to_use + pos, str->size - pos + 1);
+    data_to_use[pos] = value;
 
     str->size++;
 }
@@ -410,8 +453,10 @@ ANV_API void anv_str_clear(ANVString* str)
     }
 
     char* data_to_use = STR_DATA(str);
-
-    ZERO_MEM(data_to_use, str->size);
+    if (data_to_use)
+    {
+        data_to_use[0] = '\0';
+    }
     str->size = 0;
 }
 
@@ -448,8 +493,7 @@ ANV_API bool anv_str_shrink_to_fit(ANVString* str)
         return true;
     }
 
-    anv_str_realloc(str, new_capacity);
-    return true;
+    return anv_str_realloc(str, new_capacity);
 }
 
 ANV_API char* anv_str_data(ANVString* str)
@@ -482,6 +526,39 @@ ANV_API size_t anv_str_size(const ANVString* str)
     return str->size;
 }
 
+ANV_API size_t anv_str_memory_usage(const ANVString* str)
+{
+    if (!str || str->capacity == STR_MIN_INIT_CAP)
+    {
+        return 0;
+    }
+
+    return str->capacity;
+}
+
+ANV_API size_t anv_str_hash(const void* key)
+{
+    if (!key)
+    {
+        return 0;
+    }
+
+    const ANVString* str = key;
+    return anv_hash_bytes(STR_DATA(str), str->size);
+}
+
+ANV_API int anv_str_key_equals(const void* key1, const void* key2)
+{
+    if (!key1 || !key2)
+    {
+        return key1 == key2;
+    }
+
+    const ANVString* lhs = key1;
+    const ANVString* rhs = key2;
+    return lhs->size == rhs->size && memcmp(STR_DATA(lhs), STR_DATA(rhs), lhs->size) == 0;
+}
+
 ANV_API size_t anv_str_find_first_of(const ANVString* str, const char* value)
 {
     if (!str || !value)
@@ -651,11 +728,12 @@ ANV_API void anv_str_to_upper(ANVString* str)
     }
 }
 
-ANV_API ANVString anv_str_substr_create_cstring(const char* cstr, const size_t pos, size_t count)
+// Shared by both substring constructors so the result can use the source's allocator
+static ANVString substr_create(ANVAllocator* alloc, const char* cstr, const size_t pos, size_t count)
 {
     if (!cstr)
     {
-        return anv_str_create_empty(0);
+        return anv_str_create_empty_with_alloc(alloc, 0);
     }
 
     const size_t size = strlen(cstr);
@@ -667,23 +745,33 @@ ANV_API ANVString anv_str_substr_create_cstring(const char* cstr, const size_t p
 
     if (size - count > size)
     {
-        return anv_str_create_empty(0);
+        return anv_str_create_empty_with_alloc(alloc, 0);
     }
 
     if (pos >= size)
     {
-        return anv_str_create_empty(0);
+        return anv_str_create_empty_with_alloc(alloc, 0);
     }
 
-    ANVString result = anv_str_create_empty(count);
-    for (size_t i = 0; i < count; i++)
+    ANVString result = anv_str_create_empty_with_alloc(alloc, count + 1);
+    if (count + 1 > result.capacity)
     {
-        anv_str_push_back(&result, cstr[i + pos]);
+        return result; // Allocation failed, leave the string empty
     }
 
+    char* data_to_use = STR_DATA(&result);
+    memcpy(data_to_use, cstr + pos, count);
+    data_to_use[count] = '\0';
+    result.size = count;
+
     return result;
 }
 
+ANV_API ANVString anv_str_substr_create_cstring(const char* cstr, const size_t pos, const size_t count)
+{
+    return substr_create(NULL, cstr, pos, count);
+}
+
 ANV_API ANVString anv_str_substr_create_string(const ANVString* str, const size_t pos, const size_t count)
 {
     if (!str)
@@ -692,7 +780,7 @@ ANV_API ANVString anv_str_substr_create_string(const ANVString* str, const size_
     }
 
     const char* data_to_use = STR_DATA(str);
-    return anv_str_substr_create_cstring(data_to_use, pos, count);
+    return substr_create(str->alloc, data_to_use, pos, count);
 }
 
 ANV_API char* anv_str_substr_cstring(const char* cstr, const size_t pos, size_t count, char* buffer)
@@ -750,13 +838,17 @@ ANV_API size_t anv_str_split(const ANVString* str, const char* delim, ANVString*
     }
 
     size_t num_strings = 0;
-    char* buffer = mem_calloc(str->size + 1);
-    memcpy(buffer, STR_DATA(str), str->size);
+    char* buffer = buffer_alloc(str->alloc, str->size + 1);
+    if (!buffer)
+    {
+        return 0;
+    }
+    memcpy(buffer, STR_DATA(str), str->size + 1);
 
     ANVString* temp = malloc(sizeof(ANVString));
     if (!temp)
     {
-        free(buffer);
+        buffer_free(str->alloc, buffer, str->size + 1);
         return 0;
     }
 
@@ -767,17 +859,17 @@ ANV_API size_t anv_str_split(const ANVString* str, const char* delim, ANVString*
         if (!new_temp)
         {
             fprintf(stderr, "Error: Unable to allocate memory\n");
-            free(buffer);
-            free(temp);
+            buffer_free(str->alloc, buffer, str->size + 1);
+            anv_str_destroy_split(&temp, num_strings);
             return 0;
         }
         temp = new_temp;
-        temp[num_strings] = anv_str_create_from_cstring(token);
+        temp[num_strings] = anv_str_create_from_cstring_with_alloc(str->alloc, token);
         num_strings++;
         token = strtok(NULL, delim);
     }
     *out = temp;
-    free(buffer);
+    buffer_free(str->alloc, buffer, str->size + 1);
 
     return num_strings;
 }
@@ -0,0 +1,265 @@
+//
+// FlatGroup.h
+// Control-byte group probing shared by the open-addressing containers.
+//
+// Private to the library (FlatMap.c and HashSet.c). Each slot has a control
+// byte that is either a 7-bit hash tag (non-negative) or one of the negative
+// markers below. A probe compares one group of GROUP_WIDTH control bytes at
+// a time, with SSE2 where the target supports it.
+//
+// A table is one allocation: capacity slots of the container's own layout
+// followed by capacity control bytes. The table helpers below only see the
+// control bytes; key comparison goes through a flat_slot_matches callback.
+// Every hash passed to them has been through flat_mix_hash.
+
+#ifndef ANVIL_FLATGROUP_H
+#define ANVIL_FLATGROUP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "Allocator.h"
+
+#if (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)) && !defined(ANVIL_NO_SIMD)
+#define FLAT_GROUP_USE_SSE2 1
+#include <emmintrin.h>
+#else
+#define FLAT_GROUP_USE_SSE2 0
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Number of control bytes examined per probe step
+#define GROUP_WIDTH 16
+
+#define CTRL_EMPTY ((int8_t)-128)
+#define CTRL_DELETED ((int8_t)-2)
+
+// Returned by flat_find when the key is absent
+#define FLAT_NOT_FOUND SIZE_MAX
+
+/**
+ * True when the full slot at index holds key. table is the container passed to flat_find.
+ */
+typedef bool (*flat_slot_matches)(const void* table, size_t index, const void* key);
+
+/**
+ * Maximum number of full or deleted slots before a table must rehash (7/8 load).
+ */
+static inline size_t group_max_load(const size_t capacity)
+{
+    return capacity - capacity / 8;
+}
+
+/**
+ * Finalize a user hash before it is split into tag and group. Identity and
+ * other weak hashes leave the low bits (the tag) and the bits just above
+ * them (the group) correlated, which piles sequential keys into a few long
+ * probe runs.
+ */
+static inline size_t flat_mix_hash(size_t hash)
+{
+#if SIZE_MAX > 0xFFFFFFFFu
+    hash ^= hash >> 33;
+    hash *= (size_t)0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+#else
+    hash ^= hash >> 16;
+    hash *= (size_t)0x85ebca6bu;
+    hash ^= hash >> 13;
+#endif
+    return hash;
+}
+
+static inline int8_t hash_tag(const size_t hash)
+{
+    return (int8_t)(hash & 0x7F);
+}
+
+/**
+ * Index of the lowest set bit of a non-zero group mask.
+ */
+static inline unsigned lowest_bit(const uint32_t mask)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned)__builtin_ctz(mask);
+#elif defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (unsigned)index;
+#else
+    unsigned index = 0;
+    while (!(mask & (1u << index)))
+    {
+        index++;
+    }
+    return index;
+#endif
+}
+
+/**
+ * Bit i set when control byte i of the group equals tag.
+ */
+static inline uint32_t group_match(const int8_t* group, const int8_t tag)
+{
+#if FLAT_GROUP_USE_SSE2
+    const __m128i ctrl = _mm_loadu_si128((const __m128i*)group);
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(tag)));
+#else
+    uint32_t mask = 0;
+    for (unsigned i = 0; i < GROUP_WIDTH; i++)
+    {
+        mask |= (uint32_t)(group[i] == tag) << i;
+    }
+    return mask;
+#endif
+}
+
+/**
+ * Bit i set when control byte i is empty or deleted. Full slots hold
+ * non-negative tags, so this is simply the sign bit of each byte.
+ */
+static inline uint32_t group_match_free(const int8_t* group)
+{
+#if FLAT_GROUP_USE_SSE2
+    return (uint32_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)group));
+#else
+    uint32_t mask = 0;
+    for (unsigned i = 0; i < GROUP_WIDTH; i++)
+    {
+        mask |= (uint32_t)(group[i] < 0) << i;
+    }
+    return mask;
+#endif
+}
+
+//==============================================================================
+// Table helpers
+//==============================================================================
+
+/**
+ * Group where the probe sequence of hash starts.
+ */
+static inline size_t flat_home_group(const size_t capacity, const size_t hash)
+{
+    return (hash >> 7) & (capacity / GROUP_WIDTH - 1);
+}
+
+/**
+ * Find the slot holding key, or FLAT_NOT_FOUND. matches is only called for
+ * slots whose tag equals the tag of hash.
+ */
+static inline size_t flat_find(const int8_t* ctrl, const size_t capacity, const size_t hash,
+                               const flat_slot_matches matches, const void* table, const void* key)
+{
+    const size_t group_mask = capacity / GROUP_WIDTH - 1;
+    const int8_t tag = hash_tag(hash);
+    size_t group = flat_home_group(capacity, hash);
+
+    for (size_t step = 0; step <= group_mask;)
+    {
+        const int8_t* group_ctrl = ctrl + group * GROUP_WIDTH;
+        uint32_t match = group_match(group_ctrl, tag);
+        while (match)
+        {
+            const size_t index = group * GROUP_WIDTH + lowest_bit(match);
+            if (matches(table, index, key))
+            {
+                return index;
+            }
+            match &= match - 1;
+        }
+
+        if (group_match(group_ctrl, CTRL_EMPTY))
+        {
+            return FLAT_NOT_FOUND;
+        }
+        group = (group + ++step) & group_mask;
+    }
+
+    return FLAT_NOT_FOUND;
+}
+
+/**
+ * Find the first empty or deleted slot on the probe sequence of hash.
+ * The load limit guarantees one exists.
+ */
+static inline size_t flat_find_free(const int8_t* ctrl, const size_t capacity, const size_t hash)
+{
+    const size_t group_mask = capacity / GROUP_WIDTH - 1;
+    size_t group = flat_home_group(capacity, hash);
+
+    for (size_t step = 0;;)
+    {
+        const uint32_t free_mask = group_match_free(ctrl + group * GROUP_WIDTH);
+        if (free_mask)
+        {
+            return group * GROUP_WIDTH + lowest_bit(free_mask);
+        }
+        group = (group + ++step) & group_mask;
+    }
+}
+
+/**
+ * Bytes in the single block holding capacity slots and their control bytes.
+ */
+static inline size_t flat_table_bytes(const size_t capacity, const size_t slot_size)
+{
+    return capacity * (slot_size + sizeof(int8_t));
+}
+
+/**
+ * Allocate an empty table. Returns the slot array and sets the control bytes
+ * and growth_left, or returns NULL and leaves the outputs untouched.
+ */
+static inline void* flat_allocate(const ANVAllocator* alloc, const size_t capacity, const size_t slot_size,
+                                  int8_t** ctrl_out, size_t* growth_left_out)
+{
+    unsigned char* slots = anv_alloc_malloc(alloc, flat_table_bytes(capacity, slot_size));
+    if (!slots)
+    {
+        return NULL;
+    }
+
+    *ctrl_out = (int8_t*)(slots + capacity * slot_size);
+    *growth_left_out = group_max_load(capacity);
+    memset(*ctrl_out, CTRL_EMPTY, capacity);
+    return slots;
+}
+
+/**
+ * Mark a full slot as free again. The slot becomes empty when its group still
+ * has an empty slot, since no probe sequence can have passed through it;
+ * otherwise it becomes a tombstone. The caller adjusts its own size.
+ */
+static inline void flat_erase(int8_t* ctrl, const size_t index, size_t* growth_left)
+{
+    const int8_t* group = ctrl + (index / GROUP_WIDTH) * GROUP_WIDTH;
+    if (group_match(group, CTRL_EMPTY))
+    {
+        ctrl[index] = CTRL_EMPTY;
+        (*growth_left)++;
+    }
+    else
+    {
+        ctrl[index] = CTRL_DELETED;
+    }
+}
+
+/**
+ * First full slot at or after start, or capacity.
+ */
+static inline size_t flat_next_full(const int8_t* ctrl, const size_t capacity, size_t start)
+{
+    while (start < capacity && ctrl[start] < 0)
+    {
+        start++;
+    }
+    return start;
+}
+
+#endif //ANVIL_FLATGROUP_H
@@ -0,0 +1,543 @@
+//
+// FlatMap.c
+// Implementation of the open-addressing flat hash map.
+//
+// The table is split into groups of ANV_FLATMAP_GROUP_WIDTH slots. A key's
+// hash, after flat_mix_hash, picks a starting group (high bits) and a 7-bit
+// tag (low bits). Lookup
+// compares the tag against all control bytes of a group at once, checks the
+// keys of matching slots, and stops at the first group that still has an
+// empty slot. Groups are visited in triangular order, which covers every
+// group exactly once when the group count is a power of two.
+//
+// Removal leaves a tombstone unless the group already has an empty slot, in
+// which case no probe sequence can have passed through it and the slot can
+// be marked empty again.
+
+#include <string.h>
+
+#include "FlatGroup.h"
+#include "FlatMap.h"
+#include "Pair.h"
+
+_Static_assert(GROUP_WIDTH == ANV_FLATMAP_GROUP_WIDTH, "FlatMap group width must match FlatGroup.h");
+
+//==============================================================================
+// Default constants
+//==============================================================================
+
+#define DEFAULT_INITIAL_CAPACITY 16
+#define NOT_FOUND FLAT_NOT_FOUND
+
+//==============================================================================
+// Static helper functions
+//==============================================================================
+
+/**
+ * Mixed hash of key, the only form in which hashes reach the table helpers.
+ */
+static size_t hash_key(const ANVFlatMap* map, const void* key)
+{
+    return flat_mix_hash(map->hash(key));
+}
+
+static bool slot_matches(const void* table, const size_t index, const void* key)
+{
+    const ANVFlatMap* map = table;
+    return map->key_equals(map->slots[index].key, key);
+}
+
+/**
+ * Find the slot holding key, or NOT_FOUND.
+ */
+static size_t find_slot(const ANVFlatMap* map, const void* key, const size_t hash)
+{
+    return flat_find(map->ctrl, map->capacity, hash, slot_matches, map, key);
+}
+
+static size_t find_free_slot(const ANVFlatMap* map, const size_t hash)
+{
+    return flat_find_free(map->ctrl, map->capacity, hash);
+}
+
+static size_t table_bytes(const size_t capacity)
+{
+    return flat_table_bytes(capacity, sizeof(ANVFlatMapSlot));
+}
+
+/**
+ * Allocate an empty table of the given capacity into map.
+ */
+static int allocate_table(ANVFlatMap* map, const size_t capacity)
+{
+    ANVFlatMapSlot* slots = flat_allocate(map->alloc, capacity, sizeof(ANVFlatMapSlot),
+                                          &map->ctrl, &map->growth_left);
+    if (!slots)
+    {
+        return -1;
+    }
+
+    map->slots = slots;
+    map->capacity = capacity;
+    return 0;
+}
+
+/**
+ * Rebuild the table, doubling it unless most of the used slots are tombstones.
+ */
+static int rehash(ANVFlatMap* map)
+{
+    size_t new_capacity = map->capacity;
+    if (map->size * 2 >= group_max_load(map->capacity))
+    {
+        new_capacity = map->capacity * 2;
+        if (new_capacity < map->capacity || new_capacity > SIZE_MAX / (sizeof(ANVFlatMapSlot) + 1))
+        {
+            return -1;
+        }
+    }
+
+    ANVFlatMapSlot* old_slots = map->slots;
+    const int8_t* old_ctrl = map->ctrl;
+    const size_t old_capacity = map->capacity;
+
+    if (allocate_table(map, new_capacity) != 0)
+    {
+        return -1;
+    }
+
+    for (size_t i = 0; i < old_capacity; i++)
+    {
+        if (old_ctrl[i] >= 0)
+        {
+            const size_t hash = hash_key(map, old_slots[i].key);
+            const size_t index = find_free_slot(map, hash);
+            map->ctrl[index] = hash_tag(hash);
+            map->slots[index] = old_slots[i];
+        }
+    }
+    map->growth_left -= map->size;
+
+    anv_alloc_free_sized(map->alloc, old_slots, table_bytes(old_capacity));
+    return 0;
+}
+
+/**
+ * Shared insert path for put and put_replace.
+ */
+static int insert(ANVFlatMap* map, void* key, void* value, void** old_value_out)
+{
+    const size_t hash = hash_key(map, key);
+
+    const size_t existing = find_slot(map, key, hash);
+    if (existing != NOT_FOUND)
+    {
+        if (old_value_out)
+        {
+            *old_value_out = map->slots[existing].value;
+        }
+        map->slots[existing].value = value;
+        return 0;
+    }
+
+    size_t index = find_free_slot(map, hash);
+    if (map->ctrl[index] == CTRL_EMPTY && map->growth_left == 0)
+    {
+        if (rehash(map) != 0)
+        {
+            return -1;
+        }
+        index = find_free_slot(map, hash);
+    }
+
+    if (map->ctrl[index] == CTRL_EMPTY)
+    {
+        map->growth_left--;
+    }
+    map->ctrl[index] = hash_tag(hash);
+    map->slots[index].key = key;
+    map->slots[index].value = value;
+    map->size++;
+    return 0;
+}
+
+static void erase_slot(ANVFlatMap* map, const size_t index)
+{
+    flat_erase(map->ctrl, index, &map->growth_left);
+    map->size--;
+}
+
+//==============================================================================
+// Creation and destruction functions
+//==============================================================================
+
+ANV_API ANVFlatMap* anv_flatmap_create(ANVAllocator* alloc, const hash_func hash,
+                                       const key_equals_func key_equals, const size_t initial_capacity)
+{
+    if (!alloc || !hash || !key_equals)
+    {
+        return NULL;
+    }
+
+    // Smallest power-of-two table that holds initial_capacity elements under the load limit
+    size_t capacity = DEFAULT_INITIAL_CAPACITY;
+    while (group_max_load(capacity) < initial_capacity)
+    {
+        if (capacity > SIZE_MAX / 2 / (sizeof(ANVFlatMapSlot) + 1))
+        {
+            return NULL;
+        }
+        capacity *= 2;
+    }
+
+    ANVFlatMap* map = anv_alloc_malloc(alloc, sizeof(ANVFlatMap));
+    if (!map)
+    {
+        return NULL;
+    }
+
+    map->size = 0;
+    map->hash = hash;
+    map->key_equals = key_equals;
+    map->alloc = alloc;
+
+    if (allocate_table(map, capacity) != 0)
+    {
+        anv_alloc_free_sized(alloc, map, sizeof(ANVFlatMap));
+        return NULL;
+    }
+
+    return map;
+}
+
+ANV_API void anv_flatmap_destroy(ANVFlatMap* map, const bool should_free_keys, const bool should_free_values)
+{
+    if (!map)
+    {
+        return;
+    }
+
+    anv_flatmap_clear(map, should_free_keys, should_free_values);
+
+    anv_alloc_free_sized(map->alloc, map->slots, table_bytes(map->capacity));
+    anv_alloc_free_sized(map->alloc, map, sizeof(ANVFlatMap));
+}
+
+ANV_API void anv_flatmap_clear(ANVFlatMap* map, const bool should_free_keys, const bool should_free_values)
+{
+    if (!map || !map->slots)
+    {
+        return;
+    }
+
+    if (should_free_keys || should_free_values)
+    {
+        for (size_t i = 0; i < map->capacity; i++)
+        {
+            if (map->ctrl[i] < 0)
+            {
+                continue;
+            }
+
+            if (should_free_keys && map->slots[i].key)
+            {
+                anv_alloc_data_free(map->alloc, map->slots[i].key);
+            }
+            if (should_free_values && map->slots[i].value)
+            {
+                anv_alloc_data_free(map->alloc, map->slots[i].value);
+            }
+        }
+    }
+
+    memset(map->ctrl, CTRL_EMPTY, map->capacity);
+    map->size = 0;
+    map->growth_left = group_max_load(map->capacity);
+}
+
+//==============================================================================
+// Information functions
+//==============================================================================
+
+ANV_API size_t anv_flatmap_size(const ANVFlatMap* map)
+{
+    return map ? map->size : 0;
+}
+
+ANV_API int anv_flatmap_is_empty(const ANVFlatMap* map)
+{
+    return !map || map->size == 0;
+}
+
+ANV_API size_t anv_flatmap_capacity(const ANVFlatMap* map)
+{
+    return map ? map->capacity : 0;
+}
+
+ANV_API double anv_flatmap_load_factor(const ANVFlatMap* map)
+{
+    if (!map || map->capacity == 0)
+    {
+        return 0.0;
+    }
+    return (double)map->size / (double)map->capacity;
+}
+
+ANV_API size_t anv_flatmap_memory_usage(const ANVFlatMap* map)
+{
+    if (!map)
+    {
+        return 0;
+    }
+
+    return sizeof(ANVFlatMap) + table_bytes(map->capacity);
+}
+
+ANV_API int anv_flatmap_contains_key(const ANVFlatMap* map, const void* key)
+{
+    if (!map || !key)
+    {
+        return 0;
+    }
+
+    return find_slot(map, key, hash_key(map, key)) != NOT_FOUND;
+}
+
+//==============================================================================
+// Flat map operations
+//==============================================================================
+
+ANV_API int anv_flatmap_put(ANVFlatMap* map, void* key, void* value)
+{
+    if (!map || !key)
+    {
+        return -1;
+    }
+
+    return insert(map, key, value, NULL);
+}
+
+ANV_API int anv_flatmap_put_replace(ANVFlatMap* map, void* key, void* value, void** old_value_out)
+{
+    if (!map || !key || !old_value_out)
+    {
+        return -1;
+    }
+
+    *old_value_out = NULL;
+    return insert(map, key, value, old_value_out);
+}
+
+ANV_API void* anv_flatmap_get(const ANVFlatMap* map, const void* key)
+{
+    if (!map || !key)
+    {
+        return NULL;
+    }
+
+    const size_t index = find_slot(map, key, hash_key(map, key));
+    return index != NOT_FOUND ? map->slots[index].value : NULL;
+}
+
+ANV_API int anv_flatmap_remove(ANVFlatMap* map, const void* key,
+                               const bool should_free_key, const bool should_free_value)
+{
+    if (!map || !key)
+    {
+        return -1;
+    }
+
+    const size_t index = find_slot(map, key, hash_key(map, key));
+    if (index == NOT_FOUND)
+    {
+        return -1; // Key not found
+    }
+
+    ANVFlatMapSlot slot = map->slots[index];
+    erase_slot(map, index);
+
+    if (should_free_key && slot.key)
+    {
+        anv_alloc_data_free(map->alloc, slot.key);
+    }
+    if (should_free_value && slot.value)
+    {
+        anv_alloc_data_free(map->alloc, slot.value);
+    }
+    return 0;
+}
+
+ANV_API void* anv_flatmap_remove_get(ANVFlatMap* map, const void* key, const bool should_free_key)
+{
+    if (!map || !key)
+    {
+        return NULL;
+    }
+
+    const size_t index = find_slot(map, key, hash_key(map, key));
+    if (index == NOT_FOUND)
+    {
+        return NULL; // Key not found
+    }
+
+    ANVFlatMapSlot slot = map->slots[index];
+    erase_slot(map, index);
+
+    if (should_free_key && slot.key)
+    {
+        anv_alloc_data_free(map->alloc, slot.key);
+    }
+    return slot.value;
+}
+
+ANV_API void anv_flatmap_for_each(const ANVFlatMap* map, void (*action)(void* key, void* value))
+{
+    if (!map || !action)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < map->capacity; i++)
+    {
+        if (map->ctrl[i] >= 0)
+        {
+            action(map->slots[i].key, map->slots[i].value);
+        }
+    }
+}
+
+//==============================================================================
+// Iterator implementation
+//==============================================================================
+
+typedef struct FlatMapIteratorState
+{
+    const ANVFlatMap* map;
+    size_t index; // Current full slot, or capacity when exhausted
+    ANVPair current_pair;
+} FlatMapIteratorState;
+
+static size_t next_full_slot(const ANVFlatMap* map, const size_t start)
+{
+    return flat_next_full(map->ctrl, map->capacity, start);
+}
+
+static void* flatmap_iterator_get(const ANVIterator* it)
+{
+    FlatMapIteratorState* state = it->data_state;
+    if (state->index >= state->map->capacity)
+    {
+        return NULL;
+    }
+
+    state->current_pair = (ANVPair) {
+        .first = state->map->slots[state->index].key,
+        .second = state->map->slots[state->index].value,
+        .alloc = state->map->alloc
+    };
+
+    return &state->current_pair;
+}
+
+static int flatmap_iterator_has_next(const ANVIterator* it)
+{
+    if (!it || !it->data_state)
+    {
+        return 0;
+    }
+
+    const FlatMapIteratorState* state = it->data_state;
+    return state->index < state->map->capacity;
+}
+
+static int flatmap_iterator_next(const ANVIterator* it)
+{
+    if (!it || !it->data_state)
+    {
+        return -1;
+    }
+
+    FlatMapIteratorState* state = it->data_state;
+    if (state->index >= state->map->capacity)
+    {
+        return -1;
+    }
+
+    state->index = next_full_slot(state->map, state->index + 1);
+    return 0;
+}
+
+static int flatmap_iterator_has_prev(const ANVIterator* it)
+{
+    (void)it;
+    return 0; // Flat map iterator doesn't support backward iteration
+}
+
+static int flatmap_iterator_prev(const ANVIterator* it)
+{
+    (void)it;
+    return -1; // Flat map iterator doesn't support backward iteration
+}
+
+static void flatmap_iterator_reset(const ANVIterator* it)
+{
+    if (!it || !it->data_state)
+    {
+        return;
+    }
+
+    FlatMapIteratorState* state = it->data_state;
+    state->index = next_full_slot(state->map, 0);
+}
+
+static int flatmap_iterator_is_valid(const ANVIterator* it)
+{
+    return it && it->data_state != NULL;
+}
+
+static void flatmap_iterator_destroy(ANVIterator* it)
+{
+    if (!it || !it->data_state)
+    {
+        return;
+    }
+
+    FlatMapIteratorState* state = it->data_state;
+    if (state->map)
+    {
+        anv_alloc_free_sized(state->map->alloc, state, sizeof(FlatMapIteratorState));
+    }
+    it->data_state = NULL;
+}
+
+ANV_API ANVIterator anv_flatmap_iterator(const ANVFlatMap* map)
+{
+    ANVIterator it = {0};
+
+    it.get = flatmap_iterator_get;
+    it.has_next = flatmap_iterator_has_next;
+    it.next = flatmap_iterator_next;
+    it.has_prev = flatmap_iterator_has_prev;
+    it.prev = flatmap_iterator_prev;
+    it.reset = flatmap_iterator_reset;
+    it.is_valid = flatmap_iterator_is_valid;
+    it.destroy = flatmap_iterator_destroy;
+
+    if (!map || !map->alloc)
+    {
+        return it;
+    }
+
+    FlatMapIteratorState* state = anv_alloc_malloc(map->alloc, sizeof(FlatMapIteratorState));
+    if (!state)
+    {
+        return it;
+    }
+
+    state->map = map;
+    state->index = next_full_slot(map, 0);
+
+    it.alloc = map->alloc;
+    it.data_state = state;
+    return it;
+}
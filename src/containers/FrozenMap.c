@@ -0,0 +1,743 @@
+//
+// FrozenMap.c
+// Implementation of the frozen perfect-hash map.
+//
+// Both hashes are derived from the one hash code the user's hash function
+// returns: the bucket from a mix of the code and the build salt, and the slot
+// from a mix of the code, the salt and the bucket's seed. Buckets are placed
+// largest first while most slots are still free. A bucket's seed is the
+// first one that sends all its keys to distinct free slots; single-key
+// buckets, placed last, take the remaining slots directly. If some bucket
+// finds no seed the build starts over with a new salt.
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "FrozenMap.h"
+#include "Pair.h"
+
+//==============================================================================
+// Private constants
+//==============================================================================
+
+#define DIRECT_SLOT 0x80000000u // Seed flag: the low bits are the slot itself
+#define KEYS_PER_BUCKET 4       // Average bucket size
+#define MAX_BUCKET_SIZE 64      // Larger buckets mean a bad salt, so start over
+#define MAX_SEED_TRIES (1u << 20)
+#define MAX_ATTEMPTS 8
+
+//==============================================================================
+// Static helper functions
+//==============================================================================
+
+/**
+ * SplitMix64 finalizer.
+ */
+static uint64_t mix(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBULL;
+    x ^= x >> 31;
+    return x;
+}
+
+/**
+ * Map a 64-bit hash onto [0, n) with a multiply instead of a division.
+ * Requires n < 2^32.
+ */
+static size_t reduce(const uint64_t x, const size_t n)
+{
+    return (size_t)(((x >> 32) * (uint64_t)n) >> 32);
+}
+
+static size_t bucket_of(const uint64_t salt, const size_t hash, const size_t bucket_count)
+{
+    return reduce(mix((uint64_t)hash ^ salt), bucket_count);
+}
+
+static size_t slot_of(const uint64_t salt, const size_t hash, const uint32_t seed, const size_t size)
+{
+    return reduce(mix((uint64_t)hash + salt + ((uint64_t)seed + 1) * 0x9E3779B97F4A7C15ULL), size);
+}
+
+/**
+ * Find the entry holding key, or NULL.
+ */
+static const ANVFrozenMapEntry* find_entry(const ANVFrozenMap* map, const void* key)
+{
+    if (map->size == 0)
+    {
+        return NULL;
+    }
+
+    const size_t hash = map->hash(key);
+    const uint32_t seed = map->seeds[bucket_of(map->salt, hash, map->bucket_count)];
+    const size_t slot = seed & DIRECT_SLOT ? seed & ~DIRECT_SLOT : slot_of(map->salt, hash, seed, map->size);
+
+    const ANVFrozenMapEntry* entry = &map->entries[slot];
+    return entry->hash == hash && map->key_equals(entry->key, key) ? entry : NULL;
+}
+
+static void free_items(ANVAllocator* alloc, ANVFrozenMapEntry* items, const size_t count,
+                       const bool should_free_data)
+{
+    if (should_free_data)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            anv_alloc_data_free(alloc, items[i].key);
+            anv_alloc_data_free(alloc, items[i].value);
+        }
+    }
+}
+
+/**
+ * Read every pair from the iterator into a growing array. On failure the
+ * pairs read so far stay in *items_out for the caller to release.
+ */
+static int collect_items(ANVIterator* it, ANVAllocator* alloc, const hash_func hash, const bool should_copy,
+                         ANVFrozenMapEntry** items_out, size_t* count_out, size_t* capacity_out)
+{
+    while (it->has_next(it))
+    {
+        ANVPair* pair = it->get(it);
+
+        if (!pair)
+        {
+            if (it->next(it) != 0)
+            {
+                break;
+            }
+            continue;
+        }
+
+        if (!anv_pair_first(pair) || *count_out == ANV_FROZENMAP_MAX_SIZE)
+        {
+            return -1;
+        }
+
+        if (*count_out == *capacity_out)
+        {
+            const size_t new_capacity = *capacity_out ? *capacity_out * 2 : 16;
+            ANVFrozenMapEntry* grown = anv_alloc_realloc(alloc, *items_out,
+                                                         *capacity_out * sizeof(ANVFrozenMapEntry),
+                                                         new_capacity * sizeof(ANVFrozenMapEntry));
+            if (!grown)
+            {
+                return -1;
+            }
+            *items_out = grown;
+            *capacity_out = new_capacity;
+        }
+
+        ANVFrozenMapEntry* item = &(*items_out)[*count_out];
+        if (should_copy)
+        {
+            // Use allocator's copy function on the pair
+            ANVPair* copied_pair = alloc->copy(pair);
+            if (!copied_pair)
+            {
+                return -1;
+            }
+
+            item->key = anv_pair_first(copied_pair);
+            item->value = anv_pair_second(copied_pair);
+
+            // Free the pair structure but not the data (we're transferring ownership)
+            anv_pair_destroy(copied_pair, false, false);
+        }
+        else
+        {
+            item->key = anv_pair_first(pair);
+            item->value = anv_pair_second(pair);
+        }
+        item->hash = hash(item->key);
+        (*count_out)++;
+
+        if (it->next(it) != 0)
+        {
+            break;
+        }
+    }
+
+    return 0;
+}
+
+typedef struct HashOrder
+{
+    size_t hash;
+    size_t index;
+} HashOrder;
+
+static int compare_hash_order(const void* a, const void* b)
+{
+    const HashOrder* x = a;
+    const HashOrder* y = b;
+    if (x->hash != y->hash)
+    {
+        return x->hash < y->hash ? -1 : 1;
+    }
+    return x->index < y->index ? -1 : x->index > y->index;
+}
+
+/**
+ * Fold repeated keys into their first occurrence, which takes the value of
+ * the last one, and squeeze the repeats out of the array. Fails if two
+ * different keys share a hash code.
+ */
+static int merge_duplicates(ANVAllocator* alloc, const key_equals_func key_equals, ANVFrozenMapEntry* items,
+                            size_t* count, const bool should_copy)
+{
+    HashOrder* order = anv_alloc_malloc(alloc, *count * sizeof(HashOrder));
+    if (!order)
+    {
+        return -1;
+    }
+
+    for (size_t i = 0; i < *count; i++)
+    {
+        order[i] = (HashOrder) {items[i].hash, i};
+    }
+    qsort(order, *count, sizeof(HashOrder), compare_hash_order);
+
+    int result = 0;
+    size_t group = 0;
+    for (size_t i = 1; i < *count && result == 0; i++)
+    {
+        if (order[i].hash != order[group].hash)
+        {
+            group = i;
+            continue;
+        }
+
+        // Equal hash codes must come from equal keys, i.e. the group's first one
+        ANVFrozenMapEntry* first = &items[order[group].index];
+        ANVFrozenMapEntry* repeat = &items[order[i].index];
+        if (!key_equals(first->key, repeat->key))
+        {
+            result = -1;
+            continue;
+        }
+
+        if (should_copy)
+        {
+            anv_alloc_data_free(alloc, first->value);
+            anv_alloc_data_free(alloc, repeat->key);
+        }
+        first->value = repeat->value;
+        repeat->key = NULL;
+    }
+    anv_alloc_free_sized(alloc, order, *count * sizeof(HashOrder));
+
+    size_t kept = 0;
+    for (size_t i = 0; i < *count; i++)
+    {
+        if (items[i].key)
+        {
+            items[kept++] = items[i];
+        }
+    }
+    *count = kept;
+    return result;
+}
+
+typedef struct BucketSize
+{
+    uint32_t size;
+    uint32_t bucket;
+} BucketSize;
+
+static int compare_bucket_size(const void* a, const void* b)
+{
+    const BucketSize* x = a;
+    const BucketSize* y = b;
+    if (x->size != y->size)
+    {
+        return x->size > y->size ? -1 : 1;
+    }
+    return x->bucket < y->bucket ? -1 : x->bucket > y->bucket;
+}
+
+/**
+ * Scratch space for one placement attempt.
+ */
+typedef struct PlacementScratch
+{
+    size_t* bucket_start; // bucket_count + 1 offsets into members
+    uint32_t* members;    // Item indices grouped by bucket
+    BucketSize* by_size;  // Buckets, largest first
+    uint8_t* taken;       // Slots already assigned
+} PlacementScratch;
+
+/**
+ * Try to give every item its own slot under map->salt, filling map->seeds
+ * and slot_out. Returns -1 if some bucket finds no seed.
+ */
+static int place_items(ANVFrozenMap* map, const ANVFrozenMapEntry* items, const PlacementScratch* scratch,
+                       uint32_t* slot_out)
+{
+    const size_t n = map->size;
+    const size_t bucket_count = map->bucket_count;
+    size_t* start = scratch->bucket_start;
+
+    // Counting sort of the items by bucket
+    memset(start, 0, (bucket_count + 1) * sizeof(size_t));
+    for (size_t i = 0; i < n; i++)
+    {
+        start[bucket_of(map->salt, items[i].hash, bucket_count) + 1]++;
+    }
+    for (size_t b = 0; b < bucket_count; b++)
+    {
+        if (start[b + 1] > MAX_BUCKET_SIZE)
+        {
+            return -1;
+        }
+        scratch->by_size[b] = (BucketSize) {(uint32_t)start[b + 1], (uint32_t)b};
+        start[b + 1] += start[b];
+    }
+    for (size_t i = 0; i < n; i++)
+    {
+        scratch->members[start[bucket_of(map->salt, items[i].hash, bucket_count)]++] = (uint32_t)i;
+    }
+    for (size_t b = bucket_count; b > 0; b--)
+    {
+        start[b] = start[b - 1];
+    }
+    start[0] = 0;
+
+    qsort(scratch->by_size, bucket_count, sizeof(BucketSize), compare_bucket_size);
+    memset(scratch->taken, 0, n);
+
+    size_t next_free = 0;
+    for (size_t i = 0; i < bucket_count; i++)
+    {
+        const uint32_t bucket = scratch->by_size[i].bucket;
+        const uint32_t size = scratch->by_size[i].size;
+        const uint32_t* members = &scratch->members[start[bucket]];
+
+        if (size == 0)
+        {
+            map->seeds[bucket] = 0;
+            continue;
+        }
+
+        if (size == 1)
+        {
+            while (scratch->taken[next_free])
+            {
+                next_free++;
+            }
+            scratch->taken[next_free] = 1;
+            slot_out[members[0]] = (uint32_t)next_free;
+            map->seeds[bucket] = DIRECT_SLOT | (uint32_t)next_free;
+            continue;
+        }
+
+        uint32_t slots[MAX_BUCKET_SIZE];
+        uint32_t seed = 0;
+        uint32_t placed = 0;
+        while (placed < size && seed < MAX_SEED_TRIES)
+        {
+            for (placed = 0; placed < size; placed++)
+            {
+                const uint32_t slot = (uint32_t)slot_of(map->salt, items[members[placed]].hash, seed, n);
+                if (scratch->taken[slot])
+                {
+                    break;
+                }
+
+                uint32_t k = 0;
+                while (k < placed && slots[k] != slot)
+                {
+                    k++;
+                }
+                if (k < placed)
+                {
+                    break;
+                }
+                slots[placed] = slot;
+            }
+
+            if (placed < size)
+            {
+                seed++;
+            }
+        }
+
+        if (placed < size)
+        {
+            return -1;
+        }
+
+        for (uint32_t k = 0; k < size; k++)
+        {
+            scratch->taken[slots[k]] = 1;
+            slot_out[members[k]] = slots[k];
+        }
+        map->seeds[bucket] = seed;
+    }
+
+    return 0;
+}
+
+/**
+ * Build the seeds and the slot of every item, trying new salts as needed.
+ */
+static int build_index(ANVFrozenMap* map, const ANVFrozenMapEntry* items, uint32_t* slot_out)
+{
+    ANVAllocator* alloc = map->alloc;
+    const size_t n = map->size;
+    const size_t bucket_count = map->bucket_count;
+
+    PlacementScratch scratch;
+    scratch.bucket_start = anv_alloc_malloc(alloc, (bucket_count + 1) * sizeof(size_t));
+    scratch.members = anv_alloc_malloc(alloc, n * sizeof(uint32_t));
+    scratch.by_size = anv_alloc_malloc(alloc, bucket_count * sizeof(BucketSize));
+    scratch.taken = anv_alloc_malloc(alloc, n);
+
+    int result = -1;
+    if (scratch.bucket_start && scratch.members && scratch.by_size && scratch.taken)
+    {
+        for (uint64_t attempt = 0; attempt < MAX_ATTEMPTS && result != 0; attempt++)
+        {
+            map->salt = mix(attempt + 1);
+            result = place_items(map, items, &scratch, slot_out);
+        }
+    }
+
+    anv_alloc_free_sized(alloc, scratch.bucket_start, (bucket_count + 1) * sizeof(size_t));
+    anv_alloc_free_sized(alloc, scratch.members, n * sizeof(uint32_t));
+    anv_alloc_free_sized(alloc, scratch.by_size, bucket_count * sizeof(BucketSize));
+    anv_alloc_free_sized(alloc, scratch.taken, n);
+    return result;
+}
+
+/**
+ * Allocate the map's arrays for the given items and move each item to its
+ * slot. Leaves the items array untouched on failure.
+ */
+static int freeze_items(ANVFrozenMap* map, const ANVFrozenMapEntry* items)
+{
+    const size_t n = map->size;
+    if (n == 0)
+    {
+        return 0;
+    }
+
+    map->bucket_count = (n + KEYS_PER_BUCKET - 1) / KEYS_PER_BUCKET;
+    map->seeds = anv_alloc_malloc(map->alloc, map->bucket_count * sizeof(uint32_t));
+    map->entries = anv_alloc_malloc(map->alloc, n * sizeof(ANVFrozenMapEntry));
+    uint32_t* slots = anv_alloc_malloc(map->alloc, n * sizeof(uint32_t));
+
+    int result = -1;
+    if (map->seeds && map->entries && slots && build_index(map, items, slots) == 0)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            map->entries[slots[i]] = items[i];
+        }
+        result = 0;
+    }
+
+    anv_alloc_free_sized(map->alloc, slots, n * sizeof(uint32_t));
+    return result;
+}
+
+//==============================================================================
+// Creation and destruction functions
+//==============================================================================
+
+ANV_API ANVFrozenMap* anv_frozenmap_from_iterator(ANVIterator* it, ANVAllocator* alloc,
+                                                  const hash_func hash, const key_equals_func key_equals,
+                                                  const bool should_copy)
+{
+    if (!it || !alloc || !hash || !key_equals)
+    {
+        return NULL;
+    }
+
+    if (should_copy && !alloc->copy)
+    {
+        return NULL; // Can't copy without copy function
+    }
+
+    if (!it->is_valid || !it->is_valid(it))
+    {
+        return NULL;
+    }
+
+    ANVFrozenMap* map = anv_alloc_malloc(alloc, sizeof(ANVFrozenMap));
+    if (!map)
+    {
+        return NULL;
+    }
+    memset(map, 0, sizeof(ANVFrozenMap));
+    map->hash = hash;
+    map->key_equals = key_equals;
+    map->alloc = alloc;
+
+    ANVFrozenMapEntry* items = NULL;
+    size_t count = 0;
+    size_t capacity = 0;
+    int result = collect_items(it, alloc, hash, should_copy, &items, &count, &capacity);
+    if (result == 0 && count > 0)
+    {
+        result = merge_duplicates(alloc, key_equals, items, &count, should_copy);
+    }
+    if (result == 0)
+    {
+        map->size = count;
+        result = freeze_items(map, items);
+    }
+
+    if (result != 0)
+    {
+        free_items(alloc, items, count, should_copy);
+    }
+    anv_alloc_free_sized(alloc, items, capacity * sizeof(ANVFrozenMapEntry));
+
+    if (result != 0)
+    {
+        anv_frozenmap_destroy(map, false, false);
+        return NULL;
+    }
+    return map;
+}
+
+ANV_API void anv_frozenmap_destroy(ANVFrozenMap* map, const bool should_free_keys, const bool should_free_values)
+{
+    if (!map)
+    {
+        return;
+    }
+
+    if (map->entries && (should_free_keys || should_free_values))
+    {
+        for (size_t i = 0; i < map->size; i++)
+        {
+            if (should_free_keys)
+            {
+                anv_alloc_data_free(map->alloc, map->entries[i].key);
+            }
+            if (should_free_values && map->entries[i].value)
+            {
+                anv_alloc_data_free(map->alloc, map->entries[i].value);
+            }
+        }
+    }
+
+    anv_alloc_free_sized(map->alloc, map->entries, map->size * sizeof(ANVFrozenMapEntry));
+    anv_alloc_free_sized(map->alloc, map->seeds, map->bucket_count * sizeof(uint32_t));
+    anv_alloc_free_sized(map->alloc, map, sizeof(ANVFrozenMap));
+}
+
+//==============================================================================
+// Information functions
+//==============================================================================
+
+ANV_API size_t anv_frozenmap_size(const ANVFrozenMap* map)
+{
+    return map ? map->size : 0;
+}
+
+ANV_API int anv_frozenmap_is_empty(const ANVFrozenMap* map)
+{
+    return !map || map->size == 0;
+}
+
+ANV_API size_t anv_frozenmap_memory_usage(const ANVFrozenMap* map)
+{
+    if (!map)
+    {
+        return 0;
+    }
+
+    return sizeof(ANVFrozenMap) + map->size * sizeof(ANVFrozenMapEntry) + map->bucket_count * sizeof(uint32_t);
+}
+
+ANV_API int anv_frozenmap_contains_key(const ANVFrozenMap* map, const void* key)
+{
+    if (!map || !key)
+    {
+        return 0;
+    }
+
+    return find_entry(map, key) != NULL;
+}
+
+//==============================================================================
+// Frozen map operations
+//==============================================================================
+
+ANV_API void* anv_frozenmap_get(const ANVFrozenMap* map, const void* key)
+{
+    if (!map || !key)
+    {
+        return NULL;
+    }
+
+    const ANVFrozenMapEntry* entry = find_entry(map, key);
+    return entry ? entry->value : NULL;
+}
+
+ANV_API void anv_frozenmap_for_each(const ANVFrozenMap* map, void (*action)(void* key, void* value))
+{
+    if (!map || !action)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < map->size; i++)
+    {
+        action(map->entries[i].key, map->entries[i].value);
+    }
+}
+
+//==============================================================================
+// Iterator implementation
+//==============================================================================
+
+typedef struct FrozenMapIteratorState
+{
+    const ANVFrozenMap* map;
+    size_t index; // Current entry, or size when exhausted
+    ANVPair current_pair;
+} FrozenMapIteratorState;
+
+static void* frozenmap_iterator_get(const ANVIterator* it)
+{
+    FrozenMapIteratorState* state = it->data_state;
+    if (state->index >= state->map->size)
+    {
+        return NULL;
+    }
+
+    state->current_pair = (ANVPair) {
+        .first = state->map->entries[state->index].key,
+        .second = state->map->entries[state->index].value,
+        .alloc = state->map->alloc
+    };
+
+    return &state->current_pair;
+}
+
+static int frozenmap_iterator_has_next(const ANVIterator* it)
+{
+    if (!it || !it->data_state)
+    {
+        return 0;
+    }
+
+    const FrozenMapIteratorState* state = it->data_state;
+    return state->index < state->map->size;
+}
+
+static int frozenmap_iterator_next(const ANVIterator* it)
+{
+    if (!it || !it->data_state)
+    {
+        return -1;
+    }
+
+    FrozenMapIteratorState* state = it->data_state;
+    if (state->index >= state->map->size)
+    {
+        return -1;
+    }
+
+    state->index++;
+    return 0;
+}
+
+static int frozenmap_iterator_has_prev(const ANVIterator* it)
+{
+    if (!it || !it->data_state)
+    {
+        return 0;
+    }
+
+    const FrozenMapIteratorState* state = it->data_state;
+    return state->index > 0 && state->map->size > 0;
+}
+
+static int frozenmap_iterator_prev(const ANVIterator* it)
+{
+    if (!it || !it->data_state)
+    {
+        return -1;
+    }
+
+    FrozenMapIteratorState* state = it->data_state;
+    if (state->index == 0 || state->map->size == 0)
+    {
+        return -1;
+    }
+
+    state->index--;
+    return 0;
+}
+
+static void frozenmap_iterator_reset(const ANVIterator* it)
+{
+    if (!it || !it->data_state)
+    {
+        return;
+    }
+
+    FrozenMapIteratorState* state = it->data_state;
+    state->index = 0;
+}
+
+static int frozenmap_iterator_is_valid(const ANVIterator* it)
+{
+    return it && it->data_state != NULL;
+}
+
+static void frozenmap_iterator_destroy(ANVIterator* it)
+{
+    if (!it || !it->data_state)
+    {
+        return;
+    }
+
+    FrozenMapIteratorState* state = it->data_state;
+    if (state->map)
+    {
+        anv_alloc_free_sized(state->map->alloc, state, sizeof(FrozenMapIteratorState));
+    }
+    it->data_state = NULL;
+}
+
+ANV_API ANVIterator anv_frozenmap_iterator(const ANVFrozenMap* map)
+{
+    ANVIterator it = {0};
+
+    it.get = frozenmap_iterator_get;
+    it.has_next = frozenmap_iterator_has_next;
+    it.next = frozenmap_iterator_next;
+    it.has_prev = frozenmap_iterator_has_prev;
+    it.prev = frozenmap_iterator_prev;
+    it.reset = frozenmap_iterator_reset;
+    it.is_valid = frozenmap_iterator_is_valid;
+    it.destroy = frozenmap_iterator_destroy;
+
+    if (!map || !map->alloc)
+    {
+        return it;
+    }
+
+    FrozenMapIteratorState* state = anv_alloc_malloc(map->alloc, sizeof(FrozenMapIteratorState));
+    if (!state)
+    {
+        return it;
+    }
+
+    state->map = map;
+    state->index = 0;
+
+    it.alloc = map->alloc;
+    it.data_state = state;
+    return it;
+}
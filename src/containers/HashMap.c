@@ -6,8 +6,10 @@
 // Supports custom allocators, hash functions, and key equality functions.
 // Provides average O(1) operations with automatic resizing.
 
+#include <stdatomic.h>
 #include <stdint.h>
 #include <string.h>
+#include <time.h>
 
 #include "HashMap.h"
 #include "Pair.h"
@@ -19,6 +21,16 @@
 #define DEFAULT_INITIAL_CAPACITY 16
 #define DEFAULT_MAX_LOAD_FACTOR 0.75
 
+// Keys hashed and prefetched together by the batched operations; enough
+// independent misses to keep the memory system busy
+#define BATCH_SIZE 16
+
+#if defined(__GNUC__) || defined(__clang__)
+#define PREFETCH(addr) __builtin_prefetch(addr)
+#else
+#define PREFETCH(addr) ((void)(addr))
+#endif
+
 //==============================================================================
 // Static helper functions
 //==============================================================================
@@ -26,7 +38,7 @@
 /**
  * Create a new hash map node.
  */
-static ANVHashMapNode* create_node(const ANVHashMap* map, void* key, void* value)
+static ANVHashMapNode* create_node(const ANVHashMap* map, void* key, void* value, const size_t hash)
 {
     if (!map->alloc)
     {
@@ -41,6 +53,7 @@ static ANVHashMapNode* create_node(const ANVHashMap* map, void* key, void* value
 
     node->key = key;
     node->value = value;
+    node->hash = hash;
     node->next = NULL;
     return node;
 }
@@ -66,23 +79,217 @@ static void free_node(const ANVHashMap* map, ANVHashMapNode* node,
         anv_alloc_data_free(map->alloc, node->value);
     }
 
-    anv_alloc_free(map->alloc, node);
+    anv_alloc_free_sized(map->alloc, node, sizeof(ANVHashMapNode));
+}
+
+/**
+ * Finalizer mix (MurmurHash3 fmix) so that masking keeps well distributed
+ * bits even for weak hashes such as identity or pointer hashes.
+ */
+static size_t mix_hash(size_t hash)
+{
+#if SIZE_MAX > 0xFFFFFFFFu
+    hash ^= hash >> 33;
+    hash *= (size_t)0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+#else
+    hash ^= hash >> 16;
+    hash *= (size_t)0x85ebca6bu;
+    hash ^= hash >> 13;
+#endif
+    return hash;
+}
+
+/**
+ * Bucket index for a full hash code in a table of bucket_count buckets.
+ * In power-of-two mode this is a mix and a mask; either way a doubled
+ * table maps bucket k onto buckets k and k + bucket_count.
+ */
+static size_t index_for_count(const ANVHashMap* map, const size_t hash, const size_t bucket_count)
+{
+    if (map->power_of_two)
+    {
+        return mix_hash(hash) & (bucket_count - 1);
+    }
+    return hash % bucket_count;
 }
 
 /**
- * Get bucket index for a key.
+ * Get bucket index for a full hash code.
  */
-static size_t get_bucket_index(const ANVHashMap* map, const void* key)
+static size_t get_bucket_index(const ANVHashMap* map, const size_t hash)
 {
-    if (!map->hash || map->bucket_count == 0)
+    if (map->bucket_count == 0)
     {
         return 0;
     }
-    return map->hash(key) % map->bucket_count;
+    return index_for_count(map, hash, map->bucket_count);
+}
+
+/**
+ * Smallest power of two >= n (n > 0), or 0 on overflow.
+ */
+static size_t next_power_of_two(const size_t n)
+{
+    size_t power = 1;
+    while (power < n)
+    {
+        if (power > SIZE_MAX / 2)
+        {
+            return 0;
+        }
+        power <<= 1;
+    }
+    return power;
+}
+
+/**
+ * Wall-clock time in nanoseconds, for the rehash timer.
+ */
+static uint64_t now_nanos(void)
+{
+    struct timespec ts = {0};
+    timespec_get(&ts, TIME_UTC);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * Check whether a node holds key, comparing cached hash codes first.
+ */
+static bool node_matches(const ANVHashMap* map, const ANVHashMapNode* node, const void* key, const size_t hash)
+{
+    return node->hash == hash && map->key_equals(node->key, key);
+}
+
+/**
+ * Number of buckets across the current array and, during an incremental
+ * resize, the array still being migrated.
+ */
+static size_t total_buckets(const ANVHashMap* map)
+{
+    return map->bucket_count + (map->old_buckets ? map->old_bucket_count : 0);
+}
+
+/**
+ * Check whether old bucket index has not been migrated yet.
+ */
+static bool is_unmigrated(const ANVHashMap* map, const size_t old_index)
+{
+    return map->old_buckets && old_index >= map->migrate_index;
+}
+
+/**
+ * Head of bucket i in the combined index space of total_buckets(). New
+ * buckets whose old bucket has not been migrated are still uninitialized
+ * and read as empty.
+ */
+static ANVHashMapNode* bucket_at(const ANVHashMap* map, const size_t i)
+{
+    if (i >= map->bucket_count)
+    {
+        return map->old_buckets[i - map->bucket_count];
+    }
+    if (map->old_buckets && is_unmigrated(map, i % map->old_bucket_count))
+    {
+        return NULL;
+    }
+    return map->buckets[i];
+}
+
+/**
+ * Chain that holds (or would hold) a key with the given hash. During an
+ * incremental resize keys stay in their old bucket until it is migrated.
+ */
+static ANVHashMapNode** chain_for_hash(const ANVHashMap* map, const size_t hash)
+{
+    if (map->old_buckets)
+    {
+        const size_t old_index = index_for_count(map, hash, map->old_bucket_count);
+        if (is_unmigrated(map, old_index))
+        {
+            return &map->old_buckets[old_index];
+        }
+    }
+    return &map->buckets[get_bucket_index(map, hash)];
+}
+
+/**
+ * Find the link pointing at the node holding key, or NULL if absent.
+ */
+static ANVHashMapNode** find_link(const ANVHashMap* map, const void* key, const size_t hash)
+{
+    ANVHashMapNode** link = chain_for_hash(map, hash);
+    while (*link)
+    {
+        if (node_matches(map, *link, key, hash))
+        {
+            return link;
+        }
+        link = &(*link)->next;
+    }
+    return NULL;
+}
+
+/**
+ * Move every node of an old bucket chain into the current bucket array.
+ */
+static void relink_chain(ANVHashMap* map, ANVHashMapNode* node)
+{
+    while (node)
+    {
+        ANVHashMapNode* next = node->next;
+
+        // Relink using the cached hash, no user hash calls needed
+        const size_t new_index = get_bucket_index(map, node->hash);
+        node->next = map->buckets[new_index];
+        map->buckets[new_index] = node;
+
+        node = next;
+    }
+}
+
+/**
+ * Migrate up to count buckets of an incremental resize, releasing the old
+ * array once it is empty. The table exactly doubled, so old bucket k only
+ * feeds new buckets k and k + old_bucket_count, which are initialized here.
+ */
+static void migrate_buckets(ANVHashMap* map, size_t count)
+{
+    if (!map->old_buckets)
+    {
+        return;
+    }
+
+    const uint64_t start = now_nanos();
+    while (map->old_buckets && count > 0)
+    {
+        if (map->migrate_index < map->old_bucket_count)
+        {
+            const size_t index = map->migrate_index;
+            ANVHashMapNode* chain = map->old_buckets[index];
+            map->old_buckets[index] = NULL;
+            map->buckets[index] = NULL;
+            map->buckets[index + map->old_bucket_count] = NULL;
+            map->migrate_index++;
+            relink_chain(map, chain);
+            count--;
+        }
+
+        if (map->migrate_index == map->old_bucket_count)
+        {
+            anv_alloc_free_sized(map->alloc, map->old_buckets, map->old_bucket_count * sizeof(ANVHashMapNode*));
+            map->old_buckets = NULL;
+            map->old_bucket_count = 0;
+            map->migrate_index = 0;
+        }
+    }
+    map->rehash_nanos += now_nanos() - start;
 }
 
 /**
- * Resize the hash map to a new bucket count.
+ * Resize the hash map to a new bucket count. In incremental mode a doubling
+ * keeps the old array and drains it a few buckets per mutating operation,
+ * without touching the new array up front.
  */
 static int resize_map(ANVHashMap* map, const size_t new_bucket_count)
 {
@@ -91,6 +298,9 @@ static int resize_map(ANVHashMap* map, const size_t new_bucket_count)
         return -1;
     }
 
+    // Only one migration may be in flight
+    migrate_buckets(map, SIZE_MAX);
+
     // Allocate new bucket array
     ANVHashMapNode** new_buckets = anv_alloc_malloc(map->alloc,
                                                     new_bucket_count * sizeof(ANVHashMapNode*));
@@ -99,12 +309,6 @@ static int resize_map(ANVHashMap* map, const size_t new_bucket_count)
         return -1;
     }
 
-    // Initialize new buckets to NULL
-    for (size_t i = 0; i < new_bucket_count; i++)
-    {
-        new_buckets[i] = NULL;
-    }
-
     // Save old buckets
     ANVHashMapNode** old_buckets = map->buckets;
     const size_t old_bucket_count = map->bucket_count;
@@ -112,26 +316,33 @@ static int resize_map(ANVHashMap* map, const size_t new_bucket_count)
     // Update map with new buckets
     map->buckets = new_buckets;
     map->bucket_count = new_bucket_count;
+    map->resize_count++;
 
-    // Rehash all existing nodes
-    for (size_t i = 0; i < old_bucket_count; i++)
+    if (map->migrate_step > 0 && new_bucket_count == old_bucket_count * 2)
     {
-        ANVHashMapNode* node = old_buckets[i];
-        while (node)
-        {
-            ANVHashMapNode* next = node->next;
+        map->old_buckets = old_buckets;
+        map->old_bucket_count = old_bucket_count;
+        map->migrate_index = 0;
+        return 0;
+    }
 
-            // Rehash this node
-            const size_t new_index = get_bucket_index(map, node->key);
-            node->next = map->buckets[new_index];
-            map->buckets[new_index] = node;
+    const uint64_t start = now_nanos();
 
-            node = next;
-        }
+    // Initialize new buckets to NULL
+    for (size_t i = 0; i < new_bucket_count; i++)
+    {
+        new_buckets[i] = NULL;
+    }
+
+    // Rehash all existing nodes
+    for (size_t i = 0; i < old_bucket_count; i++)
+    {
+        relink_chain(map, old_buckets[i]);
     }
+    map->rehash_nanos += now_nanos() - start;
 
     // Free old bucket array
-    anv_alloc_free(map->alloc, old_buckets);
+    anv_alloc_free_sized(map->alloc, old_buckets, old_bucket_count * sizeof(ANVHashMapNode*));
     return 0;
 }
 
@@ -153,6 +364,115 @@ static int check_and_resize(ANVHashMap* map)
     return 0;
 }
 
+/**
+ * Smallest bucket count that holds expected_size entries under the load
+ * factor (at least one bucket), or 0 on overflow.
+ */
+static size_t buckets_for(const ANVHashMap* map, const size_t expected_size)
+{
+    const double needed = (double)expected_size / map->max_load_factor;
+    if (needed >= (double)SIZE_MAX)
+    {
+        return 0;
+    }
+
+    size_t bucket_count = (size_t)needed;
+    if ((double)bucket_count < needed || bucket_count == 0)
+    {
+        bucket_count++;
+    }
+    return map->power_of_two ? next_power_of_two(bucket_count) : bucket_count;
+}
+
+/**
+ * Grow the table so expected_size entries fit without further resizes.
+ */
+static int reserve_buckets(ANVHashMap* map, const size_t expected_size)
+{
+    const size_t bucket_count = buckets_for(map, expected_size);
+    if (bucket_count == 0)
+    {
+        return -1;
+    }
+    return bucket_count <= map->bucket_count ? 0 : resize_map(map, bucket_count);
+}
+
+/**
+ * Grow the table so expected_size entries fit, at least doubling it so that
+ * repeated small reservations stay amortized like single inserts.
+ */
+static int grow_buckets(ANVHashMap* map, const size_t expected_size)
+{
+    size_t bucket_count = buckets_for(map, expected_size);
+    if (bucket_count == 0)
+    {
+        return -1;
+    }
+    if (bucket_count <= map->bucket_count)
+    {
+        return 0;
+    }
+    if (bucket_count < map->bucket_count * 2 && map->bucket_count <= SIZE_MAX / 2)
+    {
+        bucket_count = map->bucket_count * 2;
+    }
+    return resize_map(map, bucket_count);
+}
+
+/**
+ * Hash a batch of keys and prefetch their chains in two passes: first the
+ * bucket slots, then the head nodes, so the misses of the whole batch
+ * overlap instead of being taken one key at a time.
+ */
+static void prefetch_batch(const ANVHashMap* map, const void* const* keys, const size_t count,
+                           size_t* hashes, ANVHashMapNode** links[])
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        hashes[i] = keys[i] ? map->hash(keys[i]) : 0;
+        links[i] = chain_for_hash(map, hashes[i]);
+        PREFETCH(links[i]);
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        PREFETCH(*links[i]);
+    }
+}
+
+/**
+ * Create a node for a key known to be absent and link it at the head of its
+ * chain, without resizing.
+ */
+static ANVHashMapNode* push_node(ANVHashMap* map, void* key, void* value, const size_t hash)
+{
+    ANVHashMapNode* new_node = create_node(map, key, value, hash);
+    if (!new_node)
+    {
+        return NULL;
+    }
+
+    // Insert at beginning of bucket
+    ANVHashMapNode** head = chain_for_hash(map, hash);
+    new_node->next = *head;
+    *head = new_node;
+    map->size++;
+    return new_node;
+}
+
+/**
+ * Insert a node for a key known to be absent, resizing if necessary.
+ */
+static int link_new_node(ANVHashMap* map, void* key, void* value, const size_t hash)
+{
+    if (!push_node(map, key, value, hash))
+    {
+        return -1;
+    }
+
+    // Check if resize is needed
+    return check_and_resize(map);
+}
+
 //==============================================================================
 // Creation and destruction functions
 //==============================================================================
@@ -176,7 +496,7 @@ ANV_API ANVHashMap* anv_hashmap_create(ANVAllocator* alloc, const hash_func hash
     map->buckets = anv_alloc_malloc(alloc, capacity * sizeof(ANVHashMapNode*));
     if (!map->buckets)
     {
-        anv_alloc_free(alloc, map);
+        anv_alloc_free_sized(alloc, map, sizeof(ANVHashMap));
         return NULL;
     }
 
@@ -187,11 +507,18 @@ ANV_API ANVHashMap* anv_hashmap_create(ANVAllocator* alloc, const hash_func hash
     }
 
     map->bucket_count = capacity;
+    map->old_buckets = NULL;
+    map->old_bucket_count = 0;
+    map->migrate_index = 0;
+    map->migrate_step = 0;
+    map->power_of_two = false;
     map->size = 0;
     map->max_load_factor = DEFAULT_MAX_LOAD_FACTOR;
     map->hash = hash;
     map->key_equals = key_equals;
     map->alloc = alloc;
+    map->resize_count = 0;
+    map->rehash_nanos = 0;
 
     return map;
 }
@@ -205,8 +532,8 @@ ANV_API void anv_hashmap_destroy(ANVHashMap* map, const bool should_free_keys, c
 
     anv_hashmap_clear(map, should_free_keys, should_free_values);
 
-    anv_alloc_free(map->alloc, map->buckets);
-    anv_alloc_free(map->alloc, map);
+    anv_alloc_free_sized(map->alloc, map->buckets, map->bucket_count * sizeof(ANVHashMapNode*));
+    anv_alloc_free_sized(map->alloc, map, sizeof(ANVHashMap));
 }
 
 ANV_API void anv_hashmap_clear(ANVHashMap* map, const bool should_free_keys, const bool should_free_values)
@@ -216,18 +543,32 @@ ANV_API void anv_hashmap_clear(ANVHashMap* map, const bool should_free_keys, con
         return;
     }
 
-    for (size_t i = 0; i < map->bucket_count; i++)
+    const size_t total = total_buckets(map);
+    for (size_t i = 0; i < total; i++)
     {
-        ANVHashMapNode* node = map->buckets[i];
+        ANVHashMapNode* node = bucket_at(map, i);
         while (node)
         {
             ANVHashMapNode* next = node->next;
             free_node(map, node, should_free_keys, should_free_values);
             node = next;
         }
+    }
+
+    for (size_t i = 0; i < map->bucket_count; i++)
+    {
         map->buckets[i] = NULL;
     }
 
+    // Nothing is left to migrate
+    if (map->old_buckets)
+    {
+        anv_alloc_free_sized(map->alloc, map->old_buckets, map->old_bucket_count * sizeof(ANVHashMapNode*));
+        map->old_buckets = NULL;
+        map->old_bucket_count = 0;
+        map->migrate_index = 0;
+    }
+
     map->size = 0;
 }
 
@@ -245,241 +586,477 @@ ANV_API int anv_hashmap_is_empty(const ANVHashMap* map)
     return !map || map->size == 0;
 }
 
+ANV_API size_t anv_hashmap_memory_usage(const ANVHashMap* map)
+{
+    if (!map)
+    {
+        return 0;
+    }
+
+    return sizeof(ANVHashMap) + total_buckets(map) * sizeof(ANVHashMapNode*) + map->size * sizeof(ANVHashMapNode);
+}
+
 ANV_API double anv_hashmap_load_factor(const ANVHashMap* map)
 {
     if (!map || map->bucket_count == 0)
     {
-        return 0.0;
+        return 0.0;
+    }
+    return (double)map->size / (double)map->bucket_count;
+}
+
+ANV_API int anv_hashmap_stats(const ANVHashMap* map, ANVHashMapStats* stats_out, size_t* histogram,
+                              const size_t histogram_len)
+{
+    if (!map || !stats_out)
+    {
+        return -1;
+    }
+
+    if (histogram)
+    {
+        memset(histogram, 0, histogram_len * sizeof(size_t));
+    }
+
+    ANVHashMapStats stats = {0};
+    const size_t total = total_buckets(map);
+    for (size_t i = 0; i < total; i++)
+    {
+        size_t length = 0;
+        for (const ANVHashMapNode* node = bucket_at(map, i); node; node = node->next)
+        {
+            length++;
+        }
+
+        if (length > 0)
+        {
+            stats.used_buckets++;
+        }
+        if (length > stats.max_chain_length)
+        {
+            stats.max_chain_length = length;
+        }
+        if (histogram && histogram_len > 0)
+        {
+            histogram[length < histogram_len ? length : histogram_len - 1]++;
+        }
+    }
+
+    stats.size = map->size;
+    stats.bucket_count = total;
+    stats.load_factor = total ? (double)map->size / (double)total : 0.0;
+    stats.mean_chain_length = stats.used_buckets ? (double)map->size / (double)stats.used_buckets : 0.0;
+    stats.resize_count = map->resize_count;
+    stats.rehash_seconds = (double)map->rehash_nanos / 1e9;
+    *stats_out = stats;
+    return 0;
+}
+
+ANV_API int anv_hashmap_contains_key(const ANVHashMap* map, const void* key)
+{
+    return anv_hashmap_get(map, key) != NULL;
+}
+
+//==============================================================================
+// Hash map operations
+//==============================================================================
+
+ANV_API int anv_hashmap_put(ANVHashMap* map, void* key, void* value)
+{
+    if (!map || !key)
+    {
+        return -1;
+    }
+
+    migrate_buckets(map, map->migrate_step);
+
+    const size_t hash = map->hash(key);
+    ANVHashMapNode** link = find_link(map, key, hash);
+
+    // Check if key already exists
+    if (link)
+    {
+        // Update existing value
+        (*link)->value = value;
+        return 0;
+    }
+
+    return link_new_node(map, key, value, hash);
+}
+
+ANV_API int anv_hashmap_put_replace(ANVHashMap* map, void* key, void* value, void** old_value_out)
+{
+    if (!map || !key || !old_value_out)
+    {
+        return -1;
+    }
+
+    *old_value_out = NULL; // Initialize to NULL
+
+    migrate_buckets(map, map->migrate_step);
+
+    const size_t hash = map->hash(key);
+    ANVHashMapNode** link = find_link(map, key, hash);
+
+    // Check if key already exists
+    if (link)
+    {
+        // Return the old value and update with new value
+        *old_value_out = (*link)->value;
+        (*link)->value = value;
+        return 0;
+    }
+
+    return link_new_node(map, key, value, hash);
+}
+
+ANV_API int anv_hashmap_put_with_free(ANVHashMap* map, void* key, void* value, const bool should_free_old_value)
+{
+    if (!map || !key)
+    {
+        return -1;
+    }
+
+    migrate_buckets(map, map->migrate_step);
+
+    const size_t hash = map->hash(key);
+    ANVHashMapNode** link = find_link(map, key, hash);
+
+    // Check if key already exists
+    if (link)
+    {
+        ANVHashMapNode* node = *link;
+
+        // Free the old value if requested and possible
+        if (should_free_old_value && node->value && map->alloc && map->alloc->data_free)
+        {
+            map->alloc->data_free(node->value);
+        }
+
+        // Update with new value
+        node->value = value;
+        return 0;
+    }
+
+    return link_new_node(map, key, value, hash);
+}
+
+ANV_API void** anv_hashmap_entry(ANVHashMap* map, void* key, bool* inserted_out)
+{
+    if (inserted_out)
+    {
+        *inserted_out = false;
+    }
+
+    if (!map || !key)
+    {
+        return NULL;
+    }
+
+    migrate_buckets(map, map->migrate_step);
+
+    const size_t hash = map->hash(key);
+    ANVHashMapNode** link = find_link(map, key, hash);
+    if (link)
+    {
+        return &(*link)->value;
+    }
+
+    ANVHashMapNode* node = push_node(map, key, NULL, hash);
+    if (!node)
+    {
+        return NULL;
+    }
+
+    // Nodes never move on resize, so the slot stays valid either way; a
+    // failed resize only leaves the table above its load factor
+    (void)check_and_resize(map);
+
+    if (inserted_out)
+    {
+        *inserted_out = true;
     }
-    return (double)map->size / (double)map->bucket_count;
+    return &node->value;
 }
 
-ANV_API int anv_hashmap_contains_key(const ANVHashMap* map, const void* key)
+ANV_API void* anv_hashmap_get(const ANVHashMap* map, const void* key)
 {
-    return anv_hashmap_get(map, key) != NULL;
-}
+    if (!map || !key)
+    {
+        return NULL;
+    }
 
-//==============================================================================
-// Hash map operations
-//==============================================================================
+    ANVHashMapNode** link = find_link(map, key, map->hash(key));
+    return link ? (*link)->value : NULL;
+}
 
-ANV_API int anv_hashmap_put(ANVHashMap* map, void* key, void* value)
+ANV_API int anv_hashmap_remove(ANVHashMap* map, const void* key,
+                       const bool should_free_key, const bool should_free_value)
 {
     if (!map || !key)
     {
         return -1;
     }
 
-    const size_t index = get_bucket_index(map, key);
-    ANVHashMapNode* node = map->buckets[index];
+    migrate_buckets(map, map->migrate_step);
 
-    // Check if key already exists
-    while (node)
+    ANVHashMapNode** link = find_link(map, key, map->hash(key));
+    if (!link)
     {
-        if (map->key_equals(node->key, key))
-        {
-            // Update existing value
-            node->value = value;
-            return 0;
-        }
-        node = node->next;
+        return -1; // Key not found
     }
 
-    // Create new node
-    ANVHashMapNode* new_node = create_node(map, key, value);
-    if (!new_node)
+    // Remove node from chain
+    ANVHashMapNode* node = *link;
+    *link = node->next;
+
+    free_node(map, node, should_free_key, should_free_value);
+    map->size--;
+    return 0;
+}
+
+ANV_API void* anv_hashmap_remove_get(ANVHashMap* map, const void* key, const bool should_free_key)
+{
+    if (!map || !key)
     {
-        return -1;
+        return NULL;
     }
 
-    // Insert at beginning of bucket
-    new_node->next = map->buckets[index];
-    map->buckets[index] = new_node;
-    map->size++;
+    migrate_buckets(map, map->migrate_step);
 
-    // Check if resize is needed
-    return check_and_resize(map);
+    ANVHashMapNode** link = find_link(map, key, map->hash(key));
+    if (!link)
+    {
+        return NULL; // Key not found
+    }
+
+    // Remove node from chain
+    ANVHashMapNode* node = *link;
+    *link = node->next;
+
+    void* value = node->value;
+    free_node(map, node, should_free_key, false); // Don't free value
+    map->size--;
+    return value;
 }
 
-ANV_API int anv_hashmap_put_replace(ANVHashMap* map, void* key, void* value, void** old_value_out)
+//==============================================================================
+// Batched operations
+//==============================================================================
+
+ANV_API size_t anv_hashmap_get_many(const ANVHashMap* map, const void* const* keys,
+                                    const size_t count, void** values_out)
 {
-    if (!map || !key || !old_value_out)
+    if (!map || !keys || !values_out)
     {
-        return -1;
+        return 0;
     }
 
-    *old_value_out = NULL; // Initialize to NULL
-
-    const size_t index = get_bucket_index(map, key);
-    ANVHashMapNode* node = map->buckets[index];
+    size_t hashes[BATCH_SIZE];
+    ANVHashMapNode** links[BATCH_SIZE];
+    size_t found = 0;
 
-    // Check if key already exists
-    while (node)
+    for (size_t base = 0; base < count; base += BATCH_SIZE)
     {
-        if (map->key_equals(node->key, key))
+        const size_t batch = count - base < BATCH_SIZE ? count - base : BATCH_SIZE;
+        prefetch_batch(map, keys + base, batch, hashes, links);
+
+        for (size_t i = 0; i < batch; i++)
         {
-            // Return the old value and update with new value
-            *old_value_out = node->value;
-            node->value = value;
-            return 0;
+            const void* key = keys[base + i];
+            values_out[base + i] = NULL;
+            if (!key)
+            {
+                continue;
+            }
+            for (const ANVHashMapNode* node = *links[i]; node; node = node->next)
+            {
+                if (node_matches(map, node, key, hashes[i]))
+                {
+                    values_out[base + i] = node->value;
+                    found++;
+                    break;
+                }
+            }
         }
-        node = node->next;
-    }
-
-    // Create new node (key doesn't exist)
-    ANVHashMapNode* new_node = create_node(map, key, value);
-    if (!new_node)
-    {
-        return -1;
     }
 
-    // Insert at beginning of bucket
-    new_node->next = map->buckets[index];
-    map->buckets[index] = new_node;
-    map->size++;
-
-    // Check if resize is needed
-    return check_and_resize(map);
+    return found;
 }
 
-ANV_API int anv_hashmap_put_with_free(ANVHashMap* map, void* key, void* value, const bool should_free_old_value)
+ANV_API int anv_hashmap_put_many(ANVHashMap* map, void* const* keys, void* const* values, const size_t count)
 {
-    if (!map || !key)
+    if (!map || !keys || !values)
     {
         return -1;
     }
 
-    const size_t index = get_bucket_index(map, key);
-    ANVHashMapNode* node = map->buckets[index];
+    for (size_t i = 0; i < count; i++)
+    {
+        if (!keys[i])
+        {
+            return -1;
+        }
+    }
+
+    size_t hashes[BATCH_SIZE];
+    ANVHashMapNode** links[BATCH_SIZE];
+    ANVHashMapNode* existing[BATCH_SIZE];
 
-    // Check if key already exists
-    while (node)
+    for (size_t base = 0; base < count; base += BATCH_SIZE)
     {
-        if (map->key_equals(node->key, key))
+        const size_t batch = count - base < BATCH_SIZE ? count - base : BATCH_SIZE;
+        prefetch_batch(map, (const void* const*)keys + base, batch, hashes, links);
+
+        // Look the batch up first and grow only for the keys that are new, so
+        // the inserts below do not resize halfway through the batch
+        size_t misses = 0;
+        for (size_t i = 0; i < batch; i++)
         {
-            // Free the old value if requested and possible
-            if (should_free_old_value && node->value && map->alloc && map->alloc->data_free)
+            existing[i] = NULL;
+            for (ANVHashMapNode* node = *links[i]; node; node = node->next)
             {
-                map->alloc->data_free(node->value);
+                if (node_matches(map, node, keys[base + i], hashes[i]))
+                {
+                    existing[i] = node;
+                    break;
+                }
             }
+            misses += existing[i] == NULL;
+        }
 
-            // Update with new value
-            node->value = value;
-            return 0;
+        if (misses > 0 && grow_buckets(map, map->size + misses) != 0)
+        {
+            return -1;
+        }
+
+        for (size_t i = 0; i < batch; i++)
+        {
+            migrate_buckets(map, map->migrate_step);
+            if (existing[i])
+            {
+                existing[i]->value = values[base + i];
+                continue;
+            }
+
+            // An earlier key of the same batch may have inserted this one
+            ANVHashMapNode** link = find_link(map, keys[base + i], hashes[i]);
+            if (link)
+            {
+                (*link)->value = values[base + i];
+            }
+            else if (!push_node(map, keys[base + i], values[base + i], hashes[i]))
+            {
+                return -1;
+            }
         }
-        node = node->next;
     }
 
-    // Create new node (key doesn't exist)
-    ANVHashMapNode* new_node = create_node(map, key, value);
-    if (!new_node)
+    return 0;
+}
+
+//==============================================================================
+// Capacity management
+//==============================================================================
+
+ANV_API int anv_hashmap_reserve(ANVHashMap* map, const size_t expected_size)
+{
+    if (!map)
     {
         return -1;
     }
 
-    // Insert at beginning of bucket
-    new_node->next = map->buckets[index];
-    map->buckets[index] = new_node;
-    map->size++;
-
-    // Check if resize is needed
-    return check_and_resize(map);
+    return reserve_buckets(map, expected_size);
 }
 
-ANV_API void* anv_hashmap_get(const ANVHashMap* map, const void* key)
+ANV_API int anv_hashmap_shrink_to_fit(ANVHashMap* map)
 {
-    if (!map || !key)
+    if (!map)
     {
-        return NULL;
+        return -1;
     }
 
-    const size_t index = get_bucket_index(map, key);
-    const ANVHashMapNode* node = map->buckets[index];
-
-    while (node)
+    const size_t bucket_count = buckets_for(map, map->size);
+    if (bucket_count == 0 || bucket_count >= map->bucket_count)
     {
-        if (map->key_equals(node->key, key))
-        {
-            return node->value;
-        }
-        node = node->next;
+        return 0;
     }
-
-    return NULL;
+    return resize_map(map, bucket_count);
 }
 
-ANV_API int anv_hashmap_remove(ANVHashMap* map, const void* key,
-                       const bool should_free_key, const bool should_free_value)
+//==============================================================================
+// Incremental resizing
+//==============================================================================
+
+ANV_API int anv_hashmap_set_incremental_resize(ANVHashMap* map, const size_t buckets_per_step)
 {
-    if (!map || !key)
+    if (!map)
     {
         return -1;
     }
 
-    const size_t index = get_bucket_index(map, key);
-    ANVHashMapNode* node = map->buckets[index];
-    ANVHashMapNode* prev = NULL;
-
-    while (node)
+    map->migrate_step = buckets_per_step;
+    if (buckets_per_step == 0)
     {
-        if (map->key_equals(node->key, key))
-        {
-            // Remove node from chain
-            if (prev)
-            {
-                prev->next = node->next;
-            }
-            else
-            {
-                map->buckets[index] = node->next;
-            }
+        migrate_buckets(map, SIZE_MAX);
+    }
+    return 0;
+}
 
-            free_node(map, node, should_free_key, should_free_value);
-            map->size--;
-            return 0;
-        }
-        prev = node;
-        node = node->next;
+ANV_API int anv_hashmap_rehash_step(ANVHashMap* map, const size_t bucket_count)
+{
+    if (!map)
+    {
+        return -1;
     }
 
-    return -1; // Key not found
+    migrate_buckets(map, bucket_count);
+    return map->old_buckets != NULL;
 }
 
-ANV_API void* anv_hashmap_remove_get(ANVHashMap* map, const void* key, const bool should_free_key)
+ANV_API bool anv_hashmap_is_rehashing(const ANVHashMap* map)
 {
-    if (!map || !key)
+    return map && map->old_buckets != NULL;
+}
+
+//==============================================================================
+// Table indexing
+//==============================================================================
+
+ANV_API int anv_hashmap_set_power_of_two(ANVHashMap* map, const bool enabled)
+{
+    if (!map)
     {
-        return NULL;
+        return -1;
     }
 
-    const size_t index = get_bucket_index(map, key);
-    ANVHashMapNode* node = map->buckets[index];
-    ANVHashMapNode* prev = NULL;
-
-    while (node)
+    if (map->power_of_two == enabled)
     {
-        if (map->key_equals(node->key, key))
-        {
-            // Remove node from chain
-            if (prev)
-            {
-                prev->next = node->next;
-            }
-            else
-            {
-                map->buckets[index] = node->next;
-            }
+        return 0;
+    }
 
-            void* value = node->value;
-            free_node(map, node, should_free_key, false); // Don't free value
-            map->size--;
-            return value;
-        }
-        prev = node;
-        node = node->next;
+    const size_t bucket_count = enabled ? next_power_of_two(map->bucket_count) : map->bucket_count;
+    if (bucket_count == 0)
+    {
+        return -1;
     }
 
-    return NULL; // Key not found
+    // Finish any in-flight resize under the old index function first, or the
+    // remaining old buckets would be relinked with the new one
+    migrate_buckets(map, SIZE_MAX);
+
+    // Every node moves under the new index function, so rebuild in one pass
+    const bool previous = map->power_of_two;
+    const size_t step = map->migrate_step;
+    map->power_of_two = enabled;
+    map->migrate_step = 0;
+    const int result = resize_map(map, bucket_count);
+    map->migrate_step = step;
+    if (result != 0)
+    {
+        map->power_of_two = previous;
+    }
+    return result;
 }
 
 //==============================================================================
@@ -507,9 +1084,9 @@ ANV_API int anv_hashmap_get_keys(const ANVHashMap* map, void*** keys_out, size_t
     }
 
     size_t key_index = 0;
-    for (size_t i = 0; i < map->bucket_count; i++)
+    for (size_t i = 0; i < total_buckets(map); i++)
     {
-        const ANVHashMapNode* node = map->buckets[i];
+        const ANVHashMapNode* node = bucket_at(map, i);
         while (node)
         {
             keys[key_index++] = node->key;
@@ -543,9 +1120,9 @@ ANV_API int anv_hashmap_get_values(const ANVHashMap* map, void*** values_out, si
     }
 
     size_t value_index = 0;
-    for (size_t i = 0; i < map->bucket_count; i++)
+    for (size_t i = 0; i < total_buckets(map); i++)
     {
-        const ANVHashMapNode* node = map->buckets[i];
+        const ANVHashMapNode* node = bucket_at(map, i);
         while (node)
         {
             values[value_index++] = node->value;
@@ -565,9 +1142,9 @@ ANV_API void anv_hashmap_for_each(const ANVHashMap* map, void (*action)(void* ke
         return;
     }
 
-    for (size_t i = 0; i < map->bucket_count; i++)
+    for (size_t i = 0; i < total_buckets(map); i++)
     {
-        const ANVHashMapNode* node = map->buckets[i];
+        const ANVHashMapNode* node = bucket_at(map, i);
         while (node)
         {
             action(node->key, node->value);
@@ -595,14 +1172,17 @@ ANV_API ANVHashMap* anv_hashmap_copy(const ANVHashMap* map)
     }
 
     copy->max_load_factor = map->max_load_factor;
+    copy->migrate_step = map->migrate_step;
+    copy->power_of_two = map->power_of_two;
 
     // Copy all key-value pairs
-    for (size_t i = 0; i < map->bucket_count; i++)
+    for (size_t i = 0; i < total_buckets(map); i++)
     {
-        const ANVHashMapNode* node = map->buckets[i];
+        const ANVHashMapNode* node = bucket_at(map, i);
         while (node)
         {
-            if (anv_hashmap_put(copy, node->key, node->value) != 0)
+            // Keys are already unique, so reuse the cached hash and skip the lookup
+            if (link_new_node(copy, node->key, node->value, node->hash) != 0)
             {
                 anv_hashmap_destroy(copy, false, false);
                 return NULL;
@@ -630,11 +1210,13 @@ ANV_API ANVHashMap* anv_hashmap_copy_deep(const ANVHashMap* map,
     }
 
     copy->max_load_factor = map->max_load_factor;
+    copy->migrate_step = map->migrate_step;
+    copy->power_of_two = map->power_of_two;
 
     // Copy all key-value pairs with deep copying
-    for (size_t i = 0; i < map->bucket_count; i++)
+    for (size_t i = 0; i < total_buckets(map); i++)
     {
-        const ANVHashMapNode* node = map->buckets[i];
+        const ANVHashMapNode* node = bucket_at(map, i);
         while (node)
         {
             void* copied_key = key_copy ? key_copy(node->key) : node->key;
@@ -656,7 +1238,8 @@ ANV_API ANVHashMap* anv_hashmap_copy_deep(const ANVHashMap* map,
                 return NULL;
             }
 
-            if (anv_hashmap_put(copy, copied_key, copied_value) != 0)
+            // Copies compare equal to their source key, so they share its hash
+            if (link_new_node(copy, copied_key, copied_value, node->hash) != 0)
             {
                 // Clean up on failure
                 if (key_copy)
@@ -734,10 +1317,10 @@ static int hashmap_iterator_next(const ANVIterator* it)
     state->current_node = state->current_node->next;
 
     // If no more nodes in current bucket, find next non-empty bucket
-    while (!state->current_node && state->current_bucket < state->map->bucket_count - 1)
+    while (!state->current_node && state->current_bucket + 1 < total_buckets(state->map))
     {
         state->current_bucket++;
-        state->current_node = state->map->buckets[state->current_bucket];
+        state->current_node = bucket_at(state->map, state->current_bucket);
     }
 
     return 0;
@@ -767,12 +1350,12 @@ static void hashmap_iterator_reset(const ANVIterator* it)
     state->current_node = NULL;
 
     // Find first non-empty bucket
-    for (size_t i = 0; i < state->map->bucket_count; i++)
+    for (size_t i = 0; i < total_buckets(state->map); i++)
     {
-        if (state->map->buckets[i])
+        if (bucket_at(state->map, i))
         {
             state->current_bucket = i;
-            state->current_node = state->map->buckets[i];
+            state->current_node = bucket_at(state->map, i);
             break;
         }
     }
@@ -793,7 +1376,7 @@ static void hashmap_iterator_destroy(ANVIterator* it)
     HashMapIteratorState* state = it->data_state;
     if (state->map)
     {
-        anv_alloc_free(state->map->alloc, state);
+        anv_alloc_free_sized(state->map->alloc, state, sizeof(HashMapIteratorState));
     }
     it->data_state = NULL;
 }
@@ -827,12 +1410,12 @@ ANV_API ANVIterator anv_hashmap_iterator(const ANVHashMap* map)
     state->current_node = NULL;
 
     // Find first non-empty bucket
-    for (size_t i = 0; i < map->bucket_count; i++)
+    for (size_t i = 0; i < total_buckets(map); i++)
     {
-        if (map->buckets[i])
+        if (bucket_at(map, i))
         {
             state->current_bucket = i;
-            state->current_node = map->buckets[i];
+            state->current_node = bucket_at(map, i);
             break;
         }
     }
@@ -844,6 +1427,13 @@ ANV_API ANVIterator anv_hashmap_iterator(const ANVHashMap* map)
 
 ANV_API ANVHashMap* anv_hashmap_from_iterator(ANVIterator* it, ANVAllocator* alloc,
                                       const hash_func hash, const key_equals_func key_equals, const bool should_copy)
+{
+    return anv_hashmap_from_iterator_sized(it, alloc, hash, key_equals, should_copy, 0);
+}
+
+ANV_API ANVHashMap* anv_hashmap_from_iterator_sized(ANVIterator* it, ANVAllocator* alloc,
+                                            const hash_func hash, const key_equals_func key_equals,
+                                            const bool should_copy, const size_t expected_count)
 {
     if (!it || !alloc || !hash || !key_equals)
     {
@@ -866,6 +1456,13 @@ ANV_API ANVHashMap* anv_hashmap_from_iterator(ANVIterator* it, ANVAllocator* all
         return NULL;
     }
 
+    // Size once for the expected element count instead of doubling repeatedly
+    if (anv_hashmap_reserve(map, expected_count) != 0)
+    {
+        anv_hashmap_destroy(map, false, false);
+        return NULL;
+    }
+
     while (it->has_next(it))
     {
         ANVPair* pair = it->get(it);
@@ -928,23 +1525,190 @@ ANV_API ANVHashMap* anv_hashmap_from_iterator(ANVIterator* it, ANVAllocator* all
 // Utility hash functions
 //==============================================================================
 
-ANV_API size_t anv_hash_string(const void* key)
+// Mixing constants of the wyhash family
+static const uint64_t hash_secret[4] = {
+    0x2d358dccaa6c78a5ULL, 0x8bb84b93962eacc9ULL, 0x4b33a62ed433d4a3ULL, 0x4d5a2da51de1aa47ULL
+};
+
+// Process-wide seed, 0 until first use
+static _Atomic uint64_t hash_seed = 0;
+
+/**
+ * Full 64x64 -> 128 bit multiply, low half into *a and high half into *b.
+ */
+static void hash_mum(uint64_t* a, uint64_t* b)
 {
-    if (!key)
+#if defined(__SIZEOF_INT128__)
+    const __uint128_t r = (__uint128_t)*a * *b;
+    *a = (uint64_t)r;
+    *b = (uint64_t)(r >> 64);
+#else
+    const uint64_t ha = *a >> 32, hb = *b >> 32;
+    const uint64_t la = (uint32_t)*a, lb = (uint32_t)*b;
+    const uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    const uint64_t t = rl + (rm0 << 32);
+    uint64_t carry = t < rl;
+    const uint64_t lo = t + (rm1 << 32);
+    carry += lo < t;
+    *a = lo;
+    *b = rh + (rm0 >> 32) + (rm1 >> 32) + carry;
+#endif
+}
+
+static uint64_t hash_mix(uint64_t a, uint64_t b)
+{
+    hash_mum(&a, &b);
+    return a ^ b;
+}
+
+static uint64_t read64(const uint8_t* p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint64_t read32(const uint8_t* p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/**
+ * Pick a seed from the clock and address-space layout. Not cryptographic,
+ * but differs between processes so colliding key sets cannot be precomputed.
+ */
+static uint64_t make_seed(void)
+{
+    static const int anchor = 0;
+    struct timespec ts = {0};
+    timespec_get(&ts, TIME_UTC);
+    uint64_t seed = hash_mix((uint64_t)ts.tv_sec ^ hash_secret[0], (uint64_t)ts.tv_nsec ^ hash_secret[1]);
+    seed = hash_mix(seed ^ (uint64_t)(uintptr_t)&anchor, (uint64_t)(uintptr_t)&ts ^ hash_secret[2]);
+    seed = hash_mix(seed ^ (uint64_t)clock(), hash_secret[3]);
+    return seed ? seed : hash_secret[3];
+}
+
+/**
+ * Load the process seed, choosing it on first use.
+ */
+static uint64_t current_seed(void)
+{
+    uint64_t seed = atomic_load_explicit(&hash_seed, memory_order_acquire);
+    if (seed == 0)
+    {
+        // First caller wins, so every thread agrees on one seed
+        uint64_t expected = 0;
+        const uint64_t fresh = make_seed();
+        if (atomic_compare_exchange_strong(&hash_seed, &expected, fresh))
+        {
+            return fresh;
+        }
+        seed = expected;
+    }
+    return seed;
+}
+
+ANV_API uint64_t anv_hash_seed(void)
+{
+    return current_seed();
+}
+
+ANV_API void anv_hash_set_seed(const uint64_t seed)
+{
+    atomic_store_explicit(&hash_seed, seed ? seed : hash_secret[3], memory_order_release);
+}
+
+/**
+ * wyhash-style core shared by the exported entry points.
+ */
+static uint64_t hash_bytes(const void* data, const size_t length, uint64_t seed)
+{
+    const uint8_t* p = data;
+    uint64_t a;
+    uint64_t b;
+
+    seed ^= hash_mix(seed ^ hash_secret[0], hash_secret[1]);
+    if (length <= 16)
+    {
+        if (length >= 4)
+        {
+            const size_t shift = (length >> 3) << 2;
+            a = (read32(p) << 32) | read32(p + shift);
+            b = (read32(p + length - 4) << 32) | read32(p + length - 4 - shift);
+        }
+        else if (length > 0)
+        {
+            a = ((uint64_t)p[0] << 16) | ((uint64_t)p[length >> 1] << 8) | p[length - 1];
+            b = 0;
+        }
+        else
+        {
+            a = 0;
+            b = 0;
+        }
+    }
+    else
+    {
+        size_t remaining = length;
+        if (remaining > 48)
+        {
+            // Three independent lanes keep the multipliers busy
+            uint64_t seed1 = seed;
+            uint64_t seed2 = seed;
+            do
+            {
+                seed = hash_mix(read64(p) ^ hash_secret[1], read64(p + 8) ^ seed);
+                seed1 = hash_mix(read64(p + 16) ^ hash_secret[2], read64(p + 24) ^ seed1);
+                seed2 = hash_mix(read64(p + 32) ^ hash_secret[3], read64(p + 40) ^ seed2);
+                p += 48;
+                remaining -= 48;
+            } while (remaining > 48);
+            seed ^= seed1 ^ seed2;
+        }
+        while (remaining > 16)
+        {
+            seed = hash_mix(read64(p) ^ hash_secret[1], read64(p + 8) ^ seed);
+            p += 16;
+            remaining -= 16;
+        }
+        a = read64(p + remaining - 16);
+        b = read64(p + remaining - 8);
+    }
+
+    a ^= hash_secret[1];
+    b ^= seed;
+    hash_mum(&a, &b);
+    return hash_mix(a ^ hash_secret[0] ^ length, b ^ hash_secret[1]);
+}
+
+ANV_API uint64_t anv_hash_bytes_seeded(const void* data, const size_t length, const uint64_t seed)
+{
+    if (!data && length > 0)
     {
         return 0;
     }
+    return hash_bytes(data, length, seed);
+}
 
-    const char* str = key;
-    size_t hash = 5381; // djb2 hash algorithm
-    int c;
+ANV_API size_t anv_hash_bytes(const void* data, const size_t length)
+{
+    if (!data && length > 0)
+    {
+        return 0;
+    }
+    return (size_t)hash_bytes(data, length, current_seed());
+}
 
-    while ((c = (unsigned char)*str++))
+ANV_API size_t anv_hash_string(const void* key)
+{
+    if (!key)
     {
-        hash = ((hash << 5) + hash) + c; // hash * 33 + c
+        return 0;
     }
 
-    return hash;
+    return (size_t)hash_bytes(key, strlen(key), current_seed());
 }
 
 ANV_API size_t anv_hash_int(const void* key)
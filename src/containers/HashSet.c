@@ -2,38 +2,244 @@
 // HashSet.c
 // Implementation of hash set functions.
 //
-// This file implements a hash set as a wrapper around HashMap.
-// Uses a sentinel value for all HashMap values to implement set semantics.
-// Provides average O(1) add, remove, and contains operations.
+// This file implements a hash set with its own open-addressed table. Keys are
+// stored inline next to one control byte per slot and probed a group at a
+// time with the same scheme as FlatMap (see FlatGroup.h): the mixed hash picks
+// a starting group and a 7-bit tag, only slots whose tag matches are compared,
+// and groups are visited in triangular order. Removal leaves a tombstone
+// unless the group still has an empty slot.
+//
+// The parallel set operations split the result table into ranges of groups,
+// one per worker thread, so the table is filled without locks.
 
 #include <string.h>
+#include <time.h>
 
+#include "FlatGroup.h"
 #include "HashSet.h"
-#include "Pair.h"
+
+#ifdef ANVIL_WITH_SYSTEM
+#include "system/Threads.h"
+#endif
+
+//==============================================================================
+// Private constants
+//==============================================================================
+
+#define DEFAULT_INITIAL_CAPACITY 16
+#define NOT_FOUND FLAT_NOT_FOUND
 
 //==============================================================================
 // Private helper functions
 //==============================================================================
 
-// Global variable to store the action function for for_each
-static void (*g_hashset_action)(void* key) = NULL;
+/**
+ * Wall-clock time in nanoseconds, for the rehash timer.
+ */
+static uint64_t now_nanos(void)
+{
+    struct timespec ts = {0};
+    timespec_get(&ts, TIME_UTC);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static size_t hash_group(const ANVHashSet* set, const size_t hash)
+{
+    return flat_home_group(set->capacity, hash);
+}
+
+/**
+ * Mixed hash of key, the only form in which hashes reach the table helpers.
+ */
+static size_t hash_key(const ANVHashSet* set, const void* key)
+{
+    return flat_mix_hash(set->hash(key));
+}
+
+static bool slot_matches(const void* table, const size_t index, const void* key)
+{
+    const ANVHashSet* set = table;
+    return set->key_equals(set->keys[index], key);
+}
+
+/**
+ * Find the slot holding key, or NOT_FOUND.
+ */
+static size_t find_slot(const ANVHashSet* set, const void* key, const size_t hash)
+{
+    return flat_find(set->ctrl, set->capacity, hash, slot_matches, set, key);
+}
+
+static size_t find_free_slot(const ANVHashSet* set, const size_t hash)
+{
+    return flat_find_free(set->ctrl, set->capacity, hash);
+}
 
-// Wrapper function that ignores the value parameter for for_each operation
-static void hashset_action_wrapper(void* key, void* value)
+static size_t table_bytes(const size_t capacity)
 {
-    (void)value; // Ignore the sentinel value
-    if (g_hashset_action)
+    return flat_table_bytes(capacity, sizeof(void*));
+}
+
+/**
+ * Smallest table that holds expected_size keys under the load limit, or 0 on overflow.
+ */
+static size_t capacity_for(const size_t expected_size)
+{
+    size_t capacity = DEFAULT_INITIAL_CAPACITY;
+    while (group_max_load(capacity) < expected_size)
     {
-        g_hashset_action(key);
+        if (capacity > SIZE_MAX / 2 / (sizeof(void*) + 1))
+        {
+            return 0;
+        }
+        capacity *= 2;
     }
+    return capacity;
 }
 
-//==============================================================================
-// Private constants
-//==============================================================================
+/**
+ * Allocate an empty table of the given capacity into set.
+ */
+static int allocate_table(ANVHashSet* set, const size_t capacity)
+{
+    void** keys = flat_allocate(set->alloc, capacity, sizeof(void*), &set->ctrl, &set->growth_left);
+    if (!keys)
+    {
+        return -1;
+    }
+
+    set->keys = keys;
+    set->capacity = capacity;
+    return 0;
+}
+
+/**
+ * Rebuild the table at new_capacity, dropping tombstones.
+ */
+static int rehash_to(ANVHashSet* set, const size_t new_capacity)
+{
+    void** old_keys = set->keys;
+    const int8_t* old_ctrl = set->ctrl;
+    const size_t old_capacity = set->capacity;
+
+    if (allocate_table(set, new_capacity) != 0)
+    {
+        return -1;
+    }
+
+    const uint64_t start = now_nanos();
+    for (size_t i = 0; i < old_capacity; i++)
+    {
+        if (old_ctrl[i] >= 0)
+        {
+            const size_t hash = hash_key(set, old_keys[i]);
+            const size_t index = find_free_slot(set, hash);
+            set->ctrl[index] = hash_tag(hash);
+            set->keys[index] = old_keys[i];
+        }
+    }
+    set->growth_left -= set->size;
+    set->resize_count++;
+    set->rehash_nanos += now_nanos() - start;
+
+    anv_alloc_free_sized(set->alloc, old_keys, table_bytes(old_capacity));
+    return 0;
+}
+
+/**
+ * Make room for one more key, doubling unless most used slots are tombstones.
+ */
+static int grow(ANVHashSet* set)
+{
+    size_t new_capacity = set->capacity;
+    if (set->size * 2 >= group_max_load(set->capacity))
+    {
+        if (set->capacity > SIZE_MAX / 2 / (sizeof(void*) + 1))
+        {
+            return -1;
+        }
+        new_capacity = set->capacity * 2;
+    }
+    return rehash_to(set, new_capacity);
+}
+
+/**
+ * Insert a key known to be absent, growing if needed.
+ */
+static int insert_new(ANVHashSet* set, void* key, const size_t hash)
+{
+    size_t index = find_free_slot(set, hash);
+    if (set->ctrl[index] == CTRL_EMPTY && set->growth_left == 0)
+    {
+        if (grow(set) != 0)
+        {
+            return -1;
+        }
+        index = find_free_slot(set, hash);
+    }
+
+    if (set->ctrl[index] == CTRL_EMPTY)
+    {
+        set->growth_left--;
+    }
+    set->ctrl[index] = hash_tag(hash);
+    set->keys[index] = key;
+    set->size++;
+    return 0;
+}
+
+/**
+ * Shared insert path for add and add_check.
+ */
+static int insert(ANVHashSet* set, void* key, bool* was_added_out)
+{
+    const size_t hash = hash_key(set, key);
+    if (find_slot(set, key, hash) != NOT_FOUND)
+    {
+        return 0;
+    }
+
+    if (insert_new(set, key, hash) != 0)
+    {
+        return -1;
+    }
+
+    if (was_added_out)
+    {
+        *was_added_out = true;
+    }
+    return 0;
+}
+
+/**
+ * Membership test that reuses hash when other hashes keys the same way as
+ * the set it was computed for.
+ */
+static bool contains_hashed(const ANVHashSet* other, const ANVHashSet* hashed_by,
+                            const void* key, const size_t hash)
+{
+    const size_t other_hash = other->hash == hashed_by->hash ? hash : hash_key(other, key);
+    return find_slot(other, key, other_hash) != NOT_FOUND;
+}
+
+static void erase_slot(ANVHashSet* set, const size_t index)
+{
+    flat_erase(set->ctrl, index, &set->growth_left);
+    set->size--;
+}
 
-// Sentinel value used for all HashMap values in the set
-static void* const HASHSET_PRESENT = (void*)1;
+static size_t next_full_slot(const ANVHashSet* set, const size_t start)
+{
+    return flat_next_full(set->ctrl, set->capacity, start);
+}
+
+/**
+ * Empty set with the same functions and allocator as set, sized for expected_size keys.
+ */
+static ANVHashSet* create_like(const ANVHashSet* set, const size_t expected_size)
+{
+    return anv_hashset_create(set->alloc, set->hash, set->key_equals, expected_size);
+}
 
 //==============================================================================
 // Creation and destruction functions
@@ -47,16 +253,28 @@ ANV_API ANVHashSet* anv_hashset_create(ANVAllocator* alloc, const hash_func hash
         return NULL;
     }
 
+    const size_t capacity = capacity_for(initial_capacity);
+    if (capacity == 0)
+    {
+        return NULL;
+    }
+
     ANVHashSet* set = anv_alloc_malloc(alloc, sizeof(ANVHashSet));
     if (!set)
     {
         return NULL;
     }
 
-    set->map = anv_hashmap_create(alloc, hash, key_equals, initial_capacity);
-    if (!set->map)
+    set->size = 0;
+    set->hash = hash;
+    set->key_equals = key_equals;
+    set->alloc = alloc;
+    set->resize_count = 0;
+    set->rehash_nanos = 0;
+
+    if (allocate_table(set, capacity) != 0)
     {
-        anv_alloc_free(alloc, set);
+        anv_alloc_free_sized(alloc, set, sizeof(ANVHashSet));
         return NULL;
     }
 
@@ -70,26 +288,33 @@ ANV_API void anv_hashset_destroy(ANVHashSet* set, const bool should_free_keys)
         return;
     }
 
-    if (set->map)
-    {
-        const ANVAllocator* alloc = set->map->alloc;
-
-        // Never free values (they're just sentinels), but optionally free keys
-        anv_hashmap_destroy(set->map, should_free_keys, false);
+    anv_hashset_clear(set, should_free_keys);
 
-        anv_alloc_free(alloc, set);
-    }
+    anv_alloc_free_sized(set->alloc, set->keys, table_bytes(set->capacity));
+    anv_alloc_free_sized(set->alloc, set, sizeof(ANVHashSet));
 }
 
 ANV_API void anv_hashset_clear(ANVHashSet* set, const bool should_free_keys)
 {
-    if (!set || !set->map)
+    if (!set || !set->keys)
     {
         return;
     }
 
-    // Never free values (they're just sentinels), but optionally free keys
-    anv_hashmap_clear(set->map, should_free_keys, false);
+    if (should_free_keys)
+    {
+        for (size_t i = 0; i < set->capacity; i++)
+        {
+            if (set->ctrl[i] >= 0 && set->keys[i])
+            {
+                anv_alloc_data_free(set->alloc, set->keys[i]);
+            }
+        }
+    }
+
+    memset(set->ctrl, CTRL_EMPTY, set->capacity);
+    set->size = 0;
+    set->growth_left = group_max_load(set->capacity);
 }
 
 //==============================================================================
@@ -98,115 +323,200 @@ ANV_API void anv_hashset_clear(ANVHashSet* set, const bool should_free_keys)
 
 ANV_API size_t anv_hashset_size(const ANVHashSet* set)
 {
-    return set && set->map ? anv_hashmap_size(set->map) : 0;
+    return set ? set->size : 0;
 }
 
 ANV_API int anv_hashset_is_empty(const ANVHashSet* set)
 {
-    return !set || !set->map || anv_hashmap_is_empty(set->map);
+    return !set || set->size == 0;
+}
+
+ANV_API size_t anv_hashset_memory_usage(const ANVHashSet* set)
+{
+    if (!set)
+    {
+        return 0;
+    }
+
+    return sizeof(ANVHashSet) + table_bytes(set->capacity);
 }
 
 ANV_API double anv_hashset_load_factor(const ANVHashSet* set)
 {
-    return set && set->map ? anv_hashmap_load_factor(set->map) : 0.0;
+    if (!set || set->capacity == 0)
+    {
+        return 0.0;
+    }
+    return (double)set->size / (double)set->capacity;
+}
+
+ANV_API int anv_hashset_stats(const ANVHashSet* set, ANVHashSetStats* stats_out, size_t* histogram,
+                              const size_t histogram_len)
+{
+    if (!set || !stats_out)
+    {
+        return -1;
+    }
+
+    if (histogram)
+    {
+        memset(histogram, 0, histogram_len * sizeof(size_t));
+    }
+
+    ANVHashSetStats stats = {0};
+    const size_t group_mask = set->capacity / GROUP_WIDTH - 1;
+    size_t total_probe = 0;
+    for (size_t i = 0; i < set->capacity; i++)
+    {
+        if (set->ctrl[i] == CTRL_DELETED)
+        {
+            stats.tombstones++;
+        }
+        if (set->ctrl[i] < 0)
+        {
+            continue;
+        }
+
+        // Walk the triangular probe sequence from the home group to this slot's group
+        const size_t target = i / GROUP_WIDTH;
+        size_t group = hash_group(set, hash_key(set, set->keys[i]));
+        size_t probe = 0;
+        while (group != target && probe <= group_mask)
+        {
+            group = (group + ++probe) & group_mask;
+        }
+
+        total_probe += probe;
+        if (probe > stats.max_probe_length)
+        {
+            stats.max_probe_length = probe;
+        }
+        if (histogram && histogram_len > 0)
+        {
+            histogram[probe < histogram_len ? probe : histogram_len - 1]++;
+        }
+    }
+
+    stats.size = set->size;
+    stats.capacity = set->capacity;
+    stats.load_factor = anv_hashset_load_factor(set);
+    stats.mean_probe_length = set->size ? (double)total_probe / (double)set->size : 0.0;
+    stats.resize_count = set->resize_count;
+    stats.rehash_seconds = (double)set->rehash_nanos / 1e9;
+    *stats_out = stats;
+    return 0;
+}
+
+ANV_API size_t anv_hashset_capacity(const ANVHashSet* set)
+{
+    return set ? set->capacity : 0;
 }
 
 //==============================================================================
-// Hash set operations
+// Capacity management
 //==============================================================================
 
-ANV_API int anv_hashset_add(ANVHashSet* set, void* key)
+ANV_API int anv_hashset_reserve(ANVHashSet* set, const size_t expected_size)
 {
-    if (!set || !set->map || !key)
+    if (!set)
     {
         return -1;
     }
 
-    return anv_hashmap_put(set->map, key, HASHSET_PRESENT);
+    const size_t capacity = capacity_for(expected_size);
+    if (capacity == 0)
+    {
+        return -1;
+    }
+    return capacity <= set->capacity ? 0 : rehash_to(set, capacity);
 }
 
-ANV_API int anv_hashset_add_check(ANVHashSet* set, void* key, bool* was_added_out)
+ANV_API int anv_hashset_shrink_to_fit(ANVHashSet* set)
 {
-    if (!set || !set->map || !key || !was_added_out)
+    if (!set)
     {
         return -1;
     }
 
-    *was_added_out = false;
+    const size_t capacity = capacity_for(set->size);
+    return capacity == 0 || capacity >= set->capacity ? 0 : rehash_to(set, capacity);
+}
 
-    void* old_value = NULL;
-    const int result = anv_hashmap_put_replace(set->map, key, HASHSET_PRESENT, &old_value);
+//==============================================================================
+// Hash set operations
+//==============================================================================
 
-    if (result == 0)
+ANV_API int anv_hashset_add(ANVHashSet* set, void* key)
+{
+    if (!set || !key)
     {
-        *was_added_out = (old_value == NULL); // New key if no old value
+        return -1;
     }
 
-    return result;
+    return insert(set, key, NULL);
 }
 
-ANV_API int anv_hashset_contains(const ANVHashSet* set, const void* key)
+ANV_API int anv_hashset_add_check(ANVHashSet* set, void* key, bool* was_added_out)
 {
-    if (!set || !set->map || !key)
+    if (!set || !key || !was_added_out)
     {
-        return 0;
+        return -1;
     }
 
-    return anv_hashmap_contains_key(set->map, key);
+    *was_added_out = false;
+    return insert(set, key, was_added_out);
 }
 
-ANV_API int anv_hashset_remove(ANVHashSet* set, const void* key, const bool should_free_key)
+ANV_API int anv_hashset_contains(const ANVHashSet* set, const void* key)
 {
-    if (!set || !set->map || !key)
+    if (!set || !key)
     {
-        return -1;
+        return 0;
     }
 
-    // Never free values (they're just sentinels), but optionally free keys
-    return anv_hashmap_remove(set->map, key, should_free_key, false);
+    return find_slot(set, key, hash_key(set, key)) != NOT_FOUND;
 }
 
-ANV_API void* anv_hashset_remove_get(ANVHashSet* set, const void* key)
+ANV_API int anv_hashset_remove(ANVHashSet* set, const void* key, const bool should_free_key)
 {
-    if (!set || !set->map || !key)
+    if (!set || !key)
     {
-        return NULL;
+        return -1;
     }
 
-    // First check if the key exists and get all keys to find the exact pointer
-    void** keys;
-    size_t count;
-    if (anv_hashmap_get_keys(set->map, &keys, &count) != 0)
+    const size_t index = find_slot(set, key, hash_key(set, key));
+    if (index == NOT_FOUND)
     {
-        return NULL;
+        return -1; // Key not found
     }
 
-    void* found_key = NULL;
-    // Find the actual key pointer that matches
-    for (size_t i = 0; i < count; i++)
+    void* stored = set->keys[index];
+    erase_slot(set, index);
+
+    if (should_free_key && stored)
     {
-        if (set->map->key_equals(keys[i], key))
-        {
-            found_key = keys[i];
-            break;
-        }
+        anv_alloc_data_free(set->alloc, stored);
     }
+    return 0;
+}
 
-    // Free the keys array
-    anv_alloc_free(set->map->alloc, keys);
-
-    if (!found_key)
+ANV_API void* anv_hashset_remove_get(ANVHashSet* set, const void* key)
+{
+    if (!set || !key)
     {
         return NULL;
     }
 
-    // Remove the entry (but don't free the key since we're returning it)
-    if (anv_hashmap_remove(set->map, key, false, false) == 0)
+    const size_t index = find_slot(set, key, hash_key(set, key));
+    if (index == NOT_FOUND)
     {
-        return found_key;
+        return NULL; // Key not found
     }
 
-    return NULL;
+    // Return the stored key pointer, which may differ from the lookup key
+    void* stored = set->keys[index];
+    erase_slot(set, index);
+    return stored;
 }
 
 //==============================================================================
@@ -215,182 +525,244 @@ ANV_API void* anv_hashset_remove_get(ANVHashSet* set, const void* key)
 
 ANV_API ANVHashSet* anv_hashset_union(const ANVHashSet* set1, const ANVHashSet* set2)
 {
-    if (!set1 || !set1->map || !set2 || !set2->map)
+    if (!set1 || !set2)
     {
         return NULL;
     }
 
-    // Create result set with same configuration as set1
-    ANVHashSet* result = anv_hashset_create(set1->map->alloc, set1->map->hash,
-                                            set1->map->key_equals, 0);
+    // Room for the disjoint case, so the result never rehashes while filling
+    ANVHashSet* result = create_like(set1, set1->size + set2->size);
     if (!result)
     {
         return NULL;
     }
 
-    // Add all elements from set1
-    ANVIterator it1 = anv_hashmap_iterator(set1->map);
-    while (it1.has_next(&it1))
-    {
-        const ANVPair* pair = it1.get(&it1);
-
-        if (pair && anv_hashset_add(result, pair->first) != 0)
-        {
-            it1.destroy(&it1);
-            anv_hashset_destroy(result, false);
-            return NULL;
-        }
-        it1.next(&it1);
-    }
-    it1.destroy(&it1);
-
-    // Add all elements from set2 (duplicates will be ignored)
-    ANVIterator it2 = anv_hashmap_iterator(set2->map);
-    while (it2.has_next(&it2))
+    const ANVHashSet* sources[2] = {set1, set2};
+    for (size_t s = 0; s < 2; s++)
     {
-        const ANVPair* pair = it2.get(&it2);
-        if (pair)
+        for (size_t i = 0; i < sources[s]->capacity; i++)
         {
-            anv_hashset_add(result, pair->first); // Ignore errors for duplicates
+            if (sources[s]->ctrl[i] >= 0 && insert(result, sources[s]->keys[i], NULL) != 0)
+            {
+                anv_hashset_destroy(result, false);
+                return NULL;
+            }
         }
-        it2.next(&it2);
     }
-    it2.destroy(&it2);
 
     return result;
 }
 
 ANV_API ANVHashSet* anv_hashset_intersection(const ANVHashSet* set1, const ANVHashSet* set2)
 {
-    if (!set1 || !set1->map || !set2 || !set2->map)
+    if (!set1 || !set2)
     {
         return NULL;
     }
 
-    // Create result set
-    ANVHashSet* result = anv_hashset_create(set1->map->alloc, set1->map->hash,
-                                            set1->map->key_equals, 0);
+    // Iterate through smaller set for efficiency; the result cannot be larger
+    const ANVHashSet* smaller = set1->size <= set2->size ? set1 : set2;
+    const ANVHashSet* larger = (smaller == set1) ? set2 : set1;
+
+    ANVHashSet* result = create_like(set1, smaller->size);
     if (!result)
     {
         return NULL;
     }
 
-    // Iterate through smaller set for efficiency
-    const ANVHashSet* smaller = anv_hashset_size(set1) <= anv_hashset_size(set2) ? set1 : set2;
-    const ANVHashSet* larger = (smaller == set1) ? set2 : set1;
-
-    ANVIterator it = anv_hashmap_iterator(smaller->map);
-    while (it.has_next(&it))
+    for (size_t i = 0; i < smaller->capacity; i++)
     {
-        const ANVPair* pair = it.get(&it);
+        if (smaller->ctrl[i] < 0)
+        {
+            continue;
+        }
 
-        if (pair && anv_hashset_contains(larger, pair->first))
+        // Keys of one set are distinct, so they go in without a duplicate check
+        void* key = smaller->keys[i];
+        const size_t hash = hash_key(result, key);
+        if (contains_hashed(larger, result, key, hash) && insert_new(result, key, hash) != 0)
         {
-            if (anv_hashset_add(result, pair->first) != 0)
-            {
-                it.destroy(&it);
-                anv_hashset_destroy(result, false);
-                return NULL;
-            }
+            anv_hashset_destroy(result, false);
+            return NULL;
         }
-        it.next(&it);
     }
-    it.destroy(&it);
 
     return result;
 }
 
 ANV_API ANVHashSet* anv_hashset_difference(const ANVHashSet* set1, const ANVHashSet* set2)
 {
-    if (!set1 || !set1->map)
+    if (!set1)
     {
         return NULL;
     }
 
-    // Create result set
-    ANVHashSet* result = anv_hashset_create(set1->map->alloc, set1->map->hash,
-                                            set1->map->key_equals, 0);
+    ANVHashSet* result = create_like(set1, set1->size);
     if (!result)
     {
         return NULL;
     }
 
     // Add elements from set1 that are not in set2
-    ANVIterator it = anv_hashmap_iterator(set1->map);
-    while (it.has_next(&it))
+    for (size_t i = 0; i < set1->capacity; i++)
     {
-        const ANVPair* pair = it.get(&it);
-        if (pair && (!set2 || !set2->map || !anv_hashset_contains(set2, pair->first)))
+        if (set1->ctrl[i] < 0)
         {
-            if (anv_hashset_add(result, pair->first) != 0)
-            {
-                it.destroy(&it);
-                anv_hashset_destroy(result, false);
-                return NULL;
-            }
+            continue;
+        }
+
+        void* key = set1->keys[i];
+        const size_t hash = hash_key(set1, key);
+        if ((!set2 || !contains_hashed(set2, set1, key, hash)) && insert_new(result, key, hash) != 0)
+        {
+            anv_hashset_destroy(result, false);
+            return NULL;
         }
-        it.next(&it);
     }
-    it.destroy(&it);
 
     return result;
 }
 
-ANV_API int anv_hashset_is_subset(const ANVHashSet* subset, const ANVHashSet* superset)
+ANV_API int anv_hashset_union_into(ANVHashSet* dest, const ANVHashSet* src)
 {
-    if (!subset || !subset->map || !superset || !superset->map)
+    if (!dest || !src)
     {
-        return 0;
+        return -1;
     }
 
-    // Empty set is subset of any set
-    if (anv_hashset_is_empty(subset))
+    if (dest == src)
     {
-        return 1;
+        return 0;
     }
 
-    // Check if all elements of subset are in superset
-    ANVIterator it = anv_hashmap_iterator(subset->map);
-    while (it.has_next(&it))
+    // Size for disjoint operands up front, like anv_hashset_union, so the
+    // table rehashes at most once
+    if (src->size > SIZE_MAX - dest->size || anv_hashset_reserve(dest, dest->size + src->size) != 0)
     {
-        const ANVPair* pair = it.get(&it);
+        return -1;
+    }
 
-        if (pair && !anv_hashset_contains(superset, pair->first))
+    for (size_t i = 0; i < src->capacity; i++)
+    {
+        if (src->ctrl[i] >= 0 && insert(dest, src->keys[i], NULL) != 0)
         {
-            it.destroy(&it);
-            return 0;
+            return -1;
         }
-        it.next(&it);
     }
-    it.destroy(&it);
 
-    return 1;
+    return 0;
 }
 
-//==============================================================================
-// Bulk operations
-//==============================================================================
-
-ANV_API int anv_hashset_get_elements(const ANVHashSet* set, void*** keys_out, size_t* count_out)
+ANV_API size_t anv_hashset_retain_all(ANVHashSet* set, const ANVHashSet* other, const bool should_free_keys)
 {
-    if (!set || !set->map)
+    if (!set)
     {
-        return -1;
+        return 0;
     }
 
-    return anv_hashmap_get_keys(set->map, keys_out, count_out);
-}
-
-ANV_API void anv_hashset_for_each(const ANVHashSet* set, void (*action)(void* key))
-{
-    if (!set || !set->map || !action)
+    // Slots never move on erase, so the table can be filtered in one pass
+    size_t removed = 0;
+    for (size_t i = 0; i < set->capacity; i++)
     {
-        return;
-    }
+        if (set->ctrl[i] < 0)
+        {
+            continue;
+        }
 
-    g_hashset_action = action;
-    anv_hashmap_for_each(set->map, hashset_action_wrapper);
-    g_hashset_action = NULL; // Reset after use
+        void* key = set->keys[i];
+        if (other && other->size > 0 && contains_hashed(other, set, key, hash_key(set, key)))
+        {
+            continue;
+        }
+
+        erase_slot(set, i);
+        removed++;
+        if (should_free_keys && key)
+        {
+            anv_alloc_data_free(set->alloc, key);
+        }
+    }
+
+    return removed;
+}
+
+ANV_API int anv_hashset_is_subset(const ANVHashSet* subset, const ANVHashSet* superset)
+{
+    if (!subset || !superset)
+    {
+        return 0;
+    }
+
+    // A larger set cannot be a subset
+    if (subset->size > superset->size)
+    {
+        return 0;
+    }
+
+    // Check if all elements of subset are in superset
+    for (size_t i = 0; i < subset->capacity; i++)
+    {
+        if (subset->ctrl[i] >= 0 && !anv_hashset_contains(superset, subset->keys[i]))
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+//==============================================================================
+// Bulk operations
+//==============================================================================
+
+ANV_API int anv_hashset_get_elements(const ANVHashSet* set, void*** keys_out, size_t* count_out)
+{
+    if (!set || !keys_out || !count_out)
+    {
+        return -1;
+    }
+
+    if (set->size == 0)
+    {
+        *keys_out = NULL;
+        *count_out = 0;
+        return 0;
+    }
+
+    void** keys = anv_alloc_malloc(set->alloc, set->size * sizeof(void*));
+    if (!keys)
+    {
+        return -1;
+    }
+
+    size_t key_index = 0;
+    for (size_t i = 0; i < set->capacity; i++)
+    {
+        if (set->ctrl[i] >= 0)
+        {
+            keys[key_index++] = set->keys[i];
+        }
+    }
+
+    *keys_out = keys;
+    *count_out = set->size;
+    return 0;
+}
+
+ANV_API void anv_hashset_for_each(const ANVHashSet* set, void (*action)(void* key))
+{
+    if (!set || !action)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < set->capacity; i++)
+    {
+        if (set->ctrl[i] >= 0)
+        {
+            action(set->keys[i]);
+        }
+    }
 }
 
 //==============================================================================
@@ -399,74 +771,69 @@ ANV_API void anv_hashset_for_each(const ANVHashSet* set, void (*action)(void* ke
 
 ANV_API ANVHashSet* anv_hashset_copy(const ANVHashSet* set)
 {
-    if (!set || !set->map)
+    if (!set)
     {
         return NULL;
     }
 
-    ANVHashSet* copy = anv_hashset_create(set->map->alloc, set->map->hash,
-                                          set->map->key_equals, set->map->bucket_count);
+    ANVHashSet* copy = anv_alloc_malloc(set->alloc, sizeof(ANVHashSet));
     if (!copy)
     {
         return NULL;
     }
 
-    // Copy all elements
-    ANVIterator it = anv_hashmap_iterator(set->map);
-    while (it.has_next(&it))
+    *copy = *set;
+    if (allocate_table(copy, set->capacity) != 0)
     {
-        const ANVPair* pair = it.get(&it);
-
-        if (pair && anv_hashset_add(copy, pair->first) != 0)
-        {
-            it.destroy(&it);
-            anv_hashset_destroy(copy, false);
-            return NULL;
-        }
-        it.next(&it);
+        anv_alloc_free_sized(set->alloc, copy, sizeof(ANVHashSet));
+        return NULL;
     }
-    it.destroy(&it);
 
+    // Same hash function and capacity, so the table copies as-is
+    memcpy(copy->keys, set->keys, table_bytes(set->capacity));
+    copy->growth_left = set->growth_left;
+    copy->resize_count = 0;
+    copy->rehash_nanos = 0;
     return copy;
 }
 
 ANV_API ANVHashSet* anv_hashset_copy_deep(const ANVHashSet* set, const copy_func key_copy)
 {
-    if (!set || !set->map)
+    if (!set)
     {
         return NULL;
     }
 
-    ANVHashSet* copy = anv_hashset_create(set->map->alloc, set->map->hash,
-                                          set->map->key_equals, set->map->bucket_count);
-    if (!copy)
+    ANVHashSet* copy = anv_hashset_copy(set);
+    if (!copy || !key_copy)
     {
-        return NULL;
+        return copy;
     }
 
-    // Copy all elements with deep copying of keys
-    ANVIterator it = anv_hashmap_iterator(set->map);
-    while (it.has_next(&it))
+    // Replace each key in place; slot positions depend only on the hash
+    for (size_t i = 0; i < copy->capacity; i++)
     {
-        const ANVPair* pair = it.get(&it);
+        if (copy->ctrl[i] < 0)
+        {
+            continue;
+        }
 
-        if (pair)
+        void* copied_key = key_copy(set->keys[i]);
+        if (!copied_key)
         {
-            void* copied_key = key_copy ? key_copy(pair->first) : pair->first;
-            if ((key_copy && !copied_key) || anv_hashset_add(copy, copied_key) != 0)
+            // Free the keys copied so far, then drop the rest of the table
+            for (size_t j = 0; j < i; j++)
             {
-                if (key_copy && copied_key)
+                if (copy->ctrl[j] >= 0)
                 {
-                    anv_alloc_data_free(set->map->alloc, copied_key);
+                    anv_alloc_data_free(copy->alloc, copy->keys[j]);
                 }
-                it.destroy(&it);
-                anv_hashset_destroy(copy, key_copy != NULL);
-                return NULL;
             }
+            anv_hashset_destroy(copy, false);
+            return NULL;
         }
-        it.next(&it);
+        copy->keys[i] = copied_key;
     }
-    it.destroy(&it);
 
     return copy;
 }
@@ -475,12 +842,10 @@ ANV_API ANVHashSet* anv_hashset_copy_deep(const ANVHashSet* set, const copy_func
 // Iterator implementation
 //==============================================================================
 
-// HashSet iterator state - wraps HashMap iterator but only returns keys
 typedef struct HashSetIteratorState
 {
-    ANVIterator map_iterator; // Underlying HashMap iterator
-    void* current_key;        // Current key to return
-    ANVAllocator* alloc;      // Allocator for freeing this state
+    const ANVHashSet* set;
+    size_t index; // Current full slot, or capacity when exhausted
 } HashSetIteratorState;
 
 static void* hashset_iterator_get(const ANVIterator* it)
@@ -490,19 +855,12 @@ static void* hashset_iterator_get(const ANVIterator* it)
         return NULL;
     }
 
-    HashSetIteratorState* state = it->data_state;
-
-    // If we don't have a current key, try to get one from the underlying iterator
-    if (!state->current_key && state->map_iterator.has_next(&state->map_iterator))
+    const HashSetIteratorState* state = it->data_state;
+    if (state->index >= state->set->capacity)
     {
-        const ANVPair* pair = state->map_iterator.get(&state->map_iterator);
-        if (pair)
-        {
-            state->current_key = pair->first;
-        }
+        return NULL;
     }
-
-    return state->current_key;
+    return state->set->keys[state->index];
 }
 
 static int hashset_iterator_has_next(const ANVIterator* it)
@@ -513,7 +871,7 @@ static int hashset_iterator_has_next(const ANVIterator* it)
     }
 
     const HashSetIteratorState* state = it->data_state;
-    return state->map_iterator.has_next(&state->map_iterator);
+    return state->index < state->set->capacity;
 }
 
 static int hashset_iterator_next(const ANVIterator* it)
@@ -524,14 +882,13 @@ static int hashset_iterator_next(const ANVIterator* it)
     }
 
     HashSetIteratorState* state = it->data_state;
+    if (state->index >= state->set->capacity)
+    {
+        return -1;
+    }
 
-    // Advance the underlying iterator
-    const int result = state->map_iterator.next(&state->map_iterator);
-
-    // Clear current key so next get() will fetch the new one
-    state->current_key = NULL;
-
-    return result;
+    state->index = next_full_slot(state->set, state->index + 1);
+    return 0;
 }
 
 static int hashset_iterator_has_prev(const ANVIterator* it)
@@ -554,19 +911,12 @@ static void hashset_iterator_reset(const ANVIterator* it)
     }
 
     HashSetIteratorState* state = it->data_state;
-    state->map_iterator.reset(&state->map_iterator);
-    state->current_key = NULL;
+    state->index = next_full_slot(state->set, 0);
 }
 
 static int hashset_iterator_is_valid(const ANVIterator* it)
 {
-    if (!it || !it->data_state)
-    {
-        return 0;
-    }
-
-    const HashSetIteratorState* state = it->data_state;
-    return state->map_iterator.is_valid(&state->map_iterator);
+    return it && it->data_state != NULL;
 }
 
 static void hashset_iterator_destroy(ANVIterator* it)
@@ -577,11 +927,7 @@ static void hashset_iterator_destroy(ANVIterator* it)
     }
 
     HashSetIteratorState* state = it->data_state;
-    state->map_iterator.destroy(&state->map_iterator);
-
-    // Free the state using the stored allocator
-    anv_alloc_free(state->alloc, state);
-
+    anv_alloc_free_sized(state->set->alloc, state, sizeof(HashSetIteratorState));
     it->data_state = NULL;
 }
 
@@ -636,7 +982,7 @@ ANV_API ANVIterator anv_hashset_iterator(const ANVHashSet* set)
 {
     ANVIterator it = {0};
 
-    if (!set || !set->map)
+    if (!set)
     {
         // Return iterator with safe stub functions
         it.get = invalid_iterator_get;
@@ -660,17 +1006,16 @@ ANV_API ANVIterator anv_hashset_iterator(const ANVHashSet* set)
     it.is_valid = hashset_iterator_is_valid;
     it.destroy = hashset_iterator_destroy;
 
-    HashSetIteratorState* state = anv_alloc_malloc(set->map->alloc, sizeof(HashSetIteratorState));
+    HashSetIteratorState* state = anv_alloc_malloc(set->alloc, sizeof(HashSetIteratorState));
     if (!state)
     {
         return it;
     }
 
-    state->map_iterator = anv_hashmap_iterator(set->map);
-    state->current_key = NULL;
-    state->alloc = set->map->alloc; // Set the allocator reference
+    state->set = set;
+    state->index = next_full_slot(set, 0);
 
-    it.alloc = set->map->alloc;
+    it.alloc = set->alloc;
     it.data_state = state;
     return it;
 }
@@ -742,4 +1087,630 @@ ANV_API ANVHashSet* anv_hashset_from_iterator(ANVIterator* it, ANVAllocator* all
     }
 
     return set;
-}
\ No newline at end of file
+}
+#ifdef ANVIL_WITH_SYSTEM
+
+//==============================================================================
+// Parallel operations
+//==============================================================================
+
+// Fewest result keys worth handing to one worker thread
+#define PARALLEL_MIN_KEYS_PER_THREAD 4096
+
+/**
+ * Key and its hash, staged between the partition and insert passes.
+ */
+typedef struct BuildEntry
+{
+    void* key;
+    size_t hash;
+} BuildEntry;
+
+/**
+ * A contiguous range of source slots, handled by one worker.
+ */
+typedef struct BuildSlice
+{
+    void* const* keys;   // Source keys
+    const int8_t* ctrl;  // Source control bytes, or NULL when every key is present
+    size_t begin;        // First source index
+    size_t end;          // One past the last source index
+    BuildEntry* entries; // Surviving keys, grouped by partition
+    size_t count;        // Number of entries
+} BuildSlice;
+
+/**
+ * State shared by the workers of one parallel build.
+ *
+ * The result table is split into contiguous ranges of groups, one per
+ * partition, and a key belongs to the partition holding its home group.
+ * Each partition is filled by exactly one worker, which never writes outside
+ * its range, so no locks are needed. A key whose probe sequence leaves the
+ * range is left over and inserted serially once the workers are done.
+ */
+typedef struct ParallelBuild
+{
+    ANVHashSet* result;       // Table being built
+    const ANVHashSet* probe;  // Set filtering the source keys, or NULL to keep all
+    bool keep_found;          // Keep keys found in probe (intersection) or not (difference)
+    bool dedupe;              // Whether source keys may repeat
+    bool owns_keys;           // Whether duplicate keys must be freed
+    BuildSlice* slices;       // Source ranges, in priority order for duplicates
+    size_t slice_count;       // Number of slices
+    size_t threads;           // Number of workers
+    size_t partitions;        // Number of result ranges
+    size_t group_bits;        // log2 of the result group count
+    size_t* counts;           // Entries per (slice, partition)
+    size_t* leftover;         // Entries left for the serial pass per (slice, partition)
+    size_t* inserted;         // Keys placed per partition
+} ParallelBuild;
+
+typedef struct BuildWorker
+{
+    ParallelBuild* build;
+    size_t first; // Index of the first slice or partition this worker handles
+} BuildWorker;
+
+static size_t partition_of(const ParallelBuild* build, const size_t hash)
+{
+    return (hash_group(build->result, hash) * build->partitions) >> build->group_bits;
+}
+
+/**
+ * First group of a partition; partition p owns [start(p), start(p + 1)).
+ */
+static size_t partition_start(const ParallelBuild* build, const size_t partition)
+{
+    const size_t groups = (size_t)1 << build->group_bits;
+    return (partition * groups + build->partitions - 1) / build->partitions;
+}
+
+/**
+ * Run func on count workers, the first on the calling thread. A worker whose
+ * thread cannot be started runs inline instead.
+ */
+static void run_workers(void* (*func)(void*), ParallelBuild* build, const size_t count)
+{
+    BuildWorker workers[ANV_HASHSET_MAX_THREADS] = {{NULL, 0}};
+    ANVThread threads[ANV_HASHSET_MAX_THREADS];
+    bool started[ANV_HASHSET_MAX_THREADS] = {false};
+
+    for (size_t i = 0; i < count; i++)
+    {
+        workers[i].build = build;
+        workers[i].first = i;
+    }
+    for (size_t i = 1; i < count; i++)
+    {
+        started[i] = anv_thread_create(&threads[i], func, &workers[i]) == 0;
+        if (!started[i])
+        {
+            func(&workers[i]);
+        }
+    }
+
+    func(&workers[0]);
+
+    for (size_t i = 1; i < count; i++)
+    {
+        if (started[i])
+        {
+            anv_thread_join(threads[i], NULL);
+        }
+    }
+}
+
+/**
+ * Pass 1: count the keys present in each slice, to size the entry buffers.
+ */
+static void* count_slices(void* arg)
+{
+    const BuildWorker* worker = arg;
+    const ParallelBuild* build = worker->build;
+
+    for (size_t s = worker->first; s < build->slice_count; s += build->threads)
+    {
+        BuildSlice* slice = &build->slices[s];
+        if (!slice->ctrl)
+        {
+            slice->count = slice->end - slice->begin;
+            continue;
+        }
+
+        size_t count = 0;
+        for (size_t i = slice->begin; i < slice->end; i++)
+        {
+            count += slice->ctrl[i] >= 0;
+        }
+        slice->count = count;
+    }
+    return NULL;
+}
+
+/**
+ * Pass 2: hash and filter each slice, then group its entries by partition
+ * in place (one American flag sort pass).
+ */
+static void* partition_slices(void* arg)
+{
+    const BuildWorker* worker = arg;
+    const ParallelBuild* build = worker->build;
+    const ANVHashSet* result = build->result;
+    const size_t partitions = build->partitions;
+
+    for (size_t s = worker->first; s < build->slice_count; s += build->threads)
+    {
+        BuildSlice* slice = &build->slices[s];
+        size_t* counts = build->counts + s * partitions;
+        size_t count = 0;
+
+        for (size_t i = slice->begin; i < slice->end; i++)
+        {
+            if (slice->ctrl && slice->ctrl[i] < 0)
+            {
+                continue;
+            }
+
+            void* key = slice->keys[i];
+            const size_t hash = hash_key(result, key);
+            if (build->probe && contains_hashed(build->probe, result, key, hash) != build->keep_found)
+            {
+                continue;
+            }
+
+            slice->entries[count].key = key;
+            slice->entries[count].hash = hash;
+            counts[partition_of(build, hash)]++;
+            count++;
+        }
+        slice->count = count;
+
+        size_t next[ANV_HASHSET_MAX_THREADS];
+        size_t end[ANV_HASHSET_MAX_THREADS];
+        size_t offset = 0;
+        for (size_t p = 0; p < partitions; p++)
+        {
+            next[p] = offset;
+            offset += counts[p];
+            end[p] = offset;
+        }
+
+        // Swap each misplaced entry straight into its partition's next free spot
+        BuildEntry* entries = slice->entries;
+        for (size_t p = 0; p < partitions; p++)
+        {
+            while (next[p] < end[p])
+            {
+                BuildEntry entry = entries[next[p]];
+                size_t target = partition_of(build, entry.hash);
+                while (target != p)
+                {
+                    const BuildEntry displaced = entries[next[target]];
+                    entries[next[target]++] = entry;
+                    entry = displaced;
+                    target = partition_of(build, entry.hash);
+                }
+                entries[next[p]++] = entry;
+            }
+        }
+    }
+    return NULL;
+}
+
+typedef enum
+{
+    PLACE_INSERTED,
+    PLACE_DUPLICATE,
+    PLACE_DEFERRED
+} PlaceResult;
+
+/**
+ * Insert an entry into a fresh table without leaving groups [lo, hi).
+ * The table has no tombstones, so the first group with a free slot ends the
+ * probe sequence.
+ */
+static PlaceResult place_in_range(ANVHashSet* set, const BuildEntry* entry, const bool dedupe,
+                                  const size_t lo, const size_t hi)
+{
+    const size_t group_mask = set->capacity / GROUP_WIDTH - 1;
+    const int8_t tag = hash_tag(entry->hash);
+    size_t group = hash_group(set, entry->hash);
+
+    for (size_t step = 0;;)
+    {
+        if (group < lo || group >= hi)
+        {
+            return PLACE_DEFERRED;
+        }
+
+        int8_t* ctrl = set->ctrl + group * GROUP_WIDTH;
+        if (dedupe)
+        {
+            uint32_t match = group_match(ctrl, tag);
+            while (match)
+            {
+                if (set->key_equals(set->keys[group * GROUP_WIDTH + lowest_bit(match)], entry->key))
+                {
+                    return PLACE_DUPLICATE;
+                }
+                match &= match - 1;
+            }
+        }
+
+        const uint32_t free_mask = group_match_free(ctrl);
+        if (free_mask)
+        {
+            const size_t index = group * GROUP_WIDTH + lowest_bit(free_mask);
+            set->ctrl[index] = tag;
+            set->keys[index] = entry->key;
+            return PLACE_INSERTED;
+        }
+        group = (group + ++step) & group_mask;
+    }
+}
+
+/**
+ * Pass 3: fill each partition's range from every slice, moving leftover
+ * entries to the front of their slice run. Owned duplicates are left over
+ * too, so the calling thread can free them.
+ */
+static void* insert_partitions(void* arg)
+{
+    const BuildWorker* worker = arg;
+    ParallelBuild* build = worker->build;
+    const size_t partitions = build->partitions;
+
+    for (size_t p = worker->first; p < partitions; p += build->threads)
+    {
+        const size_t lo = partition_start(build, p);
+        const size_t hi = partition_start(build, p + 1);
+        size_t inserted = 0;
+
+        for (size_t s = 0; s < build->slice_count; s++)
+        {
+            const size_t* counts = build->counts + s * partitions;
+            size_t offset = 0;
+            for (size_t q = 0; q < p; q++)
+            {
+                offset += counts[q];
+            }
+
+            BuildEntry* run = build->slices[s].entries + offset;
+            size_t leftover = 0;
+            for (size_t i = 0; i < counts[p]; i++)
+            {
+                const PlaceResult placed = place_in_range(build->result, &run[i], build->dedupe, lo, hi);
+                if (placed == PLACE_INSERTED)
+                {
+                    inserted++;
+                }
+                else if (placed == PLACE_DEFERRED || build->owns_keys)
+                {
+                    run[leftover++] = run[i];
+                }
+            }
+            build->leftover[s * partitions + p] = leftover;
+        }
+        build->inserted[p] = inserted;
+    }
+    return NULL;
+}
+
+/**
+ * Number of workers for a result of expected_size keys.
+ */
+static size_t worker_count(const size_t requested, const size_t expected_size)
+{
+    size_t threads = requested < ANV_HASHSET_MAX_THREADS ? requested : ANV_HASHSET_MAX_THREADS;
+    const size_t useful = expected_size / PARALLEL_MIN_KEYS_PER_THREAD;
+    if (threads > useful)
+    {
+        threads = useful;
+    }
+    return threads > 0 ? threads : 1;
+}
+
+/**
+ * Fill an empty result, presized for every source key, from the given slices
+ * across threads workers. Fails only before any key is placed, returning -1
+ * and leaving result empty. When owns_keys is set, duplicate keys are freed.
+ */
+static int parallel_build(ANVHashSet* result, BuildSlice* slices, const size_t slice_count,
+                          const ANVHashSet* probe, const bool keep_found, const bool dedupe,
+                          const bool owns_keys, const size_t threads)
+{
+    ParallelBuild build = {
+        .result = result,
+        .probe = probe,
+        .keep_found = keep_found,
+        .dedupe = dedupe,
+        .owns_keys = owns_keys,
+        .slices = slices,
+        .slice_count = slice_count,
+        .threads = threads,
+    };
+
+    const size_t groups = result->capacity / GROUP_WIDTH;
+    build.partitions = threads < groups ? threads : groups;
+    while (((size_t)1 << build.group_bits) < groups)
+    {
+        build.group_bits++;
+    }
+
+    ANVAllocator* alloc = result->alloc;
+    const size_t table_count = slice_count * build.partitions * 2 + build.partitions;
+    size_t* tables = anv_alloc_malloc(alloc, table_count * sizeof(size_t));
+    if (!tables)
+    {
+        return -1;
+    }
+    memset(tables, 0, table_count * sizeof(size_t));
+    build.counts = tables;
+    build.leftover = build.counts + slice_count * build.partitions;
+    build.inserted = build.leftover + slice_count * build.partitions;
+
+    // One entry buffer for all slices, carved up by the pass 1 counts
+    run_workers(count_slices, &build, threads);
+    size_t total = 0;
+    for (size_t s = 0; s < slice_count; s++)
+    {
+        total += slices[s].count;
+    }
+    BuildEntry* entries = anv_alloc_malloc(alloc, (total > 0 ? total : 1) * sizeof(BuildEntry));
+    if (!entries)
+    {
+        anv_alloc_free_sized(alloc, tables, table_count * sizeof(size_t));
+        return -1;
+    }
+    BuildEntry* cursor = entries;
+    for (size_t s = 0; s < slice_count; s++)
+    {
+        slices[s].entries = cursor;
+        cursor += slices[s].count;
+    }
+
+    run_workers(partition_slices, &build, threads);
+    run_workers(insert_partitions, &build, build.partitions < threads ? build.partitions : threads);
+
+    for (size_t p = 0; p < build.partitions; p++)
+    {
+        result->size += build.inserted[p];
+    }
+    result->growth_left -= result->size;
+
+    // Pass 4: the few keys whose probe crossed a partition boundary. The
+    // table was sized for every entry, so insert_new never has to grow it.
+    for (size_t s = 0; s < slice_count; s++)
+    {
+        const size_t* counts = build.counts + s * build.partitions;
+        const BuildEntry* run = slices[s].entries;
+        for (size_t p = 0; p < build.partitions; p++)
+        {
+            for (size_t i = 0; i < build.leftover[s * build.partitions + p]; i++)
+            {
+                if (dedupe && find_slot(result, run[i].key, run[i].hash) != NOT_FOUND)
+                {
+                    if (owns_keys)
+                    {
+                        anv_alloc_data_free(alloc, run[i].key);
+                    }
+                    continue;
+                }
+                insert_new(result, run[i].key, run[i].hash);
+            }
+            run += counts[p];
+        }
+    }
+
+    anv_alloc_free_sized(alloc, entries, (total > 0 ? total : 1) * sizeof(BuildEntry));
+    anv_alloc_free_sized(alloc, tables, table_count * sizeof(size_t));
+    return 0;
+}
+
+/**
+ * Run parallel_build, destroying result on failure.
+ */
+static ANVHashSet* finish_build(ANVHashSet* result, BuildSlice* slices, const size_t slice_count,
+                                const ANVHashSet* probe, const bool keep_found, const bool dedupe,
+                                const size_t threads)
+{
+    if (parallel_build(result, slices, slice_count, probe, keep_found, dedupe, false, threads) != 0)
+    {
+        anv_hashset_destroy(result, false);
+        return NULL;
+    }
+    return result;
+}
+
+/**
+ * Split a set's slot array into count equal ranges.
+ */
+static void slice_set(const ANVHashSet* set, BuildSlice* slices, const size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        slices[i].keys = set->keys;
+        slices[i].ctrl = set->ctrl;
+        slices[i].begin = set->capacity * i / count;
+        slices[i].end = set->capacity * (i + 1) / count;
+    }
+}
+
+ANV_API ANVHashSet* anv_hashset_union_parallel(const ANVHashSet* set1, const ANVHashSet* set2,
+                                               const size_t num_threads)
+{
+    if (!set1 || !set2)
+    {
+        return NULL;
+    }
+
+    ANVHashSet* result = create_like(set1, set1->size + set2->size);
+    if (!result)
+    {
+        return NULL;
+    }
+
+    // All of set1's slices come first, so its keys win over equal keys in set2
+    const size_t threads = worker_count(num_threads, set1->size + set2->size);
+    BuildSlice slices[ANV_HASHSET_MAX_THREADS * 2];
+    slice_set(set1, slices, threads);
+    slice_set(set2, slices + threads, threads);
+
+    return finish_build(result, slices, threads * 2, NULL, false, true, threads);
+}
+
+ANV_API ANVHashSet* anv_hashset_intersection_parallel(const ANVHashSet* set1, const ANVHashSet* set2,
+                                                      const size_t num_threads)
+{
+    if (!set1 || !set2)
+    {
+        return NULL;
+    }
+
+    const ANVHashSet* smaller = set1->size <= set2->size ? set1 : set2;
+    const ANVHashSet* larger = (smaller == set1) ? set2 : set1;
+
+    ANVHashSet* result = create_like(set1, smaller->size);
+    if (!result)
+    {
+        return NULL;
+    }
+
+    const size_t threads = worker_count(num_threads, smaller->size);
+    BuildSlice slices[ANV_HASHSET_MAX_THREADS];
+    slice_set(smaller, slices, threads);
+
+    return finish_build(result, slices, threads, larger, true, false, threads);
+}
+
+ANV_API ANVHashSet* anv_hashset_difference_parallel(const ANVHashSet* set1, const ANVHashSet* set2,
+                                                    const size_t num_threads)
+{
+    if (!set1)
+    {
+        return NULL;
+    }
+
+    ANVHashSet* result = create_like(set1, set1->size);
+    if (!result)
+    {
+        return NULL;
+    }
+
+    const size_t threads = worker_count(num_threads, set1->size);
+    BuildSlice slices[ANV_HASHSET_MAX_THREADS];
+    slice_set(set1, slices, threads);
+
+    return finish_build(result, slices, threads, set2, false, false, threads);
+}
+
+/**
+ * Free the key buffer gathered by anv_hashset_from_iterator_parallel, and the
+ * key copies in it.
+ */
+static void release_gathered(const ANVAllocator* alloc, void** keys, const size_t count,
+                             const size_t capacity, const bool should_copy)
+{
+    if (should_copy)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            anv_alloc_data_free(alloc, keys[i]);
+        }
+    }
+    anv_alloc_free_sized(alloc, keys, capacity * sizeof(void*));
+}
+
+ANV_API ANVHashSet* anv_hashset_from_iterator_parallel(ANVIterator* it, ANVAllocator* alloc,
+                                                       const hash_func hash, const key_equals_func key_equals,
+                                                       const bool should_copy, const size_t num_threads)
+{
+    if (!it || !alloc || !hash || !key_equals)
+    {
+        return NULL;
+    }
+    if (should_copy && !alloc->copy)
+    {
+        return NULL; // Can't copy without copy function
+    }
+
+    if (!it->is_valid || !it->is_valid(it))
+    {
+        return NULL;
+    }
+
+    // The iterator can only be walked serially, so gather (and copy) its
+    // keys first. Iterators may reuse the pointer they return, which is why
+    // copies cannot wait for the parallel passes.
+    size_t count = 0;
+    size_t capacity = DEFAULT_INITIAL_CAPACITY;
+    void** keys = anv_alloc_malloc(alloc, capacity * sizeof(void*));
+    if (!keys)
+    {
+        return NULL;
+    }
+
+    while (it->has_next(it))
+    {
+        void* key = it->get(it);
+        if (key)
+        {
+            if (count == capacity)
+            {
+                void** grown = capacity > SIZE_MAX / 2 / sizeof(void*)
+                                   ? NULL
+                                   : anv_alloc_realloc(alloc, keys, capacity * sizeof(void*),
+                                                       capacity * 2 * sizeof(void*));
+                if (!grown)
+                {
+                    release_gathered(alloc, keys, count, capacity, should_copy);
+                    return NULL;
+                }
+                keys = grown;
+                capacity *= 2;
+            }
+
+            keys[count] = should_copy ? alloc->copy(key) : key;
+            if (!keys[count])
+            {
+                release_gathered(alloc, keys, count, capacity, should_copy);
+                return NULL;
+            }
+            count++;
+        }
+
+        if (it->next(it) != 0)
+        {
+            break; // Iterator done or failed
+        }
+    }
+
+    ANVHashSet* result = anv_hashset_create(alloc, hash, key_equals, count);
+    if (!result)
+    {
+        release_gathered(alloc, keys, count, capacity, should_copy);
+        return NULL;
+    }
+
+    const size_t threads = worker_count(num_threads, count);
+    BuildSlice slices[ANV_HASHSET_MAX_THREADS];
+    for (size_t i = 0; i < threads; i++)
+    {
+        slices[i].keys = keys;
+        slices[i].ctrl = NULL;
+        slices[i].begin = count * i / threads;
+        slices[i].end = count * (i + 1) / threads;
+    }
+
+    if (parallel_build(result, slices, threads, NULL, false, true, should_copy, threads) != 0)
+    {
+        anv_hashset_destroy(result, false);
+        release_gathered(alloc, keys, count, capacity, should_copy);
+        return NULL;
+    }
+
+    anv_alloc_free_sized(alloc, keys, capacity * sizeof(void*));
+    return result;
+}
+
+#endif // ANVIL_WITH_SYSTEM
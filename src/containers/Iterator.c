@@ -163,7 +163,7 @@ static void transform_destroy(ANVIterator* it)
     // Free cached result if it exists
     if (state->cached_result && state->transform_allocates)
     {
-        anv_alloc_free(it->alloc, state->cached_result);
+        anv_alloc_data_free(it->alloc, state->cached_result);
     }
 
     // Destroy base iterator
@@ -172,7 +172,7 @@ static void transform_destroy(ANVIterator* it)
         state->base_iterator->destroy(state->base_iterator);
     }
 
-    anv_alloc_free(it->alloc, state);
+    anv_alloc_free_sized(it->alloc, state, sizeof(TransformState));
     it->data_state = NULL;
 }
 
@@ -396,7 +396,7 @@ static void filter_destroy(ANVIterator* it)
         state->base_iterator->destroy(state->base_iterator);
     }
 
-    anv_alloc_free(it->alloc, state);
+    anv_alloc_free_sized(it->alloc, state, sizeof(FilterState));
     it->data_state = NULL;
 }
 
@@ -613,7 +613,7 @@ static void range_destroy(ANVIterator* it)
         return;
     }
 
-    anv_alloc_free(it->alloc, it->data_state);
+    anv_alloc_free_sized(it->alloc, it->data_state, sizeof(RangeState));
     it->data_state = NULL;
 }
 
@@ -798,7 +798,7 @@ static void copy_destroy(ANVIterator* it)
         state->base_iterator->destroy(state->base_iterator);
     }
 
-    anv_alloc_free(it->alloc, state);
+    anv_alloc_free_sized(it->alloc, state, sizeof(CopyState));
     it->data_state = NULL;
 }
 
@@ -975,7 +975,7 @@ static void take_destroy(ANVIterator* it)
         state->base_iterator->destroy(state->base_iterator);
     }
 
-    anv_alloc_free(it->alloc, state);
+    anv_alloc_free_sized(it->alloc, state, sizeof(TakeState));
     it->data_state = NULL;
 }
 
@@ -1159,7 +1159,7 @@ static void skip_destroy(ANVIterator* it)
         state->base_iterator->destroy(state->base_iterator);
     }
 
-    anv_alloc_free(it->alloc, state);
+    anv_alloc_free_sized(it->alloc, state, sizeof(SkipState));
     it->data_state = NULL;
 }
 
@@ -1363,8 +1363,8 @@ static void zip_destroy(ANVIterator* it)
         state->iter2->destroy(state->iter2);
     }
 
-    anv_alloc_free(it->alloc, state->cached_pair);
-    anv_alloc_free(it->alloc, state);
+    anv_alloc_free_sized(it->alloc, state->cached_pair, sizeof(ANVPair));
+    anv_alloc_free_sized(it->alloc, state, sizeof(ZipState));
     it->data_state = NULL;
 }
 
@@ -1398,7 +1398,7 @@ ANV_API ANVIterator anv_iterator_zip(ANVIterator* it1, ANVIterator* it2, const A
     state->cached_pair = anv_pair_create((ANVAllocator*)alloc, NULL, NULL);
     if (!state->cached_pair)
     {
-        anv_alloc_free(alloc, state);
+        anv_alloc_free_sized(alloc, state, sizeof(ZipState));
         return new_it;
     }
 
@@ -1552,7 +1552,7 @@ static void enumerate_destroy(ANVIterator* it)
         state->base_iterator->destroy(state->base_iterator);
     }
 
-    anv_alloc_free(it->alloc, state);
+    anv_alloc_free_sized(it->alloc, state, sizeof(EnumerateState));
     it->data_state = NULL;
 }
 
@@ -1709,7 +1709,7 @@ static void repeat_destroy(ANVIterator* it)
     }
 
     // Note: We don't free the value pointer since we don't own it
-    anv_alloc_free(it->alloc, it->data_state);
+    anv_alloc_free_sized(it->alloc, it->data_state, sizeof(RepeatState));
     it->data_state = NULL;
 }
 
@@ -1913,10 +1913,10 @@ static void chain_destroy(ANVIterator* it)
                 current_it->destroy(current_it);
             }
         }
-        anv_alloc_free(it->alloc, state->iterators);
+        anv_alloc_free_sized(it->alloc, state->iterators, sizeof(ANVIterator) * state->iterator_count);
     }
 
-    anv_alloc_free(it->alloc, state);
+    anv_alloc_free_sized(it->alloc, state, sizeof(ChainState));
     it->data_state = NULL;
 }
 
@@ -1951,7 +1951,7 @@ ANV_API ANVIterator anv_iterator_chain(ANVIterator* iterators, const size_t iter
     state->iterators = anv_alloc_malloc(alloc, sizeof(ANVIterator) * iterator_count);
     if (!state->iterators)
     {
-        anv_alloc_free(alloc, state);
+        anv_alloc_free_sized(alloc, state, sizeof(ChainState));
         return new_it;
     }
 
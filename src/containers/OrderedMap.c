@@ -0,0 +1,800 @@
+//
+// OrderedMap.c
+// Implementation of the insertion-ordered compact hash map.
+//
+// The index table uses linear probing from a Fibonacci-hashed home slot and
+// holds at most two thirds as many entries as it has slots. Each slot stores
+// an entry position + 1, with 0 meaning empty, so a fresh table is all zero
+// bytes. Deletion from the index shifts later slots of the probe run back
+// into the gap (Knuth's algorithm R) instead of leaving a tombstone.
+//
+// The entry array grows by half whenever it fills up, and never beyond what
+// the index can address; the index doubles when that limit is reached. An
+// array holding at least a third holes left by removals is compacted
+// instead, to one and a half times the live entries. Whenever the index is
+// rebuilt, it is filled from the cached hashes without calling the hash
+// function.
+
+#include <stdint.h>
+#include <string.h>
+
+#include "OrderedMap.h"
+#include "Pair.h"
+
+//==============================================================================
+// Default constants
+//==============================================================================
+
+#define MIN_INDEX_CAPACITY 8
+#define NOT_FOUND SIZE_MAX
+
+//==============================================================================
+// Static helper functions
+//==============================================================================
+
+/**
+ * Number of entries an index table of the given size can address.
+ */
+static size_t usable_entries(const size_t index_capacity)
+{
+    return index_capacity / 3 * 2 + index_capacity % 3 * 2 / 3;
+}
+
+/**
+ * Smallest index table that can address count entries, or 0 on overflow.
+ */
+static size_t index_capacity_for(const size_t count)
+{
+    size_t capacity = MIN_INDEX_CAPACITY;
+    while (usable_entries(capacity) < count)
+    {
+        if (capacity > SIZE_MAX / 2 / sizeof(ANVOrderedMapEntry))
+        {
+            return 0;
+        }
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+static unsigned index_width_for(const size_t index_capacity)
+{
+    if (index_capacity <= UINT8_MAX)
+    {
+        return 1;
+    }
+    if (index_capacity <= UINT16_MAX)
+    {
+        return 2;
+    }
+    if ((uint64_t)index_capacity <= UINT32_MAX)
+    {
+        return 4;
+    }
+    return 8;
+}
+
+static size_t index_get(const ANVOrderedMap* map, const size_t slot)
+{
+    switch (map->index_width)
+    {
+    case 1:
+        return ((const uint8_t*)map->index)[slot];
+    case 2:
+        return ((const uint16_t*)map->index)[slot];
+    case 4:
+        return ((const uint32_t*)map->index)[slot];
+    default:
+        return (size_t)((const uint64_t*)map->index)[slot];
+    }
+}
+
+static void index_set(ANVOrderedMap* map, const size_t slot, const size_t value)
+{
+    switch (map->index_width)
+    {
+    case 1:
+        ((uint8_t*)map->index)[slot] = (uint8_t)value;
+        break;
+    case 2:
+        ((uint16_t*)map->index)[slot] = (uint16_t)value;
+        break;
+    case 4:
+        ((uint32_t*)map->index)[slot] = (uint32_t)value;
+        break;
+    default:
+        ((uint64_t*)map->index)[slot] = value;
+        break;
+    }
+}
+
+static size_t home_slot(const ANVOrderedMap* map, const size_t hash)
+{
+    return (size_t)(((uint64_t)hash * 0x9E3779B97F4A7C15ULL) >> map->index_shift);
+}
+
+/**
+ * Find the index slot naming the entry for key, or NOT_FOUND.
+ */
+static size_t find_slot(const ANVOrderedMap* map, const void* key, const size_t hash)
+{
+    const size_t mask = map->index_capacity - 1;
+    for (size_t slot = home_slot(map, hash);; slot = (slot + 1) & mask)
+    {
+        const size_t position = index_get(map, slot);
+        if (position == 0)
+        {
+            return NOT_FOUND;
+        }
+
+        const ANVOrderedMapEntry* entry = &map->entries[position - 1];
+        if (entry->hash == hash && map->key_equals(entry->key, key))
+        {
+            return slot;
+        }
+    }
+}
+
+/**
+ * Point the first empty slot on hash's probe run at an entry position.
+ */
+static void index_insert(ANVOrderedMap* map, const size_t hash, const size_t position)
+{
+    const size_t mask = map->index_capacity - 1;
+    size_t slot = home_slot(map, hash);
+    while (index_get(map, slot) != 0)
+    {
+        slot = (slot + 1) & mask;
+    }
+    index_set(map, slot, position + 1);
+}
+
+/**
+ * Empty an index slot, moving later slots of the run back so every entry
+ * stays reachable from its home slot.
+ */
+static void index_erase(ANVOrderedMap* map, size_t slot)
+{
+    const size_t mask = map->index_capacity - 1;
+    size_t next = slot;
+    for (;;)
+    {
+        next = (next + 1) & mask;
+        const size_t position = index_get(map, next);
+        if (position == 0)
+        {
+            break;
+        }
+
+        // Move the entry back unless its home lies cyclically in (slot, next]
+        const size_t home = home_slot(map, map->entries[position - 1].hash);
+        if (((next - home) & mask) >= ((next - slot) & mask))
+        {
+            index_set(map, slot, position);
+            slot = next;
+        }
+    }
+    index_set(map, slot, 0);
+}
+
+static size_t index_bytes(const size_t index_capacity)
+{
+    return index_capacity * index_width_for(index_capacity);
+}
+
+/**
+ * Reallocate the entry array to hold capacity entries.
+ */
+static int resize_entries(ANVOrderedMap* map, const size_t capacity)
+{
+    ANVOrderedMapEntry* entries = anv_alloc_realloc(map->alloc, map->entries,
+                                                    map->entry_capacity * sizeof(ANVOrderedMapEntry),
+                                                    capacity * sizeof(ANVOrderedMapEntry));
+    if (!entries)
+    {
+        return -1;
+    }
+
+    map->entries = entries;
+    map->entry_capacity = capacity;
+    return 0;
+}
+
+/**
+ * Squeeze out holes, give the entry array new_entry_capacity slots and
+ * rebuild the index with new_capacity slots. The caller guarantees
+ * size <= new_entry_capacity <= usable_entries(new_capacity).
+ * On failure the map is left untouched.
+ */
+static int rebuild(ANVOrderedMap* map, const size_t new_capacity, const size_t new_entry_capacity)
+{
+    void* index = anv_alloc_malloc(map->alloc, index_bytes(new_capacity));
+    if (!index)
+    {
+        return -1;
+    }
+
+    // Grow before compacting so a failure leaves the entries as they were
+    if (new_entry_capacity > map->entry_capacity && resize_entries(map, new_entry_capacity) != 0)
+    {
+        anv_alloc_free_sized(map->alloc, index, index_bytes(new_capacity));
+        return -1;
+    }
+
+    size_t count = 0;
+    for (size_t i = 0; i < map->entry_count; i++)
+    {
+        if (map->entries[i].key)
+        {
+            map->entries[count++] = map->entries[i];
+        }
+    }
+    map->entry_count = count;
+
+    // Shrinking is best effort; a failed realloc keeps the larger array
+    if (new_entry_capacity < map->entry_capacity)
+    {
+        resize_entries(map, new_entry_capacity);
+    }
+
+    unsigned bits = 0;
+    while (((size_t)1 << bits) < new_capacity)
+    {
+        bits++;
+    }
+
+    anv_alloc_free_sized(map->alloc, map->index, index_bytes(map->index_capacity));
+    map->index = index;
+    map->index_capacity = new_capacity;
+    map->index_shift = 64 - bits;
+    map->index_width = index_width_for(new_capacity);
+    memset(index, 0, index_bytes(new_capacity));
+
+    for (size_t i = 0; i < map->entry_count; i++)
+    {
+        index_insert(map, map->entries[i].hash, i);
+    }
+    return 0;
+}
+
+/**
+ * Make room for one more entry at the end of the entry array.
+ */
+static int make_room(ANVOrderedMap* map)
+{
+    // The entry array can outgrow the index only when a shrink failed to realloc
+    const size_t usable = usable_entries(map->index_capacity);
+    if (map->entry_count < map->entry_capacity && map->entry_count < usable)
+    {
+        return 0;
+    }
+    if (map->size > SIZE_MAX / 2)
+    {
+        return -1;
+    }
+
+    // Enough holes that compacting with room for half as many again as are
+    // live needs no larger array
+    const size_t compacted = map->size + map->size / 2 + 1;
+    if (compacted <= map->entry_count)
+    {
+        const size_t target = compacted;
+        const size_t capacity = index_capacity_for(target);
+        return capacity ? rebuild(map, capacity, target) : -1;
+    }
+
+    // The entry array grows by half; the index doubles once it cannot address it
+    const size_t target = map->entry_capacity + map->entry_capacity / 2 + 1;
+    if (map->entry_count < usable)
+    {
+        return resize_entries(map, target < usable ? target : usable);
+    }
+
+    const size_t capacity = map->index_capacity * 2;
+    if (capacity < map->index_capacity || capacity > SIZE_MAX / sizeof(ANVOrderedMapEntry))
+    {
+        return -1;
+    }
+    return rebuild(map, capacity, target < usable_entries(capacity) ? target : usable_entries(capacity));
+}
+
+/**
+ * Shared insert path for put and put_replace.
+ */
+static int insert(ANVOrderedMap* map, void* key, void* value, void** old_value_out)
+{
+    const size_t hash = map->hash(key);
+
+    const size_t existing = find_slot(map, key, hash);
+    if (existing != NOT_FOUND)
+    {
+        ANVOrderedMapEntry* entry = &map->entries[index_get(map, existing) - 1];
+        if (old_value_out)
+        {
+            *old_value_out = entry->value;
+        }
+        entry->value = value;
+        return 0;
+    }
+
+    if (make_room(map) != 0)
+    {
+        return -1;
+    }
+
+    const size_t position = map->entry_count++;
+    map->entries[position].key = key;
+    map->entries[position].value = value;
+    map->entries[position].hash = hash;
+    index_insert(map, hash, position);
+    map->size++;
+    return 0;
+}
+
+/**
+ * Remove the entry named by an index slot, returning it.
+ */
+static ANVOrderedMapEntry erase_slot(ANVOrderedMap* map, const size_t slot)
+{
+    const size_t position = index_get(map, slot) - 1;
+    const ANVOrderedMapEntry entry = map->entries[position];
+
+    index_erase(map, slot);
+    map->entries[position].key = NULL;
+    map->size--;
+
+    // Trailing holes can be reused right away
+    while (map->entry_count > 0 && !map->entries[map->entry_count - 1].key)
+    {
+        map->entry_count--;
+    }
+    return entry;
+}
+
+//==============================================================================
+// Creation and destruction functions
+//==============================================================================
+
+ANV_API ANVOrderedMap* anv_orderedmap_create(ANVAllocator* alloc, const hash_func hash,
+                                             const key_equals_func key_equals, const size_t initial_capacity)
+{
+    if (!alloc || !hash || !key_equals)
+    {
+        return NULL;
+    }
+
+    const size_t index_capacity = index_capacity_for(initial_capacity);
+    if (index_capacity == 0)
+    {
+        return NULL;
+    }
+
+    ANVOrderedMap* map = anv_alloc_malloc(alloc, sizeof(ANVOrderedMap));
+    if (!map)
+    {
+        return NULL;
+    }
+    memset(map, 0, sizeof(ANVOrderedMap));
+
+    map->hash = hash;
+    map->key_equals = key_equals;
+    map->alloc = alloc;
+
+    const size_t entry_capacity = initial_capacity ? initial_capacity : usable_entries(index_capacity);
+    if (rebuild(map, index_capacity, entry_capacity) != 0)
+    {
+        anv_alloc_free_sized(alloc, map, sizeof(ANVOrderedMap));
+        return NULL;
+    }
+
+    return map;
+}
+
+ANV_API void anv_orderedmap_destroy(ANVOrderedMap* map, const bool should_free_keys, const bool should_free_values)
+{
+    if (!map)
+    {
+        return;
+    }
+
+    anv_orderedmap_clear(map, should_free_keys, should_free_values);
+
+    anv_alloc_free_sized(map->alloc, map->entries, map->entry_capacity * sizeof(ANVOrderedMapEntry));
+    anv_alloc_free_sized(map->alloc, map->index, index_bytes(map->index_capacity));
+    anv_alloc_free_sized(map->alloc, map, sizeof(ANVOrderedMap));
+}
+
+ANV_API void anv_orderedmap_clear(ANVOrderedMap* map, const bool should_free_keys, const bool should_free_values)
+{
+    if (!map)
+    {
+        return;
+    }
+
+    if (should_free_keys || should_free_values)
+    {
+        for (size_t i = 0; i < map->entry_count; i++)
+        {
+            if (!map->entries[i].key)
+            {
+                continue;
+            }
+
+            if (should_free_keys)
+            {
+                anv_alloc_data_free(map->alloc, map->entries[i].key);
+            }
+            if (should_free_values && map->entries[i].value)
+            {
+                anv_alloc_data_free(map->alloc, map->entries[i].value);
+            }
+        }
+    }
+
+    memset(map->index, 0, index_bytes(map->index_capacity));
+    map->entry_count = 0;
+    map->size = 0;
+}
+
+//==============================================================================
+// Information functions
+//==============================================================================
+
+ANV_API size_t anv_orderedmap_size(const ANVOrderedMap* map)
+{
+    return map ? map->size : 0;
+}
+
+ANV_API int anv_orderedmap_is_empty(const ANVOrderedMap* map)
+{
+    return !map || map->size == 0;
+}
+
+ANV_API size_t anv_orderedmap_memory_usage(const ANVOrderedMap* map)
+{
+    if (!map)
+    {
+        return 0;
+    }
+
+    return sizeof(ANVOrderedMap) + map->entry_capacity * sizeof(ANVOrderedMapEntry) +
+           index_bytes(map->index_capacity);
+}
+
+ANV_API int anv_orderedmap_contains_key(const ANVOrderedMap* map, const void* key)
+{
+    if (!map || !key)
+    {
+        return 0;
+    }
+
+    return find_slot(map, key, map->hash(key)) != NOT_FOUND;
+}
+
+//==============================================================================
+// Ordered map operations
+//==============================================================================
+
+ANV_API int anv_orderedmap_put(ANVOrderedMap* map, void* key, void* value)
+{
+    if (!map || !key)
+    {
+        return -1;
+    }
+
+    return insert(map, key, value, NULL);
+}
+
+ANV_API int anv_orderedmap_put_replace(ANVOrderedMap* map, void* key, void* value, void** old_value_out)
+{
+    if (!map || !key || !old_value_out)
+    {
+        return -1;
+    }
+
+    *old_value_out = NULL;
+    return insert(map, key, value, old_value_out);
+}
+
+ANV_API void* anv_orderedmap_get(const ANVOrderedMap* map, const void* key)
+{
+    if (!map || !key)
+    {
+        return NULL;
+    }
+
+    const size_t slot = find_slot(map, key, map->hash(key));
+    return slot != NOT_FOUND ? map->entries[index_get(map, slot) - 1].value : NULL;
+}
+
+ANV_API int anv_orderedmap_remove(ANVOrderedMap* map, const void* key,
+                                  const bool should_free_key, const bool should_free_value)
+{
+    if (!map || !key)
+    {
+        return -1;
+    }
+
+    const size_t slot = find_slot(map, key, map->hash(key));
+    if (slot == NOT_FOUND)
+    {
+        return -1; // Key not found
+    }
+
+    const ANVOrderedMapEntry entry = erase_slot(map, slot);
+
+    if (should_free_key)
+    {
+        anv_alloc_data_free(map->alloc, entry.key);
+    }
+    if (should_free_value && entry.value)
+    {
+        anv_alloc_data_free(map->alloc, entry.value);
+    }
+    return 0;
+}
+
+ANV_API void* anv_orderedmap_remove_get(ANVOrderedMap* map, const void* key, const bool should_free_key)
+{
+    if (!map || !key)
+    {
+        return NULL;
+    }
+
+    const size_t slot = find_slot(map, key, map->hash(key));
+    if (slot == NOT_FOUND)
+    {
+        return NULL; // Key not found
+    }
+
+    const ANVOrderedMapEntry entry = erase_slot(map, slot);
+
+    if (should_free_key)
+    {
+        anv_alloc_data_free(map->alloc, entry.key);
+    }
+    return entry.value;
+}
+
+ANV_API void anv_orderedmap_for_each(const ANVOrderedMap* map, void (*action)(void* key, void* value))
+{
+    if (!map || !action)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < map->entry_count; i++)
+    {
+        if (map->entries[i].key)
+        {
+            action(map->entries[i].key, map->entries[i].value);
+        }
+    }
+}
+
+//==============================================================================
+// Capacity management
+//==============================================================================
+
+ANV_API int anv_orderedmap_reserve(ANVOrderedMap* map, const size_t expected_size)
+{
+    if (!map)
+    {
+        return -1;
+    }
+
+    const size_t needed = expected_size > map->size ? expected_size : map->size;
+    const size_t usable = usable_entries(map->index_capacity);
+    const size_t room = map->entry_capacity < usable ? map->entry_capacity : usable;
+    if (map->entry_count <= room && needed - map->size <= room - map->entry_count)
+    {
+        return 0; // Already room at the end of the entry array
+    }
+
+    size_t capacity = index_capacity_for(needed);
+    if (capacity == 0)
+    {
+        return -1;
+    }
+    if (capacity < map->index_capacity)
+    {
+        capacity = map->index_capacity;
+    }
+
+    size_t entry_capacity = needed > map->entry_capacity ? needed : map->entry_capacity;
+    if (entry_capacity > usable_entries(capacity))
+    {
+        entry_capacity = usable_entries(capacity);
+    }
+    return rebuild(map, capacity, entry_capacity);
+}
+
+ANV_API int anv_orderedmap_shrink_to_fit(ANVOrderedMap* map)
+{
+    if (!map)
+    {
+        return -1;
+    }
+
+    return rebuild(map, index_capacity_for(map->size), map->size ? map->size : 1);
+}
+
+//==============================================================================
+// Iterator implementation
+//==============================================================================
+
+typedef struct OrderedMapIteratorState
+{
+    const ANVOrderedMap* map;
+    size_t index; // Current entry, or entry_count when exhausted
+    ANVPair current_pair;
+} OrderedMapIteratorState;
+
+/**
+ * First live entry at or after start, or entry_count.
+ */
+static size_t next_live_entry(const ANVOrderedMap* map, size_t start)
+{
+    while (start < map->entry_count && !map->entries[start].key)
+    {
+        start++;
+    }
+    return start;
+}
+
+/**
+ * Last live entry before end, or NOT_FOUND.
+ */
+static size_t prev_live_entry(const ANVOrderedMap* map, size_t end)
+{
+    if (end > map->entry_count)
+    {
+        end = map->entry_count;
+    }
+    while (end > 0)
+    {
+        end--;
+        if (map->entries[end].key)
+        {
+            return end;
+        }
+    }
+    return NOT_FOUND;
+}
+
+static void* orderedmap_iterator_get(const ANVIterator* it)
+{
+    OrderedMapIteratorState* state = it->data_state;
+    if (state->index >= state->map->entry_count)
+    {
+        return NULL;
+    }
+
+    state->current_pair = (ANVPair) {
+        .first = state->map->entries[state->index].key,
+        .second = state->map->entries[state->index].value,
+        .alloc = state->map->alloc
+    };
+
+    return &state->current_pair;
+}
+
+static int orderedmap_iterator_has_next(const ANVIterator* it)
+{
+    if (!it || !it->data_state)
+    {
+        return 0;
+    }
+
+    const OrderedMapIteratorState* state = it->data_state;
+    return state->index < state->map->entry_count;
+}
+
+static int orderedmap_iterator_next(const ANVIterator* it)
+{
+    if (!it || !it->data_state)
+    {
+        return -1;
+    }
+
+    OrderedMapIteratorState* state = it->data_state;
+    if (state->index >= state->map->entry_count)
+    {
+        return -1;
+    }
+
+    state->index = next_live_entry(state->map, state->index + 1);
+    return 0;
+}
+
+static int orderedmap_iterator_has_prev(const ANVIterator* it)
+{
+    if (!it || !it->data_state)
+    {
+        return 0;
+    }
+
+    const OrderedMapIteratorState* state = it->data_state;
+    return prev_live_entry(state->map, state->index) != NOT_FOUND;
+}
+
+static int orderedmap_iterator_prev(const ANVIterator* it)
+{
+    if (!it || !it->data_state)
+    {
+        return -1;
+    }
+
+    OrderedMapIteratorState* state = it->data_state;
+    const size_t prev = prev_live_entry(state->map, state->index);
+    if (prev == NOT_FOUND)
+    {
+        return -1;
+    }
+
+    state->index = prev;
+    return 0;
+}
+
+static void orderedmap_iterator_reset(const ANVIterator* it)
+{
+    if (!it || !it->data_state)
+    {
+        return;
+    }
+
+    OrderedMapIteratorState* state = it->data_state;
+    state->index = next_live_entry(state->map, 0);
+}
+
+static int orderedmap_iterator_is_valid(const ANVIterator* it)
+{
+    return it && it->data_state != NULL;
+}
+
+static void orderedmap_iterator_destroy(ANVIterator* it)
+{
+    if (!it || !it->data_state)
+    {
+        return;
+    }
+
+    OrderedMapIteratorState* state = it->data_state;
+    if (state->map)
+    {
+        anv_alloc_free_sized(state->map->alloc, state, sizeof(OrderedMapIteratorState));
+    }
+    it->data_state = NULL;
+}
+
+ANV_API ANVIterator anv_orderedmap_iterator(const ANVOrderedMap* map)
+{
+    ANVIterator it = {0};
+
+    it.get = orderedmap_iterator_get;
+    it.has_next = orderedmap_iterator_has_next;
+    it.next = orderedmap_iterator_next;
+    it.has_prev = orderedmap_iterator_has_prev;
+    it.prev = orderedmap_iterator_prev;
+    it.reset = orderedmap_iterator_reset;
+    it.is_valid = orderedmap_iterator_is_valid;
+    it.destroy = orderedmap_iterator_destroy;
+
+    if (!map || !map->alloc)
+    {
+        return it;
+    }
+
+    OrderedMapIteratorState* state = anv_alloc_malloc(map->alloc, sizeof(OrderedMapIteratorState));
+    if (!state)
+    {
+        return it;
+    }
+
+    state->map = map;
+    state->index = next_live_entry(map, 0);
+
+    it.alloc = map->alloc;
+    it.data_state = state;
+    return it;
+}
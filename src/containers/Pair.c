@@ -12,7 +12,7 @@
 
 ANV_API ANVPair* anv_pair_create(ANVAllocator* alloc, void* first, void* second)
 {
-    if (!alloc || !alloc->allocate || !alloc->deallocate)
+    if (!anv_alloc_is_valid(alloc))
     {
         return NULL;
     }
@@ -61,7 +61,7 @@ ANV_API void anv_pair_destroy(ANVPair* pair, const bool should_free_first, const
         anv_alloc_data_free(pair->alloc, pair->second);
     }
 
-    anv_alloc_free(pair->alloc, pair);
+    anv_alloc_free_sized(pair->alloc, pair, sizeof(ANVPair));
 }
 
 //==============================================================================
@@ -260,7 +260,7 @@ ANV_API void* anv_pair_copy_string_int(const void* pair_data)
         char* str_copy = anv_alloc_malloc(original->alloc, len);
         if (!str_copy)
         {
-            anv_alloc_free(original->alloc, new_pair);
+            anv_alloc_free_sized(original->alloc, new_pair, sizeof(ANVPair));
             return NULL;
         }
         strcpy(str_copy, str);
@@ -275,9 +275,9 @@ ANV_API void* anv_pair_copy_string_int(const void* pair_data)
         {
             if (new_pair->first)
             {
-                anv_alloc_free(original->alloc, new_pair->first);
+                anv_alloc_free_sized(original->alloc, new_pair->first, strlen(new_pair->first) + 1);
             }
-            anv_alloc_free(original->alloc, new_pair);
+            anv_alloc_free_sized(original->alloc, new_pair, sizeof(ANVPair));
             return NULL;
         }
         *int_copy = *(const int*)original->second;
@@ -317,7 +317,7 @@ ANV_API void* anv_pair_copy_int_string(const void* pair_data)
         int* int_copy = anv_alloc_malloc(original->alloc, sizeof(int));
         if (!int_copy)
         {
-            anv_alloc_free(original->alloc, new_pair);
+            anv_alloc_free_sized(original->alloc, new_pair, sizeof(ANVPair));
             return NULL;
         }
         *int_copy = *(const int*)original->first;
@@ -334,9 +334,9 @@ ANV_API void* anv_pair_copy_int_string(const void* pair_data)
         {
             if (new_pair->first)
             {
-                anv_alloc_free(original->alloc, new_pair->first);
+                anv_alloc_free_sized(original->alloc, new_pair->first, sizeof(int));
             }
-            anv_alloc_free(original->alloc, new_pair);
+            anv_alloc_free_sized(original->alloc, new_pair, sizeof(ANVPair));
             return NULL;
         }
         strcpy(str_copy, str);
@@ -378,7 +378,7 @@ ANV_API void* anv_pair_copy_string_string(const void* pair_data)
         char* str1_copy = anv_alloc_malloc(original->alloc, len1);
         if (!str1_copy)
         {
-            anv_alloc_free(original->alloc, new_pair);
+            anv_alloc_free_sized(original->alloc, new_pair, sizeof(ANVPair));
             return NULL;
         }
         strcpy(str1_copy, str1);
@@ -395,9 +395,9 @@ ANV_API void* anv_pair_copy_string_string(const void* pair_data)
         {
             if (new_pair->first)
             {
-                anv_alloc_free(original->alloc, new_pair->first);
+                anv_alloc_free_sized(original->alloc, new_pair->first, strlen(new_pair->first) + 1);
             }
-            anv_alloc_free(original->alloc, new_pair);
+            anv_alloc_free_sized(original->alloc, new_pair, sizeof(ANVPair));
             return NULL;
         }
         strcpy(str2_copy, str2);
@@ -437,7 +437,7 @@ ANV_API void* anv_pair_copy_int_int(const void* pair_data)
         int* int1_copy = anv_alloc_malloc(original->alloc, sizeof(int));
         if (!int1_copy)
         {
-            anv_alloc_free(original->alloc, new_pair);
+            anv_alloc_free_sized(original->alloc, new_pair, sizeof(ANVPair));
             return NULL;
         }
         *int1_copy = *(const int*)original->first;
@@ -452,9 +452,9 @@ ANV_API void* anv_pair_copy_int_int(const void* pair_data)
         {
             if (new_pair->first)
             {
-                anv_alloc_free(original->alloc, new_pair->first);
+                anv_alloc_free_sized(original->alloc, new_pair->first, sizeof(int));
             }
-            anv_alloc_free(original->alloc, new_pair);
+            anv_alloc_free_sized(original->alloc, new_pair, sizeof(ANVPair));
             return NULL;
         }
         *int2_copy = *(const int*)original->second;
@@ -44,7 +44,7 @@ static void free_node(ANVQueue* queue, ANVQueueNode* node, const bool should_fre
         anv_alloc_data_free(queue->alloc, node->data);
     }
 
-    anv_alloc_free(queue->alloc, node);
+    anv_alloc_free_sized(queue->alloc, node, sizeof(ANVQueueNode));
 }
 
 //==============================================================================
@@ -81,7 +81,7 @@ ANV_API void anv_queue_destroy(ANVQueue* queue, const bool should_free_data)
 
     anv_queue_clear(queue, should_free_data);
 
-    anv_alloc_free(queue->alloc, queue);
+    anv_alloc_free_sized(queue->alloc, queue, sizeof(ANVQueue));
 }
 
 ANV_API void anv_queue_clear(ANVQueue* queue, const bool should_free_data)
@@ -118,6 +118,16 @@ ANV_API int anv_queue_is_empty(const ANVQueue* queue)
     return !queue || queue->size == 0;
 }
 
+ANV_API size_t anv_queue_memory_usage(const ANVQueue* queue)
+{
+    if (!queue)
+    {
+        return 0;
+    }
+
+    return sizeof(ANVQueue) + queue->size * sizeof(ANVQueueNode);
+}
+
 ANV_API int anv_queue_equals(const ANVQueue* queue1, const ANVQueue* queue2, const cmp_func compare)
 {
     if (!queue1 || !queue2 || !compare)
@@ -443,7 +453,7 @@ static void queue_iterator_destroy(ANVIterator* it)
     if (it->data_state)
     {
         QueueIteratorState* state = it->data_state;
-        anv_alloc_free(state->queue->alloc, state);
+        anv_alloc_free_sized(state->queue->alloc, state, sizeof(QueueIteratorState));
     }
     it->data_state = NULL;
 }
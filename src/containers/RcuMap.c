@@ -0,0 +1,886 @@
+//
+// RcuMap.c
+// Implementation of the read-optimized concurrent hash map.
+//
+// Readers: announce the current epoch in their reader record, walk the
+// published table with acquire loads, then go quiescent again.
+//
+// Writers (one at a time, under write_lock): link and unlink nodes with
+// release stores and put whatever they unlink into the retire bag of the
+// current epoch. The epoch only advances once every active reader has
+// announced it, so when it reaches e + 1 no reader can still hold anything
+// retired during e - 1, and that bag is freed. Three bags cover the epochs
+// that can be live at once. Writers make room in the bag before they unlink
+// anything, so running out of memory fails the write instead of waiting for
+// readers.
+//
+// Reader records are owned by one thread at a time and are never unlinked
+// before the map is destroyed. A thread finds its record through a small
+// thread-local table, or by scanning the list for its own token when the
+// entry was evicted; released records are claimed by the next new reader.
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "RcuMap.h"
+#include "system/Mutex.h"
+
+//==============================================================================
+// Private constants
+//==============================================================================
+
+#define DEFAULT_INITIAL_CAPACITY 16
+#define EPOCH_BAGS 3
+#define CACHE_LINE 64
+#define TLS_SLOTS 8
+
+//==============================================================================
+// Internal types
+//==============================================================================
+
+typedef struct RcuNode
+{
+    void* key;                     // Immutable once published
+    _Atomic(void*) value;          // Replaced in place by put
+    size_t hash;                   // Cached hash code of key
+    _Atomic(struct RcuNode*) next; // Next node in chain
+} RcuNode;
+
+typedef struct RcuTable
+{
+    size_t bucket_count;          // Power of two
+    unsigned shift;               // 64 - log2(bucket_count)
+    _Atomic(RcuNode*) buckets[];  // Chain heads
+} RcuTable;
+
+/**
+ * Per-thread announcement of the epoch the thread is reading in.
+ * Padded to a cache line; each reader writes its own record on every read.
+ */
+typedef struct RcuReader
+{
+    _Atomic uint64_t state;  // (epoch << 1) | 1 while reading, 0 when quiescent
+    _Atomic uintptr_t owner; // Token of the owning thread, 0 when free to claim
+    size_t depth;            // Nesting depth, only touched by the owning thread
+    struct RcuReader* next;  // Next record registered with the map, immutable once linked
+    void* block;             // Allocation the record was carved from
+} RcuReader;
+
+typedef enum
+{
+    RETIRE_NODE,  // An unlinked RcuNode
+    RETIRE_TABLE, // A replaced RcuTable together with all of its nodes
+    RETIRE_DATA   // A key or value, released with alloc->data_free
+} RetireKind;
+
+typedef struct Retired
+{
+    void* ptr;
+    RetireKind kind;
+} Retired;
+
+typedef struct RetireBag
+{
+    Retired* items;
+    size_t count;
+    size_t capacity;
+} RetireBag;
+
+struct ANVRcuMap
+{
+    _Atomic(RcuTable*) table;      // Published table
+    _Atomic uint64_t epoch;        // Global epoch
+    _Atomic size_t size;           // Number of key-value pairs
+    _Atomic(RcuReader*) readers;   // Every reader record registered with the map
+    ANVMutex write_lock;           // Serializes writers; guards the fields below
+    RetireBag bags[EPOCH_BAGS];    // Retired blocks by epoch % EPOCH_BAGS
+    size_t id;                     // Unique id used to validate thread-local lookups
+    hash_func hash;
+    key_equals_func key_equals;
+    ANVAllocator* alloc;
+};
+
+/**
+ * Thread-local lookup entry mapping a map id to this thread's reader record.
+ * Ids are never reused, so entries left behind by destroyed maps never match.
+ * Entries are evicted without touching the record, whose map may be gone, so
+ * the slot mirrors whether the record is inside a read-side section.
+ */
+typedef struct ReaderSlot
+{
+    size_t map_id;
+    RcuReader* reader;
+    bool active; // Record has depth > 0; the entry must not be evicted
+} ReaderSlot;
+
+//==============================================================================
+// Static data
+//==============================================================================
+
+static atomic_size_t next_map_id = 1;
+
+static ANVIL_THREAD_LOCAL ReaderSlot tls_slots[TLS_SLOTS];
+static ANVIL_THREAD_LOCAL size_t tls_next_slot;
+static ANVIL_THREAD_LOCAL ReaderSlot* tls_last_slot;
+static ANVIL_THREAD_LOCAL char tls_token; // Address identifies the thread
+
+_Static_assert(sizeof(RcuReader) <= CACHE_LINE, "RcuReader must fit in one cache line");
+
+//==============================================================================
+// Static helper functions
+//==============================================================================
+
+static size_t table_bytes(const size_t bucket_count)
+{
+    return sizeof(RcuTable) + bucket_count * sizeof(_Atomic(RcuNode*));
+}
+
+static size_t bucket_index(const RcuTable* table, const size_t hash)
+{
+    return (size_t)(((uint64_t)hash * 0x9E3779B97F4A7C15ULL) >> table->shift);
+}
+
+/**
+ * Allocate an empty table with at least enough buckets for expected_size
+ * entries at a load factor of 1.
+ */
+static RcuTable* allocate_table(const ANVAllocator* alloc, const size_t expected_size)
+{
+    size_t bucket_count = DEFAULT_INITIAL_CAPACITY;
+    unsigned bits = 4;
+    while (bucket_count < expected_size)
+    {
+        if (bucket_count > (SIZE_MAX - sizeof(RcuTable)) / 2 / sizeof(_Atomic(RcuNode*)))
+        {
+            return NULL;
+        }
+        bucket_count *= 2;
+        bits++;
+    }
+
+    RcuTable* table = anv_alloc_malloc(alloc, table_bytes(bucket_count));
+    if (!table)
+    {
+        return NULL;
+    }
+
+    table->bucket_count = bucket_count;
+    table->shift = 64 - bits;
+    for (size_t i = 0; i < bucket_count; i++)
+    {
+        atomic_init(&table->buckets[i], NULL);
+    }
+    return table;
+}
+
+static void free_node(const ANVAllocator* alloc, RcuNode* node)
+{
+    anv_alloc_free_sized(alloc, node, sizeof(RcuNode));
+}
+
+/**
+ * Free a table and its nodes, optionally with their keys and values.
+ * The table must be unreachable by readers.
+ */
+static void free_table(const ANVAllocator* alloc, RcuTable* table,
+                       const bool should_free_keys, const bool should_free_values)
+{
+    for (size_t i = 0; i < table->bucket_count; i++)
+    {
+        RcuNode* node = atomic_load_explicit(&table->buckets[i], memory_order_relaxed);
+        while (node)
+        {
+            RcuNode* next = atomic_load_explicit(&node->next, memory_order_relaxed);
+            if (should_free_keys)
+            {
+                anv_alloc_data_free(alloc, node->key);
+            }
+            if (should_free_values)
+            {
+                anv_alloc_data_free(alloc, atomic_load_explicit(&node->value, memory_order_relaxed));
+            }
+            free_node(alloc, node);
+            node = next;
+        }
+    }
+    anv_alloc_free_sized(alloc, table, table_bytes(table->bucket_count));
+}
+
+static void free_retired(const ANVAllocator* alloc, const Retired* item)
+{
+    switch (item->kind)
+    {
+    case RETIRE_NODE:
+        free_node(alloc, item->ptr);
+        break;
+    case RETIRE_TABLE:
+        free_table(alloc, item->ptr, false, false);
+        break;
+    case RETIRE_DATA:
+    default:
+        anv_alloc_data_free(alloc, item->ptr);
+        break;
+    }
+}
+
+static void empty_bag(const ANVAllocator* alloc, RetireBag* bag)
+{
+    for (size_t i = 0; i < bag->count; i++)
+    {
+        free_retired(alloc, &bag->items[i]);
+    }
+    bag->count = 0;
+}
+
+/**
+ * Advance the global epoch if every active reader has announced it, and free
+ * the bag that thereby became unreachable. Caller must hold write_lock.
+ */
+static bool try_advance(ANVRcuMap* map)
+{
+    // Pairs with the fence in read_lock: either the reader's announcement is
+    // visible here, or the reader sees every unlink made before this point
+    atomic_thread_fence(memory_order_seq_cst);
+
+    const uint64_t epoch = atomic_load_explicit(&map->epoch, memory_order_relaxed);
+    for (const RcuReader* reader = atomic_load_explicit(&map->readers, memory_order_relaxed); reader;
+         reader = reader->next)
+    {
+        const uint64_t state = atomic_load_explicit(&reader->state, memory_order_acquire);
+        if ((state & 1) && (state >> 1) != epoch)
+        {
+            return false;
+        }
+    }
+
+    atomic_store_explicit(&map->epoch, epoch + 1, memory_order_seq_cst);
+    empty_bag(map->alloc, &map->bags[(epoch + 2) % EPOCH_BAGS]);
+    return true;
+}
+
+static RetireBag* current_bag(ANVRcuMap* map)
+{
+    return &map->bags[atomic_load_explicit(&map->epoch, memory_order_relaxed) % EPOCH_BAGS];
+}
+
+/**
+ * Make room for count more blocks in the current epoch's bag, so the retire
+ * calls that follow cannot fail. The epoch only moves in try_advance, so the
+ * room stays in the right bag until then. Caller must hold write_lock.
+ */
+static int reserve_retire(ANVRcuMap* map, const size_t count)
+{
+    RetireBag* bag = current_bag(map);
+    if (bag->capacity - bag->count >= count)
+    {
+        return 0;
+    }
+
+    size_t capacity = bag->capacity ? bag->capacity : 16;
+    while (capacity - bag->count < count)
+    {
+        capacity *= 2;
+    }
+    Retired* items = anv_alloc_realloc(map->alloc, bag->items, bag->capacity * sizeof(Retired),
+                                       capacity * sizeof(Retired));
+    if (!items)
+    {
+        return -1;
+    }
+    bag->items = items;
+    bag->capacity = capacity;
+    return 0;
+}
+
+/**
+ * Hand a block to the current epoch's bag, which must have room reserved
+ * with reserve_retire. Caller must hold write_lock.
+ */
+static void retire(ANVRcuMap* map, void* ptr, const RetireKind kind)
+{
+    if (!ptr)
+    {
+        return;
+    }
+
+    RetireBag* bag = current_bag(map);
+    bag->items[bag->count].ptr = ptr;
+    bag->items[bag->count].kind = kind;
+    bag->count++;
+}
+
+static uintptr_t thread_token(void)
+{
+    return (uintptr_t)&tls_token;
+}
+
+/**
+ * Keep a slot's active flag in step with its record's depth.
+ */
+static void update_slot(const ANVRcuMap* map, const RcuReader* reader)
+{
+    ReaderSlot* last = tls_last_slot;
+    if (last && last->map_id == map->id && last->reader == reader)
+    {
+        last->active = reader->depth > 0;
+    }
+}
+
+/**
+ * Remember a record in the thread-local table. Entries of records inside a
+ * read-side section are never evicted; if every entry is such a record the
+ * new one is not cached and is found by scanning the list instead.
+ */
+static void cache_reader(const ANVRcuMap* map, RcuReader* reader)
+{
+    for (size_t i = 0; i < TLS_SLOTS; i++)
+    {
+        ReaderSlot* slot = &tls_slots[tls_next_slot++ % TLS_SLOTS];
+        if (!slot->active)
+        {
+            slot->map_id = map->id;
+            slot->reader = reader;
+            slot->active = reader->depth > 0;
+            tls_last_slot = slot;
+            return;
+        }
+    }
+}
+
+/**
+ * Find the calling thread's reader record for a map, or NULL if it has none.
+ */
+static RcuReader* find_reader(const ANVRcuMap* map)
+{
+    // Fast path: most threads only ever read one map
+    ReaderSlot* last = tls_last_slot;
+    if (last && last->map_id == map->id)
+    {
+        return last->reader;
+    }
+
+    for (size_t i = 0; i < TLS_SLOTS; i++)
+    {
+        if (tls_slots[i].map_id == map->id)
+        {
+            tls_last_slot = &tls_slots[i];
+            return tls_slots[i].reader;
+        }
+    }
+
+    // Evicted or never cached. Only this thread stores its own token, so
+    // the list can be scanned without write_lock.
+    const uintptr_t token = thread_token();
+    for (RcuReader* reader = atomic_load_explicit(&map->readers, memory_order_acquire); reader;
+         reader = reader->next)
+    {
+        if (atomic_load_explicit(&reader->owner, memory_order_relaxed) == token)
+        {
+            cache_reader(map, reader);
+            return reader;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Find the calling thread's reader record for a map, claiming a released
+ * record or creating one if it has none. Returns NULL if a record cannot be
+ * created.
+ */
+static RcuReader* get_reader(ANVRcuMap* map)
+{
+    RcuReader* found = find_reader(map);
+    if (found)
+    {
+        return found;
+    }
+
+    const uintptr_t token = thread_token();
+    anv_mutex_lock(&map->write_lock);
+    for (RcuReader* reader = atomic_load_explicit(&map->readers, memory_order_relaxed); reader;
+         reader = reader->next)
+    {
+        if (atomic_load_explicit(&reader->owner, memory_order_relaxed) == 0)
+        {
+            atomic_store_explicit(&reader->owner, token, memory_order_relaxed);
+            found = reader;
+            break;
+        }
+    }
+
+    if (!found)
+    {
+        // Align by hand so no two records share a cache line
+        void* block = anv_alloc_malloc(map->alloc, 2 * CACHE_LINE);
+        if (!block)
+        {
+            anv_mutex_unlock(&map->write_lock);
+            return NULL;
+        }
+        found = (RcuReader*)(((uintptr_t)block + CACHE_LINE - 1) & ~(uintptr_t)(CACHE_LINE - 1));
+        atomic_init(&found->state, 0);
+        atomic_init(&found->owner, token);
+        found->depth = 0;
+        found->block = block;
+        found->next = atomic_load_explicit(&map->readers, memory_order_relaxed);
+        atomic_store_explicit(&map->readers, found, memory_order_release);
+    }
+    anv_mutex_unlock(&map->write_lock);
+
+    cache_reader(map, found);
+    return found;
+}
+
+/**
+ * Enter a read-side section. Returns the reader record, or NULL when none
+ * could be created, in which case the caller holds write_lock instead.
+ */
+static RcuReader* read_enter(ANVRcuMap* map)
+{
+    RcuReader* reader = get_reader(map);
+    if (!reader)
+    {
+        anv_mutex_lock(&map->write_lock);
+        return NULL;
+    }
+
+    if (reader->depth++ == 0)
+    {
+        const uint64_t epoch = atomic_load_explicit(&map->epoch, memory_order_relaxed);
+        atomic_store_explicit(&reader->state, (epoch << 1) | 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+        update_slot(map, reader);
+    }
+    return reader;
+}
+
+static void read_exit(ANVRcuMap* map, RcuReader* reader)
+{
+    if (!reader)
+    {
+        anv_mutex_unlock(&map->write_lock);
+        return;
+    }
+
+    if (--reader->depth == 0)
+    {
+        atomic_store_explicit(&reader->state, 0, memory_order_release);
+        update_slot(map, reader);
+    }
+}
+
+/**
+ * Find the node for key in the published table. Caller must be inside a
+ * read-side section or hold write_lock.
+ */
+static RcuNode* find_node(const ANVRcuMap* map, const void* key, const size_t hash)
+{
+    const RcuTable* table = atomic_load_explicit(&map->table, memory_order_acquire);
+    RcuNode* node = atomic_load_explicit(&table->buckets[bucket_index(table, hash)], memory_order_acquire);
+    while (node)
+    {
+        if (node->hash == hash && map->key_equals(node->key, key))
+        {
+            return node;
+        }
+        node = atomic_load_explicit(&node->next, memory_order_acquire);
+    }
+    return NULL;
+}
+
+/**
+ * Replace the table with a copy twice its size. The copy gets fresh nodes,
+ * so readers still walking the old table are never disturbed.
+ * Caller must hold write_lock. Failure leaves the old table in place.
+ */
+static void grow_table(ANVRcuMap* map)
+{
+    RcuTable* old_table = atomic_load_explicit(&map->table, memory_order_relaxed);
+    if (reserve_retire(map, 1) != 0)
+    {
+        return;
+    }
+    RcuTable* table = allocate_table(map->alloc, old_table->bucket_count * 2);
+    if (!table)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < old_table->bucket_count; i++)
+    {
+        for (const RcuNode* node = atomic_load_explicit(&old_table->buckets[i], memory_order_relaxed); node;
+             node = atomic_load_explicit(&node->next, memory_order_relaxed))
+        {
+            RcuNode* copy = anv_alloc_malloc(map->alloc, sizeof(RcuNode));
+            if (!copy)
+            {
+                free_table(map->alloc, table, false, false);
+                return;
+            }
+
+            const size_t index = bucket_index(table, node->hash);
+            copy->key = node->key;
+            copy->hash = node->hash;
+            atomic_init(&copy->value, atomic_load_explicit(&node->value, memory_order_relaxed));
+            atomic_init(&copy->next, atomic_load_explicit(&table->buckets[index], memory_order_relaxed));
+            atomic_init(&table->buckets[index], copy);
+        }
+    }
+
+    atomic_store_explicit(&map->table, table, memory_order_release);
+    retire(map, old_table, RETIRE_TABLE);
+}
+
+/**
+ * Shared insert/update path. Caller must hold write_lock.
+ */
+static int put_locked(ANVRcuMap* map, void* key, void* value, void** old_value_out, const bool should_free_old)
+{
+    const size_t hash = map->hash(key);
+    RcuNode* existing = find_node(map, key, hash);
+    if (existing)
+    {
+        if (should_free_old && reserve_retire(map, 1) != 0)
+        {
+            return -1;
+        }
+        void* old = atomic_exchange_explicit(&existing->value, value, memory_order_acq_rel);
+        if (old_value_out)
+        {
+            *old_value_out = old;
+        }
+        if (should_free_old)
+        {
+            retire(map, old, RETIRE_DATA);
+            try_advance(map);
+        }
+        return 0;
+    }
+
+    RcuNode* node = anv_alloc_malloc(map->alloc, sizeof(RcuNode));
+    if (!node)
+    {
+        return -1;
+    }
+
+    RcuTable* table = atomic_load_explicit(&map->table, memory_order_relaxed);
+    _Atomic(RcuNode*)* head = &table->buckets[bucket_index(table, hash)];
+    node->key = key;
+    node->hash = hash;
+    atomic_init(&node->value, value);
+    atomic_init(&node->next, atomic_load_explicit(head, memory_order_relaxed));
+    atomic_store_explicit(head, node, memory_order_release);
+
+    const size_t size = atomic_load_explicit(&map->size, memory_order_relaxed) + 1;
+    atomic_store_explicit(&map->size, size, memory_order_relaxed);
+    if (old_value_out)
+    {
+        *old_value_out = NULL;
+    }
+
+    if (size > table->bucket_count)
+    {
+        grow_table(map);
+        try_advance(map);
+    }
+    return 0;
+}
+
+/**
+ * Shared removal path. Caller must hold write_lock.
+ * Returns the removed node's value through value_out.
+ */
+static int remove_locked(ANVRcuMap* map, const void* key, const bool should_free_key,
+                         const bool should_free_value, void** value_out)
+{
+    const size_t hash = map->hash(key);
+    RcuTable* table = atomic_load_explicit(&map->table, memory_order_relaxed);
+    _Atomic(RcuNode*)* link = &table->buckets[bucket_index(table, hash)];
+
+    RcuNode* node = atomic_load_explicit(link, memory_order_relaxed);
+    while (node && !(node->hash == hash && map->key_equals(node->key, key)))
+    {
+        link = &node->next;
+        node = atomic_load_explicit(link, memory_order_relaxed);
+    }
+    if (!node || reserve_retire(map, 1 + (size_t)should_free_key + (size_t)should_free_value) != 0)
+    {
+        return -1;
+    }
+
+    // Readers already on the node can still follow its next pointer
+    atomic_store_explicit(link, atomic_load_explicit(&node->next, memory_order_relaxed), memory_order_release);
+    atomic_store_explicit(&map->size, atomic_load_explicit(&map->size, memory_order_relaxed) - 1,
+                          memory_order_relaxed);
+
+    void* value = atomic_load_explicit(&node->value, memory_order_relaxed);
+    if (value_out)
+    {
+        *value_out = value;
+    }
+
+    retire(map, node, RETIRE_NODE);
+    if (should_free_key)
+    {
+        retire(map, node->key, RETIRE_DATA);
+    }
+    if (should_free_value)
+    {
+        retire(map, value, RETIRE_DATA);
+    }
+    try_advance(map);
+    return 0;
+}
+
+//==============================================================================
+// Creation and destruction functions
+//==============================================================================
+
+ANV_API ANVRcuMap* anv_rcumap_create(ANVAllocator* alloc, const hash_func hash, const key_equals_func key_equals,
+                                     const size_t initial_capacity)
+{
+    if (!alloc || !hash || !key_equals)
+    {
+        return NULL;
+    }
+
+    ANVRcuMap* map = anv_alloc_malloc(alloc, sizeof(ANVRcuMap));
+    if (!map)
+    {
+        return NULL;
+    }
+    memset(map, 0, sizeof(ANVRcuMap));
+
+    RcuTable* table = allocate_table(alloc, initial_capacity);
+    if (!table)
+    {
+        anv_alloc_free_sized(alloc, map, sizeof(ANVRcuMap));
+        return NULL;
+    }
+
+    if (anv_mutex_init(&map->write_lock) != 0)
+    {
+        anv_alloc_free_sized(alloc, table, table_bytes(table->bucket_count));
+        anv_alloc_free_sized(alloc, map, sizeof(ANVRcuMap));
+        return NULL;
+    }
+
+    atomic_init(&map->table, table);
+    atomic_init(&map->readers, NULL);
+    atomic_init(&map->epoch, 0);
+    atomic_init(&map->size, 0);
+    map->id = atomic_fetch_add(&next_map_id, 1);
+    map->hash = hash;
+    map->key_equals = key_equals;
+    map->alloc = alloc;
+    return map;
+}
+
+ANV_API void anv_rcumap_destroy(ANVRcuMap* map, const bool should_free_keys, const bool should_free_values)
+{
+    if (!map)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < EPOCH_BAGS; i++)
+    {
+        empty_bag(map->alloc, &map->bags[i]);
+        anv_alloc_free_sized(map->alloc, map->bags[i].items, map->bags[i].capacity * sizeof(Retired));
+    }
+
+    free_table(map->alloc, atomic_load_explicit(&map->table, memory_order_relaxed),
+               should_free_keys, should_free_values);
+
+    RcuReader* reader = atomic_load_explicit(&map->readers, memory_order_relaxed);
+    while (reader)
+    {
+        RcuReader* next = reader->next;
+        anv_alloc_free_sized(map->alloc, reader->block, 2 * CACHE_LINE);
+        reader = next;
+    }
+
+    anv_mutex_destroy(&map->write_lock);
+    anv_alloc_free_sized(map->alloc, map, sizeof(ANVRcuMap));
+}
+
+//==============================================================================
+// Information functions
+//==============================================================================
+
+ANV_API size_t anv_rcumap_size(const ANVRcuMap* map)
+{
+    return map ? atomic_load_explicit(&map->size, memory_order_relaxed) : 0;
+}
+
+ANV_API int anv_rcumap_is_empty(const ANVRcuMap* map)
+{
+    return anv_rcumap_size(map) == 0;
+}
+
+ANV_API size_t anv_rcumap_retired_count(ANVRcuMap* map)
+{
+    if (!map)
+    {
+        return 0;
+    }
+
+    anv_mutex_lock(&map->write_lock);
+    try_advance(map);
+    size_t count = 0;
+    for (size_t i = 0; i < EPOCH_BAGS; i++)
+    {
+        count += map->bags[i].count;
+    }
+    anv_mutex_unlock(&map->write_lock);
+    return count;
+}
+
+ANV_API int anv_rcumap_contains_key(ANVRcuMap* map, const void* key)
+{
+    if (!map || !key)
+    {
+        return 0;
+    }
+
+    RcuReader* reader = read_enter(map);
+    const int found = find_node(map, key, map->hash(key)) != NULL;
+    read_exit(map, reader);
+    return found;
+}
+
+//==============================================================================
+// Read-side critical sections
+//==============================================================================
+
+ANV_API void anv_rcumap_read_lock(ANVRcuMap* map)
+{
+    if (!map)
+    {
+        return;
+    }
+
+    read_enter(map);
+}
+
+ANV_API void anv_rcumap_read_unlock(ANVRcuMap* map)
+{
+    if (!map)
+    {
+        return;
+    }
+
+    // A thread without a record entered by taking the write lock
+    read_exit(map, find_reader(map));
+}
+
+ANV_API int anv_rcumap_release_thread(ANVRcuMap* map)
+{
+    if (!map)
+    {
+        return -1;
+    }
+
+    RcuReader* reader = find_reader(map);
+    if (!reader)
+    {
+        return 0;
+    }
+    if (reader->depth > 0)
+    {
+        return -1;
+    }
+
+    for (size_t i = 0; i < TLS_SLOTS; i++)
+    {
+        if (tls_slots[i].map_id == map->id)
+        {
+            tls_slots[i] = (ReaderSlot) {0};
+        }
+    }
+
+    anv_mutex_lock(&map->write_lock);
+    atomic_store_explicit(&reader->owner, 0, memory_order_relaxed);
+    anv_mutex_unlock(&map->write_lock);
+    return 0;
+}
+
+//==============================================================================
+// Map operations
+//==============================================================================
+
+ANV_API void* anv_rcumap_get(ANVRcuMap* map, const void* key)
+{
+    if (!map || !key)
+    {
+        return NULL;
+    }
+
+    const size_t hash = map->hash(key);
+    RcuReader* reader = read_enter(map);
+    const RcuNode* node = find_node(map, key, hash);
+    void* value = node ? atomic_load_explicit(&node->value, memory_order_acquire) : NULL;
+    read_exit(map, reader);
+    return value;
+}
+
+ANV_API int anv_rcumap_put(ANVRcuMap* map, void* key, void* value)
+{
+    return anv_rcumap_put_replace(map, key, value, NULL);
+}
+
+ANV_API int anv_rcumap_put_replace(ANVRcuMap* map, void* key, void* value, void** old_value_out)
+{
+    if (!map || !key)
+    {
+        return -1;
+    }
+
+    anv_mutex_lock(&map->write_lock);
+    const int result = put_locked(map, key, value, old_value_out, false);
+    anv_mutex_unlock(&map->write_lock);
+    return result;
+}
+
+ANV_API int anv_rcumap_put_with_free(ANVRcuMap* map, void* key, void* value, const bool should_free_old_value)
+{
+    if (!map || !key)
+    {
+        return -1;
+    }
+
+    anv_mutex_lock(&map->write_lock);
+    const int result = put_locked(map, key, value, NULL, should_free_old_value);
+    anv_mutex_unlock(&map->write_lock);
+    return result;
+}
+
+ANV_API int anv_rcumap_remove(ANVRcuMap* map, const void* key, const bool should_free_key,
+                              const bool should_free_value)
+{
+    if (!map || !key)
+    {
+        return -1;
+    }
+
+    anv_mutex_lock(&map->write_lock);
+    const int result = remove_locked(map, key, should_free_key, should_free_value, NULL);
+    anv_mutex_unlock(&map->write_lock);
+    return result;
+}
+
+ANV_API void* anv_rcumap_remove_get(ANVRcuMap* map, const void* key, const bool should_free_key)
+{
+    if (!map || !key)
+    {
+        return NULL;
+    }
+
+    void* value = NULL;
+    anv_mutex_lock(&map->write_lock);
+    const int result = remove_locked(map, key, should_free_key, false, &value);
+    anv_mutex_unlock(&map->write_lock);
+    return result == 0 ? value : NULL;
+}
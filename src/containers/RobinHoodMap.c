@@ -0,0 +1,705 @@
+//
+// RobinHoodMap.c
+// Implementation of the Robin Hood hash map.
+//
+// A key's home slot comes from the high bits of its hash times a Fibonacci
+// constant, so weak hash functions still spread. Within a run of occupied
+// slots, entries are ordered by home slot, which gives the two properties
+// everything here relies on:
+//
+//  - A probe for a key whose distance from home is d can stop at the first
+//    slot holding an entry with a smaller distance: the key would have
+//    displaced that entry on insertion.
+//  - Inserting at the first such slot and shifting the rest of the run one
+//    slot right is the same as the classic swap-as-you-go insertion, but lets
+//    the distance limit be checked before anything moves.
+//
+// Removal does the reverse: later entries of the run shift one slot left
+// until one is already in its home slot or the run ends.
+
+#include <string.h>
+
+#include "Pair.h"
+#include "RobinHoodMap.h"
+
+//==============================================================================
+// Default constants
+//==============================================================================
+
+#define DEFAULT_INITIAL_CAPACITY 16
+#define NOT_FOUND SIZE_MAX
+#define MIN_MAX_LOAD 0.5
+#define MAX_MAX_LOAD 0.95
+
+//==============================================================================
+// Static helper functions
+//==============================================================================
+
+static size_t home_slot(const ANVRobinHoodMap* map, const size_t hash)
+{
+    return (size_t)(((uint64_t)hash * 0x9E3779B97F4A7C15ULL) >> map->shift);
+}
+
+static uint8_t hash_tag(const size_t hash)
+{
+    return (uint8_t)hash;
+}
+
+/**
+ * Find the slot holding key, or NOT_FOUND.
+ */
+static size_t find_slot(const ANVRobinHoodMap* map, const void* key, const size_t hash)
+{
+    const size_t mask = map->capacity - 1;
+    const uint8_t tag = hash_tag(hash);
+    size_t index = home_slot(map, hash);
+
+    for (unsigned dist = 1; map->dists[index] >= dist; dist++)
+    {
+        if (map->tags[index] == tag && map->key_equals(map->slots[index].key, key))
+        {
+            return index;
+        }
+        index = (index + 1) & mask;
+    }
+
+    return NOT_FOUND;
+}
+
+/**
+ * Place a key that is not in the map. Returns -1 without modifying the table
+ * if the key or an entry it displaces would exceed the probe limit.
+ * The caller guarantees at least one empty slot.
+ */
+static int place(ANVRobinHoodMap* map, void* key, void* value, const size_t hash)
+{
+    const size_t mask = map->capacity - 1;
+    size_t index = home_slot(map, hash);
+    unsigned dist = 1;
+
+    // Skip entries at least as far from home as the new key would be
+    while (map->dists[index] >= dist)
+    {
+        if (dist > ANV_ROBINHOODMAP_MAX_PROBE)
+        {
+            return -1;
+        }
+        index = (index + 1) & mask;
+        dist++;
+    }
+
+    // Every entry from index to the next empty slot moves one slot further
+    size_t end = index;
+    while (map->dists[end] != 0)
+    {
+        if (map->dists[end] > ANV_ROBINHOODMAP_MAX_PROBE)
+        {
+            return -1;
+        }
+        end = (end + 1) & mask;
+    }
+
+    while (end != index)
+    {
+        const size_t prev = (end - 1) & mask;
+        map->slots[end] = map->slots[prev];
+        map->tags[end] = map->tags[prev];
+        map->dists[end] = (uint8_t)(map->dists[prev] + 1);
+        end = prev;
+    }
+
+    map->slots[index].key = key;
+    map->slots[index].value = value;
+    map->tags[index] = hash_tag(hash);
+    map->dists[index] = (uint8_t)dist;
+    return 0;
+}
+
+/**
+ * Remove the entry in a full slot by shifting the rest of its run back.
+ */
+static void erase_slot(ANVRobinHoodMap* map, size_t index)
+{
+    const size_t mask = map->capacity - 1;
+    size_t next = (index + 1) & mask;
+
+    while (map->dists[next] > 1)
+    {
+        map->slots[index] = map->slots[next];
+        map->tags[index] = map->tags[next];
+        map->dists[index] = (uint8_t)(map->dists[next] - 1);
+        index = next;
+        next = (next + 1) & mask;
+    }
+
+    map->dists[index] = 0;
+    map->size--;
+}
+
+/**
+ * Bytes in the single block holding the slots, distances and tags.
+ */
+static size_t table_bytes(const size_t capacity)
+{
+    return capacity * (sizeof(ANVRobinHoodSlot) + 2 * sizeof(uint8_t));
+}
+
+static size_t max_size_for(const size_t capacity, const double max_load_factor)
+{
+    return (size_t)((double)capacity * max_load_factor);
+}
+
+/**
+ * Allocate an empty table of the given capacity into map.
+ */
+static int allocate_table(ANVRobinHoodMap* map, const size_t capacity)
+{
+    ANVRobinHoodSlot* slots = anv_alloc_malloc(map->alloc, table_bytes(capacity));
+    if (!slots)
+    {
+        return -1;
+    }
+
+    unsigned bits = 0;
+    while (((size_t)1 << bits) < capacity)
+    {
+        bits++;
+    }
+
+    map->slots = slots;
+    map->dists = (uint8_t*)(slots + capacity);
+    map->tags = map->dists + capacity;
+    map->capacity = capacity;
+    map->shift = 64 - bits;
+    map->max_size = max_size_for(capacity, map->max_load_factor);
+    memset(map->dists, 0, capacity);
+    return 0;
+}
+
+/**
+ * Move every entry into a table of new_capacity slots. On failure the old
+ * table is left untouched.
+ */
+static int resize(ANVRobinHoodMap* map, const size_t new_capacity)
+{
+    ANVRobinHoodMap old = *map;
+    if (allocate_table(map, new_capacity) != 0)
+    {
+        return -1;
+    }
+
+    for (size_t i = 0; i < old.capacity; i++)
+    {
+        if (old.dists[i] != 0 && place(map, old.slots[i].key, old.slots[i].value, map->hash(old.slots[i].key)) != 0)
+        {
+            anv_alloc_free_sized(map->alloc, map->slots, table_bytes(new_capacity));
+            *map = old;
+            return -1;
+        }
+    }
+
+    anv_alloc_free_sized(map->alloc, old.slots, table_bytes(old.capacity));
+    return 0;
+}
+
+static int grow(ANVRobinHoodMap* map)
+{
+    const size_t new_capacity = map->capacity * 2;
+    if (new_capacity < map->capacity || new_capacity > SIZE_MAX / (sizeof(ANVRobinHoodSlot) + 2))
+    {
+        return -1;
+    }
+    return resize(map, new_capacity);
+}
+
+/**
+ * Shared insert path for put and put_replace.
+ */
+static int insert(ANVRobinHoodMap* map, void* key, void* value, void** old_value_out)
+{
+    const size_t hash = map->hash(key);
+
+    const size_t existing = find_slot(map, key, hash);
+    if (existing != NOT_FOUND)
+    {
+        if (old_value_out)
+        {
+            *old_value_out = map->slots[existing].value;
+        }
+        map->slots[existing].value = value;
+        return 0;
+    }
+
+    if (map->size >= map->max_size && grow(map) != 0)
+    {
+        return -1;
+    }
+
+    while (place(map, key, value, hash) != 0)
+    {
+        // A run too long to extend. Growing splits it unless the hash
+        // function maps too many keys to the same slot, so give up once
+        // the table is already sparse.
+        if (map->size * 2 < map->capacity || grow(map) != 0)
+        {
+            return -1;
+        }
+    }
+
+    map->size++;
+    return 0;
+}
+
+//==============================================================================
+// Creation and destruction functions
+//==============================================================================
+
+ANV_API ANVRobinHoodMap* anv_robinhoodmap_create(ANVAllocator* alloc, const hash_func hash,
+                                                 const key_equals_func key_equals, const size_t initial_capacity)
+{
+    if (!alloc || !hash || !key_equals)
+    {
+        return NULL;
+    }
+
+    // Smallest power-of-two table that holds initial_capacity elements under the load limit
+    size_t capacity = DEFAULT_INITIAL_CAPACITY;
+    while (max_size_for(capacity, ANV_ROBINHOODMAP_DEFAULT_MAX_LOAD) < initial_capacity)
+    {
+        if (capacity > SIZE_MAX / 2 / (sizeof(ANVRobinHoodSlot) + 2))
+        {
+            return NULL;
+        }
+        capacity *= 2;
+    }
+
+    ANVRobinHoodMap* map = anv_alloc_malloc(alloc, sizeof(ANVRobinHoodMap));
+    if (!map)
+    {
+        return NULL;
+    }
+
+    map->size = 0;
+    map->max_load_factor = ANV_ROBINHOODMAP_DEFAULT_MAX_LOAD;
+    map->hash = hash;
+    map->key_equals = key_equals;
+    map->alloc = alloc;
+
+    if (allocate_table(map, capacity) != 0)
+    {
+        anv_alloc_free_sized(alloc, map, sizeof(ANVRobinHoodMap));
+        return NULL;
+    }
+
+    return map;
+}
+
+ANV_API void anv_robinhoodmap_destroy(ANVRobinHoodMap* map, const bool should_free_keys,
+                                      const bool should_free_values)
+{
+    if (!map)
+    {
+        return;
+    }
+
+    anv_robinhoodmap_clear(map, should_free_keys, should_free_values);
+
+    anv_alloc_free_sized(map->alloc, map->slots, table_bytes(map->capacity));
+    anv_alloc_free_sized(map->alloc, map, sizeof(ANVRobinHoodMap));
+}
+
+ANV_API void anv_robinhoodmap_clear(ANVRobinHoodMap* map, const bool should_free_keys,
+                                    const bool should_free_values)
+{
+    if (!map || !map->slots)
+    {
+        return;
+    }
+
+    if (should_free_keys || should_free_values)
+    {
+        for (size_t i = 0; i < map->capacity; i++)
+        {
+            if (map->dists[i] == 0)
+            {
+                continue;
+            }
+
+            if (should_free_keys && map->slots[i].key)
+            {
+                anv_alloc_data_free(map->alloc, map->slots[i].key);
+            }
+            if (should_free_values && map->slots[i].value)
+            {
+                anv_alloc_data_free(map->alloc, map->slots[i].value);
+            }
+        }
+    }
+
+    memset(map->dists, 0, map->capacity);
+    map->size = 0;
+}
+
+//==============================================================================
+// Information functions
+//==============================================================================
+
+ANV_API size_t anv_robinhoodmap_size(const ANVRobinHoodMap* map)
+{
+    return map ? map->size : 0;
+}
+
+ANV_API int anv_robinhoodmap_is_empty(const ANVRobinHoodMap* map)
+{
+    return !map || map->size == 0;
+}
+
+ANV_API size_t anv_robinhoodmap_capacity(const ANVRobinHoodMap* map)
+{
+    return map ? map->capacity : 0;
+}
+
+ANV_API double anv_robinhoodmap_load_factor(const ANVRobinHoodMap* map)
+{
+    if (!map || map->capacity == 0)
+    {
+        return 0.0;
+    }
+    return (double)map->size / (double)map->capacity;
+}
+
+ANV_API size_t anv_robinhoodmap_memory_usage(const ANVRobinHoodMap* map)
+{
+    if (!map)
+    {
+        return 0;
+    }
+
+    return sizeof(ANVRobinHoodMap) + table_bytes(map->capacity);
+}
+
+ANV_API int anv_robinhoodmap_contains_key(const ANVRobinHoodMap* map, const void* key)
+{
+    if (!map || !key)
+    {
+        return 0;
+    }
+
+    return find_slot(map, key, map->hash(key)) != NOT_FOUND;
+}
+
+//==============================================================================
+// Capacity management
+//==============================================================================
+
+ANV_API int anv_robinhoodmap_set_max_load_factor(ANVRobinHoodMap* map, const double max_load_factor)
+{
+    if (!map || !(max_load_factor >= MIN_MAX_LOAD && max_load_factor <= MAX_MAX_LOAD))
+    {
+        return -1;
+    }
+
+    map->max_load_factor = max_load_factor;
+    map->max_size = max_size_for(map->capacity, max_load_factor);
+    return 0;
+}
+
+//==============================================================================
+// Robin Hood map operations
+//==============================================================================
+
+ANV_API int anv_robinhoodmap_put(ANVRobinHoodMap* map, void* key, void* value)
+{
+    if (!map || !key)
+    {
+        return -1;
+    }
+
+    return insert(map, key, value, NULL);
+}
+
+ANV_API int anv_robinhoodmap_put_replace(ANVRobinHoodMap* map, void* key, void* value, void** old_value_out)
+{
+    if (!map || !key || !old_value_out)
+    {
+        return -1;
+    }
+
+    *old_value_out = NULL;
+    return insert(map, key, value, old_value_out);
+}
+
+ANV_API void* anv_robinhoodmap_get(const ANVRobinHoodMap* map, const void* key)
+{
+    if (!map || !key)
+    {
+        return NULL;
+    }
+
+    const size_t index = find_slot(map, key, map->hash(key));
+    return index != NOT_FOUND ? map->slots[index].value : NULL;
+}
+
+ANV_API int anv_robinhoodmap_remove(ANVRobinHoodMap* map, const void* key,
+                                    const bool should_free_key, const bool should_free_value)
+{
+    if (!map || !key)
+    {
+        return -1;
+    }
+
+    const size_t index = find_slot(map, key, map->hash(key));
+    if (index == NOT_FOUND)
+    {
+        return -1; // Key not found
+    }
+
+    ANVRobinHoodSlot slot = map->slots[index];
+    erase_slot(map, index);
+
+    if (should_free_key && slot.key)
+    {
+        anv_alloc_data_free(map->alloc, slot.key);
+    }
+    if (should_free_value && slot.value)
+    {
+        anv_alloc_data_free(map->alloc, slot.value);
+    }
+    return 0;
+}
+
+ANV_API void* anv_robinhoodmap_remove_get(ANVRobinHoodMap* map, const void* key, const bool should_free_key)
+{
+    if (!map || !key)
+    {
+        return NULL;
+    }
+
+    const size_t index = find_slot(map, key, map->hash(key));
+    if (index == NOT_FOUND)
+    {
+        return NULL; // Key not found
+    }
+
+    ANVRobinHoodSlot slot = map->slots[index];
+    erase_slot(map, index);
+
+    if (should_free_key && slot.key)
+    {
+        anv_alloc_data_free(map->alloc, slot.key);
+    }
+    return slot.value;
+}
+
+ANV_API void anv_robinhoodmap_for_each(const ANVRobinHoodMap* map, void (*action)(void* key, void* value))
+{
+    if (!map || !action)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < map->capacity; i++)
+    {
+        if (map->dists[i] != 0)
+        {
+            action(map->slots[i].key, map->slots[i].value);
+        }
+    }
+}
+
+//==============================================================================
+// Probe statistics
+//==============================================================================
+
+ANV_API size_t anv_robinhoodmap_probe_histogram(const ANVRobinHoodMap* map, size_t* counts, const size_t count_len)
+{
+    if (counts)
+    {
+        memset(counts, 0, count_len * sizeof(size_t));
+    }
+    if (!map)
+    {
+        return 0;
+    }
+
+    size_t longest = 0;
+    for (size_t i = 0; i < map->capacity; i++)
+    {
+        if (map->dists[i] == 0)
+        {
+            continue;
+        }
+
+        const size_t probe = map->dists[i] - 1u;
+        if (probe > longest)
+        {
+            longest = probe;
+        }
+        if (counts && count_len > 0)
+        {
+            counts[probe < count_len ? probe : count_len - 1]++;
+        }
+    }
+    return longest;
+}
+
+ANV_API double anv_robinhoodmap_mean_probe_length(const ANVRobinHoodMap* map)
+{
+    if (!map || map->size == 0)
+    {
+        return 0.0;
+    }
+
+    size_t total = 0;
+    for (size_t i = 0; i < map->capacity; i++)
+    {
+        if (map->dists[i] != 0)
+        {
+            total += map->dists[i] - 1u;
+        }
+    }
+    return (double)total / (double)map->size;
+}
+
+//==============================================================================
+// Iterator implementation
+//==============================================================================
+
+typedef struct RobinHoodMapIteratorState
+{
+    const ANVRobinHoodMap* map;
+    size_t index; // Current full slot, or capacity when exhausted
+    ANVPair current_pair;
+} RobinHoodMapIteratorState;
+
+/**
+ * First full slot at or after start, or capacity.
+ */
+static size_t next_full_slot(const ANVRobinHoodMap* map, size_t start)
+{
+    while (start < map->capacity && map->dists[start] == 0)
+    {
+        start++;
+    }
+    return start;
+}
+
+static void* robinhoodmap_iterator_get(const ANVIterator* it)
+{
+    RobinHoodMapIteratorState* state = it->data_state;
+    if (state->index >= state->map->capacity)
+    {
+        return NULL;
+    }
+
+    state->current_pair = (ANVPair) {
+        .first = state->map->slots[state->index].key,
+        .second = state->map->slots[state->index].value,
+        .alloc = state->map->alloc
+    };
+
+    return &state->current_pair;
+}
+
+static int robinhoodmap_iterator_has_next(const ANVIterator* it)
+{
+    if (!it || !it->data_state)
+    {
+        return 0;
+    }
+
+    const RobinHoodMapIteratorState* state = it->data_state;
+    return state->index < state->map->capacity;
+}
+
+static int robinhoodmap_iterator_next(const ANVIterator* it)
+{
+    if (!it || !it->data_state)
+    {
+        return -1;
+    }
+
+    RobinHoodMapIteratorState* state = it->data_state;
+    if (state->index >= state->map->capacity)
+    {
+        return -1;
+    }
+
+    state->index = next_full_slot(state->map, state->index + 1);
+    return 0;
+}
+
+static int robinhoodmap_iterator_has_prev(const ANVIterator* it)
+{
+    (void)it;
+    return 0; // Robin Hood map iterator doesn't support backward iteration
+}
+
+static int robinhoodmap_iterator_prev(const ANVIterator* it)
+{
+    (void)it;
+    return -1; // Robin Hood map iterator doesn't support backward iteration
+}
+
+static void robinhoodmap_iterator_reset(const ANVIterator* it)
+{
+    if (!it || !it->data_state)
+    {
+        return;
+    }
+
+    RobinHoodMapIteratorState* state = it->data_state;
+    state->index = next_full_slot(state->map, 0);
+}
+
+static int robinhoodmap_iterator_is_valid(const ANVIterator* it)
+{
+    return it && it->data_state != NULL;
+}
+
+static void robinhoodmap_iterator_destroy(ANVIterator* it)
+{
+    if (!it || !it->data_state)
+    {
+        return;
+    }
+
+    RobinHoodMapIteratorState* state = it->data_state;
+    if (state->map)
+    {
+        anv_alloc_free_sized(state->map->alloc, state, sizeof(RobinHoodMapIteratorState));
+    }
+    it->data_state = NULL;
+}
+
+ANV_API ANVIterator anv_robinhoodmap_iterator(const ANVRobinHoodMap* map)
+{
+    ANVIterator it = {0};
+
+    it.get = robinhoodmap_iterator_get;
+    it.has_next = robinhoodmap_iterator_has_next;
+    it.next = robinhoodmap_iterator_next;
+    it.has_prev = robinhoodmap_iterator_has_prev;
+    it.prev = robinhoodmap_iterator_prev;
+    it.reset = robinhoodmap_iterator_reset;
+    it.is_valid = robinhoodmap_iterator_is_valid;
+    it.destroy = robinhoodmap_iterator_destroy;
+
+    if (!map || !map->alloc)
+    {
+        return it;
+    }
+
+    RobinHoodMapIteratorState* state = anv_alloc_malloc(map->alloc, sizeof(RobinHoodMapIteratorState));
+    if (!state)
+    {
+        return it;
+    }
+
+    state->map = map;
+    state->index = next_full_slot(map, 0);
+
+    it.alloc = map->alloc;
+    it.data_state = state;
+    return it;
+}
@@ -87,7 +87,7 @@ ANV_API void anv_sll_destroy(ANVSinglyLinkedList* list, const bool should_free_d
     if (list)
     {
         anv_sll_clear(list, should_free_data);
-        anv_alloc_free(list->alloc, list);
+        anv_alloc_free_sized(list->alloc, list, sizeof(ANVSinglyLinkedList));
     }
 }
 
@@ -109,7 +109,7 @@ ANV_API void anv_sll_clear(ANVSinglyLinkedList* list, const bool should_free_dat
         {
             anv_alloc_data_free(list->alloc, node->data);
         }
-        anv_alloc_free(list->alloc, node);
+        anv_alloc_free_sized(list->alloc, node, sizeof(ANVSinglyLinkedNode));
         node = next;
     }
     list->head = NULL;
@@ -141,6 +141,16 @@ ANV_API int anv_sll_is_empty(const ANVSinglyLinkedList* list)
     return !list || list->size == 0;
 }
 
+ANV_API size_t anv_sll_memory_usage(const ANVSinglyLinkedList* list)
+{
+    if (!list)
+    {
+        return 0;
+    }
+
+    return sizeof(ANVSinglyLinkedList) + list->size * sizeof(ANVSinglyLinkedNode);
+}
+
 /**
  * Find the first node equal to data using compare.
  */
@@ -302,7 +312,7 @@ ANV_API int anv_sll_insert_at(ANVSinglyLinkedList* list, const size_t pos, void*
         prev = prev->next;
         if (!prev)
         {
-            anv_alloc_free(list->alloc, node);
+            anv_alloc_free_sized(list->alloc, node, sizeof(ANVSinglyLinkedNode));
             return -1;
         }
     }
@@ -353,7 +363,7 @@ ANV_API int anv_sll_remove(ANVSinglyLinkedList* list, const void* data, const cm
                 anv_alloc_data_free(list->alloc, curr->data);
             }
 
-            anv_alloc_free(list->alloc, curr);
+            anv_alloc_free_sized(list->alloc, curr, sizeof(ANVSinglyLinkedNode));
             list->size--;
             return 0;
         }
@@ -397,7 +407,7 @@ ANV_API int anv_sll_remove_at(ANVSinglyLinkedList* list, const size_t pos, const
         anv_alloc_data_free(list->alloc, curr->data);
     }
 
-    anv_alloc_free(list->alloc, curr);
+    anv_alloc_free_sized(list->alloc, curr, sizeof(ANVSinglyLinkedNode));
     list->size--;
     return 0;
 }
@@ -420,7 +430,7 @@ ANV_API int anv_sll_pop_front(ANVSinglyLinkedList* list, const bool should_free_
         anv_alloc_data_free(list->alloc, node_to_remove->data);
     }
 
-    anv_alloc_free(list->alloc, node_to_remove);
+    anv_alloc_free_sized(list->alloc, node_to_remove, sizeof(ANVSinglyLinkedNode));
     list->size--;
     return 0;
 }
@@ -458,7 +468,7 @@ ANV_API int anv_sll_pop_back(ANVSinglyLinkedList* list, const bool should_free_d
         anv_alloc_data_free(list->alloc, curr->data);
     }
 
-    anv_alloc_free(list->alloc, curr);
+    anv_alloc_free_sized(list->alloc, curr, sizeof(ANVSinglyLinkedNode));
     list->size--;
     return 0;
 }
@@ -924,7 +934,7 @@ static void sll_iterator_destroy(ANVIterator* it)
     }
 
     const SListIteratorState* state = it->data_state;
-    anv_alloc_free(state->list->alloc, it->data_state);
+    anv_alloc_free_sized(state->list->alloc, it->data_state, sizeof(SListIteratorState));
     it->data_state = NULL;
 }
 
@@ -46,7 +46,7 @@ static void free_node(ANVStack* stack, ANVStackNode* node, const bool should_fre
 
     if (stack->alloc)
     {
-        anv_alloc_free(stack->alloc, node);
+        anv_alloc_free_sized(stack->alloc, node, sizeof(ANVStackNode));
     }
 }
 
@@ -83,7 +83,7 @@ ANV_API void anv_stack_destroy(ANVStack* stack, const bool should_free_data)
 
     anv_stack_clear(stack, should_free_data);
 
-    anv_alloc_free(stack->alloc, stack);
+    anv_alloc_free_sized(stack->alloc, stack, sizeof(ANVStack));
 }
 
 ANV_API void anv_stack_clear(ANVStack* stack, const bool should_free_data)
@@ -119,6 +119,16 @@ ANV_API int anv_stack_is_empty(const ANVStack* stack)
     return !stack || stack->size == 0;
 }
 
+ANV_API size_t anv_stack_memory_usage(const ANVStack* stack)
+{
+    if (!stack)
+    {
+        return 0;
+    }
+
+    return sizeof(ANVStack) + stack->size * sizeof(ANVStackNode);
+}
+
 ANV_API int anv_stack_equals(const ANVStack* stack1, const ANVStack* stack2, const cmp_func compare)
 {
     if (!stack1 || !stack2 || !compare)
@@ -290,13 +300,13 @@ ANV_API ANVStack* anv_stack_copy(const ANVStack* stack)
     {
         if (anv_stack_push(new_stack, temp_array[i - 1]) != 0)
         {
-            anv_alloc_free(stack->alloc, temp_array);
+            anv_alloc_free_sized(stack->alloc, temp_array, stack->size * sizeof(void*));
             anv_stack_destroy(new_stack, false);
             return NULL;
         }
     }
 
-    anv_alloc_free(stack->alloc, temp_array);
+    anv_alloc_free_sized(stack->alloc, temp_array, stack->size * sizeof(void*));
     return new_stack;
 }
 
@@ -342,7 +352,7 @@ ANV_API ANVStack* anv_stack_copy_deep(const ANVStack* stack, const bool should_f
                     anv_alloc_data_free(stack->alloc, temp_array[j]);
                 }
             }
-            anv_alloc_free(stack->alloc, temp_array);
+            anv_alloc_free_sized(stack->alloc, temp_array, stack->size * sizeof(void*));
             anv_stack_destroy(new_stack, false);
             return NULL;
         }
@@ -363,13 +373,13 @@ ANV_API ANVStack* anv_stack_copy_deep(const ANVStack* stack, const bool should_f
                     anv_alloc_data_free(stack->alloc, temp_array[j]);
                 }
             }
-            anv_alloc_free(stack->alloc, temp_array);
+            anv_alloc_free_sized(stack->alloc, temp_array, stack->size * sizeof(void*));
             anv_stack_destroy(new_stack, false);
             return NULL;
         }
     }
 
-    anv_alloc_free(stack->alloc, temp_array);
+    anv_alloc_free_sized(stack->alloc, temp_array, stack->size * sizeof(void*));
     return new_stack;
 }
 
@@ -465,7 +475,7 @@ static void stack_iterator_destroy(ANVIterator* it)
         StackIteratorState* state = it->data_state;
         if (state->stack && state->stack->alloc)
         {
-            anv_alloc_free(state->stack->alloc, state);
+            anv_alloc_free_sized(state->stack->alloc, state, sizeof(StackIteratorState));
         }
     }
     it->data_state = NULL;
@@ -0,0 +1,310 @@
+//
+// Arena.c
+// Implementation of the bump-pointer arena allocator.
+//
+// Allocations bump an offset in the current chunk. When a chunk is full the
+// arena moves on to the next chunk in the chain, creating one if needed.
+// Reset and rollback only move the current chunk pointer and offset; chunks
+// further down the chain are lazily cleared when the arena reaches them.
+
+#include <stdint.h>
+#include <string.h>
+
+#include "Arena.h"
+
+//==============================================================================
+// Default constants
+//==============================================================================
+
+#define DEFAULT_CHUNK_SIZE (64 * 1024)
+#define DEFAULT_ALIGNMENT _Alignof(max_align_t)
+
+//==============================================================================
+// Static helper functions
+//==============================================================================
+
+/**
+ * Create a new chunk with at least the given payload capacity.
+ */
+static ANVArenaChunk* create_chunk(const ANVArena* arena, const size_t capacity)
+{
+    if (capacity > SIZE_MAX - sizeof(ANVArenaChunk))
+    {
+        return NULL;
+    }
+
+    ANVArenaChunk* chunk = anv_alloc_malloc(arena->backing, sizeof(ANVArenaChunk) + capacity);
+    if (!chunk)
+    {
+        return NULL;
+    }
+
+    chunk->next = NULL;
+    chunk->capacity = capacity;
+    chunk->used = 0;
+    return chunk;
+}
+
+/**
+ * Try to carve an allocation out of a chunk.
+ * Returns NULL if the chunk does not have enough room.
+ */
+static void* chunk_bump(ANVArenaChunk* chunk, const size_t size, const size_t alignment)
+{
+    const uintptr_t base = (uintptr_t)chunk->data;
+    const uintptr_t top = base + chunk->used;
+    const uintptr_t aligned = (top + (alignment - 1)) & ~(uintptr_t)(alignment - 1);
+    const size_t offset = (size_t)(aligned - base);
+
+    if (offset > chunk->capacity || size > chunk->capacity - offset)
+    {
+        return NULL;
+    }
+
+    chunk->used = offset + size;
+    return chunk->data + offset;
+}
+
+/**
+ * Check whether ptr/size is the most recent allocation in the current chunk.
+ */
+static bool is_last_allocation(const ANVArena* arena, const void* ptr, const size_t size)
+{
+    const ANVArenaChunk* chunk = arena->current;
+    if (!chunk || size == 0 || size > chunk->used)
+    {
+        return false;
+    }
+    return (const unsigned char*)ptr == chunk->data + (chunk->used - size);
+}
+
+//==============================================================================
+// Allocator view callbacks
+//==============================================================================
+
+static void* arena_ctx_alloc(void* ctx, const size_t size)
+{
+    return anv_arena_alloc(ctx, size);
+}
+
+static void arena_ctx_free(void* ctx, void* ptr, const size_t size)
+{
+    ANVArena* arena = ctx;
+
+    // Pop the most recent allocation so LIFO patterns reclaim space
+    if (is_last_allocation(arena, ptr, size))
+    {
+        arena->current->used -= size;
+    }
+}
+
+static void* arena_ctx_realloc(void* ctx, void* ptr, const size_t old_size, const size_t new_size)
+{
+    ANVArena* arena = ctx;
+
+    // Grow or shrink the most recent allocation in place when possible
+    if (is_last_allocation(arena, ptr, old_size))
+    {
+        const size_t offset = (size_t)((unsigned char*)ptr - arena->current->data);
+        if (new_size <= arena->current->capacity - offset)
+        {
+            arena->current->used = offset + new_size;
+            return ptr;
+        }
+    }
+
+    void* new_ptr = anv_arena_alloc(arena, new_size);
+    if (!new_ptr)
+    {
+        return NULL;
+    }
+
+    if (ptr)
+    {
+        memcpy(new_ptr, ptr, old_size < new_size ? old_size : new_size);
+    }
+    return new_ptr;
+}
+
+//==============================================================================
+// Creation and destruction functions
+//==============================================================================
+
+ANV_API ANVArena* anv_arena_create(ANVAllocator* backing, const size_t chunk_size)
+{
+    if (!anv_alloc_is_valid(backing))
+    {
+        return NULL;
+    }
+
+    ANVArena* arena = anv_alloc_malloc(backing, sizeof(ANVArena));
+    if (!arena)
+    {
+        return NULL;
+    }
+
+    arena->backing = backing;
+    arena->chunk_size = chunk_size > 0 ? chunk_size : DEFAULT_CHUNK_SIZE;
+    arena->chunk_count = 0;
+    arena->head = create_chunk(arena, arena->chunk_size);
+    if (!arena->head)
+    {
+        anv_alloc_free_sized(backing, arena, sizeof(ANVArena));
+        return NULL;
+    }
+
+    arena->current = arena->head;
+    arena->chunk_count = 1;
+    return arena;
+}
+
+ANV_API void anv_arena_destroy(ANVArena* arena)
+{
+    if (!arena)
+    {
+        return;
+    }
+
+    ANVArenaChunk* chunk = arena->head;
+    while (chunk)
+    {
+        ANVArenaChunk* next = chunk->next;
+        anv_alloc_free_sized(arena->backing, chunk, sizeof(ANVArenaChunk) + chunk->capacity);
+        chunk = next;
+    }
+
+    anv_alloc_free_sized(arena->backing, arena, sizeof(ANVArena));
+}
+
+//==============================================================================
+// Allocation functions
+//==============================================================================
+
+ANV_API void* anv_arena_alloc(ANVArena* arena, const size_t size)
+{
+    return anv_arena_alloc_aligned(arena, size, DEFAULT_ALIGNMENT);
+}
+
+ANV_API void* anv_arena_alloc_aligned(ANVArena* arena, const size_t size, const size_t alignment)
+{
+    if (!arena || size == 0 || alignment == 0 || (alignment & (alignment - 1)) != 0)
+    {
+        return NULL;
+    }
+
+    void* ptr = chunk_bump(arena->current, size, alignment);
+    if (ptr)
+    {
+        return ptr;
+    }
+
+    // Reuse the next chunk in the chain if it is large enough
+    ANVArenaChunk* next = arena->current->next;
+    if (next && next->capacity >= size + alignment)
+    {
+        next->used = 0;
+        arena->current = next;
+        return chunk_bump(next, size, alignment);
+    }
+
+    // Otherwise splice a fresh chunk in after the current one
+    if (size > SIZE_MAX - alignment)
+    {
+        return NULL;
+    }
+    const size_t needed = size + alignment;
+    ANVArenaChunk* chunk = create_chunk(arena, needed > arena->chunk_size ? needed : arena->chunk_size);
+    if (!chunk)
+    {
+        return NULL;
+    }
+
+    chunk->next = arena->current->next;
+    arena->current->next = chunk;
+    arena->current = chunk;
+    arena->chunk_count++;
+
+    return chunk_bump(chunk, size, alignment);
+}
+
+ANV_API void anv_arena_reset(ANVArena* arena)
+{
+    if (!arena)
+    {
+        return;
+    }
+
+    arena->current = arena->head;
+    arena->head->used = 0;
+}
+
+ANV_API ANVArenaCheckpoint anv_arena_checkpoint(const ANVArena* arena)
+{
+    ANVArenaCheckpoint checkpoint = {0};
+    if (!arena)
+    {
+        return checkpoint;
+    }
+
+    checkpoint.chunk = arena->current;
+    checkpoint.used = arena->current->used;
+    return checkpoint;
+}
+
+ANV_API void anv_arena_rollback(ANVArena* arena, const ANVArenaCheckpoint checkpoint)
+{
+    if (!arena || !checkpoint.chunk)
+    {
+        return;
+    }
+
+    arena->current = checkpoint.chunk;
+    arena->current->used = checkpoint.used;
+}
+
+//==============================================================================
+// Information functions
+//==============================================================================
+
+ANV_API size_t anv_arena_bytes_used(const ANVArena* arena)
+{
+    if (!arena)
+    {
+        return 0;
+    }
+
+    size_t total = 0;
+    for (const ANVArenaChunk* chunk = arena->head; chunk; chunk = chunk->next)
+    {
+        total += chunk->used;
+        if (chunk == arena->current)
+        {
+            break;
+        }
+    }
+    return total;
+}
+
+ANV_API size_t anv_arena_bytes_reserved(const ANVArena* arena)
+{
+    if (!arena)
+    {
+        return 0;
+    }
+
+    size_t total = 0;
+    for (const ANVArenaChunk* chunk = arena->head; chunk; chunk = chunk->next)
+    {
+        total += chunk->capacity;
+    }
+    return total;
+}
+
+//==============================================================================
+// Allocator view
+//==============================================================================
+
+ANV_API ANVAllocator anv_arena_allocator(ANVArena* arena)
+{
+    return anv_alloc_context(arena, arena_ctx_alloc, arena_ctx_free, arena_ctx_realloc, NULL, NULL);
+}
@@ -0,0 +1,598 @@
+//
+// CachingHeap.c
+// Implementation of the thread-caching front-end allocator.
+//
+// Every block carries a small header recording its size class. Small blocks
+// are carved from per-class spans and move between three places: the
+// thread caches (lock free, owned by one thread), the central free lists
+// (guarded by the heap mutex) and the caller. Large blocks record their
+// size in the header and go straight to the backing allocator.
+//
+// A thread cache leaves its thread when the thread flushes it or when its
+// entry is evicted from the thread-local table. Its blocks then go back to
+// the central lists and the empty cache waits on the heap's idle list for
+// the next thread that needs one. Eviction may find an entry whose heap was
+// destroyed, so it first checks the process-wide list of live heaps.
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "CachingHeap.h"
+
+//==============================================================================
+// Default constants
+//==============================================================================
+
+#define HEAP_ALIGNMENT _Alignof(max_align_t)
+#define SPAN_SIZE (64 * 1024)
+#define BATCH_SIZE 32
+#define CACHE_LIMIT (2 * BATCH_SIZE)
+#define TLS_SLOTS 8
+#define LARGE_CLASS SIZE_MAX
+
+//==============================================================================
+// Internal types
+//==============================================================================
+
+/**
+ * Per-thread cache of free blocks, one list per size class.
+ */
+typedef struct ANVThreadCache
+{
+    struct ANVThreadCache* next;                      // Next cache registered with the heap
+    struct ANVThreadCache* next_idle;                 // Next cache on the heap's idle list
+    void* free_list[ANV_CACHING_HEAP_CLASS_COUNT];    // Cached blocks per size class
+    size_t count[ANV_CACHING_HEAP_CLASS_COUNT];       // Length of each cached list
+} ANVThreadCache;
+
+/**
+ * Span header. Spans are carved into blocks of a single size class.
+ */
+typedef struct ANVCachingHeapSpan
+{
+    struct ANVCachingHeapSpan* next;
+} ANVCachingHeapSpan;
+
+/**
+ * Header stored in front of every block handed out.
+ */
+typedef struct BlockHeader
+{
+    size_t size_class; // Index into class_sizes, or LARGE_CLASS
+    size_t large_size; // Requested size for large blocks
+} BlockHeader;
+
+/**
+ * Thread-local lookup entry mapping a heap id to this thread's cache.
+ * Ids are never reused, so entries left behind by destroyed heaps never match.
+ */
+typedef struct ThreadCacheSlot
+{
+    size_t heap_id;
+    ANVThreadCache* cache;
+} ThreadCacheSlot;
+
+//==============================================================================
+// Static data
+//==============================================================================
+
+static const size_t class_sizes[ANV_CACHING_HEAP_CLASS_COUNT] = {
+    16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, ANV_CACHING_HEAP_MAX_SMALL
+};
+
+// Size class for each 16-byte step up to ANV_CACHING_HEAP_MAX_SMALL
+#define CLASS_LOOKUP_SIZE (ANV_CACHING_HEAP_MAX_SMALL / 16 + 1)
+static const unsigned char class_lookup[CLASS_LOOKUP_SIZE] = {
+    0, 0, 1, 2, 3, 4, 4, 5, 5, 6, 6, 6, 6, 7, 7, 7,
+    7, 8, 8, 8, 8, 8, 8, 8, 8, 9, 9, 9, 9, 9, 9, 9,
+    9, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11,
+    11
+};
+
+static atomic_size_t next_heap_id = 1;
+
+// Live heaps, so evicting a thread-local entry never touches a destroyed heap
+static atomic_flag live_heaps_lock = ATOMIC_FLAG_INIT;
+static ANVCachingHeap* live_heaps;
+
+static ANVIL_THREAD_LOCAL ThreadCacheSlot tls_slots[TLS_SLOTS];
+static ANVIL_THREAD_LOCAL size_t tls_next_slot;
+static ANVIL_THREAD_LOCAL ThreadCacheSlot* tls_last_slot;
+
+//==============================================================================
+// Static helper functions
+//==============================================================================
+
+static size_t round_up(const size_t value, const size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+static size_t header_size(void)
+{
+    return round_up(sizeof(BlockHeader), HEAP_ALIGNMENT);
+}
+
+static BlockHeader* header_of(void* ptr)
+{
+    return (BlockHeader*)((unsigned char*)ptr - header_size());
+}
+
+static void* payload_of(BlockHeader* header)
+{
+    return (unsigned char*)header + header_size();
+}
+
+/**
+ * Map a request size to its size class (sizes must be <= ANV_CACHING_HEAP_MAX_SMALL).
+ * Uses a 16-byte granularity lookup table.
+ */
+static size_t size_class_of(const size_t size)
+{
+    return class_lookup[(size + 15) >> 4];
+}
+
+/**
+ * Carve a fresh span into blocks of the given class and push them centrally.
+ * Caller must hold heap->lock.
+ */
+static int add_span_locked(ANVCachingHeap* heap, const size_t cls)
+{
+    ANVCachingHeapSpan* span = anv_alloc_malloc(heap->backing, SPAN_SIZE);
+    if (!span)
+    {
+        return -1;
+    }
+
+    span->next = heap->spans;
+    heap->spans = span;
+    heap->span_count++;
+
+    const size_t stride = header_size() + class_sizes[cls];
+    unsigned char* cursor = (unsigned char*)span + round_up(sizeof(ANVCachingHeapSpan), HEAP_ALIGNMENT);
+    const unsigned char* end = (unsigned char*)span + SPAN_SIZE;
+
+    while (cursor + stride <= end)
+    {
+        BlockHeader* header = (BlockHeader*)cursor;
+        header->size_class = cls;
+        header->large_size = 0;
+
+        void* block = payload_of(header);
+        *(void**)block = heap->central[cls];
+        heap->central[cls] = block;
+        heap->central_count[cls]++;
+
+        cursor += stride;
+    }
+    return 0;
+}
+
+/**
+ * Move up to BATCH_SIZE blocks of a class from the central heap to a cache.
+ */
+static int refill_cache(ANVCachingHeap* heap, ANVThreadCache* cache, const size_t cls)
+{
+    anv_mutex_lock(&heap->lock);
+
+    if (!heap->central[cls] && add_span_locked(heap, cls) != 0)
+    {
+        anv_mutex_unlock(&heap->lock);
+        return -1;
+    }
+
+    size_t moved = 0;
+    while (heap->central[cls] && moved < BATCH_SIZE)
+    {
+        void* block = heap->central[cls];
+        heap->central[cls] = *(void**)block;
+
+        *(void**)block = cache->free_list[cls];
+        cache->free_list[cls] = block;
+        moved++;
+    }
+    heap->central_count[cls] -= moved;
+    cache->count[cls] += moved;
+    heap->refills++;
+
+    anv_mutex_unlock(&heap->lock);
+    return 0;
+}
+
+/**
+ * Return up to count blocks of a class from a cache to the central heap.
+ * The chain is detached without the lock and spliced in O(1) under it.
+ */
+static void flush_cache(ANVCachingHeap* heap, ANVThreadCache* cache, const size_t cls, size_t count)
+{
+    if (count > cache->count[cls])
+    {
+        count = cache->count[cls];
+    }
+    if (count == 0)
+    {
+        return;
+    }
+
+    void* head = cache->free_list[cls];
+    void* tail = head;
+    for (size_t i = 1; i < count; i++)
+    {
+        tail = *(void**)tail;
+    }
+    cache->free_list[cls] = *(void**)tail;
+    cache->count[cls] -= count;
+
+    anv_mutex_lock(&heap->lock);
+    *(void**)tail = heap->central[cls];
+    heap->central[cls] = head;
+    heap->central_count[cls] += count;
+    heap->flushes++;
+    anv_mutex_unlock(&heap->lock);
+}
+
+static void lock_live_heaps(void)
+{
+    while (atomic_flag_test_and_set_explicit(&live_heaps_lock, memory_order_acquire))
+    {
+    }
+}
+
+static void unlock_live_heaps(void)
+{
+    atomic_flag_clear_explicit(&live_heaps_lock, memory_order_release);
+}
+
+/**
+ * Return all of a cache's blocks to the central heap and park the empty
+ * cache on the idle list. The calling thread must not use it afterwards.
+ */
+static void release_cache(ANVCachingHeap* heap, ANVThreadCache* cache)
+{
+    for (size_t cls = 0; cls < ANV_CACHING_HEAP_CLASS_COUNT; cls++)
+    {
+        flush_cache(heap, cache, cls, cache->count[cls]);
+    }
+
+    anv_mutex_lock(&heap->lock);
+    cache->next_idle = heap->idle_caches;
+    heap->idle_caches = cache;
+    anv_mutex_unlock(&heap->lock);
+}
+
+/**
+ * Empty a thread-local entry, releasing its cache if its heap still exists.
+ */
+static void evict_slot(ThreadCacheSlot* slot)
+{
+    if (slot->heap_id != 0)
+    {
+        lock_live_heaps();
+        for (ANVCachingHeap* heap = live_heaps; heap; heap = heap->next_live)
+        {
+            if (heap->id == slot->heap_id)
+            {
+                release_cache(heap, slot->cache);
+                break;
+            }
+        }
+        unlock_live_heaps();
+    }
+
+    slot->heap_id = 0;
+    slot->cache = NULL;
+}
+
+/**
+ * Find the calling thread's cache for a heap, claiming an idle cache or
+ * creating one if the thread has none. Returns NULL if a cache cannot be
+ * created.
+ */
+static ANVThreadCache* get_thread_cache(ANVCachingHeap* heap)
+{
+    // Fast path: most threads only ever talk to one heap
+    ThreadCacheSlot* last = tls_last_slot;
+    if (last && last->heap_id == heap->id)
+    {
+        return last->cache;
+    }
+
+    for (size_t i = 0; i < TLS_SLOTS; i++)
+    {
+        if (tls_slots[i].heap_id == heap->id)
+        {
+            tls_last_slot = &tls_slots[i];
+            return tls_slots[i].cache;
+        }
+    }
+
+    anv_mutex_lock(&heap->lock);
+    ANVThreadCache* cache = heap->idle_caches;
+    if (cache)
+    {
+        heap->idle_caches = cache->next_idle;
+    }
+    anv_mutex_unlock(&heap->lock);
+
+    if (!cache)
+    {
+        cache = anv_alloc_malloc(heap->backing, sizeof(ANVThreadCache));
+        if (!cache)
+        {
+            return NULL;
+        }
+        memset(cache, 0, sizeof(ANVThreadCache));
+
+        anv_mutex_lock(&heap->lock);
+        cache->next = heap->caches;
+        heap->caches = cache;
+        heap->cache_count++;
+        anv_mutex_unlock(&heap->lock);
+    }
+
+    // When all slots are taken the oldest entry is evicted and its cache released
+    ThreadCacheSlot* slot = &tls_slots[tls_next_slot % TLS_SLOTS];
+    tls_next_slot++;
+    evict_slot(slot);
+    slot->heap_id = heap->id;
+    slot->cache = cache;
+    tls_last_slot = slot;
+    return cache;
+}
+
+//==============================================================================
+// Allocator view callbacks
+//==============================================================================
+
+static void* heap_ctx_alloc(void* ctx, const size_t size)
+{
+    return anv_caching_heap_alloc(ctx, size);
+}
+
+static void heap_ctx_free(void* ctx, void* ptr, const size_t size)
+{
+    (void)size;
+    anv_caching_heap_free(ctx, ptr);
+}
+
+static void* heap_ctx_realloc(void* ctx, void* ptr, const size_t old_size, const size_t new_size)
+{
+    const BlockHeader* header = header_of(ptr);
+    const size_t usable = header->size_class == LARGE_CLASS ? header->large_size : class_sizes[header->size_class];
+
+    // Stay in the same block when the size class still fits
+    if (new_size <= usable && header->size_class != LARGE_CLASS)
+    {
+        return ptr;
+    }
+
+    void* new_ptr = anv_caching_heap_alloc(ctx, new_size);
+    if (!new_ptr)
+    {
+        return NULL;
+    }
+
+    const size_t to_copy = old_size > 0 ? old_size : usable;
+    memcpy(new_ptr, ptr, to_copy < new_size ? to_copy : new_size);
+    anv_caching_heap_free(ctx, ptr);
+    return new_ptr;
+}
+
+//==============================================================================
+// Creation and destruction functions
+//==============================================================================
+
+ANV_API ANVCachingHeap* anv_caching_heap_create(ANVAllocator* backing)
+{
+    if (!anv_alloc_is_valid(backing))
+    {
+        return NULL;
+    }
+
+    ANVCachingHeap* heap = anv_alloc_malloc(backing, sizeof(ANVCachingHeap));
+    if (!heap)
+    {
+        return NULL;
+    }
+    memset(heap, 0, sizeof(ANVCachingHeap));
+
+    if (anv_mutex_init(&heap->lock) != 0)
+    {
+        anv_alloc_free_sized(backing, heap, sizeof(ANVCachingHeap));
+        return NULL;
+    }
+
+    heap->backing = backing;
+    heap->id = atomic_fetch_add(&next_heap_id, 1);
+
+    lock_live_heaps();
+    heap->next_live = live_heaps;
+    live_heaps = heap;
+    unlock_live_heaps();
+    return heap;
+}
+
+ANV_API void anv_caching_heap_destroy(ANVCachingHeap* heap)
+{
+    if (!heap)
+    {
+        return;
+    }
+
+    lock_live_heaps();
+    ANVCachingHeap** link = &live_heaps;
+    while (*link != heap)
+    {
+        link = &(*link)->next_live;
+    }
+    *link = heap->next_live;
+    unlock_live_heaps();
+
+    ANVThreadCache* cache = heap->caches;
+    while (cache)
+    {
+        ANVThreadCache* next = cache->next;
+        anv_alloc_free_sized(heap->backing, cache, sizeof(ANVThreadCache));
+        cache = next;
+    }
+
+    ANVCachingHeapSpan* span = heap->spans;
+    while (span)
+    {
+        ANVCachingHeapSpan* next = span->next;
+        anv_alloc_free_sized(heap->backing, span, SPAN_SIZE);
+        span = next;
+    }
+
+    anv_mutex_destroy(&heap->lock);
+    anv_alloc_free_sized(heap->backing, heap, sizeof(ANVCachingHeap));
+}
+
+//==============================================================================
+// Allocation functions
+//==============================================================================
+
+ANV_API void* anv_caching_heap_alloc(ANVCachingHeap* heap, const size_t size)
+{
+    if (!heap || size == 0)
+    {
+        return NULL;
+    }
+
+    if (size > ANV_CACHING_HEAP_MAX_SMALL)
+    {
+        if (size > SIZE_MAX - header_size())
+        {
+            return NULL;
+        }
+
+        BlockHeader* header = anv_alloc_malloc(heap->backing, header_size() + size);
+        if (!header)
+        {
+            return NULL;
+        }
+        header->size_class = LARGE_CLASS;
+        header->large_size = size;
+
+        anv_mutex_lock(&heap->lock);
+        heap->large_allocations++;
+        anv_mutex_unlock(&heap->lock);
+        return payload_of(header);
+    }
+
+    ANVThreadCache* cache = get_thread_cache(heap);
+    if (!cache)
+    {
+        return NULL;
+    }
+
+    const size_t cls = size_class_of(size);
+    if (!cache->free_list[cls] && refill_cache(heap, cache, cls) != 0)
+    {
+        return NULL;
+    }
+
+    void* block = cache->free_list[cls];
+    cache->free_list[cls] = *(void**)block;
+    cache->count[cls]--;
+    return block;
+}
+
+ANV_API void anv_caching_heap_free(ANVCachingHeap* heap, void* ptr)
+{
+    if (!heap || !ptr)
+    {
+        return;
+    }
+
+    BlockHeader* header = header_of(ptr);
+    if (header->size_class == LARGE_CLASS)
+    {
+        anv_alloc_free_sized(heap->backing, header, header_size() + header->large_size);
+        return;
+    }
+
+    const size_t cls = header->size_class;
+    ANVThreadCache* cache = get_thread_cache(heap);
+    if (!cache)
+    {
+        // No cache for this thread: hand the block straight to the central heap
+        anv_mutex_lock(&heap->lock);
+        *(void**)ptr = heap->central[cls];
+        heap->central[cls] = ptr;
+        heap->central_count[cls]++;
+        anv_mutex_unlock(&heap->lock);
+        return;
+    }
+
+    *(void**)ptr = cache->free_list[cls];
+    cache->free_list[cls] = ptr;
+    cache->count[cls]++;
+
+    if (cache->count[cls] > CACHE_LIMIT)
+    {
+        flush_cache(heap, cache, cls, BATCH_SIZE);
+    }
+}
+
+ANV_API void anv_caching_heap_flush_thread(ANVCachingHeap* heap)
+{
+    if (!heap)
+    {
+        return;
+    }
+
+    // A thread whose entry was evicted has already released its cache
+    for (size_t i = 0; i < TLS_SLOTS; i++)
+    {
+        if (tls_slots[i].heap_id == heap->id)
+        {
+            release_cache(heap, tls_slots[i].cache);
+            tls_slots[i].heap_id = 0;
+            tls_slots[i].cache = NULL;
+            return;
+        }
+    }
+}
+
+//==============================================================================
+// Information functions
+//==============================================================================
+
+ANV_API int anv_caching_heap_stats(ANVCachingHeap* heap, ANVCachingHeapStats* stats_out)
+{
+    if (!heap || !stats_out)
+    {
+        return -1;
+    }
+
+    anv_mutex_lock(&heap->lock);
+    stats_out->thread_caches = heap->cache_count;
+    stats_out->idle_caches = 0;
+    for (const ANVThreadCache* cache = heap->idle_caches; cache; cache = cache->next_idle)
+    {
+        stats_out->idle_caches++;
+    }
+    stats_out->refills = heap->refills;
+    stats_out->flushes = heap->flushes;
+    stats_out->large_allocations = heap->large_allocations;
+    stats_out->spans = heap->span_count;
+    stats_out->central_blocks = 0;
+    for (size_t cls = 0; cls < ANV_CACHING_HEAP_CLASS_COUNT; cls++)
+    {
+        stats_out->central_blocks += heap->central_count[cls];
+    }
+    anv_mutex_unlock(&heap->lock);
+    return 0;
+}
+
+//==============================================================================
+// Allocator view
+//==============================================================================
+
+ANV_API ANVAllocator anv_caching_heap_allocator(ANVCachingHeap* heap)
+{
+    return anv_alloc_context(heap, heap_ctx_alloc, heap_ctx_free, heap_ctx_realloc, NULL, NULL);
+}
@@ -0,0 +1,242 @@
+//
+// Pool.c
+// Implementation of the fixed-size object pool.
+//
+// Each slab is a single backing allocation holding a header followed by
+// objects_per_slab objects. New objects are bumped from the newest slab;
+// released objects are pushed onto an intrusive free list and reused first.
+
+#include <stdint.h>
+
+#include "Pool.h"
+
+//==============================================================================
+// Default constants
+//==============================================================================
+
+#define DEFAULT_OBJECTS_PER_SLAB 256
+#define POOL_ALIGNMENT _Alignof(max_align_t)
+
+//==============================================================================
+// Static helper functions
+//==============================================================================
+
+static size_t round_up(const size_t value, const size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+/**
+ * Offset of the first object inside a slab.
+ */
+static size_t slab_header_size(void)
+{
+    return round_up(sizeof(ANVPoolSlab), POOL_ALIGNMENT);
+}
+
+static size_t slab_bytes(const ANVPool* pool)
+{
+    return slab_header_size() + pool->stride * pool->objects_per_slab;
+}
+
+/**
+ * Allocate a new slab and make it the bump region.
+ */
+static int add_slab(ANVPool* pool)
+{
+    ANVPoolSlab* slab = anv_alloc_malloc(pool->backing, slab_bytes(pool));
+    if (!slab)
+    {
+        return -1;
+    }
+
+    slab->next = pool->slabs;
+    pool->slabs = slab;
+    pool->slab_count++;
+
+    pool->bump = (unsigned char*)slab + slab_header_size();
+    pool->bump_end = pool->bump + pool->stride * pool->objects_per_slab;
+    return 0;
+}
+
+//==============================================================================
+// Allocator view callbacks
+//==============================================================================
+
+static void* pool_ctx_alloc(void* ctx, const size_t size)
+{
+    ANVPool* pool = ctx;
+    if (size <= pool->object_size)
+    {
+        return anv_pool_alloc(pool);
+    }
+    return anv_alloc_malloc(pool->backing, size);
+}
+
+static void pool_ctx_free(void* ctx, void* ptr, const size_t size)
+{
+    ANVPool* pool = ctx;
+
+    // Unknown sizes (0) need an ownership check to find the right home
+    const bool from_pool = size > 0 ? size <= pool->object_size : anv_pool_owns(pool, ptr);
+    if (from_pool)
+    {
+        anv_pool_free(pool, ptr);
+    }
+    else
+    {
+        anv_alloc_free_sized(pool->backing, ptr, size);
+    }
+}
+
+//==============================================================================
+// Creation and destruction functions
+//==============================================================================
+
+ANV_API ANVPool* anv_pool_create(ANVAllocator* backing, const size_t object_size, const size_t objects_per_slab)
+{
+    if (!anv_alloc_is_valid(backing) || object_size == 0)
+    {
+        return NULL;
+    }
+
+    ANVPool* pool = anv_alloc_malloc(backing, sizeof(ANVPool));
+    if (!pool)
+    {
+        return NULL;
+    }
+
+    // Every object must be able to hold the free list link
+    const size_t min_size = object_size < sizeof(void*) ? sizeof(void*) : object_size;
+
+    pool->slabs = NULL;
+    pool->free_list = NULL;
+    pool->bump = NULL;
+    pool->bump_end = NULL;
+    pool->object_size = object_size;
+    pool->stride = round_up(min_size, POOL_ALIGNMENT);
+    pool->objects_per_slab = objects_per_slab > 0 ? objects_per_slab : DEFAULT_OBJECTS_PER_SLAB;
+    pool->slab_count = 0;
+    pool->live_objects = 0;
+    pool->high_water = 0;
+    pool->backing = backing;
+
+    return pool;
+}
+
+ANV_API void anv_pool_destroy(ANVPool* pool)
+{
+    if (!pool)
+    {
+        return;
+    }
+
+    const size_t bytes = slab_bytes(pool);
+    ANVPoolSlab* slab = pool->slabs;
+    while (slab)
+    {
+        ANVPoolSlab* next = slab->next;
+        anv_alloc_free_sized(pool->backing, slab, bytes);
+        slab = next;
+    }
+
+    anv_alloc_free_sized(pool->backing, pool, sizeof(ANVPool));
+}
+
+//==============================================================================
+// Allocation functions
+//==============================================================================
+
+ANV_API void* anv_pool_alloc(ANVPool* pool)
+{
+    if (!pool)
+    {
+        return NULL;
+    }
+
+    void* object;
+    if (pool->free_list)
+    {
+        object = pool->free_list;
+        pool->free_list = *(void**)object;
+    }
+    else
+    {
+        if (pool->bump == pool->bump_end && add_slab(pool) != 0)
+        {
+            return NULL;
+        }
+        object = pool->bump;
+        pool->bump += pool->stride;
+    }
+
+    pool->live_objects++;
+    if (pool->live_objects > pool->high_water)
+    {
+        pool->high_water = pool->live_objects;
+    }
+    return object;
+}
+
+ANV_API void anv_pool_free(ANVPool* pool, void* ptr)
+{
+    if (!pool || !ptr)
+    {
+        return;
+    }
+
+    *(void**)ptr = pool->free_list;
+    pool->free_list = ptr;
+    pool->live_objects--;
+}
+
+ANV_API bool anv_pool_owns(const ANVPool* pool, const void* ptr)
+{
+    if (!pool || !ptr)
+    {
+        return false;
+    }
+
+    const uintptr_t addr = (uintptr_t)ptr;
+    const size_t bytes = slab_bytes(pool);
+    for (const ANVPoolSlab* slab = pool->slabs; slab; slab = slab->next)
+    {
+        const uintptr_t begin = (uintptr_t)slab + slab_header_size();
+        const uintptr_t end = (uintptr_t)slab + bytes;
+        if (addr >= begin && addr < end)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+//==============================================================================
+// Information functions
+//==============================================================================
+
+ANV_API int anv_pool_stats(const ANVPool* pool, ANVPoolStats* stats_out)
+{
+    if (!pool || !stats_out)
+    {
+        return -1;
+    }
+
+    stats_out->object_size = pool->object_size;
+    stats_out->stride = pool->stride;
+    stats_out->live_objects = pool->live_objects;
+    stats_out->high_water = pool->high_water;
+    stats_out->slab_count = pool->slab_count;
+    stats_out->capacity = pool->slab_count * pool->objects_per_slab;
+    stats_out->bytes_reserved = pool->slab_count * slab_bytes(pool);
+    return 0;
+}
+
+//==============================================================================
+// Allocator view
+//==============================================================================
+
+ANV_API ANVAllocator anv_pool_allocator(ANVPool* pool)
+{
+    return anv_alloc_context(pool, pool_ctx_alloc, pool_ctx_free, NULL, NULL, NULL);
+}
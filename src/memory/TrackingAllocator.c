@@ -0,0 +1,240 @@
+//
+// TrackingAllocator.c
+// Implementation of the instrumented allocator wrapper.
+//
+// Every block is prefixed with a header recording the requested size. The
+// header is padded to the maximum fundamental alignment so the pointer handed
+// to the caller keeps the alignment guarantees of the inner allocator.
+
+#include <stdint.h>
+#include <string.h>
+
+#include "TrackingAllocator.h"
+
+//==============================================================================
+// Default constants
+//==============================================================================
+
+#define HEADER_SIZE _Alignof(max_align_t)
+#define SMALLEST_BUCKET_SHIFT 4
+
+//==============================================================================
+// Static helper functions
+//==============================================================================
+
+static void* header_of(void* ptr)
+{
+    return (unsigned char*)ptr - HEADER_SIZE;
+}
+
+static size_t stored_size(void* ptr)
+{
+    size_t size;
+    memcpy(&size, header_of(ptr), sizeof(size));
+    return size;
+}
+
+static void* finish_block(void* block, const size_t size)
+{
+    memcpy(block, &size, sizeof(size));
+    return (unsigned char*)block + HEADER_SIZE;
+}
+
+static size_t bucket_for(const size_t size)
+{
+    size_t bucket = 0;
+    size_t limit = (size_t)1 << SMALLEST_BUCKET_SHIFT;
+    while (bucket < ANV_TRACKING_HISTOGRAM_BUCKETS - 1 && size > limit)
+    {
+        limit <<= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+static void record_allocation(ANVTrackingAllocator* tracker, const size_t size)
+{
+    tracker->allocations++;
+    tracker->total_bytes += size;
+    tracker->histogram[bucket_for(size)]++;
+    tracker->bytes_in_flight += size;
+    if (tracker->bytes_in_flight > tracker->peak_bytes)
+    {
+        tracker->peak_bytes = tracker->bytes_in_flight;
+    }
+}
+
+static void record_free(ANVTrackingAllocator* tracker, const size_t size)
+{
+    tracker->frees++;
+    tracker->bytes_in_flight -= size;
+}
+
+//==============================================================================
+// Allocator view callbacks
+//==============================================================================
+
+static void* tracking_ctx_alloc(void* ctx, const size_t size)
+{
+    ANVTrackingAllocator* tracker = ctx;
+
+    if (size > SIZE_MAX - HEADER_SIZE)
+    {
+        tracker->failed_allocations++;
+        return NULL;
+    }
+
+    void* block = anv_alloc_malloc(tracker->inner, HEADER_SIZE + size);
+    if (!block)
+    {
+        tracker->failed_allocations++;
+        return NULL;
+    }
+
+    record_allocation(tracker, size);
+    return finish_block(block, size);
+}
+
+static void tracking_ctx_free(void* ctx, void* ptr, const size_t size)
+{
+    ANVTrackingAllocator* tracker = ctx;
+    (void)size; // The header is authoritative, callers may pass 0
+
+    if (!ptr)
+    {
+        return;
+    }
+
+    const size_t actual = stored_size(ptr);
+    record_free(tracker, actual);
+    anv_alloc_free_sized(tracker->inner, header_of(ptr), HEADER_SIZE + actual);
+}
+
+static void* tracking_ctx_realloc(void* ctx, void* ptr, const size_t old_size, const size_t new_size)
+{
+    ANVTrackingAllocator* tracker = ctx;
+    (void)old_size;
+
+    if (!ptr)
+    {
+        return tracking_ctx_alloc(ctx, new_size);
+    }
+
+    if (new_size > SIZE_MAX - HEADER_SIZE)
+    {
+        tracker->failed_allocations++;
+        return NULL;
+    }
+
+    const size_t actual = stored_size(ptr);
+    void* block = anv_alloc_realloc(tracker->inner, header_of(ptr), HEADER_SIZE + actual, HEADER_SIZE + new_size);
+    if (!block)
+    {
+        tracker->failed_allocations++;
+        return NULL;
+    }
+
+    // A resize is accounted as releasing the old block and acquiring a new one
+    tracker->reallocations++;
+    tracker->bytes_in_flight -= actual;
+    tracker->total_bytes += new_size;
+    tracker->histogram[bucket_for(new_size)]++;
+    tracker->bytes_in_flight += new_size;
+    if (tracker->bytes_in_flight > tracker->peak_bytes)
+    {
+        tracker->peak_bytes = tracker->bytes_in_flight;
+    }
+
+    return finish_block(block, new_size);
+}
+
+//==============================================================================
+// Creation and destruction functions
+//==============================================================================
+
+ANV_API int anv_tracking_init(ANVTrackingAllocator* tracker, ANVAllocator* inner)
+{
+    if (!tracker || !anv_alloc_is_valid(inner))
+    {
+        return -1;
+    }
+
+    memset(tracker, 0, sizeof(*tracker));
+    tracker->inner = inner;
+    return 0;
+}
+
+ANV_API void anv_tracking_reset_stats(ANVTrackingAllocator* tracker)
+{
+    if (!tracker)
+    {
+        return;
+    }
+
+    tracker->allocations = 0;
+    tracker->frees = 0;
+    tracker->reallocations = 0;
+    tracker->failed_allocations = 0;
+    tracker->total_bytes = 0;
+    tracker->peak_bytes = tracker->bytes_in_flight;
+    memset(tracker->histogram, 0, sizeof(tracker->histogram));
+}
+
+//==============================================================================
+// Information functions
+//==============================================================================
+
+ANV_API size_t anv_tracking_bucket_limit(const size_t bucket)
+{
+    if (bucket >= ANV_TRACKING_HISTOGRAM_BUCKETS - 1)
+    {
+        return SIZE_MAX;
+    }
+    return (size_t)1 << (bucket + SMALLEST_BUCKET_SHIFT);
+}
+
+ANV_API void anv_tracking_print(const ANVTrackingAllocator* tracker, FILE* stream)
+{
+    if (!tracker || !stream)
+    {
+        return;
+    }
+
+    fprintf(stream, "allocations: %zu, frees: %zu, reallocations: %zu, failed: %zu\n",
+            tracker->allocations, tracker->frees, tracker->reallocations, tracker->failed_allocations);
+    fprintf(stream, "bytes in flight: %zu, peak: %zu, total requested: %zu\n",
+            tracker->bytes_in_flight, tracker->peak_bytes, tracker->total_bytes);
+
+    for (size_t i = 0; i < ANV_TRACKING_HISTOGRAM_BUCKETS; i++)
+    {
+        if (tracker->histogram[i] == 0)
+        {
+            continue;
+        }
+
+        if (i == ANV_TRACKING_HISTOGRAM_BUCKETS - 1)
+        {
+            fprintf(stream, "  > %zu B: %zu\n", anv_tracking_bucket_limit(i - 1), tracker->histogram[i]);
+        }
+        else
+        {
+            fprintf(stream, "  <= %zu B: %zu\n", anv_tracking_bucket_limit(i), tracker->histogram[i]);
+        }
+    }
+}
+
+//==============================================================================
+// Allocator view
+//==============================================================================
+
+ANV_API ANVAllocator anv_tracking_allocator(ANVTrackingAllocator* tracker)
+{
+    ANVAllocator alloc = anv_alloc_context(tracker, tracking_ctx_alloc, tracking_ctx_free, tracking_ctx_realloc,
+                                           NULL, NULL);
+    if (tracker && tracker->inner)
+    {
+        alloc.data_free = tracker->inner->data_free;
+        alloc.copy = tracker->inner->copy;
+    }
+    return alloc;
+}
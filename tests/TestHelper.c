@@ -6,6 +6,7 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 // Integer comparison function
 int int_cmp(const void* a, const void* b)
@@ -291,4 +292,62 @@ ANVAllocator create_person_allocator(void)
 ANVAllocator create_string_allocator(void)
 {
     return anv_alloc_custom(test_calloc, test_dealloc, free, string_copy);
-}
\ No newline at end of file
+}
+
+double now_seconds(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+unsigned next_random(unsigned* state)
+{
+    *state = *state * 1103515245u + 12345u;
+    return *state >> 8;
+}
+
+int build_zipf_trace(const int* keys, const size_t num_keys, const int** trace, const size_t length,
+                     unsigned long long seed)
+{
+    double* cdf = malloc(sizeof(double) * num_keys);
+    if (!cdf)
+    {
+        return -1;
+    }
+
+    double total = 0.0;
+    for (size_t i = 0; i < num_keys; i++)
+    {
+        total += 1.0 / (double)(i + 1);
+        cdf[i] = total;
+    }
+
+    for (size_t i = 0; i < length; i++)
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        const double target = (double)(seed >> 11) / 9007199254740992.0 * total;
+
+        size_t lo = 0;
+        size_t hi = num_keys - 1;
+        while (lo < hi)
+        {
+            const size_t mid = lo + (hi - lo) / 2;
+            if (cdf[mid] < target)
+            {
+                lo = mid + 1;
+            }
+            else
+            {
+                hi = mid;
+            }
+        }
+
+        trace[i] = &keys[(lo * 7919) % num_keys];
+    }
+
+    free(cdf);
+    return 0;
+}
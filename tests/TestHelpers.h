@@ -116,4 +116,17 @@ ANVAllocator create_int_allocator(void);
 ANVAllocator create_person_allocator(void);
 ANVAllocator create_string_allocator(void);
 
+// --- Benchmark Helpers ---
+// Wall-clock time in seconds
+double now_seconds(void);
+
+// Linear congruential generator, returns the high bits of the advanced state
+unsigned next_random(unsigned* state);
+
+// Fill trace[0..length) from the classic Zipf distribution (exponent 1) over
+// keys[0..num_keys): the key of rank r is drawn with probability proportional
+// to 1 / r, and ranks are scattered so popular keys are not adjacent.
+// Returns 0 on success, -1 if memory runs out.
+int build_zipf_trace(const int* keys, size_t num_keys, const int** trace, size_t length, unsigned long long seed);
+
 #endif //ANVIL_TESTHELPERS_H
\ No newline at end of file
@@ -0,0 +1,367 @@
+//
+// Tests for context-carrying allocators (ctx + sized free + realloc hooks).
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common/Allocator.h"
+#include "containers/ArrayList.h"
+#include "containers/BinarySearchTree.h"
+#include "containers/DoublyLinkedList.h"
+#include "containers/HashMap.h"
+#include "containers/Queue.h"
+#include "containers/SinglyLinkedList.h"
+#include "containers/Stack.h"
+#include "TestAssert.h"
+#include "TestHelpers.h"
+
+//==============================================================================
+// Tracking context used by the tests
+//==============================================================================
+
+typedef struct
+{
+    size_t alloc_calls;
+    size_t free_calls;
+    size_t realloc_calls;
+    size_t bytes_live;
+    size_t sized_frees;
+} TrackingContext;
+
+static void* tracking_alloc(void* ctx, const size_t size)
+{
+    TrackingContext* tc = ctx;
+    tc->alloc_calls++;
+    tc->bytes_live += size;
+    return malloc(size);
+}
+
+static void tracking_free(void* ctx, void* ptr, const size_t size)
+{
+    TrackingContext* tc = ctx;
+    tc->free_calls++;
+    if (size > 0)
+    {
+        tc->sized_frees++;
+        tc->bytes_live -= size;
+    }
+    free(ptr);
+}
+
+static void* tracking_realloc(void* ctx, void* ptr, const size_t old_size, const size_t new_size)
+{
+    TrackingContext* tc = ctx;
+    void* result = realloc(ptr, new_size);
+    if (result)
+    {
+        tc->realloc_calls++;
+        tc->bytes_live = tc->bytes_live - old_size + new_size;
+    }
+    return result;
+}
+
+//==============================================================================
+// Test Functions
+//==============================================================================
+
+int test_context_allocator_basic(void)
+{
+    TrackingContext tc = {0};
+    const ANVAllocator alloc = anv_alloc_context(&tc, tracking_alloc, tracking_free, tracking_realloc, NULL, NULL);
+
+    ASSERT_TRUE(anv_alloc_is_valid(&alloc));
+
+    void* ptr = anv_alloc_malloc(&alloc, 64);
+    ASSERT_NOT_NULL(ptr);
+    ASSERT_EQ(tc.alloc_calls, 1);
+    ASSERT_EQ(tc.bytes_live, 64);
+
+    ptr = anv_alloc_realloc(&alloc, ptr, 64, 256);
+    ASSERT_NOT_NULL(ptr);
+    ASSERT_EQ(tc.realloc_calls, 1);
+    ASSERT_EQ(tc.bytes_live, 256);
+
+    anv_alloc_free_sized(&alloc, ptr, 256);
+    ASSERT_EQ(tc.free_calls, 1);
+    ASSERT_EQ(tc.bytes_live, 0);
+
+    // Default copy is used when none is provided
+    int value = 7;
+    ASSERT_EQ_PTR(anv_alloc_copy(&alloc, &value), &value);
+
+    return TEST_SUCCESS;
+}
+
+int test_context_allocator_realloc_fallback(void)
+{
+    TrackingContext tc = {0};
+    const ANVAllocator alloc = anv_alloc_context(&tc, tracking_alloc, tracking_free, NULL, NULL, NULL);
+
+    char* ptr = anv_alloc_malloc(&alloc, 8);
+    ASSERT_NOT_NULL(ptr);
+    memcpy(ptr, "abcdefg", 8);
+
+    char* grown = anv_alloc_realloc(&alloc, ptr, 8, 32);
+    ASSERT_NOT_NULL(grown);
+    ASSERT_EQ_STR(grown, "abcdefg");
+    ASSERT_EQ(tc.alloc_calls, 2);
+    ASSERT_EQ(tc.free_calls, 1);
+    ASSERT_EQ(tc.bytes_live, 32);
+
+    anv_alloc_free_sized(&alloc, grown, 32);
+    ASSERT_EQ(tc.bytes_live, 0);
+
+    return TEST_SUCCESS;
+}
+
+int test_context_allocator_invalid(void)
+{
+    const ANVAllocator empty = {0};
+    ASSERT_FALSE(anv_alloc_is_valid(&empty));
+    ASSERT_FALSE(anv_alloc_is_valid(NULL));
+    ASSERT_NULL(anv_alloc_malloc(&empty, 16));
+    ASSERT_NULL(anv_alloc_realloc(NULL, NULL, 0, 16));
+
+    // Region style allocators may omit the free hook entirely
+    TrackingContext tc = {0};
+    const ANVAllocator region = anv_alloc_context(&tc, tracking_alloc, NULL, NULL, NULL, NULL);
+    void* ptr = anv_alloc_malloc(&region, 16);
+    ASSERT_NOT_NULL(ptr);
+    anv_alloc_free(&region, ptr); // No-op, must not crash
+    free(ptr);
+
+    return TEST_SUCCESS;
+}
+
+int test_default_allocator_realloc(void)
+{
+    const ANVAllocator alloc = anv_alloc_default();
+
+    int* data = anv_alloc_malloc(&alloc, 4 * sizeof(int));
+    ASSERT_NOT_NULL(data);
+    for (int i = 0; i < 4; i++)
+    {
+        data[i] = i;
+    }
+
+    data = anv_alloc_realloc(&alloc, data, 4 * sizeof(int), 128 * sizeof(int));
+    ASSERT_NOT_NULL(data);
+    for (int i = 0; i < 4; i++)
+    {
+        ASSERT_EQ(data[i], i);
+    }
+
+    anv_alloc_free(&alloc, data);
+    return TEST_SUCCESS;
+}
+
+int test_context_allocator_hashmap(void)
+{
+    TrackingContext tc = {0};
+    ANVAllocator alloc = anv_alloc_context(&tc, tracking_alloc, tracking_free, tracking_realloc, NULL, NULL);
+
+    ANVHashMap* map = anv_hashmap_create(&alloc, anv_hash_int, anv_key_equals_int, 4);
+    ASSERT_NOT_NULL(map);
+
+    int keys[100];
+    for (int i = 0; i < 100; i++)
+    {
+        keys[i] = i;
+        ASSERT_EQ(anv_hashmap_put(map, &keys[i], &keys[i]), 0);
+    }
+
+    for (int i = 0; i < 100; i += 2)
+    {
+        ASSERT_EQ(anv_hashmap_remove(map, &keys[i], false, false), 0);
+    }
+
+    ANVIterator it = anv_hashmap_iterator(map);
+    size_t count = 0;
+    while (it.has_next(&it))
+    {
+        count++;
+        it.next(&it);
+    }
+    it.destroy(&it);
+    ASSERT_EQ(count, 50);
+
+    anv_hashmap_destroy(map, false, false);
+
+    // Every allocation made on behalf of the map went through the context,
+    // and every release reported its size.
+    ASSERT_GT(tc.alloc_calls, 0);
+    ASSERT_EQ(tc.alloc_calls, tc.free_calls);
+    ASSERT_EQ(tc.sized_frees, tc.free_calls);
+    ASSERT_EQ(tc.bytes_live, 0);
+
+    return TEST_SUCCESS;
+}
+
+int test_context_allocator_arraylist(void)
+{
+    TrackingContext tc = {0};
+    ANVAllocator alloc = anv_alloc_context(&tc, tracking_alloc, tracking_free, tracking_realloc, NULL, NULL);
+
+    ANVArrayList* list = anv_arraylist_create(&alloc, 0);
+    ASSERT_NOT_NULL(list);
+
+    int values[1000];
+    for (int i = 0; i < 1000; i++)
+    {
+        values[i] = i;
+        ASSERT_EQ(anv_arraylist_push_back(list, &values[i]), 0);
+    }
+
+    // Growth happens through the realloc hook rather than alloc+copy+free
+    ASSERT_GT(tc.realloc_calls, 0);
+
+    ASSERT_EQ(anv_arraylist_shrink_to_fit(list), 0);
+    ASSERT_EQ(*(int*)anv_arraylist_get(list, 999), 999);
+
+    anv_arraylist_destroy(list, false);
+    ASSERT_EQ(tc.bytes_live, 0);
+
+    return TEST_SUCCESS;
+}
+
+static size_t drain(ANVIterator* it)
+{
+    size_t count = 0;
+    while (it->has_next(it))
+    {
+        count++;
+        it->next(it);
+    }
+    it->destroy(it);
+    return count;
+}
+
+int test_context_allocator_iterators(void)
+{
+    TrackingContext tc = {0};
+    ANVAllocator alloc = anv_alloc_context(&tc, tracking_alloc, tracking_free, tracking_realloc, NULL, NULL);
+
+    int values[10];
+    ANVStack* stack = anv_stack_create(&alloc);
+    ANVQueue* queue = anv_queue_create(&alloc);
+    ANVSinglyLinkedList* slist = anv_sll_create(&alloc);
+    ANVDoublyLinkedList* dlist = anv_dll_create(&alloc);
+    ANVBinarySearchTree* tree = anv_bst_create(&alloc, int_cmp);
+    ASSERT_NOT_NULL(stack);
+    ASSERT_NOT_NULL(queue);
+    ASSERT_NOT_NULL(slist);
+    ASSERT_NOT_NULL(dlist);
+    ASSERT_NOT_NULL(tree);
+    for (int i = 0; i < 10; i++)
+    {
+        values[i] = i;
+        ASSERT_EQ(anv_stack_push(stack, &values[i]), 0);
+        ASSERT_EQ(anv_queue_enqueue(queue, &values[i]), 0);
+        ASSERT_EQ(anv_sll_push_back(slist, &values[i]), 0);
+        ASSERT_EQ(anv_dll_push_back(dlist, &values[i]), 0);
+        ASSERT_EQ(anv_bst_insert(tree, &values[i]), 0);
+    }
+
+    ANVStack* stack_copy = anv_stack_copy(stack);
+    ASSERT_NOT_NULL(stack_copy);
+    anv_stack_destroy(stack_copy, false);
+
+    ANVIterator it = anv_stack_iterator(stack);
+    ASSERT_EQ(drain(&it), 10);
+    it = anv_queue_iterator(queue);
+    ASSERT_EQ(drain(&it), 10);
+    it = anv_sll_iterator(slist);
+    ASSERT_EQ(drain(&it), 10);
+    it = anv_dll_iterator(dlist);
+    ASSERT_EQ(drain(&it), 10);
+    it = anv_bst_iterator(tree);
+    ASSERT_EQ(drain(&it), 10);
+
+    // Adapters release their own state and the iterators they wrap
+    ANVIterator range = anv_iterator_range(0, 20, 1, &alloc);
+    ANVIterator skip = anv_iterator_skip(&range, &alloc, 5);
+    ANVIterator take = anv_iterator_take(&skip, &alloc, 10);
+    ASSERT_EQ(drain(&take), 10);
+
+    ANVIterator left = anv_iterator_range(0, 5, 1, &alloc);
+    ANVIterator right = anv_iterator_repeat(&values[0], &alloc, 5);
+    ANVIterator zip = anv_iterator_zip(&left, &right, &alloc);
+    ASSERT_EQ(drain(&zip), 5);
+
+    ANVIterator parts[2] = {anv_iterator_range(0, 3, 1, &alloc), anv_iterator_range(0, 4, 1, &alloc)};
+    ANVIterator chain = anv_iterator_chain(parts, 2, &alloc);
+    ASSERT_EQ(drain(&chain), 7);
+
+    anv_stack_destroy(stack, false);
+    anv_queue_destroy(queue, false);
+    anv_sll_destroy(slist, false);
+    anv_dll_destroy(dlist, false);
+    anv_bst_destroy(tree, false);
+
+    ASSERT_GT(tc.alloc_calls, 0);
+    ASSERT_EQ(tc.alloc_calls, tc.free_calls);
+    ASSERT_EQ(tc.sized_frees, tc.free_calls);
+    ASSERT_EQ(tc.bytes_live, 0);
+
+    return TEST_SUCCESS;
+}
+
+//==============================================================================
+// Main test runner
+//==============================================================================
+
+int main(void)
+{
+    int tests_passed = 0;
+    int tests_total = 0;
+
+    printf("Running context allocator tests...\n\n");
+
+    const struct
+    {
+        const char* name;
+        int (*test_func)(void);
+    } tests[] = {
+            {"Context Allocator Basic", test_context_allocator_basic},
+            {"Context Allocator Realloc Fallback", test_context_allocator_realloc_fallback},
+            {"Context Allocator Invalid", test_context_allocator_invalid},
+            {"Default Allocator Realloc", test_default_allocator_realloc},
+            {"Context Allocator HashMap", test_context_allocator_hashmap},
+            {"Context Allocator ArrayList", test_context_allocator_arraylist},
+            {"Context Allocator Iterators", test_context_allocator_iterators}
+        };
+
+    const int num_tests = sizeof(tests) / sizeof(tests[0]);
+
+    for (int i = 0; i < num_tests; i++)
+    {
+        printf("Test %d: %s... ", i + 1, tests[i].name);
+        fflush(stdout);
+
+        const int result = tests[i].test_func();
+        tests_total++;
+
+        if (result == TEST_SUCCESS)
+        {
+            printf("PASSED\n");
+            tests_passed++;
+        }
+        else if (result == TEST_FAILURE)
+        {
+            printf("FAILED\n");
+        }
+        else
+        {
+            printf("SKIPPED\n");
+        }
+    }
+
+    printf("\n=== Test Results ===\n");
+    printf("Tests passed: %d/%d\n", tests_passed, tests_total);
+    printf("Success rate: %.1f%%\n",
+           tests_total > 0 ? (100.0 * tests_passed / tests_total) : 0.0);
+
+    return (tests_passed == tests_total) ? 0 : 1;
+}
@@ -0,0 +1,284 @@
+//
+// Arena allocator tests
+//
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "memory/Arena.h"
+#include "containers/DoublyLinkedList.h"
+#include "containers/HashMap.h"
+#include "containers/Pair.h"
+#include "TestAssert.h"
+#include "TestHelpers.h"
+
+// Test basic creation and allocation
+int test_arena_create_and_alloc(void)
+{
+    ANVAllocator backing = anv_alloc_default();
+    ANVArena* arena = anv_arena_create(&backing, 1024);
+    ASSERT_NOT_NULL(arena);
+    ASSERT_EQ(anv_arena_bytes_used(arena), 0);
+    ASSERT_EQ(anv_arena_bytes_reserved(arena), 1024);
+
+    int* a = anv_arena_alloc(arena, sizeof(int));
+    int* b = anv_arena_alloc(arena, sizeof(int));
+    ASSERT_NOT_NULL(a);
+    ASSERT_NOT_NULL(b);
+    ASSERT(a != b);
+    *a = 1;
+    *b = 2;
+    ASSERT_EQ(*a, 1);
+    ASSERT_EQ(*b, 2);
+    ASSERT_GT(anv_arena_bytes_used(arena), 0);
+
+    ASSERT_NULL(anv_arena_alloc(arena, 0));
+    ASSERT_NULL(anv_arena_alloc(NULL, 16));
+    ASSERT_NULL(anv_arena_create(NULL, 0));
+
+    anv_arena_destroy(arena);
+    return TEST_SUCCESS;
+}
+
+// Test that allocations honour the requested alignment
+int test_arena_alignment(void)
+{
+    ANVAllocator backing = anv_alloc_default();
+    ANVArena* arena = anv_arena_create(&backing, 4096);
+    ASSERT_NOT_NULL(arena);
+
+    anv_arena_alloc_aligned(arena, 1, 1);
+    void* p16 = anv_arena_alloc_aligned(arena, 8, 16);
+    ASSERT_NOT_NULL(p16);
+    ASSERT_EQ((uintptr_t)p16 % 16, 0);
+
+    anv_arena_alloc_aligned(arena, 3, 1);
+    void* p64 = anv_arena_alloc_aligned(arena, 8, 64);
+    ASSERT_NOT_NULL(p64);
+    ASSERT_EQ((uintptr_t)p64 % 64, 0);
+
+    // Non power-of-two alignment is rejected
+    ASSERT_NULL(anv_arena_alloc_aligned(arena, 8, 24));
+
+    anv_arena_destroy(arena);
+    return TEST_SUCCESS;
+}
+
+// Test chunk chaining for allocations that exceed a chunk
+int test_arena_chunk_chaining(void)
+{
+    ANVAllocator backing = anv_alloc_default();
+    ANVArena* arena = anv_arena_create(&backing, 256);
+    ASSERT_NOT_NULL(arena);
+
+    for (int i = 0; i < 100; i++)
+    {
+        char* p = anv_arena_alloc(arena, 32);
+        ASSERT_NOT_NULL(p);
+        memset(p, i, 32);
+    }
+    ASSERT_GT(arena->chunk_count, 1);
+
+    // Oversized allocation gets its own chunk
+    char* big = anv_arena_alloc(arena, 10000);
+    ASSERT_NOT_NULL(big);
+    memset(big, 0xAB, 10000);
+    ASSERT_GTE(anv_arena_bytes_reserved(arena), 10000);
+
+    anv_arena_destroy(arena);
+    return TEST_SUCCESS;
+}
+
+// Test that reset reuses chunks without new backing allocations
+int test_arena_reset_reuses_chunks(void)
+{
+    ANVAllocator backing = anv_alloc_default();
+    ANVArena* arena = anv_arena_create(&backing, 256);
+    ASSERT_NOT_NULL(arena);
+
+    void* first = anv_arena_alloc(arena, 16);
+    for (int i = 0; i < 50; i++)
+    {
+        ASSERT_NOT_NULL(anv_arena_alloc(arena, 48));
+    }
+    const size_t chunks = arena->chunk_count;
+    const size_t reserved = anv_arena_bytes_reserved(arena);
+
+    for (int round = 0; round < 10; round++)
+    {
+        anv_arena_reset(arena);
+        ASSERT_EQ(anv_arena_bytes_used(arena), 0);
+
+        void* again = anv_arena_alloc(arena, 16);
+        ASSERT_EQ_PTR(again, first);
+        for (int i = 0; i < 50; i++)
+        {
+            ASSERT_NOT_NULL(anv_arena_alloc(arena, 48));
+        }
+    }
+
+    ASSERT_EQ(arena->chunk_count, chunks);
+    ASSERT_EQ(anv_arena_bytes_reserved(arena), reserved);
+
+    anv_arena_destroy(arena);
+    return TEST_SUCCESS;
+}
+
+// Test checkpoint and rollback, including across chunk boundaries
+int test_arena_checkpoint_rollback(void)
+{
+    ANVAllocator backing = anv_alloc_default();
+    ANVArena* arena = anv_arena_create(&backing, 256);
+    ASSERT_NOT_NULL(arena);
+
+    ASSERT_NOT_NULL(anv_arena_alloc(arena, 64));
+    const size_t used_before = anv_arena_bytes_used(arena);
+    const ANVArenaCheckpoint cp = anv_arena_checkpoint(arena);
+
+    void* after = anv_arena_alloc(arena, 32);
+    for (int i = 0; i < 40; i++)
+    {
+        ASSERT_NOT_NULL(anv_arena_alloc(arena, 32));
+    }
+    ASSERT_GT(anv_arena_bytes_used(arena), used_before);
+
+    anv_arena_rollback(arena, cp);
+    ASSERT_EQ(anv_arena_bytes_used(arena), used_before);
+
+    // The next allocation lands where the rolled back one did
+    ASSERT_EQ_PTR(anv_arena_alloc(arena, 32), after);
+
+    anv_arena_destroy(arena);
+    return TEST_SUCCESS;
+}
+
+// Test the allocator view with pairs and a list
+int test_arena_allocator_view_containers(void)
+{
+    ANVAllocator backing = anv_alloc_default();
+    ANVArena* arena = anv_arena_create(&backing, 4096);
+    ASSERT_NOT_NULL(arena);
+
+    ANVAllocator alloc = anv_arena_allocator(arena);
+    ASSERT_TRUE(anv_alloc_is_valid(&alloc));
+
+    static int values[200];
+    for (int request = 0; request < 5; request++)
+    {
+        ANVDoublyLinkedList* list = anv_dll_create(&alloc);
+        ASSERT_NOT_NULL(list);
+
+        for (int i = 0; i < 200; i++)
+        {
+            values[i] = i;
+            ANVPair* pair = anv_pair_create(&alloc, &values[i], &values[i]);
+            ASSERT_NOT_NULL(pair);
+            ASSERT_EQ(anv_dll_push_back(list, pair), 0);
+        }
+        ASSERT_EQ(anv_dll_size(list), 200);
+
+        // Whole request discarded at once
+        anv_arena_reset(arena);
+    }
+
+    anv_arena_destroy(arena);
+    return TEST_SUCCESS;
+}
+
+// Test a hash map living entirely in an arena
+int test_arena_allocator_view_hashmap(void)
+{
+    ANVAllocator backing = anv_alloc_default();
+    ANVArena* arena = anv_arena_create(&backing, 1024);
+    ASSERT_NOT_NULL(arena);
+
+    ANVAllocator alloc = anv_arena_allocator(arena);
+    ANVHashMap* map = anv_hashmap_create(&alloc, anv_hash_int, anv_key_equals_int, 4);
+    ASSERT_NOT_NULL(map);
+
+    int keys[500];
+    for (int i = 0; i < 500; i++)
+    {
+        keys[i] = i;
+        ASSERT_EQ(anv_hashmap_put(map, &keys[i], &keys[i]), 0);
+    }
+
+    for (int i = 0; i < 500; i++)
+    {
+        ASSERT_EQ(*(int*)anv_hashmap_get(map, &keys[i]), i);
+    }
+
+    // Destroying is legal but optional; the arena owns the memory either way
+    anv_hashmap_destroy(map, false, false);
+    anv_arena_destroy(arena);
+    return TEST_SUCCESS;
+}
+
+// Test LIFO free and in-place realloc through the allocator view
+int test_arena_allocator_view_lifo(void)
+{
+    ANVAllocator backing = anv_alloc_default();
+    ANVArena* arena = anv_arena_create(&backing, 1024);
+    ASSERT_NOT_NULL(arena);
+
+    const ANVAllocator alloc = anv_arena_allocator(arena);
+
+    char* a = anv_alloc_malloc(&alloc, 16);
+    const size_t used = anv_arena_bytes_used(arena);
+    char* b = anv_alloc_malloc(&alloc, 16);
+    ASSERT_GT(anv_arena_bytes_used(arena), used);
+
+    anv_alloc_free_sized(&alloc, b, 16);
+    ASSERT_EQ(anv_arena_bytes_used(arena), used);
+
+    // Most recent allocation grows in place
+    char* grown = anv_alloc_realloc(&alloc, a, 16, 64);
+    ASSERT_EQ_PTR(grown, a);
+
+    anv_arena_destroy(arena);
+    return TEST_SUCCESS;
+}
+
+typedef struct
+{
+    int (*func)(void);
+    const char* name;
+} TestCase;
+
+int main(void)
+{
+    const TestCase tests[] = {
+        {test_arena_create_and_alloc, "test_arena_create_and_alloc"},
+        {test_arena_alignment, "test_arena_alignment"},
+        {test_arena_chunk_chaining, "test_arena_chunk_chaining"},
+        {test_arena_reset_reuses_chunks, "test_arena_reset_reuses_chunks"},
+        {test_arena_checkpoint_rollback, "test_arena_checkpoint_rollback"},
+        {test_arena_allocator_view_containers, "test_arena_allocator_view_containers"},
+        {test_arena_allocator_view_hashmap, "test_arena_allocator_view_hashmap"},
+        {test_arena_allocator_view_lifo, "test_arena_allocator_view_lifo"},
+    };
+
+    printf("Running Arena tests...\n");
+
+    int failed = 0;
+    const int num_tests = sizeof(tests) / sizeof(tests[0]);
+    for (int i = 0; i < num_tests; i++)
+    {
+        if (tests[i].func() != TEST_SUCCESS)
+        {
+            printf("%s failed\n", tests[i].name);
+            failed++;
+        }
+    }
+
+    if (failed == 0)
+    {
+        printf("All Arena tests passed!\n");
+        return 0;
+    }
+
+    printf("%d Arena tests failed.\n", failed);
+    return 1;
+}
@@ -0,0 +1,328 @@
+//
+// Cache tests
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "containers/Cache.h"
+#include "TestAssert.h"
+#include "TestHelpers.h"
+
+#define MANY 5000
+
+typedef struct
+{
+    size_t count;
+    int last_key;
+} EvictLog;
+
+static void record_eviction(void* key, void* value, void* user_data)
+{
+    (void)value;
+    EvictLog* log = user_data;
+    log->count++;
+    log->last_key = *(int*)key;
+}
+
+static void free_evicted(void* key, void* value, void* user_data)
+{
+    ANVAllocator* alloc = user_data;
+    anv_alloc_data_free(alloc, key);
+    anv_alloc_data_free(alloc, value);
+}
+
+static int visited[8];
+static size_t visited_count;
+
+static void visit_key(void* key, void* value)
+{
+    (void)value;
+    if (visited_count < 8)
+    {
+        visited[visited_count] = *(int*)key;
+    }
+    visited_count++;
+}
+
+// Test basic put/get/peek/remove without eviction
+int test_cache_put_get(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVCache* cache = anv_cache_create(&alloc, anv_hash_string, anv_key_equals_string, 4, ANV_CACHE_LRU);
+    ASSERT_NOT_NULL(cache);
+    ASSERT_TRUE(anv_cache_is_empty(cache));
+    ASSERT_EQ(anv_cache_capacity(cache), 4);
+
+    char k1[] = "apple";
+    char k2[] = "banana";
+    int v1 = 1;
+    int v2 = 2;
+    int v3 = 3;
+
+    ASSERT_EQ(anv_cache_put(cache, k1, &v1), 0);
+    ASSERT_EQ(anv_cache_put(cache, k2, &v2), 0);
+    ASSERT_EQ(anv_cache_size(cache), 2);
+    ASSERT_EQ_PTR(anv_cache_get(cache, "apple"), &v1);
+    ASSERT_EQ_PTR(anv_cache_peek(cache, "banana"), &v2);
+    ASSERT_TRUE(anv_cache_contains_key(cache, "banana"));
+    ASSERT_NULL(anv_cache_get(cache, "cherry"));
+
+    void* old = NULL;
+    ASSERT_EQ(anv_cache_put_replace(cache, k1, &v3, &old), 0);
+    ASSERT_EQ_PTR(old, &v1);
+    ASSERT_EQ(anv_cache_size(cache), 2);
+    ASSERT_EQ_PTR(anv_cache_remove_get(cache, "apple", false), &v3);
+    ASSERT_EQ(anv_cache_remove(cache, "apple", false, false), -1);
+    ASSERT_EQ(anv_cache_remove(cache, "banana", false, false), 0);
+    ASSERT_TRUE(anv_cache_is_empty(cache));
+
+    ASSERT_NULL(anv_cache_create(&alloc, anv_hash_string, anv_key_equals_string, 0, ANV_CACHE_LRU));
+    ASSERT_NULL(anv_cache_create(NULL, anv_hash_string, anv_key_equals_string, 4, ANV_CACHE_LRU));
+    ASSERT_EQ(anv_cache_put(NULL, k1, &v1), -1);
+    ASSERT_EQ(anv_cache_put_replace(cache, k1, &v1, NULL), -1);
+
+    anv_cache_destroy(cache, false, false);
+    return TEST_SUCCESS;
+}
+
+// Test that LRU evicts the least recently used entry and that hits refresh recency
+int test_cache_lru_eviction(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVCache* cache = anv_cache_create(&alloc, anv_hash_int, anv_key_equals_int, 3, ANV_CACHE_LRU);
+    ASSERT_NOT_NULL(cache);
+    EvictLog log = {0, -1};
+    anv_cache_set_eviction_callback(cache, record_eviction, &log);
+
+    int keys[5] = {0, 1, 2, 3, 4};
+    ASSERT_EQ(anv_cache_put(cache, &keys[0], NULL), 0);
+    ASSERT_EQ(anv_cache_put(cache, &keys[1], NULL), 0);
+    ASSERT_EQ(anv_cache_put(cache, &keys[2], NULL), 0);
+
+    // Using 0 makes 1 the oldest
+    anv_cache_get(cache, &keys[0]);
+    ASSERT_EQ(anv_cache_put(cache, &keys[3], NULL), 0);
+    ASSERT_EQ(log.count, 1);
+    ASSERT_EQ(log.last_key, 1);
+    ASSERT_FALSE(anv_cache_contains_key(cache, &keys[1]));
+    ASSERT_EQ(anv_cache_size(cache), 3);
+
+    // Peek does not refresh, so 2 goes next
+    anv_cache_peek(cache, &keys[2]);
+    ASSERT_EQ(anv_cache_put(cache, &keys[4], NULL), 0);
+    ASSERT_EQ(log.last_key, 2);
+
+    // Most to least recently used
+    visited_count = 0;
+    anv_cache_for_each(cache, visit_key);
+    ASSERT_EQ(visited_count, 3);
+    ASSERT_EQ(visited[0], 4);
+    ASSERT_EQ(visited[1], 3);
+    ASSERT_EQ(visited[2], 0);
+
+    // Updating an existing key refreshes it without evicting
+    ASSERT_EQ(anv_cache_put(cache, &keys[0], NULL), 0);
+    ASSERT_EQ(log.count, 2);
+    ASSERT_EQ(anv_cache_put(cache, &keys[1], NULL), 0);
+    ASSERT_EQ(log.last_key, 3);
+
+    const ANVCacheStats stats = anv_cache_stats(cache);
+    ASSERT_EQ(stats.evictions, 3);
+
+    anv_cache_destroy(cache, false, false);
+    return TEST_SUCCESS;
+}
+
+// Test that CLOCK gives referenced entries a second chance
+int test_cache_clock_second_chance(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVCache* cache = anv_cache_create(&alloc, anv_hash_int, anv_key_equals_int, 3, ANV_CACHE_CLOCK);
+    ASSERT_NOT_NULL(cache);
+    EvictLog log = {0, -1};
+    anv_cache_set_eviction_callback(cache, record_eviction, &log);
+
+    int keys[6] = {0, 1, 2, 3, 4, 5};
+    ASSERT_EQ(anv_cache_put(cache, &keys[0], NULL), 0);
+    ASSERT_EQ(anv_cache_put(cache, &keys[1], NULL), 0);
+    ASSERT_EQ(anv_cache_put(cache, &keys[2], NULL), 0);
+
+    // 0 is referenced, so the hand passes it and takes 1
+    anv_cache_get(cache, &keys[0]);
+    ASSERT_EQ(anv_cache_put(cache, &keys[3], NULL), 0);
+    ASSERT_EQ(log.last_key, 1);
+
+    // 0 lost its bit on the first sweep, 2 was never used
+    ASSERT_EQ(anv_cache_put(cache, &keys[4], NULL), 0);
+    ASSERT_EQ(log.last_key, 2);
+
+    // All referenced: the hand clears every bit and comes back around
+    anv_cache_get(cache, &keys[0]);
+    anv_cache_get(cache, &keys[3]);
+    anv_cache_get(cache, &keys[4]);
+    ASSERT_EQ(anv_cache_put(cache, &keys[5], NULL), 0);
+    ASSERT_EQ(log.count, 3);
+    ASSERT_EQ(anv_cache_size(cache), 3);
+    ASSERT_TRUE(anv_cache_contains_key(cache, &keys[5]));
+
+    visited_count = 0;
+    anv_cache_for_each(cache, visit_key);
+    ASSERT_EQ(visited_count, 3);
+
+    anv_cache_destroy(cache, false, false);
+    return TEST_SUCCESS;
+}
+
+// Test hit, miss and eviction counters
+int test_cache_stats(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVCache* cache = anv_cache_create(&alloc, anv_hash_int, anv_key_equals_int, 2, ANV_CACHE_LRU);
+    ASSERT_NOT_NULL(cache);
+
+    int keys[3] = {10, 20, 30};
+    ASSERT_EQ(anv_cache_put(cache, &keys[0], NULL), 0);
+    ASSERT_EQ(anv_cache_put(cache, &keys[1], &keys[1]), 0);
+    ASSERT_EQ_PTR(anv_cache_get(cache, &keys[1]), &keys[1]);
+    anv_cache_get(cache, &keys[0]);
+    ASSERT_NULL(anv_cache_get(cache, &keys[2]));
+    ASSERT_EQ(anv_cache_put(cache, &keys[2], NULL), 0);
+
+    // contains_key and peek leave the counters alone
+    anv_cache_contains_key(cache, &keys[1]);
+    anv_cache_peek(cache, &keys[2]);
+
+    ANVCacheStats stats = anv_cache_stats(cache);
+    ASSERT_EQ(stats.hits, 2);
+    ASSERT_EQ(stats.misses, 1);
+    ASSERT_EQ(stats.evictions, 1);
+
+    anv_cache_clear(cache, false, false);
+    ASSERT_TRUE(anv_cache_is_empty(cache));
+    ASSERT_EQ(anv_cache_stats(cache).hits, 2);
+
+    anv_cache_reset_stats(cache);
+    stats = anv_cache_stats(cache);
+    ASSERT_EQ(stats.hits + stats.misses + stats.evictions, 0);
+
+    anv_cache_destroy(cache, false, false);
+    return TEST_SUCCESS;
+}
+
+// Test that removed entries are reused and that many keys keep lookups consistent
+int test_cache_churn(void)
+{
+    const ANVCachePolicy policies[2] = {ANV_CACHE_LRU, ANV_CACHE_CLOCK};
+    int* keys = malloc(sizeof(int) * MANY);
+    ASSERT_NOT_NULL(keys);
+    for (int i = 0; i < MANY; i++)
+    {
+        keys[i] = i;
+    }
+
+    for (int p = 0; p < 2; p++)
+    {
+        ANVAllocator alloc = anv_alloc_default();
+        ANVCache* cache = anv_cache_create(&alloc, anv_hash_int, anv_key_equals_int, 100, policies[p]);
+        ASSERT_NOT_NULL(cache);
+
+        for (int i = 0; i < MANY; i++)
+        {
+            ASSERT_EQ(anv_cache_put(cache, &keys[i], &keys[i]), 0);
+            ASSERT_EQ_PTR(anv_cache_peek(cache, &keys[i]), &keys[i]);
+            ASSERT_LTE(anv_cache_size(cache), 100);
+            if (i % 3 == 0)
+            {
+                ASSERT_EQ(anv_cache_remove(cache, &keys[i], false, false), 0);
+            }
+        }
+
+        // Every resident key maps to itself
+        size_t resident = 0;
+        for (int i = 0; i < MANY; i++)
+        {
+            const int* value = anv_cache_peek(cache, &keys[i]);
+            if (value)
+            {
+                ASSERT_EQ(*value, i);
+                resident++;
+            }
+        }
+        ASSERT_EQ(resident, anv_cache_size(cache));
+        ASSERT_EQ(anv_cache_stats(cache).evictions + resident + (MANY + 2) / 3, MANY);
+
+        anv_cache_destroy(cache, false, false);
+    }
+
+    free(keys);
+    return TEST_SUCCESS;
+}
+
+// Test that an eviction callback can release owned keys and values
+int test_cache_free_data(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVCache* cache = anv_cache_create(&alloc, anv_hash_int, anv_key_equals_int, 16, ANV_CACHE_CLOCK);
+    ASSERT_NOT_NULL(cache);
+    anv_cache_set_eviction_callback(cache, free_evicted, &alloc);
+
+    for (int i = 0; i < 50; i++)
+    {
+        int* key = malloc(sizeof(int));
+        int* value = malloc(sizeof(int));
+        ASSERT_NOT_NULL(key);
+        ASSERT_NOT_NULL(value);
+        *key = i;
+        *value = i * 2;
+        ASSERT_EQ(anv_cache_put(cache, key, value), 0);
+    }
+
+    const int probe = 45;
+    ASSERT_EQ(*(int*)anv_cache_get(cache, &probe), 90);
+    ASSERT_EQ(anv_cache_remove(cache, &probe, true, true), 0);
+    ASSERT_EQ(anv_cache_size(cache), 15);
+
+    anv_cache_destroy(cache, true, true);
+    return TEST_SUCCESS;
+}
+
+typedef struct
+{
+    int (*func)(void);
+    const char* name;
+} TestCase;
+
+int main(void)
+{
+    const TestCase tests[] = {
+        {test_cache_put_get, "test_cache_put_get"},
+        {test_cache_lru_eviction, "test_cache_lru_eviction"},
+        {test_cache_clock_second_chance, "test_cache_clock_second_chance"},
+        {test_cache_stats, "test_cache_stats"},
+        {test_cache_churn, "test_cache_churn"},
+        {test_cache_free_data, "test_cache_free_data"},
+    };
+
+    printf("Running Cache tests...\n");
+
+    int failed = 0;
+    const int num_tests = sizeof(tests) / sizeof(tests[0]);
+    for (int i = 0; i < num_tests; i++)
+    {
+        if (tests[i].func() != TEST_SUCCESS)
+        {
+            printf("%s failed\n", tests[i].name);
+            failed++;
+        }
+    }
+
+    if (failed == 0)
+    {
+        printf("All Cache tests passed!\n");
+        return 0;
+    }
+
+    printf("%d Cache tests failed.\n", failed);
+    return 1;
+}
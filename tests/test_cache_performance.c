@@ -0,0 +1,168 @@
+//
+// Cache performance test - hit ratio and cost per access under a Zipfian key
+// distribution, for LRU and CLOCK and for the usual HashMap plus
+// DoublyLinkedList LRU
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "containers/Cache.h"
+#include "containers/DoublyLinkedList.h"
+#include "containers/HashMap.h"
+#include "TestAssert.h"
+#include "TestHelpers.h"
+
+#define NUM_KEYS 100000
+#define CAPACITY 10000
+#define NUM_ACCESSES 2000000
+
+// Run the trace as get-then-put-on-miss, returning the elapsed time
+static double run_cache(ANVCache* cache, const int** accesses)
+{
+    const double start = now_seconds();
+    for (int i = 0; i < NUM_ACCESSES; i++)
+    {
+        int* key = (int*)accesses[i];
+        if (!anv_cache_get(cache, key))
+        {
+            anv_cache_put(cache, key, key);
+        }
+    }
+    return now_seconds() - start;
+}
+
+// The same trace through a HashMap of key to list node, with the list in recency order
+static double run_paired(ANVHashMap* map, ANVDoublyLinkedList* list, const int** accesses, size_t* hits)
+{
+    const double start = now_seconds();
+    for (int i = 0; i < NUM_ACCESSES; i++)
+    {
+        int* key = (int*)accesses[i];
+        ANVDoublyLinkedNode* node = anv_hashmap_get(map, key);
+        if (node)
+        {
+            (*hits)++;
+            if (node != list->head)
+            {
+                node->prev->next = node->next;
+                if (node->next)
+                {
+                    node->next->prev = node->prev;
+                }
+                else
+                {
+                    list->tail = node->prev;
+                }
+                node->prev = NULL;
+                node->next = list->head;
+                list->head->prev = node;
+                list->head = node;
+            }
+            continue;
+        }
+
+        if (anv_dll_size(list) == CAPACITY)
+        {
+            anv_hashmap_remove(map, list->tail->data, false, false);
+            anv_dll_pop_back(list, false);
+        }
+        anv_dll_push_front(list, key);
+        anv_hashmap_put(map, key, list->head);
+    }
+    return now_seconds() - start;
+}
+
+int test_cache_performance_zipf(void)
+{
+    int* keys = malloc(sizeof(int) * NUM_KEYS);
+    const int** accesses = malloc(sizeof(int*) * NUM_ACCESSES);
+    ASSERT_NOT_NULL(keys);
+    ASSERT_NOT_NULL(accesses);
+    for (int i = 0; i < NUM_KEYS; i++)
+    {
+        keys[i] = i;
+    }
+    ASSERT_EQ(build_zipf_trace(keys, NUM_KEYS, accesses, NUM_ACCESSES, 0x2545F4914F6CDD1DULL), 0);
+
+    ANVAllocator alloc = anv_alloc_default();
+    ANVCache* lru = anv_cache_create(&alloc, anv_hash_int, anv_key_equals_int, CAPACITY, ANV_CACHE_LRU);
+    ANVCache* clock = anv_cache_create(&alloc, anv_hash_int, anv_key_equals_int, CAPACITY, ANV_CACHE_CLOCK);
+    ANVHashMap* paired_map = anv_hashmap_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ANVDoublyLinkedList* paired_list = anv_dll_create(&alloc);
+    ASSERT_NOT_NULL(lru);
+    ASSERT_NOT_NULL(clock);
+    ASSERT_NOT_NULL(paired_map);
+    ASSERT_NOT_NULL(paired_list);
+
+    const double lru_time = run_cache(lru, accesses);
+    const double clock_time = run_cache(clock, accesses);
+    size_t paired_hits = 0;
+    const double paired_time = run_paired(paired_map, paired_list, accesses, &paired_hits);
+
+    const ANVCacheStats lru_stats = anv_cache_stats(lru);
+    const ANVCacheStats clock_stats = anv_cache_stats(clock);
+    ASSERT_EQ(lru_stats.hits + lru_stats.misses, NUM_ACCESSES);
+    ASSERT_EQ(clock_stats.hits + clock_stats.misses, NUM_ACCESSES);
+    ASSERT_EQ(lru_stats.misses - lru_stats.evictions, CAPACITY);
+    ASSERT_EQ(anv_cache_size(lru), CAPACITY);
+
+    // Same policy, same trace: the cache and the hand-rolled LRU agree exactly
+    ASSERT_EQ(lru_stats.hits, paired_hits);
+
+    const size_t cache_bytes = anv_cache_memory_usage(lru);
+    const size_t paired_bytes = anv_hashmap_memory_usage(paired_map) + anv_dll_memory_usage(paired_list);
+    printf("Zipf over %d keys, capacity %d, %d accesses\n", NUM_KEYS, CAPACITY, NUM_ACCESSES);
+    printf("HashMap+DLL LRU: hit ratio %.4f, %.1f ns/access\n", (double)paired_hits / NUM_ACCESSES,
+           paired_time / NUM_ACCESSES * 1e9);
+    printf("Cache LRU:       hit ratio %.4f, %.1f ns/access\n", (double)lru_stats.hits / NUM_ACCESSES,
+           lru_time / NUM_ACCESSES * 1e9);
+    printf("Cache CLOCK:     hit ratio %.4f, %.1f ns/access\n", (double)clock_stats.hits / NUM_ACCESSES,
+           clock_time / NUM_ACCESSES * 1e9);
+    printf("Memory: HashMap+DLL %zu bytes, Cache %zu bytes (%.0f%%)\n", paired_bytes, cache_bytes,
+           100.0 * (double)cache_bytes / (double)paired_bytes);
+
+    anv_cache_destroy(lru, false, false);
+    anv_cache_destroy(clock, false, false);
+    anv_hashmap_destroy(paired_map, false, false);
+    anv_dll_destroy(paired_list, false);
+    free(accesses);
+    free(keys);
+    return TEST_SUCCESS;
+}
+
+typedef struct
+{
+    int (*func)(void);
+    const char* name;
+} TestCase;
+
+int main(void)
+{
+    const TestCase tests[] = {
+        {test_cache_performance_zipf, "test_cache_performance_zipf"},
+    };
+
+    printf("Running Cache performance tests...\n");
+
+    int failed = 0;
+    const int num_tests = sizeof(tests) / sizeof(tests[0]);
+    for (int i = 0; i < num_tests; i++)
+    {
+        if (tests[i].func() != TEST_SUCCESS)
+        {
+            printf("%s failed\n", tests[i].name);
+            failed++;
+        }
+    }
+
+    if (failed == 0)
+    {
+        printf("All Cache performance tests passed!\n");
+        return 0;
+    }
+
+    printf("%d Cache performance tests failed.\n", failed);
+    return 1;
+}
@@ -0,0 +1,396 @@
+//
+// Thread-caching heap tests
+//
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "memory/CachingHeap.h"
+#include "containers/HashMap.h"
+#include "system/Threads.h"
+#include "TestAssert.h"
+#include "TestHelpers.h"
+
+#define NUM_THREADS 4
+#define HANDOFF_COUNT 20000
+#define CHURN_THREADS 16
+#define MANY_HEAPS 12
+
+// Test basic allocation across size classes
+int test_caching_heap_basic(void)
+{
+    ANVAllocator backing = anv_alloc_default();
+    ANVCachingHeap* heap = anv_caching_heap_create(&backing);
+    ASSERT_NOT_NULL(heap);
+
+    const size_t sizes[] = {1, 16, 17, 100, 512, 1000, 1024, 1025, 10000};
+    void* ptrs[sizeof(sizes) / sizeof(sizes[0])];
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        ptrs[i] = anv_caching_heap_alloc(heap, sizes[i]);
+        ASSERT_NOT_NULL(ptrs[i]);
+        ASSERT_EQ((uintptr_t)ptrs[i] % _Alignof(max_align_t), 0);
+        memset(ptrs[i], (int)i, sizes[i]);
+    }
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        ASSERT_EQ(((unsigned char*)ptrs[i])[sizes[i] - 1], i);
+        anv_caching_heap_free(heap, ptrs[i]);
+    }
+
+    ANVCachingHeapStats stats;
+    ASSERT_EQ(anv_caching_heap_stats(heap, &stats), 0);
+    ASSERT_EQ(stats.thread_caches, 1);
+    ASSERT_EQ(stats.large_allocations, 2);
+    ASSERT_GT(stats.refills, 0);
+
+    ASSERT_NULL(anv_caching_heap_alloc(heap, 0));
+    ASSERT_NULL(anv_caching_heap_create(NULL));
+
+    anv_caching_heap_destroy(heap);
+    return TEST_SUCCESS;
+}
+
+// Test that freed blocks are reused by the same thread without refills
+int test_caching_heap_reuse(void)
+{
+    ANVAllocator backing = anv_alloc_default();
+    ANVCachingHeap* heap = anv_caching_heap_create(&backing);
+    ASSERT_NOT_NULL(heap);
+
+    void* first = anv_caching_heap_alloc(heap, 40);
+    anv_caching_heap_free(heap, first);
+    void* second = anv_caching_heap_alloc(heap, 48);
+    ASSERT_EQ_PTR(first, second); // Same size class, LIFO cache
+    anv_caching_heap_free(heap, second);
+
+    ANVCachingHeapStats before;
+    anv_caching_heap_stats(heap, &before);
+    for (int i = 0; i < 1000; i++)
+    {
+        void* p = anv_caching_heap_alloc(heap, 48);
+        ASSERT_NOT_NULL(p);
+        anv_caching_heap_free(heap, p);
+    }
+    ANVCachingHeapStats after;
+    anv_caching_heap_stats(heap, &after);
+    ASSERT_EQ(after.refills, before.refills);
+
+    anv_caching_heap_flush_thread(heap);
+    anv_caching_heap_stats(heap, &after);
+    ASSERT_GT(after.central_blocks, 0);
+
+    anv_caching_heap_destroy(heap);
+    return TEST_SUCCESS;
+}
+
+typedef struct
+{
+    ANVCachingHeap* heap;
+    void** slots;
+} HandoffArg;
+
+static void* producer_thread(void* arg)
+{
+    const HandoffArg* h = arg;
+    for (int i = 0; i < HANDOFF_COUNT; i++)
+    {
+        int* value = anv_caching_heap_alloc(h->heap, sizeof(int) * (1 + i % 32));
+        if (!value)
+        {
+            return (void*)1;
+        }
+        *value = i;
+        h->slots[i] = value;
+    }
+    anv_caching_heap_flush_thread(h->heap);
+    return NULL;
+}
+
+static void* consumer_thread(void* arg)
+{
+    const HandoffArg* h = arg;
+    for (int i = 0; i < HANDOFF_COUNT; i++)
+    {
+        int* value = h->slots[i];
+        if (*value != i)
+        {
+            return (void*)1;
+        }
+        anv_caching_heap_free(h->heap, value);
+    }
+    anv_caching_heap_flush_thread(h->heap);
+    return NULL;
+}
+
+// Test blocks allocated on one thread and freed on another
+int test_caching_heap_cross_thread_free(void)
+{
+    ANVAllocator backing = anv_alloc_default();
+    ANVCachingHeap* heap = anv_caching_heap_create(&backing);
+    ASSERT_NOT_NULL(heap);
+
+    void** slots = calloc(HANDOFF_COUNT, sizeof(void*));
+    ASSERT_NOT_NULL(slots);
+    HandoffArg arg = {heap, slots};
+
+    ANVThread producer;
+    ASSERT_EQ(anv_thread_create(&producer, producer_thread, &arg), 0);
+    void* producer_result = NULL;
+    anv_thread_join(producer, &producer_result);
+    ASSERT_NULL(producer_result);
+
+    ANVThread consumer;
+    ASSERT_EQ(anv_thread_create(&consumer, consumer_thread, &arg), 0);
+    void* consumer_result = NULL;
+    anv_thread_join(consumer, &consumer_result);
+    ASSERT_NULL(consumer_result);
+
+    // Consumer overflow and final flush returned the blocks centrally, and
+    // the consumer reused the cache the producer handed back
+    ANVCachingHeapStats stats;
+    ASSERT_EQ(anv_caching_heap_stats(heap, &stats), 0);
+    ASSERT_EQ(stats.thread_caches, 1);
+    ASSERT_EQ(stats.idle_caches, 1);
+    ASSERT_GT(stats.flushes, 0);
+
+    // A third thread (this one) reuses them without new spans
+    const size_t spans = stats.spans;
+    for (int i = 0; i < HANDOFF_COUNT; i++)
+    {
+        slots[i] = anv_caching_heap_alloc(heap, sizeof(int) * (1 + i % 32));
+        ASSERT_NOT_NULL(slots[i]);
+    }
+    ASSERT_EQ(anv_caching_heap_stats(heap, &stats), 0);
+    ASSERT_EQ(stats.spans, spans);
+    for (int i = 0; i < HANDOFF_COUNT; i++)
+    {
+        anv_caching_heap_free(heap, slots[i]);
+    }
+
+    free(slots);
+    anv_caching_heap_destroy(heap);
+    return TEST_SUCCESS;
+}
+
+static void* churn_thread(void* arg)
+{
+    ANVCachingHeap* heap = arg;
+    void* blocks[100];
+    for (int i = 0; i < 100; i++)
+    {
+        blocks[i] = anv_caching_heap_alloc(heap, 64);
+        if (!blocks[i])
+        {
+            return (void*)1;
+        }
+    }
+    for (int i = 0; i < 100; i++)
+    {
+        anv_caching_heap_free(heap, blocks[i]);
+    }
+    anv_caching_heap_flush_thread(heap);
+    return NULL;
+}
+
+// Test that short-lived threads reuse flushed caches instead of adding new ones
+int test_caching_heap_thread_churn(void)
+{
+    ANVAllocator backing = anv_alloc_default();
+    ANVCachingHeap* heap = anv_caching_heap_create(&backing);
+    ASSERT_NOT_NULL(heap);
+
+    for (int i = 0; i < CHURN_THREADS; i++)
+    {
+        ANVThread thread;
+        void* result = NULL;
+        ASSERT_EQ(anv_thread_create(&thread, churn_thread, heap), 0);
+        anv_thread_join(thread, &result);
+        ASSERT_NULL(result);
+    }
+
+    ANVCachingHeapStats stats;
+    ASSERT_EQ(anv_caching_heap_stats(heap, &stats), 0);
+    ASSERT_EQ(stats.thread_caches, 1);
+    ASSERT_EQ(stats.idle_caches, 1);
+    ASSERT_EQ(stats.spans, 1);
+
+    anv_caching_heap_destroy(heap);
+    return TEST_SUCCESS;
+}
+
+// Test that a cache evicted from the thread-local table returns its blocks,
+// including when the table still holds entries of destroyed heaps
+int test_caching_heap_evicted_cache(void)
+{
+    ANVAllocator backing = anv_alloc_default();
+    ANVCachingHeap* heap = anv_caching_heap_create(&backing);
+    ASSERT_NOT_NULL(heap);
+
+    void* blocks[10];
+    for (int i = 0; i < 10; i++)
+    {
+        blocks[i] = anv_caching_heap_alloc(heap, 32);
+        ASSERT_NOT_NULL(blocks[i]);
+    }
+    for (int i = 0; i < 10; i++)
+    {
+        anv_caching_heap_free(heap, blocks[i]);
+    }
+
+    ANVCachingHeapStats before;
+    ASSERT_EQ(anv_caching_heap_stats(heap, &before), 0);
+
+    // Touch enough other heaps to push this one out, destroying some early
+    ANVCachingHeap* others[MANY_HEAPS];
+    for (int i = 0; i < MANY_HEAPS; i++)
+    {
+        others[i] = anv_caching_heap_create(&backing);
+        ASSERT_NOT_NULL(others[i]);
+        anv_caching_heap_free(others[i], anv_caching_heap_alloc(others[i], 16));
+        if (i % 3 == 0)
+        {
+            anv_caching_heap_destroy(others[i]);
+            others[i] = NULL;
+        }
+    }
+
+    ANVCachingHeapStats after;
+    ASSERT_EQ(anv_caching_heap_stats(heap, &after), 0);
+    ASSERT_EQ(after.idle_caches, 1);
+    ASSERT_GT(after.central_blocks, before.central_blocks);
+    ASSERT_EQ(after.flushes, before.flushes + 1);
+
+    // Coming back claims the idle cache
+    anv_caching_heap_free(heap, anv_caching_heap_alloc(heap, 32));
+    ASSERT_EQ(anv_caching_heap_stats(heap, &after), 0);
+    ASSERT_EQ(after.thread_caches, 1);
+    ASSERT_EQ(after.idle_caches, 0);
+
+    for (int i = 0; i < MANY_HEAPS; i++)
+    {
+        anv_caching_heap_destroy(others[i]);
+    }
+    anv_caching_heap_destroy(heap);
+    return TEST_SUCCESS;
+}
+
+typedef struct
+{
+    ANVAllocator* alloc;
+    int base;
+} MapWorkerArg;
+
+static void* map_worker(void* arg)
+{
+    const MapWorkerArg* w = arg;
+    int* keys = malloc(sizeof(int) * 2000);
+    if (!keys)
+    {
+        return (void*)1;
+    }
+
+    ANVHashMap* map = anv_hashmap_create(w->alloc, anv_hash_int, anv_key_equals_int, 0);
+    void* result = NULL;
+    for (int i = 0; i < 2000 && map; i++)
+    {
+        keys[i] = w->base + i;
+        if (anv_hashmap_put(map, &keys[i], &keys[i]) != 0)
+        {
+            result = (void*)1;
+            break;
+        }
+    }
+    for (int i = 0; i < 2000 && map && !result; i++)
+    {
+        if (anv_hashmap_get(map, &keys[i]) != &keys[i])
+        {
+            result = (void*)1;
+        }
+    }
+
+    anv_hashmap_destroy(map, false, false);
+    free(keys);
+    return map ? result : (void*)1;
+}
+
+// Test the allocator view shared by containers on several threads
+int test_caching_heap_allocator_view(void)
+{
+    ANVAllocator backing = anv_alloc_default();
+    ANVCachingHeap* heap = anv_caching_heap_create(&backing);
+    ASSERT_NOT_NULL(heap);
+
+    ANVAllocator alloc = anv_caching_heap_allocator(heap);
+
+    ANVThread threads[NUM_THREADS];
+    MapWorkerArg args[NUM_THREADS];
+    for (int i = 0; i < NUM_THREADS; i++)
+    {
+        args[i].alloc = &alloc;
+        args[i].base = i * 100000;
+        ASSERT_EQ(anv_thread_create(&threads[i], map_worker, &args[i]), 0);
+    }
+
+    int failures = 0;
+    for (int i = 0; i < NUM_THREADS; i++)
+    {
+        void* result = NULL;
+        anv_thread_join(threads[i], &result);
+        failures += result != NULL;
+    }
+    ASSERT_EQ(failures, 0);
+
+    // Realloc within a size class stays in place
+    char* p = anv_alloc_malloc(&alloc, 20);
+    ASSERT_EQ_PTR(anv_alloc_realloc(&alloc, p, 20, 30), p);
+    char* q = anv_alloc_realloc(&alloc, p, 30, 5000);
+    ASSERT_NOT_NULL(q);
+    anv_alloc_free(&alloc, q);
+
+    anv_caching_heap_destroy(heap);
+    return TEST_SUCCESS;
+}
+
+typedef struct
+{
+    int (*func)(void);
+    const char* name;
+} TestCase;
+
+int main(void)
+{
+    const TestCase tests[] = {
+        {test_caching_heap_basic, "test_caching_heap_basic"},
+        {test_caching_heap_reuse, "test_caching_heap_reuse"},
+        {test_caching_heap_cross_thread_free, "test_caching_heap_cross_thread_free"},
+        {test_caching_heap_thread_churn, "test_caching_heap_thread_churn"},
+        {test_caching_heap_evicted_cache, "test_caching_heap_evicted_cache"},
+        {test_caching_heap_allocator_view, "test_caching_heap_allocator_view"},
+    };
+
+    printf("Running CachingHeap tests...\n");
+
+    int failed = 0;
+    const int num_tests = sizeof(tests) / sizeof(tests[0]);
+    for (int i = 0; i < num_tests; i++)
+    {
+        if (tests[i].func() != TEST_SUCCESS)
+        {
+            printf("%s failed\n", tests[i].name);
+            failed++;
+        }
+    }
+
+    if (failed == 0)
+    {
+        printf("All CachingHeap tests passed!\n");
+        return 0;
+    }
+
+    printf("%d CachingHeap tests failed.\n", failed);
+    return 1;
+}
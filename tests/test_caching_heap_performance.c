@@ -0,0 +1,168 @@
+//
+// CachingHeap performance test - multi-threaded allocation churn versus malloc
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "memory/CachingHeap.h"
+#include "system/Threads.h"
+#include "TestAssert.h"
+#include "TestHelpers.h"
+
+#define CHURN_OPS 200000
+#define LIVE_SLOTS 256
+#define MAX_THREADS 8
+
+typedef struct
+{
+    ANVCachingHeap* heap; // NULL selects plain malloc/free
+    unsigned seed;
+    int failed;
+} ChurnArg;
+
+// Each thread keeps a window of live blocks and randomly replaces them,
+// mixing small sizes typical of container nodes.
+static void* churn_thread(void* arg)
+{
+    ChurnArg* c = arg;
+    void* live[LIVE_SLOTS] = {0};
+
+    for (int i = 0; i < CHURN_OPS; i++)
+    {
+        const unsigned r = next_random(&c->seed);
+        const size_t slot = r % LIVE_SLOTS;
+        const size_t size = 16 + (r >> 10) % 240;
+
+        if (c->heap)
+        {
+            anv_caching_heap_free(c->heap, live[slot]);
+            live[slot] = anv_caching_heap_alloc(c->heap, size);
+        }
+        else
+        {
+            free(live[slot]);
+            live[slot] = malloc(size);
+        }
+
+        if (!live[slot])
+        {
+            c->failed = 1;
+            break;
+        }
+        *(unsigned char*)live[slot] = (unsigned char)i;
+    }
+
+    for (size_t i = 0; i < LIVE_SLOTS; i++)
+    {
+        if (c->heap)
+        {
+            anv_caching_heap_free(c->heap, live[i]);
+        }
+        else
+        {
+            free(live[i]);
+        }
+    }
+
+    if (c->heap)
+    {
+        anv_caching_heap_flush_thread(c->heap);
+    }
+    return NULL;
+}
+
+static int run_churn(ANVCachingHeap* heap, const int num_threads, double* seconds_out)
+{
+    ANVThread threads[MAX_THREADS];
+    ChurnArg args[MAX_THREADS];
+
+    const double start = now_seconds();
+    for (int i = 0; i < num_threads; i++)
+    {
+        args[i].heap = heap;
+        args[i].seed = 12345u + (unsigned)i;
+        args[i].failed = 0;
+        if (anv_thread_create(&threads[i], churn_thread, &args[i]) != 0)
+        {
+            return -1;
+        }
+    }
+
+    int failed = 0;
+    for (int i = 0; i < num_threads; i++)
+    {
+        anv_thread_join(threads[i], NULL);
+        failed |= args[i].failed;
+    }
+    *seconds_out = now_seconds() - start;
+    return failed ? -1 : 0;
+}
+
+// Compare churn throughput of the caching heap against malloc as threads scale
+int test_caching_heap_performance_churn(void)
+{
+    ANVAllocator backing = anv_alloc_default();
+    ANVCachingHeap* heap = anv_caching_heap_create(&backing);
+    ASSERT_NOT_NULL(heap);
+
+    const int thread_counts[] = {1, 2, 4, 8};
+    for (size_t t = 0; t < sizeof(thread_counts) / sizeof(thread_counts[0]); t++)
+    {
+        const int threads = thread_counts[t];
+        double malloc_time = 0.0;
+        double heap_time = 0.0;
+
+        ASSERT_EQ(run_churn(NULL, threads, &malloc_time), 0);
+        ASSERT_EQ(run_churn(heap, threads, &heap_time), 0);
+
+        const double ops = (double)CHURN_OPS * threads;
+        printf("%d thread(s): malloc %.2f Mops/s, caching heap %.2f Mops/s\n",
+               threads,
+               malloc_time > 0 ? ops / malloc_time / 1e6 : 0.0,
+               heap_time > 0 ? ops / heap_time / 1e6 : 0.0);
+    }
+
+    ANVCachingHeapStats stats;
+    ASSERT_EQ(anv_caching_heap_stats(heap, &stats), 0);
+    printf("Caching heap: %zu thread caches, %zu refills, %zu flushes, %zu spans\n",
+           stats.thread_caches, stats.refills, stats.flushes, stats.spans);
+
+    anv_caching_heap_destroy(heap);
+    return TEST_SUCCESS;
+}
+
+typedef struct
+{
+    int (*func)(void);
+    const char* name;
+} TestCase;
+
+int main(void)
+{
+    const TestCase tests[] = {
+        {test_caching_heap_performance_churn, "test_caching_heap_performance_churn"},
+    };
+
+    printf("Running CachingHeap performance tests...\n");
+
+    int failed = 0;
+    const int num_tests = sizeof(tests) / sizeof(tests[0]);
+    for (int i = 0; i < num_tests; i++)
+    {
+        if (tests[i].func() != TEST_SUCCESS)
+        {
+            printf("%s failed\n", tests[i].name);
+            failed++;
+        }
+    }
+
+    if (failed == 0)
+    {
+        printf("All CachingHeap performance tests passed!\n");
+        return 0;
+    }
+
+    printf("%d CachingHeap performance tests failed.\n", failed);
+    return 1;
+}
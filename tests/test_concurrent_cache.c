@@ -0,0 +1,390 @@
+//
+// ConcurrentCache tests
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "containers/ConcurrentCache.h"
+#include "system/Threads.h"
+#include "TestAssert.h"
+#include "TestHelpers.h"
+
+#define NUM_THREADS 4
+#define OPS_PER_THREAD 20000
+#define NUM_KEYS 4000
+
+// Test the single-threaded API surface
+int test_concurrent_cache_basic(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVConcurrentCache* cache = anv_concurrent_cache_create(&alloc, anv_hash_string, anv_key_equals_string, 100, 5,
+                                                            ANV_CACHE_LRU);
+    ASSERT_NOT_NULL(cache);
+    ASSERT_EQ(anv_concurrent_cache_shard_count(cache), 8); // Rounded up
+    ASSERT_EQ(anv_concurrent_cache_capacity(cache), 100);  // 13 in four shards, 12 in four
+    ASSERT_EQ((uintptr_t)cache->shards % ANV_CONCURRENT_CACHE_CACHE_LINE, 0);
+    ASSERT_EQ(sizeof(ANVConcurrentCacheShard) % ANV_CONCURRENT_CACHE_CACHE_LINE, 0);
+
+    char k1[] = "alpha";
+    char k2[] = "beta";
+    int v1 = 1;
+    int v2 = 2;
+    int v3 = 3;
+
+    ASSERT_EQ(anv_concurrent_cache_put(cache, k1, &v1), 0);
+    ASSERT_EQ(anv_concurrent_cache_put(cache, k2, &v2), 0);
+    ASSERT_EQ(anv_concurrent_cache_size(cache), 2);
+    ASSERT_EQ_PTR(anv_concurrent_cache_get(cache, "alpha"), &v1);
+    ASSERT_EQ_PTR(anv_concurrent_cache_peek(cache, "beta"), &v2);
+    ASSERT_TRUE(anv_concurrent_cache_contains_key(cache, "beta"));
+    ASSERT_NULL(anv_concurrent_cache_get(cache, "gamma"));
+
+    void* old = NULL;
+    ASSERT_EQ(anv_concurrent_cache_put_replace(cache, k1, &v3, &old), 0);
+    ASSERT_EQ_PTR(old, &v1);
+    ASSERT_EQ_PTR(anv_concurrent_cache_remove_get(cache, "alpha", false), &v3);
+    ASSERT_EQ(anv_concurrent_cache_remove(cache, "beta", false, false), 0);
+    ASSERT_EQ(anv_concurrent_cache_remove(cache, "beta", false, false), -1);
+    ASSERT_EQ(anv_concurrent_cache_size(cache), 0);
+
+    const ANVCacheStats stats = anv_concurrent_cache_stats(cache);
+    ASSERT_EQ(stats.hits, 1);
+    ASSERT_EQ(stats.misses, 1);
+    anv_concurrent_cache_reset_stats(cache);
+    ASSERT_EQ(anv_concurrent_cache_stats(cache).hits, 0);
+    ASSERT(anv_concurrent_cache_memory_usage(cache) > sizeof(ANVConcurrentCache));
+
+    ASSERT_EQ(anv_concurrent_cache_put(NULL, k1, &v1), -1);
+    ASSERT_EQ(anv_concurrent_cache_put(cache, NULL, &v1), -1);
+    ASSERT_NULL(anv_concurrent_cache_create(NULL, anv_hash_string, anv_key_equals_string, 10, 0, ANV_CACHE_LRU));
+    ASSERT_NULL(anv_concurrent_cache_create(&alloc, anv_hash_string, anv_key_equals_string, 0, 0, ANV_CACHE_LRU));
+    ASSERT_NULL(anv_concurrent_cache_create(&alloc, anv_hash_string, anv_key_equals_string, 10,
+                                            ANV_CONCURRENT_CACHE_MAX_SHARDS + 1, ANV_CACHE_LRU));
+
+    anv_concurrent_cache_destroy(cache, false, false);
+    return TEST_SUCCESS;
+}
+
+// Test that each shard evicts on its own and the shard counters add up
+int test_concurrent_cache_shard_eviction(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVConcurrentCache* cache = anv_concurrent_cache_create(&alloc, anv_hash_int, anv_key_equals_int, 64, 4,
+                                                            ANV_CACHE_CLOCK);
+    ASSERT_NOT_NULL(cache);
+
+    static int keys[1000];
+    for (int i = 0; i < 1000; i++)
+    {
+        keys[i] = i;
+        ASSERT_EQ(anv_concurrent_cache_put(cache, &keys[i], &keys[i]), 0);
+    }
+
+    // Every shard fills up before evicting, and never holds more than its slice
+    ASSERT_EQ(anv_concurrent_cache_size(cache), 64);
+    size_t evictions = 0;
+    for (size_t s = 0; s < anv_concurrent_cache_shard_count(cache); s++)
+    {
+        ASSERT_EQ(anv_cache_size(cache->shards[s].cache), 16);
+        evictions += anv_concurrent_cache_shard_stats(cache, s).evictions;
+    }
+    ASSERT_EQ(evictions, 1000 - 64);
+    ASSERT_EQ(anv_concurrent_cache_stats(cache).evictions, evictions);
+    ASSERT_EQ(anv_concurrent_cache_shard_stats(cache, 4).evictions, 0); // Out of range
+
+    anv_concurrent_cache_clear(cache, false, false);
+    ASSERT_EQ(anv_concurrent_cache_size(cache), 0);
+
+    anv_concurrent_cache_destroy(cache, false, false);
+    return TEST_SUCCESS;
+}
+
+// Test that the shard capacities add up to exactly the requested capacity
+int test_concurrent_cache_capacity(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    const size_t capacities[] = {1, 3, 15, 16, 17, 100, 1000};
+    for (size_t c = 0; c < sizeof(capacities) / sizeof(capacities[0]); c++)
+    {
+        ANVConcurrentCache* cache = anv_concurrent_cache_create(&alloc, anv_hash_int, anv_key_equals_int,
+                                                                capacities[c], 0, ANV_CACHE_LRU);
+        ASSERT_NOT_NULL(cache);
+        ASSERT_EQ(anv_concurrent_cache_capacity(cache), capacities[c]);
+        ASSERT(anv_concurrent_cache_shard_count(cache) <= capacities[c]);
+        for (size_t s = 0; s < anv_concurrent_cache_shard_count(cache); s++)
+        {
+            ASSERT(anv_cache_capacity(cache->shards[s].cache) >= 1);
+        }
+        anv_concurrent_cache_destroy(cache, false, false);
+    }
+
+    // A single entry cache keeps a single entry
+    ANVConcurrentCache* cache = anv_concurrent_cache_create(&alloc, anv_hash_int, anv_key_equals_int, 1, 0,
+                                                            ANV_CACHE_LRU);
+    ASSERT_NOT_NULL(cache);
+    ASSERT_EQ(anv_concurrent_cache_shard_count(cache), 1);
+    static int keys[8];
+    for (int i = 0; i < 8; i++)
+    {
+        keys[i] = i;
+        ASSERT_EQ(anv_concurrent_cache_put(cache, &keys[i], &keys[i]), 0);
+    }
+    ASSERT_EQ(anv_concurrent_cache_size(cache), 1);
+
+    anv_concurrent_cache_destroy(cache, false, false);
+    return TEST_SUCCESS;
+}
+
+typedef struct
+{
+    ANVConcurrentCache* cache;
+    int* keys;
+    unsigned seed;
+    size_t gets;
+    size_t bad_values;
+} WorkerArg;
+
+// Random get-then-put-on-miss over a key set larger than the cache
+static void* worker(void* arg)
+{
+    WorkerArg* w = arg;
+    for (int i = 0; i < OPS_PER_THREAD; i++)
+    {
+        w->seed = w->seed * 1103515245u + 12345u;
+        int* key = &w->keys[(w->seed >> 8) % NUM_KEYS];
+
+        const int* value = anv_concurrent_cache_get(w->cache, key);
+        w->gets++;
+        if (!value)
+        {
+            anv_concurrent_cache_put(w->cache, key, key);
+        }
+        else if (value != key)
+        {
+            w->bad_values++;
+        }
+    }
+    return NULL;
+}
+
+// Test that concurrent readers and writers keep the cache bounded and the counters exact
+int test_concurrent_cache_threads(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVConcurrentCache* cache = anv_concurrent_cache_create(&alloc, anv_hash_int, anv_key_equals_int, 1000, 0,
+                                                            ANV_CACHE_LRU);
+    ASSERT_NOT_NULL(cache);
+
+    int* keys = malloc(sizeof(int) * NUM_KEYS);
+    ASSERT_NOT_NULL(keys);
+    for (int i = 0; i < NUM_KEYS; i++)
+    {
+        keys[i] = i;
+    }
+
+    ANVThread threads[NUM_THREADS];
+    WorkerArg args[NUM_THREADS];
+    for (int t = 0; t < NUM_THREADS; t++)
+    {
+        args[t] = (WorkerArg) {cache, keys, 99u + (unsigned)t, 0, 0};
+        ASSERT_EQ(anv_thread_create(&threads[t], worker, &args[t]), 0);
+    }
+
+    size_t gets = 0;
+    for (int t = 0; t < NUM_THREADS; t++)
+    {
+        ASSERT_EQ(anv_thread_join(threads[t], NULL), 0);
+        ASSERT_EQ(args[t].bad_values, 0);
+        gets += args[t].gets;
+    }
+
+    const ANVCacheStats stats = anv_concurrent_cache_stats(cache);
+    ASSERT_EQ(stats.hits + stats.misses, gets);
+    ASSERT_LTE(anv_concurrent_cache_size(cache), anv_concurrent_cache_capacity(cache));
+    ASSERT_TRUE(stats.evictions > 0);
+
+    anv_concurrent_cache_destroy(cache, false, false);
+    free(keys);
+    return TEST_SUCCESS;
+}
+
+static void free_evicted(void* key, void* value, void* user_data)
+{
+    (void)key;
+    (void)user_data;
+    free(value);
+}
+
+static void copy_int(void* value, void* user_data)
+{
+    *(int*)user_data = *(const int*)value;
+}
+
+static void ignore_value(void* value, void* user_data)
+{
+    (void)value;
+    (void)user_data;
+}
+
+// Copy the value out under the shard lock; put an owned value on a miss
+static void* owned_value_worker(void* arg)
+{
+    WorkerArg* w = arg;
+    for (int i = 0; i < OPS_PER_THREAD; i++)
+    {
+        w->seed = w->seed * 1103515245u + 12345u;
+        int* key = &w->keys[(w->seed >> 8) % NUM_KEYS];
+
+        int copy = -1;
+        w->gets++;
+        if (anv_concurrent_cache_get_with(w->cache, key, copy_int, &copy))
+        {
+            w->bad_values += copy != *key;
+            continue;
+        }
+
+        int* value = malloc(sizeof(int));
+        if (!value)
+        {
+            w->bad_values++;
+            continue;
+        }
+        *value = *key;
+        void* old = NULL;
+        if (anv_concurrent_cache_put_replace(w->cache, key, value, &old) != 0)
+        {
+            free(value);
+        }
+        free(old);
+    }
+    return NULL;
+}
+
+// Test reading values that a freeing eviction callback may release at any time
+int test_concurrent_cache_get_with(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVConcurrentCache* cache = anv_concurrent_cache_create(&alloc, anv_hash_int, anv_key_equals_int, 256, 4,
+                                                            ANV_CACHE_LRU);
+    ASSERT_NOT_NULL(cache);
+    anv_concurrent_cache_set_eviction_callback(cache, free_evicted, NULL);
+
+    int* keys = malloc(sizeof(int) * NUM_KEYS);
+    ASSERT_NOT_NULL(keys);
+    for (int i = 0; i < NUM_KEYS; i++)
+    {
+        keys[i] = i;
+    }
+
+    // Hits and misses are counted like get; NULL values still count as found
+    int copy = 0;
+    ASSERT_EQ(anv_concurrent_cache_get_with(cache, &keys[0], copy_int, &copy), 0);
+    ASSERT_EQ(anv_concurrent_cache_get_with(cache, &keys[0], NULL, &copy), 0);
+    ASSERT_EQ(anv_concurrent_cache_put(cache, &keys[1], NULL), 0);
+    ASSERT_EQ(anv_concurrent_cache_get_with(cache, &keys[1], ignore_value, NULL), 1);
+    ASSERT_EQ(anv_concurrent_cache_stats(cache).hits, 1);
+    ASSERT_EQ(anv_concurrent_cache_stats(cache).misses, 1);
+    ASSERT_EQ(anv_concurrent_cache_remove(cache, &keys[1], false, false), 0);
+
+    ANVThread threads[NUM_THREADS];
+    WorkerArg args[NUM_THREADS];
+    for (int t = 0; t < NUM_THREADS; t++)
+    {
+        args[t] = (WorkerArg) {cache, keys, 7u + (unsigned)t, 0, 0};
+        ASSERT_EQ(anv_thread_create(&threads[t], owned_value_worker, &args[t]), 0);
+    }
+    for (int t = 0; t < NUM_THREADS; t++)
+    {
+        ASSERT_EQ(anv_thread_join(threads[t], NULL), 0);
+        ASSERT_EQ(args[t].bad_values, 0);
+    }
+    ASSERT_TRUE(anv_concurrent_cache_stats(cache).evictions > 0);
+
+    anv_concurrent_cache_destroy(cache, false, true);
+    free(keys);
+    return TEST_SUCCESS;
+}
+
+static size_t hash_calls;
+
+static size_t counting_hash(const void* key)
+{
+    hash_calls++;
+    return anv_hash_int(key);
+}
+
+// Test that every keyed operation hashes its key exactly once
+int test_concurrent_cache_hash_once(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVConcurrentCache* cache = anv_concurrent_cache_create(&alloc, counting_hash, anv_key_equals_int, 64, 4,
+                                                            ANV_CACHE_LRU);
+    ASSERT_NOT_NULL(cache);
+
+    int key = 42;
+    int value = 1;
+    void* old = NULL;
+    int copy = 0;
+
+    hash_calls = 0;
+    ASSERT_EQ(anv_concurrent_cache_put(cache, &key, &value), 0);
+    ASSERT_EQ(hash_calls, 1);
+    ASSERT_EQ_PTR(anv_concurrent_cache_get(cache, &key), &value);
+    ASSERT_EQ(hash_calls, 2);
+    ASSERT_EQ(anv_concurrent_cache_get_with(cache, &key, copy_int, &copy), 1);
+    ASSERT_EQ(hash_calls, 3);
+    ASSERT_EQ_PTR(anv_concurrent_cache_peek(cache, &key), &value);
+    ASSERT_EQ(hash_calls, 4);
+    ASSERT_TRUE(anv_concurrent_cache_contains_key(cache, &key));
+    ASSERT_EQ(hash_calls, 5);
+    ASSERT_EQ(anv_concurrent_cache_put_replace(cache, &key, &value, &old), 0);
+    ASSERT_EQ(hash_calls, 6);
+    ASSERT_EQ_PTR(anv_concurrent_cache_remove_get(cache, &key, false), &value);
+    ASSERT_EQ(hash_calls, 7);
+    ASSERT_EQ(anv_concurrent_cache_remove(cache, &key, false, false), -1);
+    ASSERT_EQ(hash_calls, 8);
+
+    anv_concurrent_cache_destroy(cache, false, false);
+    return TEST_SUCCESS;
+}
+
+typedef struct
+{
+    int (*func)(void);
+    const char* name;
+} TestCase;
+
+int main(void)
+{
+    const TestCase tests[] = {
+        {test_concurrent_cache_basic, "test_concurrent_cache_basic"},
+        {test_concurrent_cache_shard_eviction, "test_concurrent_cache_shard_eviction"},
+        {test_concurrent_cache_capacity, "test_concurrent_cache_capacity"},
+        {test_concurrent_cache_threads, "test_concurrent_cache_threads"},
+        {test_concurrent_cache_get_with, "test_concurrent_cache_get_with"},
+        {test_concurrent_cache_hash_once, "test_concurrent_cache_hash_once"},
+    };
+
+    printf("Running ConcurrentCache tests...\n");
+
+    int failed = 0;
+    const int num_tests = sizeof(tests) / sizeof(tests[0]);
+    for (int i = 0; i < num_tests; i++)
+    {
+        if (tests[i].func() != TEST_SUCCESS)
+        {
+            printf("%s failed\n", tests[i].name);
+            failed++;
+        }
+    }
+
+    if (failed == 0)
+    {
+        printf("All ConcurrentCache tests passed!\n");
+        return 0;
+    }
+
+    printf("%d ConcurrentCache tests failed.\n", failed);
+    return 1;
+}
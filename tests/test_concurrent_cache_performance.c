@@ -0,0 +1,175 @@
+//
+// ConcurrentCache performance test - throughput and hit ratio under a
+// Zipfian key distribution versus a mutex-wrapped Cache as thread count grows
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "containers/Cache.h"
+#include "containers/ConcurrentCache.h"
+#include "system/Mutex.h"
+#include "system/Threads.h"
+#include "TestAssert.h"
+#include "TestHelpers.h"
+
+#define NUM_KEYS 100000
+#define CAPACITY 10000
+#define TRACE_LENGTH 1000000
+#define OPS_PER_THREAD 250000
+#define MAX_THREADS 8
+#define SHARDS 64
+
+typedef struct
+{
+    ANVCache* cache;
+    ANVMutex lock;
+} LockedCache;
+
+typedef struct
+{
+    ANVConcurrentCache* sharded; // NULL selects the locked cache
+    LockedCache* locked;
+    const int** trace;
+    size_t offset;
+} WorkerArg;
+
+// Get, and put on a miss, walking the trace from this thread's offset
+static void* worker(void* arg)
+{
+    const WorkerArg* w = arg;
+    for (size_t i = 0; i < OPS_PER_THREAD; i++)
+    {
+        int* key = (int*)w->trace[(w->offset + i) % TRACE_LENGTH];
+        if (w->sharded)
+        {
+            if (!anv_concurrent_cache_get(w->sharded, key))
+            {
+                anv_concurrent_cache_put(w->sharded, key, key);
+            }
+        }
+        else
+        {
+            anv_mutex_lock(&w->locked->lock);
+            if (!anv_cache_get(w->locked->cache, key))
+            {
+                anv_cache_put(w->locked->cache, key, key);
+            }
+            anv_mutex_unlock(&w->locked->lock);
+        }
+    }
+    return NULL;
+}
+
+static double run(ANVConcurrentCache* sharded, LockedCache* locked, const int** trace, const int num_threads)
+{
+    ANVThread threads[MAX_THREADS];
+    WorkerArg args[MAX_THREADS];
+
+    const double start = now_seconds();
+    for (int i = 0; i < num_threads; i++)
+    {
+        args[i] = (WorkerArg) {sharded, locked, trace, (size_t)i * (TRACE_LENGTH / MAX_THREADS)};
+        if (anv_thread_create(&threads[i], worker, &args[i]) != 0)
+        {
+            return -1.0;
+        }
+    }
+
+    for (int i = 0; i < num_threads; i++)
+    {
+        anv_thread_join(threads[i], NULL);
+    }
+    return now_seconds() - start;
+}
+
+// Sweep thread count for both eviction policies
+int test_concurrent_cache_performance_zipf(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    int* keys = malloc(sizeof(int) * NUM_KEYS);
+    const int** trace = malloc(sizeof(int*) * TRACE_LENGTH);
+    ASSERT_NOT_NULL(keys);
+    ASSERT_NOT_NULL(trace);
+    for (int i = 0; i < NUM_KEYS; i++)
+    {
+        keys[i] = i;
+    }
+    ASSERT_EQ(build_zipf_trace(keys, NUM_KEYS, trace, TRACE_LENGTH, 0x9E3779B97F4A7C15ULL), 0);
+
+    const ANVCachePolicy policies[] = {ANV_CACHE_LRU, ANV_CACHE_CLOCK};
+    const char* policy_names[] = {"LRU", "CLOCK"};
+    const int thread_counts[] = {1, 2, 4, 8};
+    printf("Zipf over %d keys, capacity %d, %d ops per thread\n", NUM_KEYS, CAPACITY, OPS_PER_THREAD);
+
+    for (size_t p = 0; p < sizeof(policies) / sizeof(policies[0]); p++)
+    {
+        for (size_t t = 0; t < sizeof(thread_counts) / sizeof(thread_counts[0]); t++)
+        {
+            LockedCache locked;
+            locked.cache = anv_cache_create(&alloc, anv_hash_int, anv_key_equals_int, CAPACITY, policies[p]);
+            ASSERT_NOT_NULL(locked.cache);
+            ASSERT_EQ(anv_mutex_init(&locked.lock), 0);
+            ANVConcurrentCache* sharded = anv_concurrent_cache_create(&alloc, anv_hash_int, anv_key_equals_int,
+                                                                      CAPACITY, SHARDS, policies[p]);
+            ASSERT_NOT_NULL(sharded);
+
+            const double locked_time = run(NULL, &locked, trace, thread_counts[t]);
+            const double sharded_time = run(sharded, NULL, trace, thread_counts[t]);
+
+            const ANVCacheStats locked_stats = anv_cache_stats(locked.cache);
+            const ANVCacheStats sharded_stats = anv_concurrent_cache_stats(sharded);
+            const double ops = (double)OPS_PER_THREAD * thread_counts[t];
+            ASSERT_EQ((double)(locked_stats.hits + locked_stats.misses), ops);
+            ASSERT_EQ((double)(sharded_stats.hits + sharded_stats.misses), ops);
+
+            printf("%-5s %d thread(s): one mutex %.2f Mops/s (hit %.3f), %d shards %.2f Mops/s (hit %.3f)\n",
+                   policy_names[p], thread_counts[t],
+                   locked_time > 0 ? ops / locked_time / 1e6 : 0.0, (double)locked_stats.hits / ops, SHARDS,
+                   sharded_time > 0 ? ops / sharded_time / 1e6 : 0.0, (double)sharded_stats.hits / ops);
+
+            anv_concurrent_cache_destroy(sharded, false, false);
+            anv_mutex_destroy(&locked.lock);
+            anv_cache_destroy(locked.cache, false, false);
+        }
+    }
+
+    free(trace);
+    free(keys);
+    return TEST_SUCCESS;
+}
+
+typedef struct
+{
+    int (*func)(void);
+    const char* name;
+} TestCase;
+
+int main(void)
+{
+    const TestCase tests[] = {
+        {test_concurrent_cache_performance_zipf, "test_concurrent_cache_performance_zipf"},
+    };
+
+    printf("Running ConcurrentCache performance tests...\n");
+
+    int failed = 0;
+    const int num_tests = sizeof(tests) / sizeof(tests[0]);
+    for (int i = 0; i < num_tests; i++)
+    {
+        if (tests[i].func() != TEST_SUCCESS)
+        {
+            printf("%s failed\n", tests[i].name);
+            failed++;
+        }
+    }
+
+    if (failed == 0)
+    {
+        printf("All ConcurrentCache performance tests passed!\n");
+        return 0;
+    }
+
+    printf("%d ConcurrentCache performance tests failed.\n", failed);
+    return 1;
+}
@@ -0,0 +1,355 @@
+//
+// ConcurrentHashMap tests
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "containers/ConcurrentHashMap.h"
+#include "system/Threads.h"
+#include "TestAssert.h"
+#include "TestHelpers.h"
+
+#define NUM_THREADS 4
+#define KEYS_PER_THREAD 5000
+
+// Test the single-threaded API surface
+int test_concurrent_hashmap_basic(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVConcurrentHashMap* map = anv_concurrent_hashmap_create(&alloc, anv_hash_string, anv_key_equals_string, 5, 0);
+    ASSERT_NOT_NULL(map);
+    ASSERT_EQ(anv_concurrent_hashmap_segment_count(map), 8); // Rounded up
+    ASSERT_TRUE(anv_concurrent_hashmap_is_empty(map));
+    ASSERT_EQ((uintptr_t)map->segments % ANV_CONCURRENT_HASHMAP_CACHE_LINE, 0);
+    ASSERT_EQ(sizeof(ANVConcurrentHashMapSegment) % ANV_CONCURRENT_HASHMAP_CACHE_LINE, 0);
+
+    char k1[] = "alpha";
+    char k2[] = "beta";
+    int v1 = 1;
+    int v2 = 2;
+    int v3 = 3;
+
+    ASSERT_EQ(anv_concurrent_hashmap_put(map, k1, &v1), 0);
+    ASSERT_EQ(anv_concurrent_hashmap_put(map, k2, &v2), 0);
+    ASSERT_EQ(anv_concurrent_hashmap_size(map), 2);
+    ASSERT_EQ_PTR(anv_concurrent_hashmap_get(map, "alpha"), &v1);
+    ASSERT_TRUE(anv_concurrent_hashmap_contains_key(map, "beta"));
+    ASSERT_FALSE(anv_concurrent_hashmap_contains_key(map, "gamma"));
+
+    void* old = NULL;
+    ASSERT_EQ(anv_concurrent_hashmap_put_replace(map, k1, &v3, &old), 0);
+    ASSERT_EQ_PTR(old, &v1);
+
+    void* existing = NULL;
+    ASSERT_EQ(anv_concurrent_hashmap_put_if_absent(map, k1, &v1, &existing), 1);
+    ASSERT_EQ_PTR(existing, &v3);
+    ASSERT_EQ_PTR(anv_concurrent_hashmap_get(map, "alpha"), &v3);
+    char k3[] = "gamma";
+    ASSERT_EQ(anv_concurrent_hashmap_put_if_absent(map, k3, &v1, NULL), 0);
+    ASSERT_EQ_PTR(anv_concurrent_hashmap_get(map, "gamma"), &v1);
+
+    ASSERT_EQ_PTR(anv_concurrent_hashmap_remove_get(map, "gamma", false), &v1);
+    ASSERT_EQ(anv_concurrent_hashmap_remove(map, "beta", false, false), 0);
+    ASSERT_EQ(anv_concurrent_hashmap_remove(map, "beta", false, false), -1);
+    ASSERT_EQ(anv_concurrent_hashmap_size(map), 1);
+    ASSERT(anv_concurrent_hashmap_memory_usage(map) > sizeof(ANVConcurrentHashMap));
+
+    ASSERT_EQ(anv_concurrent_hashmap_put(NULL, k1, &v1), -1);
+    ASSERT_EQ(anv_concurrent_hashmap_put(map, NULL, &v1), -1);
+    ASSERT_NULL(anv_concurrent_hashmap_create(NULL, anv_hash_string, anv_key_equals_string, 0, 0));
+    ASSERT_NULL(anv_concurrent_hashmap_create(&alloc, anv_hash_string, anv_key_equals_string,
+                                              ANV_CONCURRENT_HASHMAP_MAX_SEGMENTS + 1, 0));
+
+    anv_concurrent_hashmap_clear(map, false, false);
+    ASSERT_TRUE(anv_concurrent_hashmap_is_empty(map));
+
+    anv_concurrent_hashmap_destroy(map, false, false);
+    return TEST_SUCCESS;
+}
+
+// Test that a single segment behaves like a plain map
+int test_concurrent_hashmap_single_segment(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVConcurrentHashMap* map = anv_concurrent_hashmap_create(&alloc, anv_hash_int, anv_key_equals_int, 1, 0);
+    ASSERT_NOT_NULL(map);
+
+    static int keys[1000];
+    for (int i = 0; i < 1000; i++)
+    {
+        keys[i] = i;
+        ASSERT_EQ(anv_concurrent_hashmap_put(map, &keys[i], &keys[i]), 0);
+    }
+    ASSERT_EQ(anv_concurrent_hashmap_size(map), 1000);
+    for (int i = 0; i < 1000; i++)
+    {
+        ASSERT_EQ_PTR(anv_concurrent_hashmap_get(map, &keys[i]), &keys[i]);
+    }
+
+    anv_concurrent_hashmap_destroy(map, false, false);
+    return TEST_SUCCESS;
+}
+
+typedef struct
+{
+    ANVConcurrentHashMap* map;
+    int* keys;
+    int first;
+    int count;
+    int failed;
+} WorkerArg;
+
+// Insert a private key range, read it back, remove half of it, and race
+// put_if_absent on keys shared by every thread
+static void* worker(void* arg)
+{
+    WorkerArg* w = arg;
+    for (int i = w->first; i < w->first + w->count; i++)
+    {
+        if (anv_concurrent_hashmap_put(w->map, &w->keys[i], &w->keys[i]) != 0)
+        {
+            w->failed = 1;
+        }
+    }
+    for (int i = w->first; i < w->first + w->count; i++)
+    {
+        if (anv_concurrent_hashmap_get(w->map, &w->keys[i]) != &w->keys[i])
+        {
+            w->failed = 1;
+        }
+    }
+    for (int i = w->first; i < w->first + w->count; i += 2)
+    {
+        if (anv_concurrent_hashmap_remove(w->map, &w->keys[i], false, false) != 0)
+        {
+            w->failed = 1;
+        }
+    }
+
+    // Shared keys live past the private ranges
+    const int shared = NUM_THREADS * KEYS_PER_THREAD;
+    for (int i = shared; i < shared + 100; i++)
+    {
+        if (anv_concurrent_hashmap_put_if_absent(w->map, &w->keys[i], w, NULL) < 0)
+        {
+            w->failed = 1;
+        }
+    }
+    return NULL;
+}
+
+// Test concurrent writers and readers against the final contents
+int test_concurrent_hashmap_threads(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVConcurrentHashMap* map = anv_concurrent_hashmap_create(&alloc, anv_hash_int, anv_key_equals_int, 0, 0);
+    ASSERT_NOT_NULL(map);
+
+    const int total = NUM_THREADS * KEYS_PER_THREAD;
+    int* keys = malloc(sizeof(int) * (total + 100));
+    ASSERT_NOT_NULL(keys);
+    for (int i = 0; i < total + 100; i++)
+    {
+        keys[i] = i;
+    }
+
+    ANVThread threads[NUM_THREADS];
+    WorkerArg args[NUM_THREADS];
+    for (int t = 0; t < NUM_THREADS; t++)
+    {
+        args[t] = (WorkerArg) {map, keys, t * KEYS_PER_THREAD, KEYS_PER_THREAD, 0};
+        ASSERT_EQ(anv_thread_create(&threads[t], worker, &args[t]), 0);
+    }
+    for (int t = 0; t < NUM_THREADS; t++)
+    {
+        ASSERT_EQ(anv_thread_join(threads[t], NULL), 0);
+        ASSERT_EQ(args[t].failed, 0);
+    }
+
+    ASSERT_EQ(anv_concurrent_hashmap_size(map), (size_t)(total / 2 + 100));
+    for (int i = 0; i < total; i++)
+    {
+        ASSERT_EQ(anv_concurrent_hashmap_contains_key(map, &keys[i]), i % 2 == 1);
+    }
+
+    // Exactly one thread won each shared key
+    for (int i = total; i < total + 100; i++)
+    {
+        const void* winner = anv_concurrent_hashmap_get(map, &keys[i]);
+        ASSERT_TRUE(winner >= (void*)&args[0] && winner <= (void*)&args[NUM_THREADS - 1]);
+    }
+
+    anv_concurrent_hashmap_destroy(map, false, false);
+    free(keys);
+    return TEST_SUCCESS;
+}
+
+typedef struct
+{
+    ANVConcurrentHashMap* map;
+    int* keys;
+} ChurnArg;
+
+static void* churn(void* arg)
+{
+    ChurnArg* c = arg;
+    for (int round = 0; round < 20; round++)
+    {
+        for (int i = 1000; i < 2000; i++)
+        {
+            anv_concurrent_hashmap_put(c->map, &c->keys[i], &c->keys[i]);
+        }
+        for (int i = 1000; i < 2000; i++)
+        {
+            anv_concurrent_hashmap_remove(c->map, &c->keys[i], false, false);
+        }
+    }
+    return NULL;
+}
+
+// Test that the iterator sees every stable entry exactly once while another
+// thread churns other keys
+int test_concurrent_hashmap_iterator(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVConcurrentHashMap* map = anv_concurrent_hashmap_create(&alloc, anv_hash_int, anv_key_equals_int, 8, 0);
+    ASSERT_NOT_NULL(map);
+
+    static int keys[2000];
+    for (int i = 0; i < 2000; i++)
+    {
+        keys[i] = i;
+    }
+    for (int i = 0; i < 1000; i++)
+    {
+        ASSERT_EQ(anv_concurrent_hashmap_put(map, &keys[i], &keys[i]), 0);
+    }
+
+    ChurnArg arg = {map, keys};
+    ANVThread thread;
+    ASSERT_EQ(anv_thread_create(&thread, churn, &arg), 0);
+
+    for (int pass = 0; pass < 5; pass++)
+    {
+        int seen[1000] = {0};
+        ANVIterator it = anv_concurrent_hashmap_iterator(map);
+        ASSERT_TRUE(it.is_valid(&it));
+        while (it.has_next(&it))
+        {
+            const ANVPair* pair = it.get(&it);
+            ASSERT_NOT_NULL(pair);
+            const int key = *(const int*)pair->first;
+            ASSERT_EQ_PTR(pair->second, &keys[key]);
+            if (key < 1000)
+            {
+                seen[key]++;
+            }
+            it.next(&it);
+        }
+        it.destroy(&it);
+
+        for (int i = 0; i < 1000; i++)
+        {
+            ASSERT_EQ(seen[i], 1);
+        }
+    }
+
+    ASSERT_EQ(anv_thread_join(thread, NULL), 0);
+    ASSERT_EQ(anv_concurrent_hashmap_size(map), 1000);
+
+    ANVIterator it = anv_concurrent_hashmap_iterator(map);
+    size_t count = 0;
+    while (it.has_next(&it))
+    {
+        count++;
+        it.next(&it);
+    }
+    it.reset(&it);
+    ASSERT_TRUE(it.has_next(&it));
+    it.destroy(&it);
+    ASSERT_EQ(count, 1000);
+
+    anv_concurrent_hashmap_destroy(map, false, false);
+    return TEST_SUCCESS;
+}
+
+// Test that an iterator that cannot copy a segment stops and reports itself invalid
+int test_concurrent_hashmap_iterator_out_of_memory(void)
+{
+    ANVAllocator alloc = create_failing_int_allocator();
+    ANVConcurrentHashMap* map = anv_concurrent_hashmap_create(&alloc, anv_hash_int, anv_key_equals_int, 4, 0);
+    ASSERT_NOT_NULL(map);
+
+    static int keys[100];
+    for (int i = 0; i < 100; i++)
+    {
+        keys[i] = i;
+        ASSERT_EQ(anv_concurrent_hashmap_put(map, &keys[i], &keys[i]), 0);
+    }
+
+    // The iterator state is allocated, the first segment snapshot is not
+    set_alloc_fail_countdown(1);
+    ANVIterator it = anv_concurrent_hashmap_iterator(map);
+    ASSERT_NOT_NULL(it.data_state);
+    ASSERT_FALSE(it.is_valid(&it));
+    ASSERT_FALSE(it.has_next(&it));
+    ASSERT_NULL(it.get(&it));
+
+    // Once memory is available again a reset starts a complete pass
+    set_alloc_fail_countdown(-1);
+    it.reset(&it);
+    ASSERT_TRUE(it.is_valid(&it));
+    size_t count = 0;
+    while (it.has_next(&it))
+    {
+        count++;
+        it.next(&it);
+    }
+    ASSERT_TRUE(it.is_valid(&it));
+    ASSERT_EQ(count, 100);
+    it.destroy(&it);
+
+    anv_concurrent_hashmap_destroy(map, false, false);
+    return TEST_SUCCESS;
+}
+
+typedef struct
+{
+    int (*func)(void);
+    const char* name;
+} TestCase;
+
+int main(void)
+{
+    const TestCase tests[] = {
+        {test_concurrent_hashmap_basic, "test_concurrent_hashmap_basic"},
+        {test_concurrent_hashmap_single_segment, "test_concurrent_hashmap_single_segment"},
+        {test_concurrent_hashmap_threads, "test_concurrent_hashmap_threads"},
+        {test_concurrent_hashmap_iterator, "test_concurrent_hashmap_iterator"},
+        {test_concurrent_hashmap_iterator_out_of_memory, "test_concurrent_hashmap_iterator_out_of_memory"},
+    };
+
+    printf("Running ConcurrentHashMap tests...\n");
+
+    int failed = 0;
+    const int num_tests = sizeof(tests) / sizeof(tests[0]);
+    for (int i = 0; i < num_tests; i++)
+    {
+        if (tests[i].func() != TEST_SUCCESS)
+        {
+            printf("%s failed\n", tests[i].name);
+            failed++;
+        }
+    }
+
+    if (failed == 0)
+    {
+        printf("All ConcurrentHashMap tests passed!\n");
+        return 0;
+    }
+
+    printf("%d ConcurrentHashMap tests failed.\n", failed);
+    return 1;
+}
@@ -0,0 +1,200 @@
+//
+// ConcurrentHashMap performance test - throughput versus a mutex-wrapped
+// HashMap as thread count and read/write ratio vary
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "containers/ConcurrentHashMap.h"
+#include "containers/HashMap.h"
+#include "system/Mutex.h"
+#include "system/Threads.h"
+#include "TestAssert.h"
+#include "TestHelpers.h"
+
+#define NUM_KEYS 100000
+#define OPS_PER_THREAD 200000
+#define MAX_THREADS 8
+#define SEGMENTS 64
+
+typedef struct
+{
+    ANVHashMap* map;
+    ANVMutex lock;
+} LockedMap;
+
+typedef struct
+{
+    ANVConcurrentHashMap* striped; // NULL selects the locked map
+    LockedMap* locked;
+    int* keys;
+    unsigned seed;
+    unsigned read_percent;
+    size_t hits;
+} WorkerArg;
+
+// Random gets and overwriting puts over the preloaded keys
+static void* worker(void* arg)
+{
+    WorkerArg* w = arg;
+    for (int i = 0; i < OPS_PER_THREAD; i++)
+    {
+        const unsigned r = next_random(&w->seed);
+        int* key = &w->keys[r % NUM_KEYS];
+        const int is_read = (r >> 20) % 100 < w->read_percent;
+
+        if (w->striped)
+        {
+            if (is_read)
+            {
+                w->hits += anv_concurrent_hashmap_get(w->striped, key) != NULL;
+            }
+            else
+            {
+                anv_concurrent_hashmap_put(w->striped, key, key);
+            }
+        }
+        else
+        {
+            anv_mutex_lock(&w->locked->lock);
+            if (is_read)
+            {
+                w->hits += anv_hashmap_get(w->locked->map, key) != NULL;
+            }
+            else
+            {
+                anv_hashmap_put(w->locked->map, key, key);
+            }
+            anv_mutex_unlock(&w->locked->lock);
+        }
+    }
+    return NULL;
+}
+
+static double run(ANVConcurrentHashMap* striped, LockedMap* locked, int* keys, const int num_threads,
+                  const unsigned read_percent, size_t* hits_out)
+{
+    ANVThread threads[MAX_THREADS];
+    WorkerArg args[MAX_THREADS];
+
+    const double start = now_seconds();
+    for (int i = 0; i < num_threads; i++)
+    {
+        args[i] = (WorkerArg) {striped, locked, keys, 777u + (unsigned)i, read_percent, 0};
+        if (anv_thread_create(&threads[i], worker, &args[i]) != 0)
+        {
+            return -1.0;
+        }
+    }
+
+    *hits_out = 0;
+    for (int i = 0; i < num_threads; i++)
+    {
+        anv_thread_join(threads[i], NULL);
+        *hits_out += args[i].hits;
+    }
+    return now_seconds() - start;
+}
+
+// Number of gets the workers of run issue, replaying their random streams
+static size_t expected_reads(const int num_threads, const unsigned read_percent)
+{
+    size_t reads = 0;
+    for (int i = 0; i < num_threads; i++)
+    {
+        unsigned seed = 777u + (unsigned)i;
+        for (int op = 0; op < OPS_PER_THREAD; op++)
+        {
+            reads += (next_random(&seed) >> 20) % 100 < read_percent;
+        }
+    }
+    return reads;
+}
+
+// Sweep thread count and read ratio
+int test_concurrent_hashmap_performance_throughput(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    int* keys = malloc(sizeof(int) * NUM_KEYS);
+    ASSERT_NOT_NULL(keys);
+
+    LockedMap locked;
+    locked.map = anv_hashmap_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(locked.map);
+    ASSERT_EQ(anv_mutex_init(&locked.lock), 0);
+    ANVConcurrentHashMap* striped = anv_concurrent_hashmap_create(&alloc, anv_hash_int, anv_key_equals_int,
+                                                                  SEGMENTS, 0);
+    ASSERT_NOT_NULL(striped);
+
+    for (int i = 0; i < NUM_KEYS; i++)
+    {
+        keys[i] = i;
+        ASSERT_EQ(anv_hashmap_put(locked.map, &keys[i], &keys[i]), 0);
+        ASSERT_EQ(anv_concurrent_hashmap_put(striped, &keys[i], &keys[i]), 0);
+    }
+
+    const int thread_counts[] = {1, 2, 4, 8};
+    const unsigned read_percents[] = {50, 90, 100};
+    for (size_t r = 0; r < sizeof(read_percents) / sizeof(read_percents[0]); r++)
+    {
+        for (size_t t = 0; t < sizeof(thread_counts) / sizeof(thread_counts[0]); t++)
+        {
+            size_t locked_hits = 0;
+            size_t striped_hits = 0;
+            const double locked_time = run(NULL, &locked, keys, thread_counts[t], read_percents[r], &locked_hits);
+            const double striped_time = run(striped, NULL, keys, thread_counts[t], read_percents[r], &striped_hits);
+            ASSERT_EQ(striped_hits, expected_reads(thread_counts[t], read_percents[r])); // Every key present
+            ASSERT_EQ(locked_hits, striped_hits);
+
+            const double ops = (double)OPS_PER_THREAD * thread_counts[t];
+            printf("%3u%% reads, %d thread(s): one mutex %.2f Mops/s, %d stripes %.2f Mops/s\n",
+                   read_percents[r], thread_counts[t],
+                   locked_time > 0 ? ops / locked_time / 1e6 : 0.0, SEGMENTS,
+                   striped_time > 0 ? ops / striped_time / 1e6 : 0.0);
+        }
+    }
+
+    ASSERT_EQ(anv_concurrent_hashmap_size(striped), NUM_KEYS);
+
+    anv_concurrent_hashmap_destroy(striped, false, false);
+    anv_mutex_destroy(&locked.lock);
+    anv_hashmap_destroy(locked.map, false, false);
+    free(keys);
+    return TEST_SUCCESS;
+}
+
+typedef struct
+{
+    int (*func)(void);
+    const char* name;
+} TestCase;
+
+int main(void)
+{
+    const TestCase tests[] = {
+        {test_concurrent_hashmap_performance_throughput, "test_concurrent_hashmap_performance_throughput"},
+    };
+
+    printf("Running ConcurrentHashMap performance tests...\n");
+
+    int failed = 0;
+    const int num_tests = sizeof(tests) / sizeof(tests[0]);
+    for (int i = 0; i < num_tests; i++)
+    {
+        if (tests[i].func() != TEST_SUCCESS)
+        {
+            printf("%s failed\n", tests[i].name);
+            failed++;
+        }
+    }
+
+    if (failed == 0)
+    {
+        printf("All ConcurrentHashMap performance tests passed!\n");
+        return 0;
+    }
+
+    printf("%d ConcurrentHashMap performance tests failed.\n", failed);
+    return 1;
+}
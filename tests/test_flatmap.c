@@ -0,0 +1,278 @@
+//
+// FlatMap tests
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "containers/FlatMap.h"
+#include "TestAssert.h"
+#include "TestHelpers.h"
+
+#define MANY 5000
+
+// Test basic put/get/contains and updates
+int test_flatmap_put_get(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVFlatMap* map = anv_flatmap_create(&alloc, anv_hash_string, anv_key_equals_string, 0);
+    ASSERT_NOT_NULL(map);
+    ASSERT_TRUE(anv_flatmap_is_empty(map));
+    ASSERT_EQ(anv_flatmap_capacity(map), 16);
+
+    char k1[] = "apple";
+    char k2[] = "banana";
+    int v1 = 1;
+    int v2 = 2;
+    int v3 = 3;
+
+    ASSERT_EQ(anv_flatmap_put(map, k1, &v1), 0);
+    ASSERT_EQ(anv_flatmap_put(map, k2, &v2), 0);
+    ASSERT_EQ(anv_flatmap_size(map), 2);
+    ASSERT_EQ_PTR(anv_flatmap_get(map, "apple"), &v1);
+    ASSERT_TRUE(anv_flatmap_contains_key(map, "banana"));
+    ASSERT_FALSE(anv_flatmap_contains_key(map, "cherry"));
+    ASSERT_NULL(anv_flatmap_get(map, "cherry"));
+
+    void* old = NULL;
+    ASSERT_EQ(anv_flatmap_put_replace(map, k1, &v3, &old), 0);
+    ASSERT_EQ_PTR(old, &v1);
+    ASSERT_EQ_PTR(anv_flatmap_get(map, "apple"), &v3);
+    ASSERT_EQ(anv_flatmap_size(map), 2);
+
+    ASSERT_EQ(anv_flatmap_put(NULL, k1, &v1), -1);
+    ASSERT_EQ(anv_flatmap_put(map, NULL, &v1), -1);
+    ASSERT_NULL(anv_flatmap_create(NULL, anv_hash_string, anv_key_equals_string, 0));
+
+    anv_flatmap_destroy(map, false, false);
+    return TEST_SUCCESS;
+}
+
+// Test growth and removal over many keys, including tombstone reuse
+int test_flatmap_many(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVFlatMap* map = anv_flatmap_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(map);
+
+    int* keys = malloc(sizeof(int) * MANY);
+    ASSERT_NOT_NULL(keys);
+    for (int i = 0; i < MANY; i++)
+    {
+        keys[i] = i * 31;
+        ASSERT_EQ(anv_flatmap_put(map, &keys[i], &keys[i]), 0);
+    }
+    ASSERT_EQ(anv_flatmap_size(map), MANY);
+    ASSERT_LTE(anv_flatmap_load_factor(map), 0.875);
+
+    for (int i = 0; i < MANY; i++)
+    {
+        ASSERT_EQ_PTR(anv_flatmap_get(map, &keys[i]), &keys[i]);
+    }
+
+    // Remove every even key, the rest must stay reachable past the holes
+    for (int i = 0; i < MANY; i += 2)
+    {
+        ASSERT_EQ(anv_flatmap_remove(map, &keys[i], false, false), 0);
+    }
+    ASSERT_EQ(anv_flatmap_size(map), MANY / 2);
+    for (int i = 0; i < MANY; i++)
+    {
+        if (i % 2 == 0)
+        {
+            ASSERT_NULL(anv_flatmap_get(map, &keys[i]));
+        }
+        else
+        {
+            ASSERT_EQ_PTR(anv_flatmap_get(map, &keys[i]), &keys[i]);
+        }
+    }
+    ASSERT_EQ(anv_flatmap_remove(map, &keys[0], false, false), -1);
+
+    // Churn at a fixed size must not grow the table forever
+    const size_t capacity = anv_flatmap_capacity(map);
+    for (int round = 0; round < 20; round++)
+    {
+        for (int i = 0; i < MANY; i += 2)
+        {
+            ASSERT_EQ(anv_flatmap_put(map, &keys[i], &keys[i]), 0);
+        }
+        for (int i = 0; i < MANY; i += 2)
+        {
+            ASSERT_EQ_PTR(anv_flatmap_remove_get(map, &keys[i], false), &keys[i]);
+        }
+    }
+    ASSERT_EQ(anv_flatmap_capacity(map), capacity);
+    ASSERT_EQ(anv_flatmap_size(map), MANY / 2);
+
+    anv_flatmap_clear(map, false, false);
+    ASSERT_TRUE(anv_flatmap_is_empty(map));
+    ASSERT_NULL(anv_flatmap_get(map, &keys[1]));
+
+    free(keys);
+    anv_flatmap_destroy(map, false, false);
+    return TEST_SUCCESS;
+}
+
+// Test the iterator visits every pair exactly once
+int test_flatmap_iterator(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVFlatMap* map = anv_flatmap_create(&alloc, anv_hash_int, anv_key_equals_int, 100);
+    ASSERT_NOT_NULL(map);
+    const size_t capacity = anv_flatmap_capacity(map);
+
+    int keys[100];
+    int seen[100] = {0};
+    for (int i = 0; i < 100; i++)
+    {
+        keys[i] = i;
+        ASSERT_EQ(anv_flatmap_put(map, &keys[i], &keys[i]), 0);
+    }
+    ASSERT_EQ(anv_flatmap_capacity(map), capacity); // Presized, no rehash
+
+    ANVIterator it = anv_flatmap_iterator(map);
+    size_t count = 0;
+    while (it.has_next(&it))
+    {
+        const ANVPair* pair = it.get(&it);
+        ASSERT_NOT_NULL(pair);
+        const int key = *(int*)pair->first;
+        ASSERT_EQ_PTR(pair->second, &keys[key]);
+        seen[key]++;
+        count++;
+        it.next(&it);
+    }
+    ASSERT_EQ(count, 100);
+    for (int i = 0; i < 100; i++)
+    {
+        ASSERT_EQ(seen[i], 1);
+    }
+
+    it.reset(&it);
+    ASSERT_TRUE(it.has_next(&it));
+    it.destroy(&it);
+
+    anv_flatmap_destroy(map, false, false);
+    return TEST_SUCCESS;
+}
+
+// Test that owned keys and values are released through the allocator
+int test_flatmap_free_data(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVFlatMap* map = anv_flatmap_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(map);
+
+    for (int i = 0; i < 50; i++)
+    {
+        int* key = malloc(sizeof(int));
+        int* value = malloc(sizeof(int));
+        ASSERT_NOT_NULL(key);
+        ASSERT_NOT_NULL(value);
+        *key = i;
+        *value = i * 2;
+        ASSERT_EQ(anv_flatmap_put(map, key, value), 0);
+    }
+
+    const int probe = 7;
+    ASSERT_EQ(*(int*)anv_flatmap_get(map, &probe), 14);
+    ASSERT_EQ(anv_flatmap_remove(map, &probe, true, true), 0);
+    ASSERT_EQ(anv_flatmap_memory_usage(map),
+              sizeof(ANVFlatMap) + anv_flatmap_capacity(map) * (sizeof(ANVFlatMapSlot) + 1));
+
+    anv_flatmap_destroy(map, true, true);
+    return TEST_SUCCESS;
+}
+
+static size_t identity_hash(const void* key)
+{
+    return (size_t)*(const int*)key;
+}
+
+static size_t equals_calls = 0;
+
+static int counting_equals(const void* a, const void* b)
+{
+    equals_calls++;
+    return anv_key_equals_int(a, b);
+}
+
+// Test that sequential keys under an identity hash do not cluster: with short
+// probe sequences a hit compares about one key, a miss almost none
+int test_flatmap_identity_hash(void)
+{
+    enum { COUNT = 200000 };
+    ANVAllocator alloc = anv_alloc_default();
+    ANVFlatMap* map = anv_flatmap_create(&alloc, identity_hash, counting_equals, 0);
+    ASSERT_NOT_NULL(map);
+
+    int* keys = malloc(sizeof(int) * 2 * COUNT);
+    ASSERT_NOT_NULL(keys);
+    for (int i = 0; i < 2 * COUNT; i++)
+    {
+        keys[i] = i;
+    }
+    for (int i = 0; i < COUNT; i++)
+    {
+        ASSERT_EQ(anv_flatmap_put(map, &keys[i], &keys[i]), 0);
+    }
+
+    equals_calls = 0;
+    for (int i = 0; i < COUNT; i++)
+    {
+        ASSERT_EQ_PTR(anv_flatmap_get(map, &keys[i]), &keys[i]);
+    }
+    ASSERT(equals_calls < COUNT + COUNT / 10);
+
+    equals_calls = 0;
+    for (int i = COUNT; i < 2 * COUNT; i++)
+    {
+        ASSERT_NULL(anv_flatmap_get(map, &keys[i]));
+    }
+    ASSERT(equals_calls < COUNT / 10);
+
+    anv_flatmap_destroy(map, false, false);
+    free(keys);
+    return TEST_SUCCESS;
+}
+
+typedef struct
+{
+    int (*func)(void);
+    const char* name;
+} TestCase;
+
+int main(void)
+{
+    const TestCase tests[] = {
+        {test_flatmap_put_get, "test_flatmap_put_get"},
+        {test_flatmap_many, "test_flatmap_many"},
+        {test_flatmap_iterator, "test_flatmap_iterator"},
+        {test_flatmap_free_data, "test_flatmap_free_data"},
+        {test_flatmap_identity_hash, "test_flatmap_identity_hash"},
+    };
+
+    printf("Running FlatMap tests...\n");
+
+    int failed = 0;
+    const int num_tests = sizeof(tests) / sizeof(tests[0]);
+    for (int i = 0; i < num_tests; i++)
+    {
+        if (tests[i].func() != TEST_SUCCESS)
+        {
+            printf("%s failed\n", tests[i].name);
+            failed++;
+        }
+    }
+
+    if (failed == 0)
+    {
+        printf("All FlatMap tests passed!\n");
+        return 0;
+    }
+
+    printf("%d FlatMap tests failed.\n", failed);
+    return 1;
+}
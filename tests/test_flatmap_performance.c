@@ -0,0 +1,117 @@
+//
+// FlatMap performance test - lookup latency versus the chained HashMap
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "containers/FlatMap.h"
+#include "containers/HashMap.h"
+#include "TestAssert.h"
+#include "TestHelpers.h"
+
+#define NUM_KEYS 200000
+#define LOOKUP_ROUNDS 5
+
+// Insert and look up the same keys in both maps, including misses
+int test_flatmap_performance_lookup(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVHashMap* chained = anv_hashmap_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ANVFlatMap* flat = anv_flatmap_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(chained);
+    ASSERT_NOT_NULL(flat);
+
+    int* keys = malloc(sizeof(int) * NUM_KEYS * 2);
+    ASSERT_NOT_NULL(keys);
+    for (int i = 0; i < NUM_KEYS * 2; i++)
+    {
+        keys[i] = i * 7 + 3;
+    }
+
+    double start = now_seconds();
+    for (int i = 0; i < NUM_KEYS; i++)
+    {
+        ASSERT_EQ(anv_hashmap_put(chained, &keys[i], &keys[i]), 0);
+    }
+    const double chained_insert = now_seconds() - start;
+
+    start = now_seconds();
+    for (int i = 0; i < NUM_KEYS; i++)
+    {
+        ASSERT_EQ(anv_flatmap_put(flat, &keys[i], &keys[i]), 0);
+    }
+    const double flat_insert = now_seconds() - start;
+
+    // Half hits, half misses
+    size_t chained_hits = 0;
+    start = now_seconds();
+    for (int round = 0; round < LOOKUP_ROUNDS; round++)
+    {
+        for (int i = 0; i < NUM_KEYS * 2; i += 2)
+        {
+            chained_hits += anv_hashmap_get(chained, &keys[i / 2 + (i & 2 ? NUM_KEYS : 0)]) != NULL;
+        }
+    }
+    const double chained_lookup = now_seconds() - start;
+
+    size_t flat_hits = 0;
+    start = now_seconds();
+    for (int round = 0; round < LOOKUP_ROUNDS; round++)
+    {
+        for (int i = 0; i < NUM_KEYS * 2; i += 2)
+        {
+            flat_hits += anv_flatmap_get(flat, &keys[i / 2 + (i & 2 ? NUM_KEYS : 0)]) != NULL;
+        }
+    }
+    const double flat_lookup = now_seconds() - start;
+
+    ASSERT_EQ(flat_hits, chained_hits);
+
+    const double lookups = (double)NUM_KEYS * LOOKUP_ROUNDS;
+    printf("Insert %d keys: HashMap %.3f s, FlatMap %.3f s\n", NUM_KEYS, chained_insert, flat_insert);
+    printf("Lookups: HashMap %.1f ns/op, FlatMap %.1f ns/op\n",
+           chained_lookup / lookups * 1e9, flat_lookup / lookups * 1e9);
+    printf("Memory: HashMap %zu bytes, FlatMap %zu bytes\n",
+           anv_hashmap_memory_usage(chained), anv_flatmap_memory_usage(flat));
+
+    free(keys);
+    anv_hashmap_destroy(chained, false, false);
+    anv_flatmap_destroy(flat, false, false);
+    return TEST_SUCCESS;
+}
+
+typedef struct
+{
+    int (*func)(void);
+    const char* name;
+} TestCase;
+
+int main(void)
+{
+    const TestCase tests[] = {
+        {test_flatmap_performance_lookup, "test_flatmap_performance_lookup"},
+    };
+
+    printf("Running FlatMap performance tests...\n");
+
+    int failed = 0;
+    const int num_tests = sizeof(tests) / sizeof(tests[0]);
+    for (int i = 0; i < num_tests; i++)
+    {
+        if (tests[i].func() != TEST_SUCCESS)
+        {
+            printf("%s failed\n", tests[i].name);
+            failed++;
+        }
+    }
+
+    if (failed == 0)
+    {
+        printf("All FlatMap performance tests passed!\n");
+        return 0;
+    }
+
+    printf("%d FlatMap performance tests failed.\n", failed);
+    return 1;
+}
@@ -0,0 +1,309 @@
+//
+// FrozenMap tests
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "containers/ArrayList.h"
+#include "containers/FrozenMap.h"
+#include "containers/HashMap.h"
+#include "containers/Pair.h"
+#include "system/Threads.h"
+#include "TestAssert.h"
+#include "TestHelpers.h"
+
+#define MANY 50000
+#define NUM_THREADS 4
+
+// Constant hash, so any two different keys collide
+static size_t constant_hash(const void* key)
+{
+    (void)key;
+    return 42;
+}
+
+// Test building from a HashMap and looking every key up
+int test_frozenmap_basic(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVHashMap* source = anv_hashmap_create(&alloc, anv_hash_string, anv_key_equals_string, 0);
+    ASSERT_NOT_NULL(source);
+
+    const char* keys[] = {"alpha", "beta", "gamma", "delta", "epsilon", "zeta", "eta"};
+    int values[7];
+    for (int i = 0; i < 7; i++)
+    {
+        values[i] = i * 10;
+        ASSERT_EQ(anv_hashmap_put(source, (void*)keys[i], &values[i]), 0);
+    }
+
+    ANVIterator it = anv_hashmap_iterator(source);
+    ANVFrozenMap* map = anv_frozenmap_from_iterator(&it, &alloc, anv_hash_string, anv_key_equals_string, false);
+    it.destroy(&it);
+    ASSERT_NOT_NULL(map);
+    ASSERT_EQ(anv_frozenmap_size(map), 7);
+    ASSERT_FALSE(anv_frozenmap_is_empty(map));
+
+    for (int i = 0; i < 7; i++)
+    {
+        ASSERT_EQ_PTR(anv_frozenmap_get(map, keys[i]), &values[i]);
+        ASSERT_TRUE(anv_frozenmap_contains_key(map, keys[i]));
+    }
+    ASSERT_NULL(anv_frozenmap_get(map, "theta"));
+    ASSERT_FALSE(anv_frozenmap_contains_key(map, "iota"));
+    ASSERT_NULL(anv_frozenmap_get(map, NULL));
+    ASSERT_NULL(anv_frozenmap_get(NULL, "alpha"));
+    ASSERT(anv_frozenmap_memory_usage(map) >= sizeof(ANVFrozenMap) + 7 * sizeof(ANVFrozenMapEntry));
+
+    // One slot per key, in the order the iterator reports
+    ANVIterator entries = anv_frozenmap_iterator(map);
+    size_t count = 0;
+    while (entries.has_next(&entries))
+    {
+        const ANVPair* pair = entries.get(&entries);
+        ASSERT_EQ_PTR(pair->first, map->entries[count].key);
+        ASSERT_EQ_PTR(anv_hashmap_get(source, pair->first), pair->second);
+        count++;
+        entries.next(&entries);
+    }
+    ASSERT_EQ(count, 7);
+    ASSERT_TRUE(entries.has_prev(&entries));
+    ASSERT_EQ(entries.prev(&entries), 0);
+    ASSERT_EQ_PTR(((const ANVPair*)entries.get(&entries))->first, map->entries[6].key);
+    entries.destroy(&entries);
+
+    anv_frozenmap_destroy(map, false, false);
+    anv_hashmap_destroy(source, false, false);
+    return TEST_SUCCESS;
+}
+
+// Test that every one of many keys lands in its own slot
+int test_frozenmap_many(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVHashMap* source = anv_hashmap_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(source);
+
+    int* keys = malloc(sizeof(int) * (MANY + 100));
+    ASSERT_NOT_NULL(keys);
+    for (int i = 0; i < MANY + 100; i++)
+    {
+        keys[i] = i * 3 + 1;
+    }
+    for (int i = 0; i < MANY; i++)
+    {
+        ASSERT_EQ(anv_hashmap_put(source, &keys[i], &keys[i]), 0);
+    }
+
+    ANVIterator it = anv_hashmap_iterator(source);
+    ANVFrozenMap* map = anv_frozenmap_from_iterator(&it, &alloc, anv_hash_int, anv_key_equals_int, false);
+    it.destroy(&it);
+    ASSERT_NOT_NULL(map);
+    ASSERT_EQ(anv_frozenmap_size(map), MANY);
+
+    for (int i = 0; i < MANY; i++)
+    {
+        ASSERT_EQ_PTR(anv_frozenmap_get(map, &keys[i]), &keys[i]);
+    }
+    for (int i = MANY; i < MANY + 100; i++)
+    {
+        ASSERT_NULL(anv_frozenmap_get(map, &keys[i]));
+    }
+
+    // About one byte of seeds per key
+    const size_t overhead = anv_frozenmap_memory_usage(map) - MANY * sizeof(ANVFrozenMapEntry);
+    ASSERT_LTE(overhead, (size_t)MANY + sizeof(ANVFrozenMap) + 4);
+
+    anv_frozenmap_destroy(map, false, false);
+    anv_hashmap_destroy(source, false, false);
+    free(keys);
+    return TEST_SUCCESS;
+}
+
+// Test empty input, repeated keys and hash collisions
+int test_frozenmap_edge_cases(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVArrayList* list = anv_arraylist_create(&alloc, 0);
+    ASSERT_NOT_NULL(list);
+
+    ANVIterator it = anv_arraylist_iterator(list);
+    ANVFrozenMap* empty = anv_frozenmap_from_iterator(&it, &alloc, anv_hash_string, anv_key_equals_string, false);
+    it.destroy(&it);
+    ASSERT_NOT_NULL(empty);
+    ASSERT_TRUE(anv_frozenmap_is_empty(empty));
+    ASSERT_NULL(anv_frozenmap_get(empty, "anything"));
+    anv_frozenmap_destroy(empty, false, false);
+
+    // A repeated key keeps the last value, NULL elements are skipped
+    char k1[] = "one";
+    char k1_again[] = "one";
+    char k2[] = "two";
+    int v1 = 1;
+    int v2 = 2;
+    int v3 = 3;
+    ANVPair pairs[3];
+    ASSERT_EQ(anv_pair_init(&pairs[0], &alloc, k1, &v1), 0);
+    ASSERT_EQ(anv_pair_init(&pairs[1], &alloc, k2, &v2), 0);
+    ASSERT_EQ(anv_pair_init(&pairs[2], &alloc, k1_again, &v3), 0);
+    ASSERT_EQ(anv_arraylist_push_back(list, &pairs[0]), 0);
+    ASSERT_EQ(anv_arraylist_push_back(list, NULL), 0);
+    ASSERT_EQ(anv_arraylist_push_back(list, &pairs[1]), 0);
+    ASSERT_EQ(anv_arraylist_push_back(list, &pairs[2]), 0);
+
+    it = anv_arraylist_iterator(list);
+    ANVFrozenMap* map = anv_frozenmap_from_iterator(&it, &alloc, anv_hash_string, anv_key_equals_string, false);
+    it.destroy(&it);
+    ASSERT_NOT_NULL(map);
+    ASSERT_EQ(anv_frozenmap_size(map), 2);
+    ASSERT_EQ_PTR(anv_frozenmap_get(map, "one"), &v3);
+    ASSERT_EQ_PTR(anv_frozenmap_get(map, "two"), &v2);
+    anv_frozenmap_destroy(map, false, false);
+
+    // Different keys with one hash code cannot be separated
+    it = anv_arraylist_iterator(list);
+    ASSERT_NULL(anv_frozenmap_from_iterator(&it, &alloc, constant_hash, anv_key_equals_string, false));
+    it.destroy(&it);
+
+    it = anv_arraylist_iterator(list);
+    ASSERT_NULL(anv_frozenmap_from_iterator(&it, &alloc, NULL, anv_key_equals_string, false));
+    ASSERT_NULL(anv_frozenmap_from_iterator(NULL, &alloc, anv_hash_string, anv_key_equals_string, false));
+    it.destroy(&it);
+
+    anv_arraylist_destroy(list, false);
+    return TEST_SUCCESS;
+}
+
+// Test that copies are owned by the map, including when repeats are merged
+int test_frozenmap_copy(void)
+{
+    ANVAllocator alloc = create_string_allocator();
+    alloc.copy = anv_pair_copy_string_string;
+    ANVArrayList* list = anv_arraylist_create(&alloc, 0);
+    ASSERT_NOT_NULL(list);
+
+    char* keys[] = {"red", "green", "blue", "green"};
+    char* values[] = {"#f00", "#0f0", "#00f", "#0f1"};
+    ANVPair pairs[4];
+    for (int i = 0; i < 4; i++)
+    {
+        ASSERT_EQ(anv_pair_init(&pairs[i], &alloc, keys[i], values[i]), 0);
+        ASSERT_EQ(anv_arraylist_push_back(list, &pairs[i]), 0);
+    }
+
+    ANVIterator it = anv_arraylist_iterator(list);
+    ANVFrozenMap* map = anv_frozenmap_from_iterator(&it, &alloc, anv_hash_string, anv_key_equals_string, true);
+    it.destroy(&it);
+    ASSERT_NOT_NULL(map);
+    ASSERT_EQ(anv_frozenmap_size(map), 3);
+    ASSERT_EQ(strcmp(anv_frozenmap_get(map, "green"), "#0f1"), 0);
+    ASSERT_TRUE(anv_frozenmap_get(map, "red") != values[0]);
+    anv_frozenmap_destroy(map, true, true);
+
+    // A failed build releases its copies
+    it = anv_arraylist_iterator(list);
+    ASSERT_NULL(anv_frozenmap_from_iterator(&it, &alloc, constant_hash, anv_key_equals_string, true));
+    it.destroy(&it);
+
+    anv_arraylist_destroy(list, false);
+    return TEST_SUCCESS;
+}
+
+typedef struct
+{
+    const ANVFrozenMap* map;
+    int* keys;
+    size_t misses;
+} ReaderArg;
+
+static void* reader(void* arg)
+{
+    ReaderArg* r = arg;
+    for (int round = 0; round < 4; round++)
+    {
+        for (int i = 0; i < MANY; i++)
+        {
+            r->misses += anv_frozenmap_get(r->map, &r->keys[i]) != &r->keys[i];
+        }
+    }
+    return NULL;
+}
+
+// Test concurrent readers without any locking
+int test_frozenmap_concurrent_readers(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVHashMap* source = anv_hashmap_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(source);
+    int* keys = malloc(sizeof(int) * MANY);
+    ASSERT_NOT_NULL(keys);
+    for (int i = 0; i < MANY; i++)
+    {
+        keys[i] = i;
+        ASSERT_EQ(anv_hashmap_put(source, &keys[i], &keys[i]), 0);
+    }
+
+    ANVIterator it = anv_hashmap_iterator(source);
+    ANVFrozenMap* map = anv_frozenmap_from_iterator(&it, &alloc, anv_hash_int, anv_key_equals_int, false);
+    it.destroy(&it);
+    ASSERT_NOT_NULL(map);
+
+    ANVThread threads[NUM_THREADS];
+    ReaderArg args[NUM_THREADS];
+    for (int t = 0; t < NUM_THREADS; t++)
+    {
+        args[t] = (ReaderArg) {map, keys, 0};
+        ASSERT_EQ(anv_thread_create(&threads[t], reader, &args[t]), 0);
+    }
+    for (int t = 0; t < NUM_THREADS; t++)
+    {
+        ASSERT_EQ(anv_thread_join(threads[t], NULL), 0);
+        ASSERT_EQ(args[t].misses, 0);
+    }
+
+    anv_frozenmap_destroy(map, false, false);
+    anv_hashmap_destroy(source, false, false);
+    free(keys);
+    return TEST_SUCCESS;
+}
+
+typedef struct
+{
+    int (*func)(void);
+    const char* name;
+} TestCase;
+
+int main(void)
+{
+    const TestCase tests[] = {
+        {test_frozenmap_basic, "test_frozenmap_basic"},
+        {test_frozenmap_many, "test_frozenmap_many"},
+        {test_frozenmap_edge_cases, "test_frozenmap_edge_cases"},
+        {test_frozenmap_copy, "test_frozenmap_copy"},
+        {test_frozenmap_concurrent_readers, "test_frozenmap_concurrent_readers"},
+    };
+
+    printf("Running FrozenMap tests...\n");
+
+    int failed = 0;
+    const int num_tests = sizeof(tests) / sizeof(tests[0]);
+    for (int i = 0; i < num_tests; i++)
+    {
+        if (tests[i].func() != TEST_SUCCESS)
+        {
+            printf("%s failed\n", tests[i].name);
+            failed++;
+        }
+    }
+
+    if (failed == 0)
+    {
+        printf("All FrozenMap tests passed!\n");
+        return 0;
+    }
+
+    printf("%d FrozenMap tests failed.\n", failed);
+    return 1;
+}
@@ -0,0 +1,115 @@
+//
+// FrozenMap performance test - build time, memory and lookups versus the
+// HashMap it was built from
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "containers/FrozenMap.h"
+#include "containers/HashMap.h"
+#include "TestAssert.h"
+#include "TestHelpers.h"
+
+#define NUM_KEYS 500000
+#define ROUNDS 10
+
+int test_frozenmap_performance_versus_hashmap(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVHashMap* source = anv_hashmap_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(source);
+
+    // Even keys are stored, odd keys are misses
+    int* keys = malloc(sizeof(int) * NUM_KEYS * 2);
+    ASSERT_NOT_NULL(keys);
+    for (int i = 0; i < NUM_KEYS * 2; i++)
+    {
+        keys[i] = i;
+    }
+    for (int i = 0; i < NUM_KEYS; i++)
+    {
+        ASSERT_EQ(anv_hashmap_put(source, &keys[i * 2], &keys[i * 2]), 0);
+    }
+
+    double start = now_seconds();
+    ANVIterator it = anv_hashmap_iterator(source);
+    ANVFrozenMap* frozen = anv_frozenmap_from_iterator(&it, &alloc, anv_hash_int, anv_key_equals_int, false);
+    it.destroy(&it);
+    const double build = now_seconds() - start;
+    ASSERT_NOT_NULL(frozen);
+
+    size_t map_hits = 0;
+    start = now_seconds();
+    for (int round = 0; round < ROUNDS; round++)
+    {
+        for (int i = 0; i < NUM_KEYS * 2; i++)
+        {
+            map_hits += anv_hashmap_get(source, &keys[(int)(((long long)i * 7919) % (NUM_KEYS * 2))]) != NULL;
+        }
+    }
+    const double map_lookup = now_seconds() - start;
+
+    size_t frozen_hits = 0;
+    start = now_seconds();
+    for (int round = 0; round < ROUNDS; round++)
+    {
+        for (int i = 0; i < NUM_KEYS * 2; i++)
+        {
+            frozen_hits += anv_frozenmap_get(frozen, &keys[(int)(((long long)i * 7919) % (NUM_KEYS * 2))]) != NULL;
+        }
+    }
+    const double frozen_lookup = now_seconds() - start;
+    ASSERT_EQ(frozen_hits, map_hits);
+    ASSERT_EQ(frozen_hits, (size_t)NUM_KEYS * ROUNDS);
+
+    const size_t map_bytes = anv_hashmap_memory_usage(source);
+    const size_t frozen_bytes = anv_frozenmap_memory_usage(frozen);
+    const double ops = (double)NUM_KEYS * 2 * ROUNDS;
+    printf("Build from %d-entry HashMap: %.3f s (%.1f ns/key)\n", NUM_KEYS, build, build / NUM_KEYS * 1e9);
+    printf("Lookups, half misses: HashMap %.1f ns/op, FrozenMap %.1f ns/op\n",
+           map_lookup / ops * 1e9, frozen_lookup / ops * 1e9);
+    printf("Memory: HashMap %zu bytes, FrozenMap %zu bytes (%.2f bytes/key beyond entries)\n", map_bytes,
+           frozen_bytes, (double)(frozen_bytes - NUM_KEYS * sizeof(ANVFrozenMapEntry)) / NUM_KEYS);
+    ASSERT(frozen_bytes < map_bytes);
+
+    anv_frozenmap_destroy(frozen, false, false);
+    anv_hashmap_destroy(source, false, false);
+    free(keys);
+    return TEST_SUCCESS;
+}
+
+typedef struct
+{
+    int (*func)(void);
+    const char* name;
+} TestCase;
+
+int main(void)
+{
+    const TestCase tests[] = {
+        {test_frozenmap_performance_versus_hashmap, "test_frozenmap_performance_versus_hashmap"},
+    };
+
+    printf("Running FrozenMap performance tests...\n");
+
+    int failed = 0;
+    const int num_tests = sizeof(tests) / sizeof(tests[0]);
+    for (int i = 0; i < num_tests; i++)
+    {
+        if (tests[i].func() != TEST_SUCCESS)
+        {
+            printf("%s failed\n", tests[i].name);
+            failed++;
+        }
+    }
+
+    if (failed == 0)
+    {
+        printf("All FrozenMap performance tests passed!\n");
+        return 0;
+    }
+
+    printf("%d FrozenMap performance tests failed.\n", failed);
+    return 1;
+}
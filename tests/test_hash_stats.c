@@ -0,0 +1,384 @@
+//
+// Hash table stats test - anv_hashmap_stats and anv_hashset_stats
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "containers/HashMap.h"
+#include "containers/HashSet.h"
+#include "TestAssert.h"
+#include "TestHelpers.h"
+
+#define NUM_KEYS 1000
+#define HISTOGRAM_LEN 8
+
+static size_t constant_hash(const void* key)
+{
+    (void)key;
+    return 42;
+}
+
+static size_t identity_hash(const void* key)
+{
+    return (size_t)*(const int*)key;
+}
+
+static size_t sum(const size_t* histogram, const size_t len)
+{
+    size_t total = 0;
+    for (size_t i = 0; i < len; i++)
+    {
+        total += histogram[i];
+    }
+    return total;
+}
+
+// Test argument checks and an empty map
+int test_hashmap_stats_empty(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVHashMap* map = anv_hashmap_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(map);
+
+    ANVHashMapStats stats;
+    ASSERT_EQ(anv_hashmap_stats(NULL, &stats, NULL, 0), -1);
+    ASSERT_EQ(anv_hashmap_stats(map, NULL, NULL, 0), -1);
+
+    size_t histogram[HISTOGRAM_LEN] = {1, 2, 3};
+    ASSERT_EQ(anv_hashmap_stats(map, &stats, histogram, HISTOGRAM_LEN), 0);
+    ASSERT_EQ(stats.size, 0);
+    ASSERT_EQ(stats.used_buckets, 0);
+    ASSERT_EQ(stats.max_chain_length, 0);
+    ASSERT_EQ(stats.mean_chain_length, 0.0);
+    ASSERT_EQ(stats.resize_count, 0);
+    ASSERT_EQ(histogram[0], stats.bucket_count);
+    ASSERT_EQ(sum(histogram, HISTOGRAM_LEN), stats.bucket_count);
+
+    anv_hashmap_destroy(map, false, false);
+    return TEST_SUCCESS;
+}
+
+// Test the figures of a well-hashed map that has grown several times
+int test_hashmap_stats_growth(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVHashMap* map = anv_hashmap_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(map);
+
+    int* keys = malloc(sizeof(int) * NUM_KEYS);
+    ASSERT_NOT_NULL(keys);
+    for (int i = 0; i < NUM_KEYS; i++)
+    {
+        keys[i] = i;
+        ASSERT_EQ(anv_hashmap_put(map, &keys[i], &keys[i]), 0);
+    }
+
+    ANVHashMapStats stats;
+    size_t histogram[HISTOGRAM_LEN];
+    ASSERT_EQ(anv_hashmap_stats(map, &stats, histogram, HISTOGRAM_LEN), 0);
+    ASSERT_EQ(stats.size, NUM_KEYS);
+    ASSERT_EQ(stats.bucket_count, map->bucket_count);
+    ASSERT_EQ(stats.load_factor, anv_hashmap_load_factor(map));
+    ASSERT(stats.resize_count > 0);
+    ASSERT(stats.rehash_seconds >= 0.0);
+    ASSERT(stats.max_chain_length < HISTOGRAM_LEN);
+    ASSERT(stats.mean_chain_length >= 1.0);
+    ASSERT(stats.mean_chain_length < 2.0);
+
+    // Every bucket lands in one bin, and the bins add back up to the size
+    size_t nodes = 0;
+    for (size_t i = 0; i < HISTOGRAM_LEN; i++)
+    {
+        nodes += i * histogram[i];
+    }
+    ASSERT_EQ(sum(histogram, HISTOGRAM_LEN), stats.bucket_count);
+    ASSERT_EQ(nodes, NUM_KEYS);
+    ASSERT_EQ(stats.bucket_count - histogram[0], stats.used_buckets);
+
+    // A copy starts with no resize history
+    ANVHashMap* copy = anv_hashmap_copy(map);
+    ASSERT_NOT_NULL(copy);
+    ANVHashMapStats copy_stats;
+    ASSERT_EQ(anv_hashmap_stats(copy, &copy_stats, NULL, 0), 0);
+    ASSERT_EQ(copy_stats.size, NUM_KEYS);
+    ASSERT(copy_stats.resize_count <= stats.resize_count);
+
+    anv_hashmap_destroy(copy, false, false);
+    anv_hashmap_destroy(map, false, false);
+    free(keys);
+    return TEST_SUCCESS;
+}
+
+// Test that a degenerate hash function shows up as one long chain
+int test_hashmap_stats_bad_hash(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVHashMap* map = anv_hashmap_create(&alloc, constant_hash, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(map);
+
+    int keys[100];
+    for (int i = 0; i < 100; i++)
+    {
+        keys[i] = i;
+        ASSERT_EQ(anv_hashmap_put(map, &keys[i], &keys[i]), 0);
+    }
+
+    ANVHashMapStats stats;
+    size_t histogram[HISTOGRAM_LEN];
+    ASSERT_EQ(anv_hashmap_stats(map, &stats, histogram, HISTOGRAM_LEN), 0);
+    ASSERT_EQ(stats.used_buckets, 1);
+    ASSERT_EQ(stats.max_chain_length, 100);
+    ASSERT_EQ(stats.mean_chain_length, 100.0);
+
+    // The long chain is clamped into the last bin
+    ASSERT_EQ(histogram[HISTOGRAM_LEN - 1], 1);
+    ASSERT_EQ(histogram[0], stats.bucket_count - 1);
+
+    anv_hashmap_destroy(map, false, false);
+    return TEST_SUCCESS;
+}
+
+// Test that stats cover both bucket arrays while an incremental resize is in progress
+int test_hashmap_stats_incremental(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVHashMap* map = anv_hashmap_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(map);
+    ASSERT_EQ(anv_hashmap_set_incremental_resize(map, 1), 0);
+
+    int* keys = malloc(sizeof(int) * NUM_KEYS);
+    ASSERT_NOT_NULL(keys);
+    bool saw_rehashing = false;
+    for (int i = 0; i < NUM_KEYS; i++)
+    {
+        keys[i] = i;
+        ASSERT_EQ(anv_hashmap_put(map, &keys[i], &keys[i]), 0);
+        if (!anv_hashmap_is_rehashing(map))
+        {
+            continue;
+        }
+
+        saw_rehashing = true;
+        ANVHashMapStats stats;
+        size_t histogram[HISTOGRAM_LEN];
+        ASSERT_EQ(anv_hashmap_stats(map, &stats, histogram, HISTOGRAM_LEN), 0);
+        ASSERT_EQ(stats.size, (size_t)i + 1);
+        ASSERT_EQ(stats.bucket_count, map->bucket_count + map->old_bucket_count);
+        ASSERT_EQ(stats.load_factor, (double)stats.size / (double)stats.bucket_count);
+        ASSERT_EQ(sum(histogram, HISTOGRAM_LEN), stats.bucket_count);
+    }
+    ASSERT_TRUE(saw_rehashing);
+
+    anv_hashmap_destroy(map, false, false);
+    free(keys);
+    return TEST_SUCCESS;
+}
+
+// Test that an incremental resize is charged only for its migration steps,
+// not for the time the caller spends elsewhere between them
+int test_hashmap_stats_incremental_timing(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVHashMap* map = anv_hashmap_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(map);
+    ASSERT_EQ(anv_hashmap_set_incremental_resize(map, 1), 0);
+
+    int* keys = malloc(sizeof(int) * NUM_KEYS);
+    ASSERT_NOT_NULL(keys);
+    int i = 0;
+    while (!anv_hashmap_is_rehashing(map))
+    {
+        keys[i] = i;
+        ASSERT_EQ(anv_hashmap_put(map, &keys[i], &keys[i]), 0);
+        i++;
+    }
+
+    // Stay away 5 ms before every migrating put, 50 ms in total
+    double idle = 0.0;
+    for (int steps = 0; steps < 10 && anv_hashmap_is_rehashing(map); steps++)
+    {
+        const double start = now_seconds();
+        while (now_seconds() - start < 0.005)
+        {
+        }
+        idle += now_seconds() - start;
+
+        keys[i] = i;
+        ASSERT_EQ(anv_hashmap_put(map, &keys[i], &keys[i]), 0);
+        i++;
+    }
+    ASSERT_EQ(anv_hashmap_rehash_step(map, SIZE_MAX), 0);
+    ASSERT_FALSE(anv_hashmap_is_rehashing(map));
+
+    ANVHashMapStats stats;
+    ASSERT_EQ(anv_hashmap_stats(map, &stats, NULL, 0), 0);
+    ASSERT(stats.resize_count > 0);
+    ASSERT(idle >= 0.05);
+    ASSERT(stats.rehash_seconds < 0.01);
+
+    anv_hashmap_destroy(map, false, false);
+    free(keys);
+    return TEST_SUCCESS;
+}
+
+// Test argument checks and the figures of a grown set
+int test_hashset_stats_growth(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVHashSet* set = anv_hashset_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(set);
+
+    ANVHashSetStats stats;
+    ASSERT_EQ(anv_hashset_stats(NULL, &stats, NULL, 0), -1);
+    ASSERT_EQ(anv_hashset_stats(set, NULL, NULL, 0), -1);
+    ASSERT_EQ(anv_hashset_stats(set, &stats, NULL, 0), 0);
+    ASSERT_EQ(stats.size, 0);
+    ASSERT_EQ(stats.resize_count, 0);
+
+    int* keys = malloc(sizeof(int) * NUM_KEYS);
+    ASSERT_NOT_NULL(keys);
+    for (int i = 0; i < NUM_KEYS; i++)
+    {
+        keys[i] = i;
+        ASSERT_EQ(anv_hashset_add(set, &keys[i]), 0);
+    }
+
+    size_t histogram[HISTOGRAM_LEN];
+    ASSERT_EQ(anv_hashset_stats(set, &stats, histogram, HISTOGRAM_LEN), 0);
+    ASSERT_EQ(stats.size, NUM_KEYS);
+    ASSERT_EQ(stats.capacity, set->capacity);
+    ASSERT_EQ(stats.load_factor, anv_hashset_load_factor(set));
+    ASSERT_EQ(stats.tombstones, 0);
+    ASSERT(stats.resize_count > 0);
+    ASSERT(stats.rehash_seconds >= 0.0);
+    ASSERT(stats.mean_probe_length < 1.0);
+    ASSERT_EQ(sum(histogram, HISTOGRAM_LEN), NUM_KEYS);
+    ASSERT(histogram[0] > NUM_KEYS / 2);
+
+    // Removals from full groups leave tombstones
+    for (int i = 0; i < NUM_KEYS; i += 2)
+    {
+        ASSERT_EQ(anv_hashset_remove(set, &keys[i], false), 0);
+    }
+    ASSERT_EQ(anv_hashset_stats(set, &stats, histogram, HISTOGRAM_LEN), 0);
+    ASSERT_EQ(stats.size, NUM_KEYS / 2);
+    ASSERT_EQ(sum(histogram, HISTOGRAM_LEN), NUM_KEYS / 2);
+
+    // A copy starts with no resize history, and shrinking counts as a rebuild
+    ANVHashSet* copy = anv_hashset_copy(set);
+    ASSERT_NOT_NULL(copy);
+    ANVHashSetStats copy_stats;
+    ASSERT_EQ(anv_hashset_stats(copy, &copy_stats, NULL, 0), 0);
+    ASSERT_EQ(copy_stats.resize_count, 0);
+    ASSERT_EQ(copy_stats.tombstones, stats.tombstones);
+    ASSERT_EQ(anv_hashset_shrink_to_fit(copy), 0);
+    ASSERT_EQ(anv_hashset_stats(copy, &copy_stats, NULL, 0), 0);
+    ASSERT_EQ(copy_stats.resize_count, 1);
+    ASSERT_EQ(copy_stats.tombstones, 0);
+
+    anv_hashset_destroy(copy, false);
+    anv_hashset_destroy(set, false);
+    free(keys);
+    return TEST_SUCCESS;
+}
+
+// Test that a degenerate hash function shows up as long probe sequences
+int test_hashset_stats_bad_hash(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVHashSet* set = anv_hashset_create(&alloc, constant_hash, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(set);
+
+    int keys[100];
+    for (int i = 0; i < 100; i++)
+    {
+        keys[i] = i;
+        ASSERT_EQ(anv_hashset_add(set, &keys[i]), 0);
+    }
+
+    ANVHashSetStats stats;
+    size_t histogram[HISTOGRAM_LEN];
+    ASSERT_EQ(anv_hashset_stats(set, &stats, histogram, HISTOGRAM_LEN), 0);
+    ASSERT_EQ(stats.size, 100);
+    ASSERT(stats.max_probe_length >= 100 / 16);
+    ASSERT(stats.mean_probe_length > 1.0);
+    ASSERT(histogram[0] <= 16);
+    ASSERT_EQ(sum(histogram, HISTOGRAM_LEN), 100);
+
+    anv_hashset_destroy(set, false);
+    return TEST_SUCCESS;
+}
+
+// Test that sequential keys under an identity hash do not cluster
+int test_hashset_stats_identity_hash(void)
+{
+    enum { COUNT = 200000 };
+    ANVAllocator alloc = anv_alloc_default();
+    ANVHashSet* set = anv_hashset_create(&alloc, identity_hash, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(set);
+
+    int* keys = malloc(sizeof(int) * COUNT);
+    ASSERT_NOT_NULL(keys);
+    for (int i = 0; i < COUNT; i++)
+    {
+        keys[i] = i;
+        ASSERT_EQ(anv_hashset_add(set, &keys[i]), 0);
+    }
+
+    ANVHashSetStats stats;
+    ASSERT_EQ(anv_hashset_stats(set, &stats, NULL, 0), 0);
+    ASSERT_EQ(stats.size, COUNT);
+    ASSERT(stats.mean_probe_length < 0.5);
+    ASSERT(stats.max_probe_length < 16);
+    for (int i = 0; i < COUNT; i++)
+    {
+        ASSERT_TRUE(anv_hashset_contains(set, &keys[i]));
+    }
+
+    anv_hashset_destroy(set, false);
+    free(keys);
+    return TEST_SUCCESS;
+}
+
+typedef struct
+{
+    int (*func)(void);
+    const char* name;
+} TestCase;
+
+int main(void)
+{
+    const TestCase tests[] = {
+        {test_hashmap_stats_empty, "test_hashmap_stats_empty"},
+        {test_hashmap_stats_growth, "test_hashmap_stats_growth"},
+        {test_hashmap_stats_bad_hash, "test_hashmap_stats_bad_hash"},
+        {test_hashmap_stats_incremental, "test_hashmap_stats_incremental"},
+        {test_hashmap_stats_incremental_timing, "test_hashmap_stats_incremental_timing"},
+        {test_hashset_stats_growth, "test_hashset_stats_growth"},
+        {test_hashset_stats_bad_hash, "test_hashset_stats_bad_hash"},
+        {test_hashset_stats_identity_hash, "test_hashset_stats_identity_hash"},
+    };
+
+    printf("Running hash table stats tests...\n");
+
+    int failed = 0;
+    const int num_tests = sizeof(tests) / sizeof(tests[0]);
+    for (int i = 0; i < num_tests; i++)
+    {
+        if (tests[i].func() != TEST_SUCCESS)
+        {
+            printf("%s failed\n", tests[i].name);
+            failed++;
+        }
+    }
+
+    if (failed == 0)
+    {
+        printf("All hash table stats tests passed!\n");
+        return 0;
+    }
+
+    printf("%d hash table stats tests failed.\n", failed);
+    return 1;
+}
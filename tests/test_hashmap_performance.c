@@ -242,6 +242,415 @@ int test_hashmap_performance_resize(void)
     return TEST_SUCCESS;
 }
 
+/**
+ * Insert count int keys and return the slowest single put in seconds.
+ */
+static double worst_put_latency(ANVHashMap* map, int* keys, const int count)
+{
+    double worst = 0.0;
+    for (int i = 0; i < count; i++)
+    {
+        const double start = now_seconds();
+        if (anv_hashmap_put(map, &keys[i], &keys[i]) != 0)
+        {
+            return -1.0;
+        }
+        const double elapsed = now_seconds() - start;
+        if (elapsed > worst)
+        {
+            worst = elapsed;
+        }
+    }
+    return worst;
+}
+
+// Compare worst-case put latency of synchronous and incremental resizing
+int test_hashmap_performance_incremental_resize(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    const int num_items = 1000000;
+    int* keys = malloc(sizeof(int) * num_items);
+    ASSERT_NOT_NULL(keys);
+    for (int i = 0; i < num_items; i++)
+    {
+        keys[i] = i;
+    }
+
+    ANVHashMap* sync_map = anv_hashmap_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(sync_map);
+    const double sync_worst = worst_put_latency(sync_map, keys, num_items);
+    ASSERT_GTE(sync_worst, 0.0);
+
+    ANVHashMap* inc_map = anv_hashmap_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(inc_map);
+    ASSERT_EQ(anv_hashmap_set_incremental_resize(inc_map, 64), 0);
+    const double inc_worst = worst_put_latency(inc_map, keys, num_items);
+    ASSERT_GTE(inc_worst, 0.0);
+    ASSERT_EQ(anv_hashmap_size(inc_map), (size_t)num_items);
+
+    printf("Worst put latency over %d inserts: synchronous %.3f ms, incremental %.3f ms\n",
+           num_items, sync_worst * 1e3, inc_worst * 1e3);
+
+    anv_hashmap_destroy(sync_map, false, false);
+    anv_hashmap_destroy(inc_map, false, false);
+    free(keys);
+    return TEST_SUCCESS;
+}
+
+/**
+ * Look up every key rounds times and return nanoseconds per lookup.
+ */
+static double lookup_ns(const ANVHashMap* map, void** keys, const int count, const int rounds)
+{
+    size_t hits = 0;
+    const double start = now_seconds();
+    for (int round = 0; round < rounds; round++)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            hits += anv_hashmap_get(map, keys[i]) != NULL;
+        }
+    }
+    const double elapsed = now_seconds() - start;
+    return hits == (size_t)count * rounds ? elapsed / ((double)count * rounds) * 1e9 : -1.0;
+}
+
+/**
+ * Build a map over keys with modulo or power-of-two indexing.
+ */
+static ANVHashMap* build_map(ANVAllocator* alloc, hash_func hash, key_equals_func equals,
+                             void** keys, const int count, const bool power_of_two)
+{
+    ANVHashMap* map = anv_hashmap_create(alloc, hash, equals, 0);
+    if (!map || anv_hashmap_set_power_of_two(map, power_of_two) != 0)
+    {
+        anv_hashmap_destroy(map, false, false);
+        return NULL;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        if (anv_hashmap_put(map, keys[i], keys[i]) != 0)
+        {
+            anv_hashmap_destroy(map, false, false);
+            return NULL;
+        }
+    }
+    return map;
+}
+
+// Compare lookup throughput of modulo and power-of-two indexing on int and pointer keys
+int test_hashmap_performance_power_of_two(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    const int num_items = 200000;
+    const int sizes[] = {4096, num_items}; // Cache resident, then memory bound
+
+    int* ints = malloc(sizeof(int) * num_items);
+    void** int_keys = malloc(sizeof(void*) * num_items);
+    void** ptr_keys = malloc(sizeof(void*) * num_items);
+    char* block = malloc((size_t)num_items * 64);
+    ASSERT_NOT_NULL(ints);
+    ASSERT_NOT_NULL(int_keys);
+    ASSERT_NOT_NULL(ptr_keys);
+    ASSERT_NOT_NULL(block);
+    for (int i = 0; i < num_items; i++)
+    {
+        ints[i] = i * 4096; // Strided keys share their low bits
+        int_keys[i] = &ints[i];
+        ptr_keys[i] = block + (size_t)i * 64; // Object-sized pointer stride
+    }
+
+    const struct
+    {
+        const char* name;
+        hash_func hash;
+        key_equals_func equals;
+        void** keys;
+    } cases[] = {
+        {"int", anv_hash_int, anv_key_equals_int, int_keys},
+        {"pointer", anv_hash_pointer, anv_key_equals_pointer, ptr_keys},
+    };
+
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++)
+    {
+        for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+        {
+            const int count = sizes[s];
+            const int rounds = num_items * 5 / count;
+            ANVHashMap* modulo = build_map(&alloc, cases[c].hash, cases[c].equals, cases[c].keys, count, false);
+            ANVHashMap* pow2 = build_map(&alloc, cases[c].hash, cases[c].equals, cases[c].keys, count, true);
+            ASSERT_NOT_NULL(modulo);
+            ASSERT_NOT_NULL(pow2);
+
+            const double modulo_ns = lookup_ns(modulo, cases[c].keys, count, rounds);
+            const double pow2_ns = lookup_ns(pow2, cases[c].keys, count, rounds);
+            ASSERT_GTE(modulo_ns, 0.0);
+            ASSERT_GTE(pow2_ns, 0.0);
+
+            printf("Lookup %s keys (%d): modulo %.1f ns/op, power-of-two %.1f ns/op\n",
+                   cases[c].name, count, modulo_ns, pow2_ns);
+
+            anv_hashmap_destroy(modulo, false, false);
+            anv_hashmap_destroy(pow2, false, false);
+        }
+    }
+
+    free(block);
+    free(ptr_keys);
+    free(int_keys);
+    free(ints);
+    return TEST_SUCCESS;
+}
+
+/**
+ * The previous anv_hash_string (djb2), kept as the baseline.
+ */
+static size_t djb2_hash(const void* key)
+{
+    const unsigned char* str = key;
+    size_t hash = 5381;
+    int c;
+    while ((c = *str++))
+    {
+        hash = ((hash << 5) + hash) + c;
+    }
+    return hash;
+}
+
+/**
+ * Chi-square of hash % buckets over keys, relative to the bucket count;
+ * close to 1.0 for a uniform hash.
+ */
+static double distribution_score(hash_func hash, char** keys, const int count, const size_t buckets)
+{
+    size_t* counts = calloc(buckets, sizeof(size_t));
+    if (!counts)
+    {
+        return -1.0;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        counts[hash(keys[i]) % buckets]++;
+    }
+    const double expected = (double)count / (double)buckets;
+    double chi = 0.0;
+    for (size_t i = 0; i < buckets; i++)
+    {
+        const double diff = (double)counts[i] - expected;
+        chi += diff * diff / expected;
+    }
+    free(counts);
+    return chi / (double)buckets;
+}
+
+// Compare string hash throughput and bucket distribution with djb2
+int test_hashmap_performance_string_hash(void)
+{
+    // Throughput in bytes per second for short and long keys, cycling over a
+    // few prebuilt keys so the loop cannot be hoisted
+    const size_t lengths[] = {8, 32, 256, 4096};
+    enum { KEY_VARIANTS = 16 };
+    char* texts[KEY_VARIANTS];
+    for (int k = 0; k < KEY_VARIANTS; k++)
+    {
+        texts[k] = malloc(4097);
+        ASSERT_NOT_NULL(texts[k]);
+        for (int i = 0; i < 4096; i++)
+        {
+            texts[k][i] = (char)('a' + (i * 7 + k) % 26);
+        }
+    }
+
+    for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++)
+    {
+        const size_t length = lengths[l];
+        const int iterations = (int)(64 * 1024 * 1024 / length);
+        for (int k = 0; k < KEY_VARIANTS; k++)
+        {
+            texts[k][length] = '\0';
+        }
+
+        volatile size_t sink = 0;
+        double start = now_seconds();
+        for (int i = 0; i < iterations; i++)
+        {
+            sink += djb2_hash(texts[i % KEY_VARIANTS]);
+        }
+        const double djb2_time = now_seconds() - start;
+
+        start = now_seconds();
+        for (int i = 0; i < iterations; i++)
+        {
+            sink += anv_hash_string(texts[i % KEY_VARIANTS]);
+        }
+        const double seeded_time = now_seconds() - start;
+        (void)sink;
+
+        const double bytes = (double)length * iterations;
+        printf("Hash %4zu-byte keys: djb2 %.2f GB/s, seeded %.2f GB/s\n",
+               length, bytes / djb2_time / 1e9, bytes / seeded_time / 1e9);
+        for (int k = 0; k < KEY_VARIANTS; k++)
+        {
+            texts[k][length] = 'a';
+        }
+    }
+    for (int k = 0; k < KEY_VARIANTS; k++)
+    {
+        free(texts[k]);
+    }
+
+    // Distribution over sequential keys and over a djb2 multi-collision set:
+    // "Ez" and "FY" hash equally under djb2, so every concatenation of 12
+    // such pairs collides
+    const int num_keys = 4096;
+    char** sequential = malloc(sizeof(char*) * num_keys);
+    char** crafted = malloc(sizeof(char*) * num_keys);
+    ASSERT_NOT_NULL(sequential);
+    ASSERT_NOT_NULL(crafted);
+    for (int i = 0; i < num_keys; i++)
+    {
+        sequential[i] = malloc(16);
+        crafted[i] = malloc(25);
+        ASSERT_NOT_NULL(sequential[i]);
+        ASSERT_NOT_NULL(crafted[i]);
+        snprintf(sequential[i], 16, "key%d", i);
+        for (int bit = 0; bit < 12; bit++)
+        {
+            memcpy(crafted[i] + bit * 2, (i >> bit) & 1 ? "FY" : "Ez", 2);
+        }
+        crafted[i][24] = '\0';
+    }
+    ASSERT_EQ(djb2_hash(crafted[0]), djb2_hash(crafted[num_keys - 1]));
+
+    const size_t buckets = 1024;
+    const double seq_djb2 = distribution_score(djb2_hash, sequential, num_keys, buckets);
+    const double seq_seeded = distribution_score(anv_hash_string, sequential, num_keys, buckets);
+    const double crafted_djb2 = distribution_score(djb2_hash, crafted, num_keys, buckets);
+    const double crafted_seeded = distribution_score(anv_hash_string, crafted, num_keys, buckets);
+    ASSERT_LT(crafted_seeded, 2.0);
+    printf("Chi-square/bucket (1.0 is uniform), sequential keys: djb2 %.2f, seeded %.2f\n", seq_djb2, seq_seeded);
+    printf("Chi-square/bucket, djb2 collision set: djb2 %.2f, seeded %.2f\n", crafted_djb2, crafted_seeded);
+
+    // Lookup cost in a map built from the collision set
+    ANVAllocator alloc = anv_alloc_default();
+    ANVHashMap* maps[2] = {
+        anv_hashmap_create(&alloc, djb2_hash, anv_key_equals_string, 0),
+        anv_hashmap_create(&alloc, anv_hash_string, anv_key_equals_string, 0),
+    };
+    double lookup_time[2];
+    for (int m = 0; m < 2; m++)
+    {
+        ASSERT_NOT_NULL(maps[m]);
+        for (int i = 0; i < num_keys; i++)
+        {
+            ASSERT_EQ(anv_hashmap_put(maps[m], crafted[i], crafted[i]), 0);
+        }
+        const double start = now_seconds();
+        for (int i = 0; i < num_keys; i++)
+        {
+            ASSERT_EQ_PTR(anv_hashmap_get(maps[m], crafted[i]), crafted[i]);
+        }
+        lookup_time[m] = now_seconds() - start;
+    }
+    printf("Lookup %d colliding keys: djb2 %.1f us/op, seeded %.3f us/op\n",
+           num_keys, lookup_time[0] / num_keys * 1e6, lookup_time[1] / num_keys * 1e6);
+
+    for (int i = 0; i < num_keys; i++)
+    {
+        free(sequential[i]);
+        free(crafted[i]);
+    }
+    free(sequential);
+    free(crafted);
+    anv_hashmap_destroy(maps[0], false, false);
+    anv_hashmap_destroy(maps[1], false, false);
+    return TEST_SUCCESS;
+}
+
+// Compare one-at-a-time and batched lookups and inserts on a table far
+// larger than the last-level cache
+int test_hashmap_performance_batched(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    const int num_items = 4 * 1024 * 1024;
+    int* keys = malloc(sizeof(int) * num_items);
+    void** key_ptrs = malloc(sizeof(void*) * num_items);
+    const void** probes = malloc(sizeof(void*) * num_items);
+    void** results = malloc(sizeof(void*) * num_items);
+    ASSERT_NOT_NULL(keys);
+    ASSERT_NOT_NULL(key_ptrs);
+    ASSERT_NOT_NULL(probes);
+    ASSERT_NOT_NULL(results);
+
+    for (int i = 0; i < num_items; i++)
+    {
+        keys[i] = i;
+        key_ptrs[i] = &keys[i];
+    }
+
+    // Random probe order so every lookup misses the cache
+    unsigned int state = 12345;
+    for (int i = 0; i < num_items; i++)
+    {
+        probes[i] = &keys[i];
+    }
+    for (int i = num_items - 1; i > 0; i--)
+    {
+        state = state * 1103515245u + 12345u;
+        const int j = (int)((state >> 8) % (unsigned int)(i + 1));
+        const void* tmp = probes[i];
+        probes[i] = probes[j];
+        probes[j] = tmp;
+    }
+
+    ANVHashMap* single = anv_hashmap_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ANVHashMap* batched = anv_hashmap_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(single);
+    ASSERT_NOT_NULL(batched);
+
+    double start = now_seconds();
+    for (int i = 0; i < num_items; i++)
+    {
+        ASSERT_EQ(anv_hashmap_put(single, key_ptrs[i], key_ptrs[i]), 0);
+    }
+    const double single_put = now_seconds() - start;
+
+    start = now_seconds();
+    ASSERT_EQ(anv_hashmap_put_many(batched, key_ptrs, key_ptrs, (size_t)num_items), 0);
+    const double batched_put = now_seconds() - start;
+    ASSERT_EQ(anv_hashmap_size(batched), (size_t)num_items);
+
+    size_t hits = 0;
+    start = now_seconds();
+    for (int i = 0; i < num_items; i++)
+    {
+        hits += anv_hashmap_get(single, probes[i]) == probes[i];
+    }
+    const double single_get = now_seconds() - start;
+    ASSERT_EQ(hits, (size_t)num_items);
+
+    // Same table for both lookup runs, only the access pattern differs
+    start = now_seconds();
+    const size_t found = anv_hashmap_get_many(single, probes, (size_t)num_items, results);
+    const double batched_get = now_seconds() - start;
+    ASSERT_EQ(found, (size_t)num_items);
+    ASSERT_EQ_PTR(results[0], probes[0]);
+
+    printf("Random lookups, %d keys (%zu MB of nodes and buckets): get %.1f ns/op, get_many %.1f ns/op\n",
+           num_items, anv_hashmap_memory_usage(single) >> 20,
+           single_get / num_items * 1e9, batched_get / num_items * 1e9);
+    printf("Inserts, %d keys: put %.1f ns/op, put_many %.1f ns/op\n",
+           num_items, single_put / num_items * 1e9, batched_put / num_items * 1e9);
+
+    anv_hashmap_destroy(single, false, false);
+    anv_hashmap_destroy(batched, false, false);
+    free(results);
+    free(probes);
+    free(key_ptrs);
+    free(keys);
+    return TEST_SUCCESS;
+}
+
 typedef struct
 {
     int (*func)(void);
@@ -257,6 +666,10 @@ int main(void)
         {test_hashmap_performance_copy, "test_hashmap_performance_copy"},
         {test_hashmap_performance_iteration, "test_hashmap_performance_iteration"},
         {test_hashmap_performance_resize, "test_hashmap_performance_resize"},
+        {test_hashmap_performance_incremental_resize, "test_hashmap_performance_incremental_resize"},
+        {test_hashmap_performance_power_of_two, "test_hashmap_performance_power_of_two"},
+        {test_hashmap_performance_string_hash, "test_hashmap_performance_string_hash"},
+        {test_hashmap_performance_batched, "test_hashmap_performance_batched"},
     };
 
     printf("Running HashMap performance tests...\n");
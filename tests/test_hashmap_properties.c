@@ -2,9 +2,11 @@
 // HashMap properties test - converted from HashTable properties test
 //
 
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "containers/DynamicString.h"
 #include "containers/HashMap.h"
 #include "TestAssert.h"
 #include "TestHelpers.h"
@@ -371,6 +373,508 @@ int test_hashmap_hash_function_property(void)
     return TEST_SUCCESS;
 }
 
+static size_t hash_calls = 0;
+static size_t equals_calls = 0;
+
+static size_t counting_hash(const void* key)
+{
+    hash_calls++;
+    return anv_hash_int(key);
+}
+
+static int counting_equals(const void* key1, const void* key2)
+{
+    equals_calls++;
+    return anv_key_equals_int(key1, key2);
+}
+
+// Test that resizing and copying reuse cached hash codes
+int test_hashmap_cached_hash_property(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVHashMap* map = anv_hashmap_create(&alloc, counting_hash, counting_equals, 4);
+    ASSERT_NOT_NULL(map);
+
+    int keys[1000];
+    hash_calls = 0;
+    for (int i = 0; i < 1000; i++)
+    {
+        keys[i] = i;
+        ASSERT_EQ(anv_hashmap_put(map, &keys[i], &keys[i]), 0);
+    }
+    ASSERT_GT(map->bucket_count, 4);
+    ASSERT_EQ(hash_calls, 1000); // One call per put, none during resizes
+
+    ANVHashMap* copy = anv_hashmap_copy(map);
+    ASSERT_NOT_NULL(copy);
+    ASSERT_EQ(hash_calls, 1000);
+
+    // A miss only calls key_equals on nodes whose full hash matches
+    equals_calls = 0;
+    const int missing = -1;
+    ASSERT_NULL(anv_hashmap_get(copy, &missing));
+    ASSERT_EQ(equals_calls, 0);
+    ASSERT_EQ_PTR(anv_hashmap_get(copy, &keys[500]), &keys[500]);
+    ASSERT_EQ(equals_calls, 1);
+
+    anv_hashmap_destroy(copy, false, false);
+    anv_hashmap_destroy(map, false, false);
+    return TEST_SUCCESS;
+}
+
+// Test that every operation stays correct while an incremental resize is in progress
+int test_hashmap_incremental_resize_property(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVHashMap* map = anv_hashmap_create(&alloc, anv_hash_int, anv_key_equals_int, 8);
+    ASSERT_NOT_NULL(map);
+    ASSERT_EQ(anv_hashmap_set_incremental_resize(map, 1), 0);
+
+    int keys[2000];
+    bool saw_rehashing = false;
+    for (int i = 0; i < 2000; i++)
+    {
+        keys[i] = i;
+        ASSERT_EQ(anv_hashmap_put(map, &keys[i], &keys[i]), 0);
+        saw_rehashing |= anv_hashmap_is_rehashing(map);
+
+        // Every key inserted so far is reachable mid-migration
+        if (i % 97 == 0)
+        {
+            for (int j = 0; j <= i; j++)
+            {
+                ASSERT_EQ_PTR(anv_hashmap_get(map, &keys[j]), &keys[j]);
+            }
+        }
+    }
+    ASSERT_TRUE(saw_rehashing);
+
+    // Force a migration to be in flight, then exercise remove and iteration
+    static int extra[4000];
+    int next = 0;
+    while (!anv_hashmap_is_rehashing(map) && next < 4000)
+    {
+        extra[next] = 1000000 + next;
+        ASSERT_EQ(anv_hashmap_put(map, &extra[next], &extra[next]), 0);
+        next++;
+    }
+    ASSERT_TRUE(anv_hashmap_is_rehashing(map));
+    const size_t size = anv_hashmap_size(map);
+    ASSERT_EQ(anv_hashmap_remove(map, &keys[0], false, false), 0);
+    ASSERT_EQ_PTR(anv_hashmap_remove_get(map, &keys[1], false), &keys[1]);
+    ASSERT_NULL(anv_hashmap_get(map, &keys[0]));
+    ASSERT_EQ(anv_hashmap_size(map), size - 2);
+
+    size_t visited = 0;
+    ANVIterator it = anv_hashmap_iterator(map);
+    while (it.has_next(&it))
+    {
+        ASSERT_NOT_NULL(it.get(&it));
+        visited++;
+        it.next(&it);
+    }
+    it.destroy(&it);
+    ASSERT_EQ(visited, size - 2);
+
+    void** keys_out = NULL;
+    size_t count = 0;
+    ASSERT_EQ(anv_hashmap_get_keys(map, &keys_out, &count), 0);
+    ASSERT_EQ(count, size - 2);
+    anv_alloc_free(&alloc, keys_out);
+
+    ANVHashMap* copy = anv_hashmap_copy(map);
+    ASSERT_NOT_NULL(copy);
+    ASSERT_EQ(anv_hashmap_size(copy), size - 2);
+    anv_hashmap_destroy(copy, false, false);
+
+    // Idle-time migration finishes the resize
+    while (anv_hashmap_rehash_step(map, 16) == 1)
+    {
+    }
+    ASSERT_FALSE(anv_hashmap_is_rehashing(map));
+    ASSERT_EQ_PTR(anv_hashmap_get(map, &keys[1999]), &keys[1999]);
+
+    anv_hashmap_destroy(map, false, false);
+    return TEST_SUCCESS;
+}
+
+// Property: power-of-two indexing keeps every key reachable, also through
+// incremental resizes, and the bucket count stays a power of two
+int test_hashmap_power_of_two_property(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVHashMap* map = anv_hashmap_create(&alloc, anv_hash_int, anv_key_equals_int, 10);
+    ASSERT_NOT_NULL(map);
+
+    int keys[3000];
+    for (int i = 0; i < 500; i++)
+    {
+        keys[i] = i * 1024; // Identity-like hashes that share their low bits
+        ASSERT_EQ(anv_hashmap_put(map, &keys[i], &keys[i]), 0);
+    }
+
+    // Switching rehashes existing entries into a power-of-two table
+    ASSERT_EQ(anv_hashmap_set_power_of_two(map, true), 0);
+    ASSERT_EQ(map->bucket_count & (map->bucket_count - 1), 0);
+    for (int i = 0; i < 500; i++)
+    {
+        ASSERT_EQ_PTR(anv_hashmap_get(map, &keys[i]), &keys[i]);
+    }
+
+    ASSERT_EQ(anv_hashmap_set_incremental_resize(map, 2), 0);
+    for (int i = 500; i < 3000; i++)
+    {
+        keys[i] = i * 1024;
+        ASSERT_EQ(anv_hashmap_put(map, &keys[i], &keys[i]), 0);
+        if (i % 251 == 0)
+        {
+            for (int j = 0; j <= i; j++)
+            {
+                ASSERT_EQ_PTR(anv_hashmap_get(map, &keys[j]), &keys[j]);
+            }
+        }
+    }
+    ASSERT_EQ(map->bucket_count & (map->bucket_count - 1), 0);
+
+    // No bucket should collect a large share of the keys
+    ASSERT_EQ(anv_hashmap_set_incremental_resize(map, 0), 0);
+    size_t longest = 0;
+    for (size_t i = 0; i < map->bucket_count; i++)
+    {
+        size_t length = 0;
+        for (const ANVHashMapNode* node = map->buckets[i]; node; node = node->next)
+        {
+            length++;
+        }
+        longest = length > longest ? length : longest;
+    }
+    ASSERT_LTE(longest, 12);
+
+    ANVHashMap* copy = anv_hashmap_copy(map);
+    ASSERT_NOT_NULL(copy);
+    ASSERT_TRUE(copy->power_of_two);
+    ASSERT_EQ_PTR(anv_hashmap_get(copy, &keys[2999]), &keys[2999]);
+    anv_hashmap_destroy(copy, false, false);
+
+    // And back to modulo indexing
+    ASSERT_EQ(anv_hashmap_set_power_of_two(map, false), 0);
+    ASSERT_EQ(anv_hashmap_remove(map, &keys[0], false, false), 0);
+    for (int i = 1; i < 3000; i++)
+    {
+        ASSERT_EQ_PTR(anv_hashmap_get(map, &keys[i]), &keys[i]);
+    }
+    ASSERT_EQ(anv_hashmap_set_power_of_two(NULL, true), -1);
+
+    anv_hashmap_destroy(map, false, false);
+    return TEST_SUCCESS;
+}
+
+// Property: the seeded byte hash is deterministic per seed, sensitive to
+// every byte and the length, and ANVString keys hash by their stored length
+int test_hashmap_seeded_hash_property(void)
+{
+    char buffer[256];
+    for (int i = 0; i < 256; i++)
+    {
+        buffer[i] = (char)('a' + i % 26);
+    }
+
+    // Each length and each single-bit flip gives a different hash
+    for (size_t length = 0; length <= sizeof(buffer); length++)
+    {
+        const uint64_t base = anv_hash_bytes_seeded(buffer, length, 1234);
+        ASSERT_EQ(anv_hash_bytes_seeded(buffer, length, 1234), base);
+        ASSERT_TRUE(anv_hash_bytes_seeded(buffer, length, 1235) != base);
+        if (length > 0)
+        {
+            ASSERT_TRUE(anv_hash_bytes_seeded(buffer, length - 1, 1234) != base);
+            buffer[length / 2] ^= 0x10;
+            ASSERT_TRUE(anv_hash_bytes_seeded(buffer, length, 1234) != base);
+            buffer[length / 2] ^= 0x10;
+        }
+    }
+
+    // The process seed is stable and drives anv_hash_string
+    const uint64_t seed = anv_hash_seed();
+    ASSERT_EQ(anv_hash_seed(), seed);
+    ASSERT_EQ(anv_hash_string("hello"), (size_t)anv_hash_bytes_seeded("hello", 5, seed));
+    ASSERT_EQ(anv_hash_string(NULL), 0);
+
+    // ANVString keys: embedded null bytes are part of the key
+    ANVString a = anv_str_create_from_cstring("key");
+    ANVString b = anv_str_create_from_cstring("key");
+    ANVString c = anv_str_create_from_cstring("key");
+    anv_str_push_back(&c, '\0');
+    ASSERT_EQ(anv_str_hash(&a), anv_str_hash(&b));
+    ASSERT_EQ(anv_str_hash(&a), anv_hash_string("key"));
+    ASSERT_TRUE(anv_str_key_equals(&a, &b));
+    ASSERT_FALSE(anv_str_key_equals(&a, &c));
+    ASSERT_TRUE(anv_str_hash(&a) != anv_str_hash(&c));
+
+    ANVAllocator alloc = anv_alloc_default();
+    ANVHashMap* map = anv_hashmap_create(&alloc, anv_str_hash, anv_str_key_equals, 0);
+    ASSERT_NOT_NULL(map);
+    int value = 7;
+    ASSERT_EQ(anv_hashmap_put(map, &a, &value), 0);
+    ASSERT_EQ_PTR(anv_hashmap_get(map, &b), &value);
+    ASSERT_NULL(anv_hashmap_get(map, &c));
+    anv_hashmap_destroy(map, false, false);
+
+    anv_str_destroy(&a);
+    anv_str_destroy(&b);
+    anv_str_destroy(&c);
+    return TEST_SUCCESS;
+}
+
+// Property: switching the index function while an incremental resize is in
+// flight keeps every key reachable and counted
+int test_hashmap_power_of_two_mid_migration_property(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    enum { COUNT = 400 };
+    static int keys[COUNT];
+
+    for (int enabled = 1; enabled >= 0; enabled--)
+    {
+        ANVHashMap* map = anv_hashmap_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+        ASSERT_NOT_NULL(map);
+        ASSERT_EQ(anv_hashmap_set_power_of_two(map, !enabled), 0);
+        ASSERT_EQ(anv_hashmap_set_incremental_resize(map, 1), 0);
+
+        int inserted = 0;
+        bool switched = false;
+        while (inserted < COUNT)
+        {
+            keys[inserted] = inserted;
+            ASSERT_EQ(anv_hashmap_put(map, &keys[inserted], &keys[inserted]), 0);
+            inserted++;
+            if (!switched && anv_hashmap_is_rehashing(map) && map->migrate_index > 0)
+            {
+                ASSERT_EQ(anv_hashmap_set_power_of_two(map, enabled), 0);
+                ASSERT_FALSE(anv_hashmap_is_rehashing(map));
+                switched = true;
+            }
+        }
+        ASSERT_TRUE(switched);
+
+        ASSERT_EQ(anv_hashmap_size(map), COUNT);
+        for (int i = 0; i < COUNT; i++)
+        {
+            ASSERT_EQ_PTR(anv_hashmap_get(map, &keys[i]), &keys[i]);
+        }
+
+        size_t iterated = 0;
+        ANVIterator it = anv_hashmap_iterator(map);
+        while (it.has_next(&it))
+        {
+            iterated++;
+            it.next(&it);
+        }
+        it.destroy(&it);
+        ASSERT_EQ(iterated, COUNT);
+
+        anv_hashmap_destroy(map, false, false);
+    }
+    return TEST_SUCCESS;
+}
+
+// Property: batched get/put agree with the single-key operations, including
+// duplicates inside a batch, misses and in-flight incremental resizes
+int test_hashmap_batch_property(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVHashMap* map = anv_hashmap_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(map);
+    ASSERT_EQ(anv_hashmap_set_incremental_resize(map, 1), 0);
+
+    enum { COUNT = 1000 };
+    static int keys[COUNT];
+    static int values[COUNT];
+    void* key_ptrs[COUNT];
+    void* value_ptrs[COUNT];
+    for (int i = 0; i < COUNT; i++)
+    {
+        keys[i] = i % 700; // The tail repeats earlier keys
+        values[i] = i;
+        key_ptrs[i] = &keys[i];
+        value_ptrs[i] = &values[i];
+    }
+
+    ASSERT_EQ(anv_hashmap_put_many(map, key_ptrs, value_ptrs, 500), 0);
+    ASSERT_EQ(anv_hashmap_put_many(map, key_ptrs + 500, value_ptrs + 500, COUNT - 500), 0);
+    ASSERT_EQ(anv_hashmap_size(map), 700);
+
+    // Later duplicates win, as with repeated anv_hashmap_put
+    for (int i = 0; i < 700; i++)
+    {
+        const int expected = i < COUNT - 700 ? i + 700 : i;
+        ASSERT_EQ(*(int*)anv_hashmap_get(map, &keys[i]), expected);
+    }
+
+    static int probes[COUNT];
+    const void* probe_ptrs[COUNT];
+    void* results[COUNT];
+    for (int i = 0; i < COUNT; i++)
+    {
+        probes[i] = i * 3; // Every third value below 700 is present
+        probe_ptrs[i] = &probes[i];
+    }
+    probe_ptrs[5] = NULL;
+
+    const size_t found = anv_hashmap_get_many(map, probe_ptrs, COUNT, results);
+    size_t expected_found = 0;
+    for (int i = 0; i < COUNT; i++)
+    {
+        ASSERT_EQ_PTR(results[i], probe_ptrs[i] ? anv_hashmap_get(map, probe_ptrs[i]) : NULL);
+        expected_found += results[i] != NULL;
+    }
+    ASSERT_EQ(found, expected_found);
+    ASSERT_EQ(found, 234 - 1); // Multiples of 3 below 700, minus the NULL probe
+
+    void* null_keys[1] = {NULL};
+    ASSERT_EQ(anv_hashmap_put_many(map, null_keys, value_ptrs, 1), -1);
+    ASSERT_EQ(anv_hashmap_put_many(NULL, key_ptrs, value_ptrs, 1), -1);
+    ASSERT_EQ(anv_hashmap_get_many(map, probe_ptrs, COUNT, NULL), 0);
+    ASSERT_EQ(anv_hashmap_put_many(map, key_ptrs, value_ptrs, 0), 0);
+    ASSERT_EQ(anv_hashmap_size(map), 700);
+
+    // Updating keys that are all present must not grow the table
+    ASSERT_EQ(anv_hashmap_rehash_step(map, SIZE_MAX), 0);
+    const size_t buckets = map->bucket_count;
+    ASSERT_EQ(anv_hashmap_put_many(map, key_ptrs, value_ptrs, 700), 0);
+    ASSERT_EQ(map->bucket_count, buckets);
+    ASSERT_FALSE(anv_hashmap_is_rehashing(map));
+
+    anv_hashmap_destroy(map, false, false);
+    return TEST_SUCCESS;
+}
+
+// Property: entry hashes once, inserts a NULL slot for new keys and returns
+// the existing slot otherwise, and slots survive resizes
+int test_hashmap_entry_property(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVHashMap* map = anv_hashmap_create(&alloc, counting_hash, counting_equals, 4);
+    ASSERT_NOT_NULL(map);
+
+    // Word-count style: keys repeat, counts live in the value pointer
+    static int words[600];
+    for (int i = 0; i < 600; i++)
+    {
+        words[i] = i % 150;
+    }
+
+    hash_calls = 0;
+    size_t inserted_count = 0;
+    void** first_slot = NULL;
+    for (int i = 0; i < 600; i++)
+    {
+        bool inserted = false;
+        void** slot = anv_hashmap_entry(map, &words[i], &inserted);
+        ASSERT_NOT_NULL(slot);
+        if (inserted)
+        {
+            ASSERT_NULL(*slot);
+            inserted_count++;
+        }
+        *slot = (void*)((intptr_t)*slot + 1);
+        if (i == 0)
+        {
+            first_slot = slot;
+        }
+    }
+    ASSERT_EQ(hash_calls, 600); // One hash per call, none for the resizes
+    ASSERT_EQ(inserted_count, 150);
+    ASSERT_EQ(anv_hashmap_size(map), 150);
+
+    // The slot taken before several resizes still belongs to key 0
+    ASSERT_EQ_PTR(*first_slot, anv_hashmap_get(map, &words[0]));
+    for (int i = 0; i < 150; i++)
+    {
+        ASSERT_EQ((intptr_t)anv_hashmap_get(map, &words[i]), 4);
+    }
+
+    // An existing key keeps the stored key pointer
+    int probe = 7;
+    bool inserted = true;
+    void** slot = anv_hashmap_entry(map, &probe, &inserted);
+    ASSERT_FALSE(inserted);
+    ASSERT_EQ((intptr_t)*slot, 4);
+    ASSERT_NOT_NULL(anv_hashmap_entry(map, &probe, NULL));
+
+    ASSERT_NULL(anv_hashmap_entry(map, NULL, &inserted));
+    ASSERT_FALSE(inserted);
+    ASSERT_NULL(anv_hashmap_entry(NULL, &probe, NULL));
+
+    anv_hashmap_destroy(map, false, false);
+    return TEST_SUCCESS;
+}
+
+// Property: reserve presizes without later resizes, shrink_to_fit returns
+// buckets after mass removal, and the sized from_iterator loads in one go
+int test_hashmap_reserve_shrink_property(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVHashMap* map = anv_hashmap_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(map);
+
+    enum { COUNT = 5000 };
+    static int keys[COUNT];
+    ASSERT_EQ(anv_hashmap_reserve(map, COUNT), 0);
+    const size_t reserved = map->bucket_count;
+    ASSERT_GTE((double)reserved * map->max_load_factor, (double)COUNT);
+    ASSERT_EQ(anv_hashmap_reserve(map, 10), 0); // Never shrinks
+    ASSERT_EQ(map->bucket_count, reserved);
+
+    for (int i = 0; i < COUNT; i++)
+    {
+        keys[i] = i;
+        ASSERT_EQ(anv_hashmap_put(map, &keys[i], &keys[i]), 0);
+    }
+    ASSERT_EQ(map->bucket_count, reserved);
+
+    // Source for the sized from_iterator before most keys go away
+    ANVIterator it = anv_hashmap_iterator(map);
+    ANVHashMap* loaded = anv_hashmap_from_iterator_sized(&it, &alloc, anv_hash_int, anv_key_equals_int, false, COUNT);
+    it.destroy(&it);
+    ASSERT_NOT_NULL(loaded);
+    ASSERT_EQ(anv_hashmap_size(loaded), COUNT);
+    ASSERT_EQ(loaded->bucket_count, reserved);
+    anv_hashmap_destroy(loaded, false, false);
+
+    for (int i = 10; i < COUNT; i++)
+    {
+        ASSERT_EQ(anv_hashmap_remove(map, &keys[i], false, false), 0);
+    }
+    const size_t before = anv_hashmap_memory_usage(map);
+    ASSERT_EQ(anv_hashmap_shrink_to_fit(map), 0);
+    ASSERT_LT(anv_hashmap_memory_usage(map), before);
+    ASSERT_LTE(anv_hashmap_load_factor(map), map->max_load_factor);
+    ASSERT_LTE(map->bucket_count, 14);
+    for (int i = 0; i < 10; i++)
+    {
+        ASSERT_EQ_PTR(anv_hashmap_get(map, &keys[i]), &keys[i]);
+    }
+
+    // Power-of-two tables stay power-of-two sized
+    ASSERT_EQ(anv_hashmap_set_power_of_two(map, true), 0);
+    ASSERT_EQ(anv_hashmap_reserve(map, 1000), 0);
+    ASSERT_EQ(map->bucket_count, 2048);
+    ASSERT_EQ(anv_hashmap_shrink_to_fit(map), 0);
+    ASSERT_EQ(map->bucket_count, 16);
+
+    anv_hashmap_clear(map, false, false);
+    ASSERT_EQ(anv_hashmap_shrink_to_fit(map), 0);
+    ASSERT_EQ(map->bucket_count, 1);
+    ASSERT_EQ(anv_hashmap_put(map, &keys[0], &keys[0]), 0);
+    ASSERT_EQ_PTR(anv_hashmap_get(map, &keys[0]), &keys[0]);
+    ASSERT_EQ(anv_hashmap_reserve(NULL, 1), -1);
+    ASSERT_EQ(anv_hashmap_shrink_to_fit(NULL), -1);
+
+    anv_hashmap_destroy(map, false, false);
+    return TEST_SUCCESS;
+}
+
 typedef struct
 {
     int (*func)(void);
@@ -388,6 +892,14 @@ int main(void)
         {test_hashmap_contains_property, "test_hashmap_contains_property"},
         {test_hashmap_iterator_completeness, "test_hashmap_iterator_completeness"},
         {test_hashmap_hash_function_property, "test_hashmap_hash_function_property"},
+        {test_hashmap_cached_hash_property, "test_hashmap_cached_hash_property"},
+        {test_hashmap_incremental_resize_property, "test_hashmap_incremental_resize_property"},
+        {test_hashmap_power_of_two_property, "test_hashmap_power_of_two_property"},
+        {test_hashmap_power_of_two_mid_migration_property, "test_hashmap_power_of_two_mid_migration_property"},
+        {test_hashmap_seeded_hash_property, "test_hashmap_seeded_hash_property"},
+        {test_hashmap_batch_property, "test_hashmap_batch_property"},
+        {test_hashmap_entry_property, "test_hashmap_entry_property"},
+        {test_hashmap_reserve_shrink_property, "test_hashmap_reserve_shrink_property"},
     };
 
     printf("Running HashMap properties tests...\n");
@@ -237,6 +237,89 @@ int test_hashset_difference(void)
     return TEST_SUCCESS;
 }
 
+// Test in-place union and presized results
+int test_hashset_union_into(void)
+{
+    ANVAllocator alloc = create_int_allocator();
+    ANVHashSet* set1 = anv_hashset_create(&alloc, anv_hash_string, anv_key_equals_string, 0);
+    ANVHashSet* set2 = anv_hashset_create(&alloc, anv_hash_string, anv_key_equals_string, 0);
+
+    anv_hashset_add(set1, "a");
+    anv_hashset_add(set1, "b");
+
+    anv_hashset_add(set2, "b");
+    anv_hashset_add(set2, "c");
+    anv_hashset_add(set2, "d");
+
+    ASSERT_EQ(anv_hashset_union_into(set1, set2), 0);
+    ASSERT_EQ(anv_hashset_size(set1), 4); // a, b, c, d
+    ASSERT_EQ(anv_hashset_size(set2), 3);
+    ASSERT(anv_hashset_contains(set1, "a"));
+    ASSERT(anv_hashset_contains(set1, "c"));
+    ASSERT(anv_hashset_contains(set1, "d"));
+
+    // Self-union is a no-op
+    ASSERT_EQ(anv_hashset_union_into(set1, set1), 0);
+    ASSERT_EQ(anv_hashset_size(set1), 4);
+    ASSERT_EQ(anv_hashset_union_into(NULL, set2), -1);
+    ASSERT_EQ(anv_hashset_union_into(set1, NULL), -1);
+
+    // An intersection result never needs to grow past the smaller operand
+    ANVHashSet* intersection_set = anv_hashset_intersection(set1, set2);
+    ASSERT_NOT_NULL(intersection_set);
+    ASSERT_EQ(anv_hashset_size(intersection_set), 3);
+    ASSERT_EQ(anv_hashset_capacity(intersection_set), 16);
+
+    anv_hashset_destroy(set1, false);
+    anv_hashset_destroy(set2, false);
+    anv_hashset_destroy(intersection_set, false);
+    return TEST_SUCCESS;
+}
+
+// Test in-place intersection
+int test_hashset_retain_all(void)
+{
+    ANVAllocator alloc = create_int_allocator();
+    ANVHashSet* set = anv_hashset_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ANVHashSet* keep = anv_hashset_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+
+    int values[200];
+    for (int i = 0; i < 200; i++)
+    {
+        values[i] = i;
+        ASSERT_EQ(anv_hashset_add(set, &values[i]), 0);
+        if (i % 3 == 0)
+        {
+            ASSERT_EQ(anv_hashset_add(keep, &values[i]), 0);
+        }
+    }
+    const size_t capacity = anv_hashset_capacity(set);
+
+    ASSERT_EQ(anv_hashset_retain_all(set, keep, false), 133);
+    ASSERT_EQ(anv_hashset_size(set), 67);
+    ASSERT_EQ(anv_hashset_capacity(set), capacity);
+    for (int i = 0; i < 200; i++)
+    {
+        ASSERT_EQ(anv_hashset_contains(set, &values[i]), i % 3 == 0);
+    }
+
+    // Removed keys are released through the allocator
+    int* owned = malloc(sizeof(int));
+    ASSERT_NOT_NULL(owned);
+    *owned = 1000;
+    ASSERT_EQ(anv_hashset_add(set, owned), 0);
+    ASSERT_EQ(anv_hashset_retain_all(set, keep, true), 1);
+
+    // Retaining against nothing empties the set
+    ASSERT_EQ(anv_hashset_retain_all(set, NULL, false), 67);
+    ASSERT_TRUE(anv_hashset_is_empty(set));
+    ASSERT_EQ(anv_hashset_retain_all(NULL, keep, false), 0);
+
+    anv_hashset_destroy(set, false);
+    anv_hashset_destroy(keep, false);
+    return TEST_SUCCESS;
+}
+
 // Test subset operation
 int test_hashset_is_subset(void)
 {
@@ -402,6 +485,8 @@ int main(void)
         {test_hashset_union, "test_hashset_union"},
         {test_hashset_intersection, "test_hashset_intersection"},
         {test_hashset_difference, "test_hashset_difference"},
+        {test_hashset_union_into, "test_hashset_union_into"},
+        {test_hashset_retain_all, "test_hashset_retain_all"},
         {test_hashset_is_subset, "test_hashset_is_subset"},
         {test_hashset_iterator, "test_hashset_iterator"},
         {test_hashset_clear, "test_hashset_clear"},
@@ -5,7 +5,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "containers/HashMap.h"
 #include "containers/HashSet.h"
+#include "memory/TrackingAllocator.h"
 #include "TestAssert.h"
 #include "TestHelpers.h"
 
@@ -249,6 +251,69 @@ int test_hashset_memory_no_leaks(void)
 }
 
 // Main test runner
+// Test that key-only storage costs far less per element than a map, and
+// that add/remove churn reuses tombstones instead of growing
+int test_hashset_memory_compact_storage(void)
+{
+    ANVAllocator inner = anv_alloc_default();
+    ANVTrackingAllocator tracker;
+    ASSERT_EQ(anv_tracking_init(&tracker, &inner), 0);
+    ANVAllocator alloc = anv_tracking_allocator(&tracker);
+
+    enum { COUNT = 100000 };
+    int* keys = malloc(sizeof(int) * COUNT);
+    ASSERT_NOT_NULL(keys);
+
+    ANVHashSet* set = anv_hashset_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(set);
+    for (int i = 0; i < COUNT; i++)
+    {
+        keys[i] = i;
+        ASSERT_EQ(anv_hashset_add(set, &keys[i]), 0);
+    }
+    const size_t set_bytes = tracker.bytes_in_flight;
+    ASSERT_EQ(anv_hashset_memory_usage(set), set_bytes);
+
+    ANVHashMap* map = anv_hashmap_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(map);
+    for (int i = 0; i < COUNT; i++)
+    {
+        ASSERT_EQ(anv_hashmap_put(map, &keys[i], &keys[i]), 0);
+    }
+    const size_t map_bytes = tracker.bytes_in_flight - set_bytes;
+    anv_hashmap_destroy(map, false, false);
+
+    // A key pointer plus a control byte per slot, at most 2x slots per key
+    ASSERT_LTE(set_bytes / COUNT, 2 * (sizeof(void*) + 1));
+    ASSERT_LT(set_bytes * 3, map_bytes);
+
+    // Churn at a fixed size must not grow the table
+    const size_t capacity = anv_hashset_capacity(set);
+    for (int round = 0; round < 5; round++)
+    {
+        for (int i = 0; i < COUNT; i += 2)
+        {
+            ASSERT_EQ(anv_hashset_remove(set, &keys[i], false), 0);
+        }
+        for (int i = 0; i < COUNT; i += 2)
+        {
+            ASSERT_EQ(anv_hashset_add(set, &keys[i]), 0);
+        }
+    }
+    ASSERT_EQ(anv_hashset_capacity(set), capacity);
+    ASSERT_EQ(anv_hashset_size(set), COUNT);
+
+    // remove_get hands back the stored pointer, not the lookup key
+    const int probe = 42;
+    ASSERT_EQ_PTR(anv_hashset_remove_get(set, &probe), &keys[42]);
+    ASSERT_NULL(anv_hashset_remove_get(set, &probe));
+
+    anv_hashset_destroy(set, false);
+    ASSERT_EQ(tracker.bytes_in_flight, 0);
+    free(keys);
+    return TEST_SUCCESS;
+}
+
 typedef struct
 {
     int (*func)(void);
@@ -266,6 +331,7 @@ int main(void)
         {test_hashset_memory_iterator, "test_hashset_memory_iterator"},
         {test_hashset_memory_set_operations, "test_hashset_memory_set_operations"},
         {test_hashset_memory_no_leaks, "test_hashset_memory_no_leaks"},
+        {test_hashset_memory_compact_storage, "test_hashset_memory_compact_storage"},
     };
 
     printf("Running HashSet Memory tests...\n");
@@ -6,6 +6,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include "containers/HashMap.h"
 #include "containers/HashSet.h"
 #include "TestAssert.h"
 #include "TestHelpers.h"
@@ -298,6 +299,208 @@ int test_hashset_load_factor_performance(void)
 }
 
 // Main test runner
+// Compare membership lookups and memory of the set against a HashMap
+// holding the same keys
+int test_hashset_membership_performance(void)
+{
+    ANVAllocator alloc = create_int_allocator();
+    const int count = 1000000;
+    int* keys = malloc(sizeof(int) * count * 2);
+    ASSERT_NOT_NULL(keys);
+    for (int i = 0; i < count * 2; i++)
+    {
+        keys[i] = i * 3;
+    }
+
+    ANVHashSet* set = anv_hashset_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ANVHashMap* map = anv_hashmap_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(set);
+    ASSERT_NOT_NULL(map);
+    for (int i = 0; i < count; i++)
+    {
+        ASSERT_EQ(anv_hashset_add(set, &keys[i]), 0);
+        ASSERT_EQ(anv_hashmap_put(map, &keys[i], &keys[i]), 0);
+    }
+
+    // Half hits, half misses
+    size_t set_hits = 0;
+    clock_t start = clock();
+    for (int i = 0; i < count * 2; i++)
+    {
+        set_hits += (size_t)anv_hashset_contains(set, &keys[i]);
+    }
+    const double set_time = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    size_t map_hits = 0;
+    start = clock();
+    for (int i = 0; i < count * 2; i++)
+    {
+        map_hits += (size_t)anv_hashmap_contains_key(map, &keys[i]);
+    }
+    const double map_time = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    ASSERT_EQ(set_hits, (size_t)count);
+    ASSERT_EQ(map_hits, (size_t)count);
+    printf("%d lookups: HashSet %.1f ns/op, %.1f bytes/key; HashMap %.1f ns/op, %.1f bytes/key (plus malloc headers)\n",
+           count * 2, set_time / (count * 2) * 1e9, (double)anv_hashset_memory_usage(set) / count,
+           map_time / (count * 2) * 1e9, (double)anv_hashmap_memory_usage(map) / count);
+
+    anv_hashset_destroy(set, false);
+    anv_hashmap_destroy(map, false, false);
+    free(keys);
+    return TEST_SUCCESS;
+}
+
+// Compare the allocating set operations against their in-place variants
+int test_hashset_in_place_operations_performance(void)
+{
+    ANVAllocator alloc = create_int_allocator();
+    const int count = 200000;
+    const int rounds = 10;
+    int* keys = malloc(sizeof(int) * count * 2);
+    ASSERT_NOT_NULL(keys);
+    for (int i = 0; i < count * 2; i++)
+    {
+        keys[i] = i;
+    }
+
+    // Half of set2 overlaps set1
+    ANVHashSet* set1 = anv_hashset_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ANVHashSet* set2 = anv_hashset_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(set1);
+    ASSERT_NOT_NULL(set2);
+    for (int i = 0; i < count; i++)
+    {
+        ASSERT_EQ(anv_hashset_add(set1, &keys[i]), 0);
+        ASSERT_EQ(anv_hashset_add(set2, &keys[i + count / 2]), 0);
+    }
+
+    double union_time = 0.0;
+    double union_into_time = 0.0;
+    double intersection_time = 0.0;
+    double retain_time = 0.0;
+    for (int round = 0; round < rounds; round++)
+    {
+        clock_t start = clock();
+        ANVHashSet* union_set = anv_hashset_union(set1, set2);
+        union_time += (double)(clock() - start) / CLOCKS_PER_SEC;
+        ASSERT_NOT_NULL(union_set);
+        ASSERT_EQ(anv_hashset_size(union_set), (size_t)(count + count / 2));
+
+        start = clock();
+        ANVHashSet* intersection_set = anv_hashset_intersection(set1, set2);
+        intersection_time += (double)(clock() - start) / CLOCKS_PER_SEC;
+        ASSERT_NOT_NULL(intersection_set);
+        ASSERT_EQ(anv_hashset_size(intersection_set), (size_t)(count / 2));
+
+        // In-place variants work on copies so every round sees the same input
+        ANVHashSet* dest = anv_hashset_copy(set1);
+        ASSERT_NOT_NULL(dest);
+        start = clock();
+        ASSERT_EQ(anv_hashset_union_into(dest, set2), 0);
+        union_into_time += (double)(clock() - start) / CLOCKS_PER_SEC;
+        ASSERT_EQ(anv_hashset_size(dest), (size_t)(count + count / 2));
+        anv_hashset_destroy(dest, false);
+
+        dest = anv_hashset_copy(set1);
+        ASSERT_NOT_NULL(dest);
+        start = clock();
+        ASSERT_EQ(anv_hashset_retain_all(dest, set2, false), (size_t)(count / 2));
+        retain_time += (double)(clock() - start) / CLOCKS_PER_SEC;
+        anv_hashset_destroy(dest, false);
+
+        anv_hashset_destroy(union_set, false);
+        anv_hashset_destroy(intersection_set, false);
+    }
+
+    printf("Union of %d + %d: allocating %.2f ms, union_into %.2f ms\n", count, count,
+           union_time / rounds * 1e3, union_into_time / rounds * 1e3);
+    printf("Intersection of %d + %d: allocating %.2f ms, retain_all %.2f ms\n", count, count,
+           intersection_time / rounds * 1e3, retain_time / rounds * 1e3);
+
+    anv_hashset_destroy(set1, false);
+    anv_hashset_destroy(set2, false);
+    free(keys);
+    return TEST_SUCCESS;
+}
+
+#ifdef ANVIL_WITH_SYSTEM
+// Compare the serial set operations and bulk build against the parallel
+// versions. Speedup depends on the number of cores available.
+int test_hashset_parallel_operations_performance(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    const int count = 1000000;
+    const size_t threads = 4;
+    int* keys = malloc(sizeof(int) * count * 2);
+    ASSERT_NOT_NULL(keys);
+    for (int i = 0; i < count * 2; i++)
+    {
+        keys[i] = i;
+    }
+
+    ANVHashSet* set1 = anv_hashset_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ANVHashSet* set2 = anv_hashset_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(set1);
+    ASSERT_NOT_NULL(set2);
+    for (int i = 0; i < count; i++)
+    {
+        ASSERT_EQ(anv_hashset_add(set1, &keys[i]), 0);
+        ASSERT_EQ(anv_hashset_add(set2, &keys[i + count / 2]), 0);
+    }
+
+    // Wall-clock time, since clock() adds up every thread's CPU time
+    struct timespec t0, t1;
+    timespec_get(&t0, TIME_UTC);
+    ANVHashSet* serial = anv_hashset_intersection(set1, set2);
+    timespec_get(&t1, TIME_UTC);
+    const double serial_time = (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) / 1e9;
+
+    timespec_get(&t0, TIME_UTC);
+    ANVHashSet* parallel = anv_hashset_intersection_parallel(set1, set2, threads);
+    timespec_get(&t1, TIME_UTC);
+    const double parallel_time = (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) / 1e9;
+
+    ASSERT_NOT_NULL(serial);
+    ASSERT_NOT_NULL(parallel);
+    ASSERT_EQ(anv_hashset_size(parallel), anv_hashset_size(serial));
+
+    ANVHashSet* all = anv_hashset_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(all);
+    timespec_get(&t0, TIME_UTC);
+    for (int i = 0; i < count * 2; i++)
+    {
+        ASSERT_EQ(anv_hashset_add(all, &keys[i]), 0);
+    }
+    timespec_get(&t1, TIME_UTC);
+    const double add_time = (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) / 1e9;
+
+    ANVIterator it = anv_hashset_iterator(all);
+    timespec_get(&t0, TIME_UTC);
+    ANVHashSet* built = anv_hashset_from_iterator_parallel(&it, &alloc, anv_hash_int, anv_key_equals_int,
+                                                           false, threads);
+    timespec_get(&t1, TIME_UTC);
+    const double build_time = (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) / 1e9;
+    it.destroy(&it);
+    ASSERT_NOT_NULL(built);
+    ASSERT_EQ(anv_hashset_size(built), (size_t)count * 2);
+
+    printf("Intersection of %d + %d: serial %.1f ms, %zu threads %.1f ms\n", count, count,
+           serial_time * 1e3, threads, parallel_time * 1e3);
+    printf("Build of %d keys: add loop %.1f ms, from_iterator_parallel (%zu threads) %.1f ms\n", count * 2,
+           add_time * 1e3, threads, build_time * 1e3);
+
+    anv_hashset_destroy(serial, false);
+    anv_hashset_destroy(parallel, false);
+    anv_hashset_destroy(all, false);
+    anv_hashset_destroy(built, false);
+    anv_hashset_destroy(set1, false);
+    anv_hashset_destroy(set2, false);
+    free(keys);
+    return TEST_SUCCESS;
+}
+#endif // ANVIL_WITH_SYSTEM
+
 typedef struct
 {
     int (*func)(void);
@@ -314,6 +517,11 @@ int main(void)
         {test_hashset_iterator_performance, "test_hashset_iterator_performance"},
         {test_hashset_copy_performance, "test_hashset_copy_performance"},
         {test_hashset_load_factor_performance, "test_hashset_load_factor_performance"},
+        {test_hashset_membership_performance, "test_hashset_membership_performance"},
+        {test_hashset_in_place_operations_performance, "test_hashset_in_place_operations_performance"},
+#ifdef ANVIL_WITH_SYSTEM
+        {test_hashset_parallel_operations_performance, "test_hashset_parallel_operations_performance"},
+#endif
     };
 
     printf("Running HashSet Performance tests...\n");
@@ -5,6 +5,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "containers/ArrayList.h"
 #include "containers/HashSet.h"
 #include "TestAssert.h"
 #include "TestHelpers.h"
@@ -288,6 +289,207 @@ int test_hashset_iterator_consistency(void)
 }
 
 // Main test runner
+// Test reserve and shrink_to_fit, and that union results are presized
+int test_hashset_reserve_shrink(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVHashSet* set = anv_hashset_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(set);
+
+    static int keys[2000];
+    const size_t empty_usage = anv_hashset_memory_usage(set);
+    ASSERT_EQ(anv_hashset_reserve(set, 2000), 0);
+    const size_t reserved_usage = anv_hashset_memory_usage(set);
+    ASSERT(reserved_usage > empty_usage);
+
+    for (int i = 0; i < 2000; i++)
+    {
+        keys[i] = i;
+        ASSERT_EQ(anv_hashset_add(set, &keys[i]), 0);
+    }
+    ASSERT_LTE(anv_hashset_load_factor(set), 0.75);
+
+    ANVHashSet* other = anv_hashset_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(other);
+    ASSERT_EQ(anv_hashset_add(other, &keys[0]), 0);
+    ANVHashSet* joined = anv_hashset_union(set, other);
+    ASSERT_NOT_NULL(joined);
+    ASSERT_EQ(anv_hashset_size(joined), 2000);
+    anv_hashset_destroy(joined, false);
+    anv_hashset_destroy(other, false);
+
+    for (int i = 5; i < 2000; i++)
+    {
+        ASSERT_EQ(anv_hashset_remove(set, &keys[i], false), 0);
+    }
+    ASSERT_EQ(anv_hashset_shrink_to_fit(set), 0);
+    ASSERT(anv_hashset_memory_usage(set) < reserved_usage);
+    for (int i = 0; i < 5; i++)
+    {
+        ASSERT_TRUE(anv_hashset_contains(set, &keys[i]));
+    }
+
+    ASSERT_EQ(anv_hashset_reserve(NULL, 1), -1);
+    ASSERT_EQ(anv_hashset_shrink_to_fit(NULL), -1);
+
+    anv_hashset_destroy(set, false);
+    return TEST_SUCCESS;
+}
+
+#ifdef ANVIL_WITH_SYSTEM
+// Crowds 64 consecutive keys into each home group, so probes regularly
+// cross from one worker's range into the next
+static size_t clustered_hash(const void* key)
+{
+    return (size_t)(*(const int*)key / 64) << 7;
+}
+
+// Check that two sets hold exactly the same keys
+static int same_keys(const ANVHashSet* expected, const ANVHashSet* actual)
+{
+    ASSERT_NOT_NULL(actual);
+    ASSERT_EQ(anv_hashset_size(actual), anv_hashset_size(expected));
+    ANVIterator it = anv_hashset_iterator(expected);
+    while (it.has_next(&it))
+    {
+        ASSERT_TRUE(anv_hashset_contains(actual, it.get(&it)));
+        it.next(&it);
+    }
+    it.destroy(&it);
+    return TEST_SUCCESS;
+}
+
+// Test that the parallel set operations match the serial ones for any
+// thread count
+int test_hashset_parallel_operations(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    const hash_func hashes[] = {anv_hash_int, clustered_hash};
+    const size_t thread_counts[] = {0, 1, 3, 8, ANV_HASHSET_MAX_THREADS + 10};
+    static int keys[60000];
+    for (int i = 0; i < 60000; i++)
+    {
+        keys[i] = i;
+    }
+
+    for (size_t h = 0; h < sizeof(hashes) / sizeof(hashes[0]); h++)
+    {
+        // set1 holds [0, 40000), set2 every third key of [20000, 60000)
+        ANVHashSet* set1 = anv_hashset_create(&alloc, hashes[h], anv_key_equals_int, 0);
+        ANVHashSet* set2 = anv_hashset_create(&alloc, hashes[h], anv_key_equals_int, 0);
+        ASSERT_NOT_NULL(set1);
+        ASSERT_NOT_NULL(set2);
+        for (int i = 0; i < 60000; i++)
+        {
+            if (i < 40000)
+            {
+                ASSERT_EQ(anv_hashset_add(set1, &keys[i]), 0);
+            }
+            if (i >= 20000 && i % 3 == 0)
+            {
+                ASSERT_EQ(anv_hashset_add(set2, &keys[i]), 0);
+            }
+        }
+
+        ANVHashSet* union_set = anv_hashset_union(set1, set2);
+        ANVHashSet* intersection_set = anv_hashset_intersection(set1, set2);
+        ANVHashSet* difference_set = anv_hashset_difference(set1, set2);
+        ASSERT_EQ(anv_hashset_size(union_set), 40000 + 6666);
+        ASSERT_EQ(anv_hashset_size(intersection_set), 6667);
+
+        for (size_t t = 0; t < sizeof(thread_counts) / sizeof(thread_counts[0]); t++)
+        {
+            ANVHashSet* result = anv_hashset_union_parallel(set1, set2, thread_counts[t]);
+            ASSERT_EQ(same_keys(union_set, result), TEST_SUCCESS);
+            anv_hashset_destroy(result, false);
+
+            result = anv_hashset_intersection_parallel(set1, set2, thread_counts[t]);
+            ASSERT_EQ(same_keys(intersection_set, result), TEST_SUCCESS);
+            anv_hashset_destroy(result, false);
+
+            result = anv_hashset_difference_parallel(set1, set2, thread_counts[t]);
+            ASSERT_EQ(same_keys(difference_set, result), TEST_SUCCESS);
+            anv_hashset_destroy(result, false);
+
+            // The result is a normal set afterwards
+            result = anv_hashset_difference_parallel(set1, NULL, thread_counts[t]);
+            ASSERT_EQ(same_keys(set1, result), TEST_SUCCESS);
+            ASSERT_EQ(anv_hashset_remove(result, &keys[5], false), 0);
+            ASSERT_EQ(anv_hashset_add(result, &keys[45000]), 0);
+            ASSERT_TRUE(anv_hashset_contains(result, &keys[45000]));
+            ASSERT_FALSE(anv_hashset_contains(result, &keys[5]));
+            anv_hashset_destroy(result, false);
+        }
+
+        anv_hashset_destroy(union_set, false);
+        anv_hashset_destroy(intersection_set, false);
+        anv_hashset_destroy(difference_set, false);
+        anv_hashset_destroy(set1, false);
+        anv_hashset_destroy(set2, false);
+    }
+
+    ASSERT_NULL(anv_hashset_union_parallel(NULL, NULL, 4));
+    ASSERT_NULL(anv_hashset_intersection_parallel(NULL, NULL, 4));
+    ASSERT_NULL(anv_hashset_difference_parallel(NULL, NULL, 4));
+    return TEST_SUCCESS;
+}
+
+// Test the parallel bulk build, including duplicate copies being freed
+int test_hashset_from_iterator_parallel(void)
+{
+    ANVAllocator alloc = create_int_allocator();
+    ANVArrayList* list = anv_arraylist_create(&alloc, 0);
+    ASSERT_NOT_NULL(list);
+
+    // Every key appears three times
+    static int keys[20000];
+    for (int round = 0; round < 3; round++)
+    {
+        for (int i = 0; i < 20000; i++)
+        {
+            keys[i] = i;
+            ASSERT_EQ(anv_arraylist_push_back(list, &keys[i]), 0);
+        }
+    }
+
+    const size_t thread_counts[] = {1, 4, 16};
+    for (size_t t = 0; t < sizeof(thread_counts) / sizeof(thread_counts[0]); t++)
+    {
+        for (int copy = 0; copy < 2; copy++)
+        {
+            ANVIterator it = anv_arraylist_iterator(list);
+            ANVHashSet* set = anv_hashset_from_iterator_parallel(&it, &alloc, clustered_hash,
+                                                                 anv_key_equals_int, copy, thread_counts[t]);
+            it.destroy(&it);
+            ASSERT_NOT_NULL(set);
+            ASSERT_EQ(anv_hashset_size(set), 20000);
+            for (int i = 0; i < 20000; i++)
+            {
+                ASSERT_TRUE(anv_hashset_contains(set, &keys[i]));
+            }
+            anv_hashset_destroy(set, copy);
+        }
+    }
+
+    // Transient pointers from the range iterator are copied as they are read
+    ANVIterator range_it = anv_iterator_range(0, 10000, 1, &alloc);
+    ANVHashSet* set = anv_hashset_from_iterator_parallel(&range_it, &alloc, anv_hash_int,
+                                                         anv_key_equals_int, true, 4);
+    range_it.destroy(&range_it);
+    ASSERT_NOT_NULL(set);
+    ASSERT_EQ(anv_hashset_size(set), 10000);
+    ASSERT_TRUE(anv_hashset_contains(set, &keys[9999]));
+    anv_hashset_destroy(set, true);
+
+    ANVIterator it = anv_arraylist_iterator(list);
+    ASSERT_NULL(anv_hashset_from_iterator_parallel(&it, NULL, anv_hash_int, anv_key_equals_int, false, 4));
+    it.destroy(&it);
+
+    anv_arraylist_destroy(list, false);
+    return TEST_SUCCESS;
+}
+#endif // ANVIL_WITH_SYSTEM
+
 typedef struct
 {
     int (*func)(void);
@@ -305,6 +507,11 @@ int main(void)
         {test_hashset_copy_properties, "test_hashset_copy_properties"},
         {test_hashset_operation_properties, "test_hashset_operation_properties"},
         {test_hashset_iterator_consistency, "test_hashset_iterator_consistency"},
+        {test_hashset_reserve_shrink, "test_hashset_reserve_shrink"},
+#ifdef ANVIL_WITH_SYSTEM
+        {test_hashset_parallel_operations, "test_hashset_parallel_operations"},
+        {test_hashset_from_iterator_parallel, "test_hashset_from_iterator_parallel"},
+#endif
     };
 
     printf("Running HashSet Properties tests...\n");
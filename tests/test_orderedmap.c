@@ -0,0 +1,348 @@
+//
+// OrderedMap tests
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "containers/OrderedMap.h"
+#include "TestAssert.h"
+#include "TestHelpers.h"
+
+#define MANY 5000
+
+// Check that iteration yields exactly expected[0..count) in order
+static int iterates_in_order(const ANVOrderedMap* map, int* const* expected, const size_t count)
+{
+    ANVIterator it = anv_orderedmap_iterator(map);
+    size_t i = 0;
+    int ok = 1;
+    while (it.has_next(&it))
+    {
+        const ANVPair* pair = it.get(&it);
+        if (i >= count || pair->first != expected[i])
+        {
+            ok = 0;
+            break;
+        }
+        i++;
+        it.next(&it);
+    }
+    it.destroy(&it);
+    return ok && i == count;
+}
+
+// Test basic put/get/contains and updates
+int test_orderedmap_put_get(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVOrderedMap* map = anv_orderedmap_create(&alloc, anv_hash_string, anv_key_equals_string, 0);
+    ASSERT_NOT_NULL(map);
+    ASSERT_TRUE(anv_orderedmap_is_empty(map));
+    ASSERT_EQ(map->index_width, 1);
+
+    char k1[] = "apple";
+    char k2[] = "banana";
+    int v1 = 1;
+    int v2 = 2;
+    int v3 = 3;
+
+    ASSERT_EQ(anv_orderedmap_put(map, k1, &v1), 0);
+    ASSERT_EQ(anv_orderedmap_put(map, k2, &v2), 0);
+    ASSERT_EQ(anv_orderedmap_size(map), 2);
+    ASSERT_EQ_PTR(anv_orderedmap_get(map, "apple"), &v1);
+    ASSERT_TRUE(anv_orderedmap_contains_key(map, "banana"));
+    ASSERT_FALSE(anv_orderedmap_contains_key(map, "cherry"));
+    ASSERT_NULL(anv_orderedmap_get(map, "cherry"));
+
+    void* old = NULL;
+    ASSERT_EQ(anv_orderedmap_put_replace(map, k1, &v3, &old), 0);
+    ASSERT_EQ_PTR(old, &v1);
+    ASSERT_EQ_PTR(anv_orderedmap_get(map, "apple"), &v3);
+    ASSERT_EQ(anv_orderedmap_size(map), 2);
+
+    ASSERT_EQ_PTR(anv_orderedmap_remove_get(map, "apple", false), &v3);
+    ASSERT_EQ(anv_orderedmap_remove(map, "banana", false, false), 0);
+    ASSERT_EQ(anv_orderedmap_remove(map, "banana", false, false), -1);
+    ASSERT_TRUE(anv_orderedmap_is_empty(map));
+    ASSERT_EQ(map->entry_count, 0); // Trailing holes are dropped
+
+    ASSERT_EQ(anv_orderedmap_put(NULL, k1, &v1), -1);
+    ASSERT_EQ(anv_orderedmap_put(map, NULL, &v1), -1);
+    ASSERT_NULL(anv_orderedmap_create(NULL, anv_hash_string, anv_key_equals_string, 0));
+
+    anv_orderedmap_destroy(map, false, false);
+    return TEST_SUCCESS;
+}
+
+// Test that iteration follows first insertion through updates, removals and growth
+int test_orderedmap_order(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVOrderedMap* map = anv_orderedmap_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(map);
+
+    int* keys = malloc(sizeof(int) * MANY);
+    int** expected = malloc(sizeof(int*) * MANY);
+    ASSERT_NOT_NULL(keys);
+    ASSERT_NOT_NULL(expected);
+
+    // Descending keys, so hash order and insertion order differ
+    for (int i = 0; i < MANY; i++)
+    {
+        keys[i] = (MANY - i) * 31;
+        ASSERT_EQ(anv_orderedmap_put(map, &keys[i], &keys[i]), 0);
+        expected[i] = &keys[i];
+    }
+    ASSERT_EQ(anv_orderedmap_size(map), MANY);
+    ASSERT_EQ(map->index_width, 2);
+    ASSERT_TRUE(iterates_in_order(map, expected, MANY));
+
+    // Updates keep position
+    for (int i = 0; i < MANY; i += 7)
+    {
+        ASSERT_EQ(anv_orderedmap_put(map, &keys[i], &keys[0]), 0);
+    }
+    ASSERT_TRUE(iterates_in_order(map, expected, MANY));
+    ASSERT_EQ_PTR(anv_orderedmap_get(map, &keys[7]), &keys[0]);
+
+    // Remove every third key, then re-add some: they move to the end
+    size_t count = 0;
+    for (int i = 0; i < MANY; i++)
+    {
+        if (i % 3 == 0)
+        {
+            ASSERT_EQ(anv_orderedmap_remove(map, &keys[i], false, false), 0);
+        }
+        else
+        {
+            expected[count++] = &keys[i];
+        }
+    }
+    ASSERT_TRUE(iterates_in_order(map, expected, count));
+    for (int i = 0; i < MANY; i++)
+    {
+        ASSERT_EQ(anv_orderedmap_contains_key(map, &keys[i]), i % 3 != 0);
+    }
+
+    for (int i = 0; i < 300; i += 3)
+    {
+        ASSERT_EQ(anv_orderedmap_put(map, &keys[i], &keys[i]), 0);
+        expected[count++] = &keys[i];
+    }
+    ASSERT_EQ(anv_orderedmap_size(map), count);
+    ASSERT_TRUE(iterates_in_order(map, expected, count));
+
+    free(expected);
+    free(keys);
+    anv_orderedmap_destroy(map, false, false);
+    return TEST_SUCCESS;
+}
+
+// Test that churn compacts the entry array instead of growing it
+int test_orderedmap_compaction(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVOrderedMap* map = anv_orderedmap_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(map);
+
+    static int keys[2000];
+    for (int i = 0; i < 2000; i++)
+    {
+        keys[i] = i;
+    }
+    for (int i = 0; i < 100; i++)
+    {
+        ASSERT_EQ(anv_orderedmap_put(map, &keys[i], &keys[i]), 0);
+    }
+
+    // A sliding window of 100 keys: remove the oldest, append a new one
+    size_t largest = 0;
+    for (int i = 100; i < 2000; i++)
+    {
+        ASSERT_EQ(anv_orderedmap_remove(map, &keys[i - 100], false, false), 0);
+        ASSERT_EQ(anv_orderedmap_put(map, &keys[i], &keys[i]), 0);
+        largest = map->entry_capacity > largest ? map->entry_capacity : largest;
+    }
+    ASSERT_EQ(anv_orderedmap_size(map), 100);
+    ASSERT_LTE(largest, 200);
+
+    int* expected[100];
+    for (int i = 0; i < 100; i++)
+    {
+        expected[i] = &keys[1900 + i];
+        ASSERT_EQ_PTR(anv_orderedmap_get(map, &keys[1900 + i]), &keys[1900 + i]);
+    }
+    ASSERT_TRUE(iterates_in_order(map, expected, 100));
+    ASSERT_FALSE(anv_orderedmap_contains_key(map, &keys[1899]));
+
+    anv_orderedmap_destroy(map, false, false);
+    return TEST_SUCCESS;
+}
+
+// Test forward and backward iteration across holes
+int test_orderedmap_iterator(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVOrderedMap* map = anv_orderedmap_create(&alloc, anv_hash_int, anv_key_equals_int, 10);
+    ASSERT_NOT_NULL(map);
+
+    int keys[10];
+    for (int i = 0; i < 10; i++)
+    {
+        keys[i] = i;
+        ASSERT_EQ(anv_orderedmap_put(map, &keys[i], &keys[i]), 0);
+    }
+    ASSERT_EQ(anv_orderedmap_remove(map, &keys[0], false, false), 0);
+    ASSERT_EQ(anv_orderedmap_remove(map, &keys[4], false, false), 0);
+    ASSERT_EQ(anv_orderedmap_remove(map, &keys[5], false, false), 0);
+
+    ANVIterator it = anv_orderedmap_iterator(map);
+    ASSERT_TRUE(it.is_valid(&it));
+    ASSERT_FALSE(it.has_prev(&it));
+    ASSERT_EQ(*(int*)((const ANVPair*)it.get(&it))->first, 1);
+
+    int visited[7];
+    size_t count = 0;
+    while (it.has_next(&it))
+    {
+        visited[count++] = *(int*)((const ANVPair*)it.get(&it))->first;
+        it.next(&it);
+    }
+    ASSERT_EQ(count, 7);
+    const int forward[] = {1, 2, 3, 6, 7, 8, 9};
+    for (size_t i = 0; i < 7; i++)
+    {
+        ASSERT_EQ(visited[i], forward[i]);
+    }
+
+    // Walk back from the end
+    ASSERT_NULL(it.get(&it));
+    ASSERT_EQ(it.prev(&it), 0);
+    ASSERT_EQ(*(int*)((const ANVPair*)it.get(&it))->first, 9);
+    ASSERT_EQ(it.prev(&it), 0);
+    ASSERT_EQ(it.prev(&it), 0);
+    ASSERT_EQ(it.prev(&it), 0);
+    ASSERT_EQ(*(int*)((const ANVPair*)it.get(&it))->first, 6);
+    ASSERT_EQ(it.prev(&it), 0);
+    ASSERT_EQ(*(int*)((const ANVPair*)it.get(&it))->first, 3);
+    ASSERT_EQ(it.prev(&it), 0);
+    ASSERT_EQ(it.prev(&it), 0);
+    ASSERT_FALSE(it.has_prev(&it));
+    ASSERT_EQ(it.prev(&it), -1);
+
+    it.reset(&it);
+    ASSERT_EQ(*(int*)((const ANVPair*)it.get(&it))->first, 1);
+    it.destroy(&it);
+
+    anv_orderedmap_destroy(map, false, false);
+    return TEST_SUCCESS;
+}
+
+// Test reserve and shrink_to_fit
+int test_orderedmap_capacity(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVOrderedMap* map = anv_orderedmap_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(map);
+
+    ASSERT_EQ(anv_orderedmap_reserve(map, MANY), 0);
+    const size_t entry_capacity = map->entry_capacity;
+    ASSERT(entry_capacity >= MANY);
+
+    int* keys = malloc(sizeof(int) * MANY);
+    ASSERT_NOT_NULL(keys);
+    for (int i = 0; i < MANY; i++)
+    {
+        keys[i] = i;
+        ASSERT_EQ(anv_orderedmap_put(map, &keys[i], &keys[i]), 0);
+    }
+    ASSERT_EQ(map->entry_capacity, entry_capacity); // No growth after reserve
+
+    for (int i = 10; i < MANY; i++)
+    {
+        ASSERT_EQ(anv_orderedmap_remove(map, &keys[i - 10], false, false), 0);
+    }
+    const size_t before = anv_orderedmap_memory_usage(map);
+    ASSERT_EQ(anv_orderedmap_shrink_to_fit(map), 0);
+    ASSERT(anv_orderedmap_memory_usage(map) < before);
+    ASSERT_EQ(map->entry_count, 10);
+    ASSERT_EQ(map->index_width, 1);
+    for (int i = MANY - 10; i < MANY; i++)
+    {
+        ASSERT_EQ_PTR(anv_orderedmap_get(map, &keys[i]), &keys[i]);
+    }
+    ASSERT_EQ(anv_orderedmap_memory_usage(map),
+              sizeof(ANVOrderedMap) + map->entry_capacity * sizeof(ANVOrderedMapEntry) + map->index_capacity);
+
+    free(keys);
+    anv_orderedmap_destroy(map, false, false);
+    return TEST_SUCCESS;
+}
+
+// Test that owned keys and values are released through the allocator
+int test_orderedmap_free_data(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVOrderedMap* map = anv_orderedmap_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(map);
+
+    for (int i = 0; i < 50; i++)
+    {
+        int* key = malloc(sizeof(int));
+        int* value = malloc(sizeof(int));
+        ASSERT_NOT_NULL(key);
+        ASSERT_NOT_NULL(value);
+        *key = i;
+        *value = i * 2;
+        ASSERT_EQ(anv_orderedmap_put(map, key, value), 0);
+    }
+
+    const int probe = 7;
+    ASSERT_EQ(*(int*)anv_orderedmap_get(map, &probe), 14);
+    ASSERT_EQ(anv_orderedmap_remove(map, &probe, true, true), 0);
+
+    anv_orderedmap_destroy(map, true, true);
+    return TEST_SUCCESS;
+}
+
+typedef struct
+{
+    int (*func)(void);
+    const char* name;
+} TestCase;
+
+int main(void)
+{
+    const TestCase tests[] = {
+        {test_orderedmap_put_get, "test_orderedmap_put_get"},
+        {test_orderedmap_order, "test_orderedmap_order"},
+        {test_orderedmap_compaction, "test_orderedmap_compaction"},
+        {test_orderedmap_iterator, "test_orderedmap_iterator"},
+        {test_orderedmap_capacity, "test_orderedmap_capacity"},
+        {test_orderedmap_free_data, "test_orderedmap_free_data"},
+    };
+
+    printf("Running OrderedMap tests...\n");
+
+    int failed = 0;
+    const int num_tests = sizeof(tests) / sizeof(tests[0]);
+    for (int i = 0; i < num_tests; i++)
+    {
+        if (tests[i].func() != TEST_SUCCESS)
+        {
+            printf("%s failed\n", tests[i].name);
+            failed++;
+        }
+    }
+
+    if (failed == 0)
+    {
+        printf("All OrderedMap tests passed!\n");
+        return 0;
+    }
+
+    printf("%d OrderedMap tests failed.\n", failed);
+    return 1;
+}
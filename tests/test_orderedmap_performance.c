@@ -0,0 +1,157 @@
+//
+// OrderedMap performance test - memory, insertion, lookup and in-order
+// iteration versus a HashMap paired with a DoublyLinkedList of keys
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "containers/DoublyLinkedList.h"
+#include "containers/HashMap.h"
+#include "containers/OrderedMap.h"
+#include "TestAssert.h"
+#include "TestHelpers.h"
+
+#define NUM_KEYS 200000
+#define ROUNDS 10
+
+int test_orderedmap_performance_versus_paired(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVHashMap* paired_map = anv_hashmap_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ANVDoublyLinkedList* paired_order = anv_dll_create(&alloc);
+    ANVOrderedMap* ordered = anv_orderedmap_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(paired_map);
+    ASSERT_NOT_NULL(paired_order);
+    ASSERT_NOT_NULL(ordered);
+
+    int* keys = malloc(sizeof(int) * NUM_KEYS);
+    ASSERT_NOT_NULL(keys);
+    for (int i = 0; i < NUM_KEYS; i++)
+    {
+        keys[i] = i * 7 + 3;
+    }
+
+    double start = now_seconds();
+    for (int i = 0; i < NUM_KEYS; i++)
+    {
+        ASSERT_EQ(anv_hashmap_put(paired_map, &keys[i], &keys[i]), 0);
+        ASSERT_EQ(anv_dll_push_back(paired_order, &keys[i]), 0);
+    }
+    const double paired_insert = now_seconds() - start;
+
+    start = now_seconds();
+    for (int i = 0; i < NUM_KEYS; i++)
+    {
+        ASSERT_EQ(anv_orderedmap_put(ordered, &keys[i], &keys[i]), 0);
+    }
+    const double ordered_insert = now_seconds() - start;
+
+    size_t paired_hits = 0;
+    start = now_seconds();
+    for (int round = 0; round < ROUNDS; round++)
+    {
+        for (int i = 0; i < NUM_KEYS; i++)
+        {
+            paired_hits += anv_hashmap_get(paired_map, &keys[(i * 7919) % NUM_KEYS]) != NULL;
+        }
+    }
+    const double paired_lookup = now_seconds() - start;
+
+    size_t ordered_hits = 0;
+    start = now_seconds();
+    for (int round = 0; round < ROUNDS; round++)
+    {
+        for (int i = 0; i < NUM_KEYS; i++)
+        {
+            ordered_hits += anv_orderedmap_get(ordered, &keys[(i * 7919) % NUM_KEYS]) != NULL;
+        }
+    }
+    const double ordered_lookup = now_seconds() - start;
+    ASSERT_EQ(ordered_hits, paired_hits);
+
+    // In-order traversal: list order plus a map lookup per key, against one array scan
+    long long paired_sum = 0;
+    start = now_seconds();
+    for (int round = 0; round < ROUNDS; round++)
+    {
+        ANVIterator it = anv_dll_iterator(paired_order);
+        while (it.has_next(&it))
+        {
+            const int* key = it.get(&it);
+            paired_sum += *(const int*)anv_hashmap_get(paired_map, key);
+            it.next(&it);
+        }
+        it.destroy(&it);
+    }
+    const double paired_iterate = now_seconds() - start;
+
+    long long ordered_sum = 0;
+    start = now_seconds();
+    for (int round = 0; round < ROUNDS; round++)
+    {
+        ANVIterator it = anv_orderedmap_iterator(ordered);
+        while (it.has_next(&it))
+        {
+            const ANVPair* pair = it.get(&it);
+            ordered_sum += *(const int*)pair->second;
+            it.next(&it);
+        }
+        it.destroy(&it);
+    }
+    const double ordered_iterate = now_seconds() - start;
+    ASSERT_EQ(ordered_sum, paired_sum);
+
+    const size_t paired_bytes = anv_hashmap_memory_usage(paired_map) + anv_dll_memory_usage(paired_order);
+    const size_t ordered_bytes = anv_orderedmap_memory_usage(ordered);
+    const double ops = (double)NUM_KEYS * ROUNDS;
+    printf("Insert %d keys: HashMap+DLL %.3f s, OrderedMap %.3f s\n", NUM_KEYS, paired_insert, ordered_insert);
+    printf("Lookups: HashMap+DLL %.1f ns/op, OrderedMap %.1f ns/op\n",
+           paired_lookup / ops * 1e9, ordered_lookup / ops * 1e9);
+    printf("In-order iteration: HashMap+DLL %.1f ns/entry, OrderedMap %.1f ns/entry\n",
+           paired_iterate / ops * 1e9, ordered_iterate / ops * 1e9);
+    printf("Memory: HashMap+DLL %zu bytes, OrderedMap %zu bytes (%.0f%%)\n", paired_bytes, ordered_bytes,
+           100.0 * (double)ordered_bytes / (double)paired_bytes);
+    ASSERT(ordered_bytes < paired_bytes);
+
+    free(keys);
+    anv_dll_destroy(paired_order, false);
+    anv_hashmap_destroy(paired_map, false, false);
+    anv_orderedmap_destroy(ordered, false, false);
+    return TEST_SUCCESS;
+}
+
+typedef struct
+{
+    int (*func)(void);
+    const char* name;
+} TestCase;
+
+int main(void)
+{
+    const TestCase tests[] = {
+        {test_orderedmap_performance_versus_paired, "test_orderedmap_performance_versus_paired"},
+    };
+
+    printf("Running OrderedMap performance tests...\n");
+
+    int failed = 0;
+    const int num_tests = sizeof(tests) / sizeof(tests[0]);
+    for (int i = 0; i < num_tests; i++)
+    {
+        if (tests[i].func() != TEST_SUCCESS)
+        {
+            printf("%s failed\n", tests[i].name);
+            failed++;
+        }
+    }
+
+    if (failed == 0)
+    {
+        printf("All OrderedMap performance tests passed!\n");
+        return 0;
+    }
+
+    printf("%d OrderedMap performance tests failed.\n", failed);
+    return 1;
+}
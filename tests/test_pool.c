@@ -0,0 +1,250 @@
+//
+// Fixed-size pool allocator tests
+//
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "memory/Pool.h"
+#include "containers/BinarySearchTree.h"
+#include "containers/DoublyLinkedList.h"
+#include "containers/HashMap.h"
+#include "containers/Queue.h"
+#include "containers/SinglyLinkedList.h"
+#include "containers/Stack.h"
+#include "TestAssert.h"
+#include "TestHelpers.h"
+
+// Test basic allocation, reuse and stats
+int test_pool_alloc_free_reuse(void)
+{
+    ANVAllocator backing = anv_alloc_default();
+    ANVPool* pool = anv_pool_create(&backing, 24, 8);
+    ASSERT_NOT_NULL(pool);
+
+    void* objects[20];
+    for (int i = 0; i < 20; i++)
+    {
+        objects[i] = anv_pool_alloc(pool);
+        ASSERT_NOT_NULL(objects[i]);
+        ASSERT_EQ((uintptr_t)objects[i] % _Alignof(max_align_t), 0);
+        ASSERT_TRUE(anv_pool_owns(pool, objects[i]));
+    }
+
+    ANVPoolStats stats;
+    ASSERT_EQ(anv_pool_stats(pool, &stats), 0);
+    ASSERT_EQ(stats.live_objects, 20);
+    ASSERT_EQ(stats.high_water, 20);
+    ASSERT_EQ(stats.slab_count, 3);
+    ASSERT_EQ(stats.capacity, 24);
+
+    // Freed objects are handed out again before new slabs are created
+    anv_pool_free(pool, objects[5]);
+    anv_pool_free(pool, objects[6]);
+    void* again = anv_pool_alloc(pool);
+    ASSERT(again == objects[6] || again == objects[5]);
+
+    ASSERT_EQ(anv_pool_stats(pool, &stats), 0);
+    ASSERT_EQ(stats.live_objects, 19);
+    ASSERT_EQ(stats.high_water, 20);
+    ASSERT_EQ(stats.slab_count, 3);
+
+    int local = 0;
+    ASSERT_FALSE(anv_pool_owns(pool, &local));
+
+    anv_pool_destroy(pool);
+    return TEST_SUCCESS;
+}
+
+// Test invalid arguments
+int test_pool_invalid(void)
+{
+    ANVAllocator backing = anv_alloc_default();
+    ASSERT_NULL(anv_pool_create(NULL, 16, 0));
+    ASSERT_NULL(anv_pool_create(&backing, 0, 0));
+    ASSERT_NULL(anv_pool_alloc(NULL));
+    anv_pool_free(NULL, NULL);
+
+    ANVPoolStats stats;
+    ASSERT_EQ(anv_pool_stats(NULL, &stats), -1);
+    return TEST_SUCCESS;
+}
+
+// Test allocator view routing by size
+int test_pool_allocator_view(void)
+{
+    ANVAllocator backing = anv_alloc_default();
+    ANVPool* pool = anv_pool_create(&backing, 32, 0);
+    ASSERT_NOT_NULL(pool);
+
+    const ANVAllocator alloc = anv_pool_allocator(pool);
+
+    void* small = anv_alloc_malloc(&alloc, 16);
+    void* large = anv_alloc_malloc(&alloc, 4096);
+    ASSERT_TRUE(anv_pool_owns(pool, small));
+    ASSERT_FALSE(anv_pool_owns(pool, large));
+    ASSERT_EQ(pool->live_objects, 1);
+
+    // Unsized frees are routed by ownership
+    anv_alloc_free(&alloc, large);
+    anv_alloc_free(&alloc, small);
+    ASSERT_EQ(pool->live_objects, 0);
+
+    anv_pool_destroy(pool);
+    return TEST_SUCCESS;
+}
+
+// Test linked containers drawing nodes from the pool
+int test_pool_linked_containers(void)
+{
+    ANVAllocator backing = anv_alloc_default();
+    int values[300];
+    for (int i = 0; i < 300; i++)
+    {
+        values[i] = i;
+    }
+
+    ANVPool* sll_pool = anv_pool_create(&backing, sizeof(ANVSinglyLinkedNode), 64);
+    ANVAllocator sll_alloc = anv_pool_allocator(sll_pool);
+    ANVSinglyLinkedList* sll = anv_sll_create(&sll_alloc);
+    ASSERT_NOT_NULL(sll);
+
+    ANVPool* dll_pool = anv_pool_create(&backing, sizeof(ANVDoublyLinkedNode), 64);
+    ANVAllocator dll_alloc = anv_pool_allocator(dll_pool);
+    ANVDoublyLinkedList* dll = anv_dll_create(&dll_alloc);
+    ASSERT_NOT_NULL(dll);
+
+    ANVPool* stack_pool = anv_pool_create(&backing, sizeof(ANVStackNode), 64);
+    ANVAllocator stack_alloc = anv_pool_allocator(stack_pool);
+    ANVStack* stack = anv_stack_create(&stack_alloc);
+    ASSERT_NOT_NULL(stack);
+
+    ANVPool* queue_pool = anv_pool_create(&backing, sizeof(ANVQueueNode), 64);
+    ANVAllocator queue_alloc = anv_pool_allocator(queue_pool);
+    ANVQueue* queue = anv_queue_create(&queue_alloc);
+    ASSERT_NOT_NULL(queue);
+
+    for (int i = 0; i < 300; i++)
+    {
+        ASSERT_EQ(anv_sll_push_back(sll, &values[i]), 0);
+        ASSERT_EQ(anv_dll_push_back(dll, &values[i]), 0);
+        ASSERT_EQ(anv_stack_push(stack, &values[i]), 0);
+        ASSERT_EQ(anv_queue_enqueue(queue, &values[i]), 0);
+    }
+
+    // Nodes are slab allocated: 300 nodes fit in 5 slabs of 64
+    ANVPoolStats stats;
+    ASSERT_EQ(anv_pool_stats(dll_pool, &stats), 0);
+    ASSERT_GTE(stats.live_objects, 300);
+    ASSERT_LTE(stats.slab_count, 6);
+
+    for (int i = 0; i < 150; i++)
+    {
+        ASSERT_EQ(anv_stack_pop(stack, false), 0);
+        ASSERT_EQ(anv_queue_dequeue(queue, false), 0);
+    }
+    ASSERT_EQ(anv_pool_stats(stack_pool, &stats), 0);
+    ASSERT_GTE(stats.high_water, 300);
+    ASSERT_LT(stats.live_objects, stats.high_water);
+
+    anv_sll_destroy(sll, false);
+    anv_dll_destroy(dll, false);
+    anv_stack_destroy(stack, false);
+    anv_queue_destroy(queue, false);
+
+    ASSERT_EQ(sll_pool->live_objects, 0);
+    ASSERT_EQ(dll_pool->live_objects, 0);
+    ASSERT_EQ(stack_pool->live_objects, 0);
+    ASSERT_EQ(queue_pool->live_objects, 0);
+
+    anv_pool_destroy(sll_pool);
+    anv_pool_destroy(dll_pool);
+    anv_pool_destroy(stack_pool);
+    anv_pool_destroy(queue_pool);
+    return TEST_SUCCESS;
+}
+
+// Test tree and hash map nodes drawn from a pool
+int test_pool_bst_and_hashmap(void)
+{
+    ANVAllocator backing = anv_alloc_default();
+    int values[500];
+    for (int i = 0; i < 500; i++)
+    {
+        values[i] = (i * 7919) % 500;
+    }
+
+    ANVPool* bst_pool = anv_pool_create(&backing, sizeof(ANVBinarySearchTreeNode), 0);
+    ANVAllocator bst_alloc = anv_pool_allocator(bst_pool);
+    ANVBinarySearchTree* tree = anv_bst_create(&bst_alloc, int_cmp);
+    ASSERT_NOT_NULL(tree);
+
+    ANVPool* map_pool = anv_pool_create(&backing, sizeof(ANVHashMapNode), 0);
+    ANVAllocator map_alloc = anv_pool_allocator(map_pool);
+    ANVHashMap* map = anv_hashmap_create(&map_alloc, anv_hash_int, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(map);
+
+    for (int i = 0; i < 500; i++)
+    {
+        ASSERT_EQ(anv_bst_insert(tree, &values[i]), 0);
+        ASSERT_EQ(anv_hashmap_put(map, &values[i], &values[i]), 0);
+    }
+
+    for (int i = 0; i < 250; i++)
+    {
+        ASSERT_EQ(anv_bst_remove(tree, &values[i], false), 0);
+        ASSERT_EQ(anv_hashmap_remove(map, &values[i], false, false), 0);
+    }
+
+    ASSERT_EQ(map_pool->live_objects, 250);
+    ASSERT_EQ(map_pool->high_water, 500);
+
+    anv_bst_destroy(tree, false);
+    anv_hashmap_destroy(map, false, false);
+    ASSERT_EQ(bst_pool->live_objects, 0);
+    ASSERT_EQ(map_pool->live_objects, 0);
+
+    anv_pool_destroy(bst_pool);
+    anv_pool_destroy(map_pool);
+    return TEST_SUCCESS;
+}
+
+typedef struct
+{
+    int (*func)(void);
+    const char* name;
+} TestCase;
+
+int main(void)
+{
+    const TestCase tests[] = {
+        {test_pool_alloc_free_reuse, "test_pool_alloc_free_reuse"},
+        {test_pool_invalid, "test_pool_invalid"},
+        {test_pool_allocator_view, "test_pool_allocator_view"},
+        {test_pool_linked_containers, "test_pool_linked_containers"},
+        {test_pool_bst_and_hashmap, "test_pool_bst_and_hashmap"},
+    };
+
+    printf("Running Pool tests...\n");
+
+    int failed = 0;
+    const int num_tests = sizeof(tests) / sizeof(tests[0]);
+    for (int i = 0; i < num_tests; i++)
+    {
+        if (tests[i].func() != TEST_SUCCESS)
+        {
+            printf("%s failed\n", tests[i].name);
+            failed++;
+        }
+    }
+
+    if (failed == 0)
+    {
+        printf("All Pool tests passed!\n");
+        return 0;
+    }
+
+    printf("%d Pool tests failed.\n", failed);
+    return 1;
+}
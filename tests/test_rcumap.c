@@ -0,0 +1,408 @@
+//
+// RcuMap tests
+//
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "containers/RcuMap.h"
+#include "system/Threads.h"
+#include "TestAssert.h"
+#include "TestHelpers.h"
+
+#define NUM_READERS 4
+#define STABLE_KEYS 1000
+#define CHURN_KEYS 1000
+#define CHURN_ROUNDS 30
+#define MANY_MAPS 20
+
+static atomic_size_t record_allocations;
+
+// Default allocation, counting the cache-line-aligned reader record blocks
+static void* counting_malloc(const size_t size)
+{
+    if (size == 128)
+    {
+        atomic_fetch_add(&record_allocations, 1);
+    }
+    return malloc(size);
+}
+
+static int* new_int(const ANVAllocator* alloc, const int value)
+{
+    int* p = anv_alloc_malloc(alloc, sizeof(int));
+    if (p)
+    {
+        *p = value;
+    }
+    return p;
+}
+
+// Reclamation needs two epoch advances after the last retire
+static size_t drain_retired(ANVRcuMap* map)
+{
+    size_t pending = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        pending = anv_rcumap_retired_count(map);
+    }
+    return pending;
+}
+
+// Test the single-threaded API surface, including growth
+int test_rcumap_basic(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVRcuMap* map = anv_rcumap_create(&alloc, anv_hash_string, anv_key_equals_string, 0);
+    ASSERT_NOT_NULL(map);
+    ASSERT_TRUE(anv_rcumap_is_empty(map));
+
+    char k1[] = "alpha";
+    char k2[] = "beta";
+    int v1 = 1;
+    int v2 = 2;
+
+    ASSERT_EQ(anv_rcumap_put(map, k1, &v1), 0);
+    ASSERT_EQ(anv_rcumap_put(map, k2, &v2), 0);
+    ASSERT_EQ(anv_rcumap_size(map), 2);
+    ASSERT_EQ_PTR(anv_rcumap_get(map, "alpha"), &v1);
+    ASSERT_TRUE(anv_rcumap_contains_key(map, "beta"));
+    ASSERT_FALSE(anv_rcumap_contains_key(map, "gamma"));
+    ASSERT_NULL(anv_rcumap_get(map, "gamma"));
+
+    void* old = NULL;
+    ASSERT_EQ(anv_rcumap_put_replace(map, k1, &v2, &old), 0);
+    ASSERT_EQ_PTR(old, &v1);
+    ASSERT_EQ(anv_rcumap_size(map), 2);
+
+    ASSERT_EQ_PTR(anv_rcumap_remove_get(map, "alpha", false), &v2);
+    ASSERT_EQ(anv_rcumap_remove(map, "beta", false, false), 0);
+    ASSERT_EQ(anv_rcumap_remove(map, "beta", false, false), -1);
+    ASSERT_TRUE(anv_rcumap_is_empty(map));
+
+    ASSERT_EQ(anv_rcumap_put(NULL, k1, &v1), -1);
+    ASSERT_EQ(anv_rcumap_put(map, NULL, &v1), -1);
+    ASSERT_NULL(anv_rcumap_create(NULL, anv_hash_string, anv_key_equals_string, 0));
+    ASSERT_NULL(anv_rcumap_create(&alloc, NULL, anv_key_equals_string, 0));
+    anv_rcumap_destroy(map, false, false);
+
+    // Grow well past the initial table, with owned keys and values
+    map = anv_rcumap_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(map);
+    for (int i = 0; i < 5000; i++)
+    {
+        ASSERT_EQ(anv_rcumap_put(map, new_int(&alloc, i), new_int(&alloc, i)), 0);
+    }
+    ASSERT_EQ(anv_rcumap_size(map), 5000);
+    for (int i = 0; i < 5000; i++)
+    {
+        const int* value = anv_rcumap_get(map, &i);
+        ASSERT_NOT_NULL(value);
+        ASSERT_EQ(*value, i);
+    }
+
+    for (int i = 0; i < 5000; i += 2)
+    {
+        ASSERT_EQ(anv_rcumap_put_with_free(map, &i, new_int(&alloc, -i), true), 0);
+    }
+    for (int i = 1; i < 5000; i += 2)
+    {
+        ASSERT_EQ(anv_rcumap_remove(map, &i, true, true), 0);
+    }
+    ASSERT_EQ(anv_rcumap_size(map), 2500);
+    ASSERT_EQ(*(const int*)anv_rcumap_get(map, &(int) {42}), -42);
+
+    // No readers, so everything retired is reclaimed promptly
+    ASSERT_EQ(drain_retired(map), 0);
+
+    anv_rcumap_destroy(map, true, true);
+    return TEST_SUCCESS;
+}
+
+// Test that an open read-side section holds back reclamation, and nests
+int test_rcumap_read_lock(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVRcuMap* map = anv_rcumap_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(map);
+
+    static int keys[100];
+    for (int i = 0; i < 100; i++)
+    {
+        keys[i] = i;
+        ASSERT_EQ(anv_rcumap_put(map, &keys[i], new_int(&alloc, i)), 0);
+    }
+
+    anv_rcumap_read_lock(map);
+    const int* value = anv_rcumap_get(map, &keys[7]);
+    ASSERT_NOT_NULL(value);
+
+    anv_rcumap_read_lock(map);
+    ASSERT_EQ(anv_rcumap_remove(map, &keys[7], false, true), 0);
+    anv_rcumap_read_unlock(map);
+
+    // Still inside the outer section: the value must stay readable
+    ASSERT(drain_retired(map) > 0);
+    ASSERT_EQ(*value, 7);
+    ASSERT_FALSE(anv_rcumap_contains_key(map, &keys[7]));
+
+    anv_rcumap_read_unlock(map);
+    ASSERT_EQ(drain_retired(map), 0);
+
+    // Destroy also reclaims anything still pending
+    anv_rcumap_read_lock(map);
+    ASSERT_EQ(anv_rcumap_remove(map, &keys[8], false, true), 0);
+    anv_rcumap_read_unlock(map);
+
+    anv_rcumap_destroy(map, false, true);
+    return TEST_SUCCESS;
+}
+
+// Test that a section stays open while the thread reads more maps than its
+// thread-local table holds, and that revisits reuse the thread's records
+int test_rcumap_many_maps(void)
+{
+    ANVAllocator alloc = anv_alloc_custom(counting_malloc, free, free, NULL);
+    ANVRcuMap* maps[MANY_MAPS];
+    static int keys[MANY_MAPS];
+    for (int i = 0; i < MANY_MAPS; i++)
+    {
+        keys[i] = i;
+        maps[i] = anv_rcumap_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+        ASSERT_NOT_NULL(maps[i]);
+        ASSERT_EQ(anv_rcumap_put(maps[i], &keys[i], new_int(&alloc, i)), 0);
+    }
+
+    anv_rcumap_read_lock(maps[0]);
+    const int* value = anv_rcumap_get(maps[0], &keys[0]);
+    ASSERT_NOT_NULL(value);
+
+    const size_t before = atomic_load(&record_allocations);
+    for (int round = 0; round < 3; round++)
+    {
+        for (int i = 1; i < MANY_MAPS; i++)
+        {
+            ASSERT_EQ(*(const int*)anv_rcumap_get(maps[i], &keys[i]), i);
+        }
+    }
+    ASSERT_EQ(atomic_load(&record_allocations) - before, MANY_MAPS - 1);
+
+    // The open section on maps[0] still holds back reclamation
+    ASSERT_EQ(anv_rcumap_remove(maps[0], &keys[0], false, true), 0);
+    ASSERT(drain_retired(maps[0]) > 0);
+    ASSERT_EQ(*value, 0);
+    ASSERT_EQ(anv_rcumap_release_thread(maps[0]), -1);
+    anv_rcumap_read_unlock(maps[0]);
+    ASSERT_EQ(drain_retired(maps[0]), 0);
+
+    for (int i = 0; i < MANY_MAPS; i++)
+    {
+        anv_rcumap_destroy(maps[i], false, true);
+    }
+    return TEST_SUCCESS;
+}
+
+static void* read_and_release(void* arg)
+{
+    ANVRcuMap* map = arg;
+    const int key = 1;
+    const int* value = anv_rcumap_get(map, &key);
+    anv_rcumap_release_thread(map);
+    return (void*)value;
+}
+
+// Test that a released record is claimed by the next thread to read
+int test_rcumap_release_thread(void)
+{
+    ANVAllocator alloc = anv_alloc_custom(counting_malloc, free, free, NULL);
+    ANVRcuMap* map = anv_rcumap_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(map);
+    static int key = 1;
+    static int value = 10;
+    ASSERT_EQ(anv_rcumap_put(map, &key, &value), 0);
+
+    // The calling thread takes a record and gives it back
+    ASSERT_EQ(anv_rcumap_release_thread(NULL), -1);
+    ASSERT_EQ(anv_rcumap_release_thread(map), 0);
+    const size_t before = atomic_load(&record_allocations);
+    ASSERT_EQ_PTR(anv_rcumap_get(map, &key), &value);
+    ASSERT_EQ(anv_rcumap_release_thread(map), 0);
+    ASSERT_EQ(atomic_load(&record_allocations) - before, 1);
+
+    for (int i = 0; i < 10; i++)
+    {
+        ANVThread thread;
+        void* result = NULL;
+        ASSERT_EQ(anv_thread_create(&thread, read_and_release, map), 0);
+        ASSERT_EQ(anv_thread_join(thread, &result), 0);
+        ASSERT_EQ_PTR(result, &value);
+    }
+    ASSERT_EQ(atomic_load(&record_allocations) - before, 1);
+
+    anv_rcumap_destroy(map, false, false);
+    return TEST_SUCCESS;
+}
+
+// Test that a write inside a read-side section fails cleanly when it cannot
+// defer its frees, instead of waiting for its own section to end
+int test_rcumap_out_of_memory(void)
+{
+    ANVAllocator alloc = create_failing_int_allocator();
+    ANVRcuMap* map = anv_rcumap_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(map);
+    static int keys[2] = {0, 1};
+    ASSERT_EQ(anv_rcumap_put(map, &keys[0], new_int(&alloc, 0)), 0);
+    ASSERT_EQ(anv_rcumap_put(map, &keys[1], new_int(&alloc, 1)), 0);
+
+    anv_rcumap_read_lock(map);
+    set_alloc_fail_countdown(0);
+    ASSERT_EQ(anv_rcumap_remove(map, &keys[0], false, true), -1);
+    ASSERT_EQ(anv_rcumap_put_with_free(map, &keys[1], &keys[1], true), -1);
+    set_alloc_fail_countdown(-1);
+    ASSERT_EQ(anv_rcumap_size(map), 2);
+    ASSERT_EQ(*(const int*)anv_rcumap_get(map, &keys[1]), 1);
+
+    ASSERT_EQ(anv_rcumap_remove(map, &keys[0], false, true), 0);
+    anv_rcumap_read_unlock(map);
+    ASSERT_EQ(drain_retired(map), 0);
+
+    anv_rcumap_destroy(map, false, true);
+    return TEST_SUCCESS;
+}
+
+typedef struct
+{
+    ANVRcuMap* map;
+    int* keys;
+    atomic_int* stop;
+    size_t reads;
+    int failed;
+} ReaderArg;
+
+// Repeatedly look up every key and dereference the values found; freed
+// memory would be caught by the sanitizer builds
+static void* reader(void* arg)
+{
+    ReaderArg* r = arg;
+    while (!atomic_load(r->stop))
+    {
+        for (int i = 0; i < STABLE_KEYS + CHURN_KEYS; i++)
+        {
+            anv_rcumap_read_lock(r->map);
+            const int* value = anv_rcumap_get(r->map, &r->keys[i]);
+            if (i < STABLE_KEYS && !value)
+            {
+                r->failed = 1;
+            }
+            if (value && *value != i && *value != -i)
+            {
+                r->failed = 1;
+            }
+            anv_rcumap_read_unlock(r->map);
+            r->reads++;
+        }
+    }
+    return NULL;
+}
+
+// Test lock-free readers against a writer that inserts, replaces and removes
+// with freeing enabled, forcing several table replacements
+int test_rcumap_concurrent_readers(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVRcuMap* map = anv_rcumap_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(map);
+
+    static int keys[STABLE_KEYS + CHURN_KEYS];
+    for (int i = 0; i < STABLE_KEYS + CHURN_KEYS; i++)
+    {
+        keys[i] = i;
+    }
+    for (int i = 0; i < STABLE_KEYS; i++)
+    {
+        ASSERT_EQ(anv_rcumap_put(map, &keys[i], new_int(&alloc, i)), 0);
+    }
+
+    atomic_int stop = 0;
+    ANVThread threads[NUM_READERS];
+    ReaderArg args[NUM_READERS];
+    for (int t = 0; t < NUM_READERS; t++)
+    {
+        args[t] = (ReaderArg) {map, keys, &stop, 0, 0};
+        ASSERT_EQ(anv_thread_create(&threads[t], reader, &args[t]), 0);
+    }
+
+    for (int round = 0; round < CHURN_ROUNDS; round++)
+    {
+        for (int i = STABLE_KEYS; i < STABLE_KEYS + CHURN_KEYS; i++)
+        {
+            ASSERT_EQ(anv_rcumap_put(map, &keys[i], new_int(&alloc, i)), 0);
+        }
+        for (int i = 0; i < STABLE_KEYS; i += 3)
+        {
+            const int sign = round % 2 ? -1 : 1;
+            ASSERT_EQ(anv_rcumap_put_with_free(map, &keys[i], new_int(&alloc, sign * i), true), 0);
+        }
+        for (int i = STABLE_KEYS; i < STABLE_KEYS + CHURN_KEYS; i++)
+        {
+            ASSERT_EQ(anv_rcumap_remove(map, &keys[i], false, true), 0);
+        }
+    }
+
+    atomic_store(&stop, 1);
+    size_t reads = 0;
+    for (int t = 0; t < NUM_READERS; t++)
+    {
+        ASSERT_EQ(anv_thread_join(threads[t], NULL), 0);
+        ASSERT_EQ(args[t].failed, 0);
+        reads += args[t].reads;
+    }
+    ASSERT(reads > 0);
+
+    ASSERT_EQ(anv_rcumap_size(map), STABLE_KEYS);
+    ASSERT_EQ(drain_retired(map), 0);
+
+    anv_rcumap_destroy(map, false, true);
+    return TEST_SUCCESS;
+}
+
+typedef struct
+{
+    int (*func)(void);
+    const char* name;
+} TestCase;
+
+int main(void)
+{
+    const TestCase tests[] = {
+        {test_rcumap_basic, "test_rcumap_basic"},
+        {test_rcumap_read_lock, "test_rcumap_read_lock"},
+        {test_rcumap_concurrent_readers, "test_rcumap_concurrent_readers"},
+        {test_rcumap_many_maps, "test_rcumap_many_maps"},
+        {test_rcumap_release_thread, "test_rcumap_release_thread"},
+        {test_rcumap_out_of_memory, "test_rcumap_out_of_memory"},
+    };
+
+    printf("Running RcuMap tests...\n");
+
+    int failed = 0;
+    const int num_tests = sizeof(tests) / sizeof(tests[0]);
+    for (int i = 0; i < num_tests; i++)
+    {
+        if (tests[i].func() != TEST_SUCCESS)
+        {
+            printf("%s failed\n", tests[i].name);
+            failed++;
+        }
+    }
+
+    if (failed == 0)
+    {
+        printf("All RcuMap tests passed!\n");
+        return 0;
+    }
+
+    printf("%d RcuMap tests failed.\n", failed);
+    return 1;
+}
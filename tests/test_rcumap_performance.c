@@ -0,0 +1,211 @@
+//
+// RcuMap performance test - lookup throughput versus a mutex-wrapped HashMap
+// as reader count grows, with and without a concurrent writer
+//
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "containers/HashMap.h"
+#include "containers/RcuMap.h"
+#include "system/Mutex.h"
+#include "system/Threads.h"
+#include "TestAssert.h"
+#include "TestHelpers.h"
+
+#define NUM_KEYS 100000
+#define OPS_PER_THREAD 500000
+#define MAX_THREADS 8
+
+typedef struct
+{
+    ANVHashMap* map;
+    ANVMutex lock;
+} LockedMap;
+
+typedef struct
+{
+    ANVRcuMap* rcu; // NULL selects the locked map
+    LockedMap* locked;
+    int* keys;
+    unsigned seed;
+    size_t hits;
+} ReaderArg;
+
+typedef struct
+{
+    ANVRcuMap* rcu;
+    LockedMap* locked;
+    int* keys;
+    atomic_int* stop;
+    size_t writes;
+} WriterArg;
+
+static void* reader(void* arg)
+{
+    ReaderArg* r = arg;
+    for (int i = 0; i < OPS_PER_THREAD; i++)
+    {
+        const int* key = &r->keys[next_random(&r->seed) % NUM_KEYS];
+        if (r->rcu)
+        {
+            r->hits += anv_rcumap_get(r->rcu, key) != NULL;
+        }
+        else
+        {
+            anv_mutex_lock(&r->locked->lock);
+            r->hits += anv_hashmap_get(r->locked->map, key) != NULL;
+            anv_mutex_unlock(&r->locked->lock);
+        }
+    }
+    return NULL;
+}
+
+// Overwrite values until the readers finish
+static void* writer(void* arg)
+{
+    WriterArg* w = arg;
+    unsigned seed = 4242u;
+    while (!atomic_load(w->stop))
+    {
+        int* key = &w->keys[next_random(&seed) % NUM_KEYS];
+        if (w->rcu)
+        {
+            anv_rcumap_put(w->rcu, key, key);
+        }
+        else
+        {
+            anv_mutex_lock(&w->locked->lock);
+            anv_hashmap_put(w->locked->map, key, key);
+            anv_mutex_unlock(&w->locked->lock);
+        }
+        w->writes++;
+    }
+    return NULL;
+}
+
+// Returns the time taken by the readers, or a negative value on failure
+static double run(ANVRcuMap* rcu, LockedMap* locked, int* keys, const int num_readers, const bool with_writer,
+                  size_t* hits_out)
+{
+    ANVThread threads[MAX_THREADS];
+    ReaderArg args[MAX_THREADS];
+    ANVThread writer_thread;
+    atomic_int stop = 0;
+    WriterArg writer_arg = {rcu, locked, keys, &stop, 0};
+
+    if (with_writer && anv_thread_create(&writer_thread, writer, &writer_arg) != 0)
+    {
+        return -1.0;
+    }
+
+    const double start = now_seconds();
+    for (int i = 0; i < num_readers; i++)
+    {
+        args[i] = (ReaderArg) {rcu, locked, keys, 777u + (unsigned)i, 0};
+        if (anv_thread_create(&threads[i], reader, &args[i]) != 0)
+        {
+            return -1.0;
+        }
+    }
+
+    *hits_out = 0;
+    for (int i = 0; i < num_readers; i++)
+    {
+        anv_thread_join(threads[i], NULL);
+        *hits_out += args[i].hits;
+    }
+    const double elapsed = now_seconds() - start;
+
+    if (with_writer)
+    {
+        atomic_store(&stop, 1);
+        anv_thread_join(writer_thread, NULL);
+    }
+    return elapsed;
+}
+
+// Sweep reader count, read-only and with one writer
+int test_rcumap_performance_read_scaling(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    int* keys = malloc(sizeof(int) * NUM_KEYS);
+    ASSERT_NOT_NULL(keys);
+
+    LockedMap locked;
+    locked.map = anv_hashmap_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(locked.map);
+    ASSERT_EQ(anv_mutex_init(&locked.lock), 0);
+    ANVRcuMap* rcu = anv_rcumap_create(&alloc, anv_hash_int, anv_key_equals_int, NUM_KEYS);
+    ASSERT_NOT_NULL(rcu);
+
+    for (int i = 0; i < NUM_KEYS; i++)
+    {
+        keys[i] = i;
+        ASSERT_EQ(anv_hashmap_put(locked.map, &keys[i], &keys[i]), 0);
+        ASSERT_EQ(anv_rcumap_put(rcu, &keys[i], &keys[i]), 0);
+    }
+
+    const int thread_counts[] = {1, 2, 4, 8};
+    for (int w = 0; w < 2; w++)
+    {
+        for (size_t t = 0; t < sizeof(thread_counts) / sizeof(thread_counts[0]); t++)
+        {
+            size_t locked_hits = 0;
+            size_t rcu_hits = 0;
+            const double locked_time = run(NULL, &locked, keys, thread_counts[t], w, &locked_hits);
+            const double rcu_time = run(rcu, NULL, keys, thread_counts[t], w, &rcu_hits);
+            ASSERT_EQ(rcu_hits, (size_t)OPS_PER_THREAD * (size_t)thread_counts[t]); // Every key present
+            ASSERT_EQ(locked_hits, rcu_hits);
+
+            const double ops = (double)OPS_PER_THREAD * thread_counts[t];
+            printf("%d reader(s)%s: one mutex %.2f Mops/s, rcu %.2f Mops/s\n", thread_counts[t],
+                   w ? " + writer" : "", locked_time > 0 ? ops / locked_time / 1e6 : 0.0,
+                   rcu_time > 0 ? ops / rcu_time / 1e6 : 0.0);
+        }
+    }
+
+    ASSERT_EQ(anv_rcumap_size(rcu), NUM_KEYS);
+
+    anv_rcumap_destroy(rcu, false, false);
+    anv_mutex_destroy(&locked.lock);
+    anv_hashmap_destroy(locked.map, false, false);
+    free(keys);
+    return TEST_SUCCESS;
+}
+
+typedef struct
+{
+    int (*func)(void);
+    const char* name;
+} TestCase;
+
+int main(void)
+{
+    const TestCase tests[] = {
+        {test_rcumap_performance_read_scaling, "test_rcumap_performance_read_scaling"},
+    };
+
+    printf("Running RcuMap performance tests...\n");
+
+    int failed = 0;
+    const int num_tests = sizeof(tests) / sizeof(tests[0]);
+    for (int i = 0; i < num_tests; i++)
+    {
+        if (tests[i].func() != TEST_SUCCESS)
+        {
+            printf("%s failed\n", tests[i].name);
+            failed++;
+        }
+    }
+
+    if (failed == 0)
+    {
+        printf("All RcuMap performance tests passed!\n");
+        return 0;
+    }
+
+    printf("%d RcuMap performance tests failed.\n", failed);
+    return 1;
+}
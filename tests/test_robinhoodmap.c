@@ -0,0 +1,355 @@
+//
+// RobinHoodMap tests
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "containers/RobinHoodMap.h"
+#include "TestAssert.h"
+#include "TestHelpers.h"
+
+#define MANY 5000
+#define HISTOGRAM_LEN 16
+
+// Check the Robin Hood ordering: every displaced entry is preceded by an
+// entry at most one slot closer to its own home
+static int invariant_holds(const ANVRobinHoodMap* map)
+{
+    size_t full = 0;
+    for (size_t i = 0; i < map->capacity; i++)
+    {
+        if (map->dists[i] == 0)
+        {
+            continue;
+        }
+        full++;
+
+        const size_t prev = (i - 1) & (map->capacity - 1);
+        if (map->dists[i] > 1 && map->dists[prev] + 1 < map->dists[i])
+        {
+            return 0;
+        }
+    }
+    return full == map->size;
+}
+
+static size_t constant_hash(const void* key)
+{
+    (void)key;
+    return 42;
+}
+
+// Test basic put/get/contains and updates
+int test_robinhoodmap_put_get(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVRobinHoodMap* map = anv_robinhoodmap_create(&alloc, anv_hash_string, anv_key_equals_string, 0);
+    ASSERT_NOT_NULL(map);
+    ASSERT_TRUE(anv_robinhoodmap_is_empty(map));
+    ASSERT_EQ(anv_robinhoodmap_capacity(map), 16);
+
+    char k1[] = "apple";
+    char k2[] = "banana";
+    int v1 = 1;
+    int v2 = 2;
+    int v3 = 3;
+
+    ASSERT_EQ(anv_robinhoodmap_put(map, k1, &v1), 0);
+    ASSERT_EQ(anv_robinhoodmap_put(map, k2, &v2), 0);
+    ASSERT_EQ(anv_robinhoodmap_size(map), 2);
+    ASSERT_EQ_PTR(anv_robinhoodmap_get(map, "apple"), &v1);
+    ASSERT_TRUE(anv_robinhoodmap_contains_key(map, "banana"));
+    ASSERT_FALSE(anv_robinhoodmap_contains_key(map, "cherry"));
+    ASSERT_NULL(anv_robinhoodmap_get(map, "cherry"));
+
+    void* old = NULL;
+    ASSERT_EQ(anv_robinhoodmap_put_replace(map, k1, &v3, &old), 0);
+    ASSERT_EQ_PTR(old, &v1);
+    ASSERT_EQ_PTR(anv_robinhoodmap_get(map, "apple"), &v3);
+    ASSERT_EQ(anv_robinhoodmap_size(map), 2);
+
+    ASSERT_EQ_PTR(anv_robinhoodmap_remove_get(map, "apple", false), &v3);
+    ASSERT_EQ(anv_robinhoodmap_remove(map, "banana", false, false), 0);
+    ASSERT_EQ(anv_robinhoodmap_remove(map, "banana", false, false), -1);
+    ASSERT_TRUE(anv_robinhoodmap_is_empty(map));
+
+    ASSERT_EQ(anv_robinhoodmap_put(NULL, k1, &v1), -1);
+    ASSERT_EQ(anv_robinhoodmap_put(map, NULL, &v1), -1);
+    ASSERT_EQ(anv_robinhoodmap_set_max_load_factor(map, 0.99), -1);
+    ASSERT_EQ(anv_robinhoodmap_set_max_load_factor(map, 0.4), -1);
+    ASSERT_NULL(anv_robinhoodmap_create(NULL, anv_hash_string, anv_key_equals_string, 0));
+
+    anv_robinhoodmap_destroy(map, false, false);
+    return TEST_SUCCESS;
+}
+
+// Test growth, backward-shift removal and churn over many keys
+int test_robinhoodmap_many(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVRobinHoodMap* map = anv_robinhoodmap_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(map);
+
+    int* keys = malloc(sizeof(int) * MANY);
+    ASSERT_NOT_NULL(keys);
+    for (int i = 0; i < MANY; i++)
+    {
+        keys[i] = i * 31;
+        ASSERT_EQ(anv_robinhoodmap_put(map, &keys[i], &keys[i]), 0);
+    }
+    ASSERT_EQ(anv_robinhoodmap_size(map), MANY);
+    ASSERT_LTE(anv_robinhoodmap_load_factor(map), ANV_ROBINHOODMAP_DEFAULT_MAX_LOAD);
+    ASSERT_TRUE(invariant_holds(map));
+
+    for (int i = 0; i < MANY; i++)
+    {
+        ASSERT_EQ_PTR(anv_robinhoodmap_get(map, &keys[i]), &keys[i]);
+    }
+
+    // Remove every even key; the shifted runs must stay ordered and reachable
+    for (int i = 0; i < MANY; i += 2)
+    {
+        ASSERT_EQ(anv_robinhoodmap_remove(map, &keys[i], false, false), 0);
+    }
+    ASSERT_EQ(anv_robinhoodmap_size(map), MANY / 2);
+    ASSERT_TRUE(invariant_holds(map));
+    for (int i = 0; i < MANY; i++)
+    {
+        if (i % 2 == 0)
+        {
+            ASSERT_NULL(anv_robinhoodmap_get(map, &keys[i]));
+        }
+        else
+        {
+            ASSERT_EQ_PTR(anv_robinhoodmap_get(map, &keys[i]), &keys[i]);
+        }
+    }
+
+    // No tombstones: churn at a fixed size neither grows the table nor
+    // lengthens probes
+    const size_t capacity = anv_robinhoodmap_capacity(map);
+    const double mean_probe = anv_robinhoodmap_mean_probe_length(map);
+    for (int round = 0; round < 20; round++)
+    {
+        for (int i = 0; i < MANY; i += 2)
+        {
+            ASSERT_EQ(anv_robinhoodmap_put(map, &keys[i], &keys[i]), 0);
+        }
+        for (int i = 0; i < MANY; i += 2)
+        {
+            ASSERT_EQ_PTR(anv_robinhoodmap_remove_get(map, &keys[i], false), &keys[i]);
+        }
+    }
+    ASSERT_EQ(anv_robinhoodmap_capacity(map), capacity);
+    ASSERT_EQ(anv_robinhoodmap_size(map), MANY / 2);
+    ASSERT_TRUE(invariant_holds(map));
+    ASSERT_LTE(anv_robinhoodmap_mean_probe_length(map), mean_probe + 0.01);
+
+    anv_robinhoodmap_clear(map, false, false);
+    ASSERT_TRUE(anv_robinhoodmap_is_empty(map));
+    ASSERT_NULL(anv_robinhoodmap_get(map, &keys[1]));
+
+    free(keys);
+    anv_robinhoodmap_destroy(map, false, false);
+    return TEST_SUCCESS;
+}
+
+// Test the probe histogram at a 0.9 load factor
+int test_robinhoodmap_probe_histogram(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVRobinHoodMap* map = anv_robinhoodmap_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(map);
+
+    size_t counts[HISTOGRAM_LEN];
+    ASSERT_EQ(anv_robinhoodmap_probe_histogram(map, counts, HISTOGRAM_LEN), 0);
+    ASSERT_EQ(counts[0], 0);
+    ASSERT_EQ(anv_robinhoodmap_mean_probe_length(map), 0.0);
+
+    // Fill a 16384-slot table to just under 0.9
+    static int keys[14700];
+    for (int i = 0; i < 14700; i++)
+    {
+        keys[i] = i;
+        ASSERT_EQ(anv_robinhoodmap_put(map, &keys[i], &keys[i]), 0);
+    }
+    ASSERT_EQ(anv_robinhoodmap_capacity(map), 16384);
+    ASSERT(anv_robinhoodmap_load_factor(map) > 0.89);
+
+    const size_t longest = anv_robinhoodmap_probe_histogram(map, counts, HISTOGRAM_LEN);
+    size_t total = 0;
+    for (size_t i = 0; i < HISTOGRAM_LEN; i++)
+    {
+        total += counts[i];
+    }
+    ASSERT_EQ(total, 14700);
+    ASSERT(counts[0] > counts[HISTOGRAM_LEN - 1]);
+    ASSERT(longest < 64);
+    ASSERT(anv_robinhoodmap_mean_probe_length(map) < 8.0);
+
+    // A one-element histogram counts everything in its only bucket
+    ASSERT_EQ(anv_robinhoodmap_probe_histogram(map, counts, 1), longest);
+    ASSERT_EQ(counts[0], 14700);
+    ASSERT_EQ(anv_robinhoodmap_probe_histogram(map, NULL, 0), longest);
+
+    // A lower limit grows the table on the next insertion
+    ASSERT_EQ(anv_robinhoodmap_set_max_load_factor(map, 0.5), 0);
+    int extra = -1;
+    ASSERT_EQ(anv_robinhoodmap_put(map, &extra, &extra), 0);
+    ASSERT_EQ(anv_robinhoodmap_capacity(map), 32768);
+
+    anv_robinhoodmap_destroy(map, false, false);
+    return TEST_SUCCESS;
+}
+
+// Test that a hash putting every key in one slot fails cleanly at the probe limit
+int test_robinhoodmap_probe_limit(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVRobinHoodMap* map = anv_robinhoodmap_create(&alloc, constant_hash, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(map);
+
+    static int keys[300];
+    int inserted = 0;
+    for (int i = 0; i < 300; i++)
+    {
+        keys[i] = i;
+        if (anv_robinhoodmap_put(map, &keys[i], &keys[i]) != 0)
+        {
+            break;
+        }
+        inserted++;
+    }
+    ASSERT_EQ(inserted, ANV_ROBINHOODMAP_MAX_PROBE + 1);
+    ASSERT_EQ(anv_robinhoodmap_size(map), (size_t)inserted);
+    ASSERT_TRUE(invariant_holds(map));
+    ASSERT_EQ(anv_robinhoodmap_probe_histogram(map, NULL, 0), ANV_ROBINHOODMAP_MAX_PROBE);
+
+    // Nothing was lost by the failed insertion
+    for (int i = 0; i < inserted; i++)
+    {
+        ASSERT_EQ_PTR(anv_robinhoodmap_get(map, &keys[i]), &keys[i]);
+    }
+    ASSERT_NULL(anv_robinhoodmap_get(map, &keys[inserted]));
+
+    // Removal frees room for another key
+    ASSERT_EQ(anv_robinhoodmap_remove(map, &keys[0], false, false), 0);
+    ASSERT_EQ(anv_robinhoodmap_put(map, &keys[inserted], &keys[inserted]), 0);
+    ASSERT_TRUE(invariant_holds(map));
+
+    anv_robinhoodmap_destroy(map, false, false);
+    return TEST_SUCCESS;
+}
+
+// Test the iterator visits every pair exactly once
+int test_robinhoodmap_iterator(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVRobinHoodMap* map = anv_robinhoodmap_create(&alloc, anv_hash_int, anv_key_equals_int, 100);
+    ASSERT_NOT_NULL(map);
+    const size_t capacity = anv_robinhoodmap_capacity(map);
+
+    int keys[100];
+    int seen[100] = {0};
+    for (int i = 0; i < 100; i++)
+    {
+        keys[i] = i;
+        ASSERT_EQ(anv_robinhoodmap_put(map, &keys[i], &keys[i]), 0);
+    }
+    ASSERT_EQ(anv_robinhoodmap_capacity(map), capacity); // Presized, no rehash
+
+    ANVIterator it = anv_robinhoodmap_iterator(map);
+    size_t count = 0;
+    while (it.has_next(&it))
+    {
+        const ANVPair* pair = it.get(&it);
+        ASSERT_NOT_NULL(pair);
+        const int key = *(int*)pair->first;
+        ASSERT_EQ_PTR(pair->second, &keys[key]);
+        seen[key]++;
+        count++;
+        it.next(&it);
+    }
+    ASSERT_EQ(count, 100);
+    for (int i = 0; i < 100; i++)
+    {
+        ASSERT_EQ(seen[i], 1);
+    }
+
+    it.reset(&it);
+    ASSERT_TRUE(it.has_next(&it));
+    it.destroy(&it);
+
+    anv_robinhoodmap_destroy(map, false, false);
+    return TEST_SUCCESS;
+}
+
+// Test that owned keys and values are released through the allocator
+int test_robinhoodmap_free_data(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVRobinHoodMap* map = anv_robinhoodmap_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(map);
+
+    for (int i = 0; i < 50; i++)
+    {
+        int* key = malloc(sizeof(int));
+        int* value = malloc(sizeof(int));
+        ASSERT_NOT_NULL(key);
+        ASSERT_NOT_NULL(value);
+        *key = i;
+        *value = i * 2;
+        ASSERT_EQ(anv_robinhoodmap_put(map, key, value), 0);
+    }
+
+    const int probe = 7;
+    ASSERT_EQ(*(int*)anv_robinhoodmap_get(map, &probe), 14);
+    ASSERT_EQ(anv_robinhoodmap_remove(map, &probe, true, true), 0);
+    ASSERT_EQ(anv_robinhoodmap_memory_usage(map),
+              sizeof(ANVRobinHoodMap) + anv_robinhoodmap_capacity(map) * (sizeof(ANVRobinHoodSlot) + 2));
+
+    anv_robinhoodmap_destroy(map, true, true);
+    return TEST_SUCCESS;
+}
+
+typedef struct
+{
+    int (*func)(void);
+    const char* name;
+} TestCase;
+
+int main(void)
+{
+    const TestCase tests[] = {
+        {test_robinhoodmap_put_get, "test_robinhoodmap_put_get"},
+        {test_robinhoodmap_many, "test_robinhoodmap_many"},
+        {test_robinhoodmap_probe_histogram, "test_robinhoodmap_probe_histogram"},
+        {test_robinhoodmap_probe_limit, "test_robinhoodmap_probe_limit"},
+        {test_robinhoodmap_iterator, "test_robinhoodmap_iterator"},
+        {test_robinhoodmap_free_data, "test_robinhoodmap_free_data"},
+    };
+
+    printf("Running RobinHoodMap tests...\n");
+
+    int failed = 0;
+    const int num_tests = sizeof(tests) / sizeof(tests[0]);
+    for (int i = 0; i < num_tests; i++)
+    {
+        if (tests[i].func() != TEST_SUCCESS)
+        {
+            printf("%s failed\n", tests[i].name);
+            failed++;
+        }
+    }
+
+    if (failed == 0)
+    {
+        printf("All RobinHoodMap tests passed!\n");
+        return 0;
+    }
+
+    printf("%d RobinHoodMap tests failed.\n", failed);
+    return 1;
+}
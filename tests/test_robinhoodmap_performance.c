@@ -0,0 +1,171 @@
+//
+// RobinHoodMap performance test - lookup latency at a 0.9 load factor versus
+// the chained HashMap, with the probe-length histogram
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "containers/HashMap.h"
+#include "containers/RobinHoodMap.h"
+#include "TestAssert.h"
+#include "TestHelpers.h"
+
+#define NUM_KEYS 235000 // Just under 0.9 of 262144 slots
+#define LOOKUP_ROUNDS 5
+#define HISTOGRAM_LEN 12
+
+// Insert and look up the same keys in both maps, half hits and half misses
+int test_robinhoodmap_performance_lookup(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVHashMap* chained = anv_hashmap_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ANVRobinHoodMap* robin = anv_robinhoodmap_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(chained);
+    ASSERT_NOT_NULL(robin);
+
+    int* keys = malloc(sizeof(int) * NUM_KEYS * 2);
+    ASSERT_NOT_NULL(keys);
+    for (int i = 0; i < NUM_KEYS * 2; i++)
+    {
+        keys[i] = i * 7 + 3;
+    }
+
+    double start = now_seconds();
+    for (int i = 0; i < NUM_KEYS; i++)
+    {
+        ASSERT_EQ(anv_hashmap_put(chained, &keys[i], &keys[i]), 0);
+    }
+    const double chained_insert = now_seconds() - start;
+
+    start = now_seconds();
+    for (int i = 0; i < NUM_KEYS; i++)
+    {
+        ASSERT_EQ(anv_robinhoodmap_put(robin, &keys[i], &keys[i]), 0);
+    }
+    const double robin_insert = now_seconds() - start;
+    ASSERT(anv_robinhoodmap_load_factor(robin) > 0.89);
+
+    size_t chained_hits = 0;
+    start = now_seconds();
+    for (int round = 0; round < LOOKUP_ROUNDS; round++)
+    {
+        for (int i = 0; i < NUM_KEYS * 2; i += 2)
+        {
+            chained_hits += anv_hashmap_get(chained, &keys[i / 2 + (i & 2 ? NUM_KEYS : 0)]) != NULL;
+        }
+    }
+    const double chained_lookup = now_seconds() - start;
+
+    size_t robin_hits = 0;
+    start = now_seconds();
+    for (int round = 0; round < LOOKUP_ROUNDS; round++)
+    {
+        for (int i = 0; i < NUM_KEYS * 2; i += 2)
+        {
+            robin_hits += anv_robinhoodmap_get(robin, &keys[i / 2 + (i & 2 ? NUM_KEYS : 0)]) != NULL;
+        }
+    }
+    const double robin_lookup = now_seconds() - start;
+
+    ASSERT_EQ(robin_hits, chained_hits);
+
+    const double lookups = (double)NUM_KEYS * LOOKUP_ROUNDS;
+    printf("Insert %d keys: HashMap %.3f s, RobinHoodMap %.3f s (load %.3f)\n", NUM_KEYS, chained_insert,
+           robin_insert, anv_robinhoodmap_load_factor(robin));
+    printf("Lookups: HashMap %.1f ns/op, RobinHoodMap %.1f ns/op\n",
+           chained_lookup / lookups * 1e9, robin_lookup / lookups * 1e9);
+    printf("Memory: HashMap %zu bytes, RobinHoodMap %zu bytes\n",
+           anv_hashmap_memory_usage(chained), anv_robinhoodmap_memory_usage(robin));
+
+    size_t counts[HISTOGRAM_LEN];
+    const size_t longest = anv_robinhoodmap_probe_histogram(robin, counts, HISTOGRAM_LEN);
+    printf("Probe lengths (mean %.2f, max %zu):", anv_robinhoodmap_mean_probe_length(robin), longest);
+    for (size_t i = 0; i < HISTOGRAM_LEN; i++)
+    {
+        printf(" %zu%s:%zu", i, i + 1 == HISTOGRAM_LEN ? "+" : "", counts[i]);
+    }
+    printf("\n");
+
+    free(keys);
+    anv_hashmap_destroy(chained, false, false);
+    anv_robinhoodmap_destroy(robin, false, false);
+    return TEST_SUCCESS;
+}
+
+// Remove and reinsert half the keys repeatedly; without tombstones lookups
+// stay as fast as on a freshly built table
+int test_robinhoodmap_performance_churn(void)
+{
+    ANVAllocator alloc = anv_alloc_default();
+    ANVRobinHoodMap* robin = anv_robinhoodmap_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(robin);
+
+    int* keys = malloc(sizeof(int) * NUM_KEYS);
+    ASSERT_NOT_NULL(keys);
+    for (int i = 0; i < NUM_KEYS; i++)
+    {
+        keys[i] = i * 7 + 3;
+        ASSERT_EQ(anv_robinhoodmap_put(robin, &keys[i], &keys[i]), 0);
+    }
+    const double mean_before = anv_robinhoodmap_mean_probe_length(robin);
+
+    const double start = now_seconds();
+    for (int round = 0; round < LOOKUP_ROUNDS; round++)
+    {
+        for (int i = round % 2; i < NUM_KEYS; i += 2)
+        {
+            ASSERT_EQ(anv_robinhoodmap_remove(robin, &keys[i], false, false), 0);
+        }
+        for (int i = round % 2; i < NUM_KEYS; i += 2)
+        {
+            ASSERT_EQ(anv_robinhoodmap_put(robin, &keys[i], &keys[i]), 0);
+        }
+    }
+    const double churn = now_seconds() - start;
+
+    const double mean_after = anv_robinhoodmap_mean_probe_length(robin);
+    printf("Churn: %.1f ns per remove+insert, mean probe %.2f before, %.2f after\n",
+           churn / ((double)NUM_KEYS / 2 * LOOKUP_ROUNDS) * 1e9, mean_before, mean_after);
+    ASSERT_LTE(mean_after, mean_before + 0.01);
+
+    free(keys);
+    anv_robinhoodmap_destroy(robin, false, false);
+    return TEST_SUCCESS;
+}
+
+typedef struct
+{
+    int (*func)(void);
+    const char* name;
+} TestCase;
+
+int main(void)
+{
+    const TestCase tests[] = {
+        {test_robinhoodmap_performance_lookup, "test_robinhoodmap_performance_lookup"},
+        {test_robinhoodmap_performance_churn, "test_robinhoodmap_performance_churn"},
+    };
+
+    printf("Running RobinHoodMap performance tests...\n");
+
+    int failed = 0;
+    const int num_tests = sizeof(tests) / sizeof(tests[0]);
+    for (int i = 0; i < num_tests; i++)
+    {
+        if (tests[i].func() != TEST_SUCCESS)
+        {
+            printf("%s failed\n", tests[i].name);
+            failed++;
+        }
+    }
+
+    if (failed == 0)
+    {
+        printf("All RobinHoodMap performance tests passed!\n");
+        return 0;
+    }
+
+    printf("%d RobinHoodMap performance tests failed.\n", failed);
+    return 1;
+}
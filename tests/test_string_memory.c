@@ -3,6 +3,8 @@
 //
 
 #include "containers/DynamicString.h"
+#include "memory/Arena.h"
+#include "memory/TrackingAllocator.h"
 #include "TestAssert.h"
 
 #include <stdio.h>
@@ -59,6 +61,73 @@ int test_reserve_and_shrink_optimal(void)
     return TEST_SUCCESS;
 }
 
+int test_string_with_allocator(void)
+{
+    ANVAllocator inner = anv_alloc_default();
+    ANVTrackingAllocator tracker;
+    ASSERT_EQ(anv_tracking_init(&tracker, &inner), 0);
+    ANVAllocator alloc = anv_tracking_allocator(&tracker);
+
+    ANVString str = anv_str_create_from_cstring_with_alloc(&alloc, "hello, allocator world");
+    ASSERT_EQ(tracker.allocations, 1);
+    ASSERT_EQ(tracker.bytes_in_flight, anv_str_memory_usage(&str));
+
+    for (int i = 0; i < 200; i++)
+    {
+        anv_str_push_back(&str, 'x');
+    }
+    ASSERT_EQ(anv_str_size(&str), 222);
+    ASSERT_EQ(anv_str_data(&str)[222], '\0');
+    ASSERT_EQ(tracker.allocations, 1); // Growth goes through realloc
+    ASSERT_GT(tracker.reallocations, 0);
+    ASSERT_EQ(tracker.bytes_in_flight, anv_str_memory_usage(&str));
+
+    // Copies and substrings inherit the allocator
+    ANVString copy = anv_str_create_from_string(&str);
+    ANVString sub = anv_str_substr_create_string(&str, 7, 100);
+    ASSERT_EQ_PTR(copy.alloc, &alloc);
+    ASSERT_EQ_PTR(sub.alloc, &alloc);
+    ASSERT_EQ(anv_str_size(&sub), 100);
+    ASSERT_EQ(tracker.bytes_in_flight,
+              anv_str_memory_usage(&str) + anv_str_memory_usage(&copy) + anv_str_memory_usage(&sub));
+
+    // Shrinking back into the inline buffer releases the heap block
+    anv_str_assign_cstring(&sub, "tiny");
+    ASSERT_TRUE(anv_str_shrink_to_fit(&sub));
+    ASSERT_EQ(anv_str_memory_usage(&sub), 0);
+    ASSERT_EQ(anv_str_compare_cstring(&sub, "tiny"), 0);
+
+    anv_str_destroy(&sub);
+    anv_str_destroy(&copy);
+    anv_str_destroy(&str);
+    ASSERT_EQ(tracker.bytes_in_flight, 0);
+    return TEST_SUCCESS;
+}
+
+int test_string_grows_in_arena(void)
+{
+    ANVAllocator backing = anv_alloc_default();
+    ANVArena* arena = anv_arena_create(&backing, 4096);
+    ASSERT_NOT_NULL(arena);
+    ANVAllocator alloc = anv_arena_allocator(arena);
+
+    ANVString str = anv_str_create_empty_with_alloc(&alloc, 32);
+    const char* first = anv_str_data(&str);
+    for (int i = 0; i < 1000; i++)
+    {
+        anv_str_append_cstring(&str, "ab");
+    }
+
+    // The buffer is the arena's last allocation, so it is extended in place
+    ASSERT_EQ_PTR(anv_str_data(&str), first);
+    ASSERT_EQ(anv_str_size(&str), 2000);
+    ASSERT_LTE(anv_arena_bytes_used(arena), anv_str_capacity(&str) + 64);
+
+    anv_str_destroy(&str);
+    anv_arena_destroy(arena);
+    return TEST_SUCCESS;
+}
+
 typedef struct
 {
     int (*func)(void);
@@ -70,6 +139,8 @@ TestCase tests[] = {
     {test_buffer_growth, "test_buffer_growth"},
     {test_large_string, "test_large_string"},
     {test_reserve_and_shrink_optimal, "test_reserve_and_shrink_optimal"},
+    {test_string_with_allocator, "test_string_with_allocator"},
+    {test_string_grows_in_arena, "test_string_grows_in_arena"},
 };
 
 int main(void)
@@ -0,0 +1,217 @@
+//
+// Tracking allocator and container memory accounting tests
+//
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "memory/TrackingAllocator.h"
+#include "containers/ArrayList.h"
+#include "containers/BinarySearchTree.h"
+#include "containers/DoublyLinkedList.h"
+#include "containers/DynamicString.h"
+#include "containers/HashMap.h"
+#include "containers/HashSet.h"
+#include "containers/Queue.h"
+#include "containers/SinglyLinkedList.h"
+#include "containers/Stack.h"
+#include "TestAssert.h"
+#include "TestHelpers.h"
+
+#define ITEM_COUNT 500
+
+static int values[ITEM_COUNT];
+
+static void fill_values(void)
+{
+    for (int i = 0; i < ITEM_COUNT; i++)
+    {
+        values[i] = (i * 7919) % 10007; // Distinct, unordered keys for the BST
+    }
+}
+
+// Test counters, peak tracking and the size histogram
+int test_tracking_counters(void)
+{
+    ANVAllocator inner = anv_alloc_default();
+    ANVTrackingAllocator tracker;
+    ASSERT_EQ(anv_tracking_init(&tracker, &inner), 0);
+    ANVAllocator alloc = anv_tracking_allocator(&tracker);
+
+    void* a = anv_alloc_malloc(&alloc, 10);
+    void* b = anv_alloc_malloc(&alloc, 100);
+    ASSERT_NOT_NULL(a);
+    ASSERT_NOT_NULL(b);
+    ASSERT_EQ((uintptr_t)b % _Alignof(max_align_t), 0);
+    ASSERT_EQ(tracker.allocations, 2);
+    ASSERT_EQ(tracker.bytes_in_flight, 110);
+    ASSERT_EQ(tracker.histogram[0], 1); // <= 16
+    ASSERT_EQ(tracker.histogram[3], 1); // <= 128
+
+    // Unsized free still releases the exact byte count
+    anv_alloc_free(&alloc, b);
+    ASSERT_EQ(tracker.frees, 1);
+    ASSERT_EQ(tracker.bytes_in_flight, 10);
+    ASSERT_EQ(tracker.peak_bytes, 110);
+
+    // Realloc keeps contents and adjusts bytes in flight
+    memset(a, 0x5A, 10);
+    char* grown = anv_alloc_realloc(&alloc, a, 10, 4000);
+    ASSERT_NOT_NULL(grown);
+    ASSERT_EQ(grown[9], 0x5A);
+    ASSERT_EQ(tracker.reallocations, 1);
+    ASSERT_EQ(tracker.bytes_in_flight, 4000);
+    ASSERT_EQ(tracker.peak_bytes, 4000);
+
+    anv_tracking_reset_stats(&tracker);
+    ASSERT_EQ(tracker.allocations, 0);
+    ASSERT_EQ(tracker.peak_bytes, 4000);
+
+    anv_alloc_free_sized(&alloc, grown, 4000);
+    ASSERT_EQ(tracker.bytes_in_flight, 0);
+
+    ASSERT_EQ(anv_tracking_bucket_limit(0), 16);
+    ASSERT_EQ(anv_tracking_bucket_limit(ANV_TRACKING_HISTOGRAM_BUCKETS - 1), SIZE_MAX);
+    ASSERT_EQ(anv_tracking_init(&tracker, NULL), -1);
+
+    return TEST_SUCCESS;
+}
+
+// Test that memory_usage matches what the containers actually allocate
+int test_tracking_container_usage(void)
+{
+    ANVAllocator inner = anv_alloc_default();
+    ANVTrackingAllocator tracker;
+    ASSERT_EQ(anv_tracking_init(&tracker, &inner), 0);
+    ANVAllocator alloc = anv_tracking_allocator(&tracker);
+    fill_values();
+
+    ANVArrayList* list = anv_arraylist_create(&alloc, 4);
+    ASSERT_NOT_NULL(list);
+    for (int i = 0; i < ITEM_COUNT; i++)
+    {
+        ASSERT_EQ(anv_arraylist_push_back(list, &values[i]), 0);
+    }
+    ASSERT_EQ(anv_arraylist_memory_usage(list), tracker.bytes_in_flight);
+    anv_arraylist_destroy(list, false);
+    ASSERT_EQ(tracker.bytes_in_flight, 0);
+
+    ANVHashMap* map = anv_hashmap_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(map);
+    for (int i = 0; i < ITEM_COUNT; i++)
+    {
+        ASSERT_EQ(anv_hashmap_put(map, &values[i], &values[i]), 0);
+    }
+    ASSERT_EQ(anv_hashmap_memory_usage(map), tracker.bytes_in_flight);
+    anv_hashmap_destroy(map, false, false);
+    ASSERT_EQ(tracker.bytes_in_flight, 0);
+
+    ANVHashSet* set = anv_hashset_create(&alloc, anv_hash_int, anv_key_equals_int, 0);
+    ASSERT_NOT_NULL(set);
+    for (int i = 0; i < ITEM_COUNT; i++)
+    {
+        ASSERT_EQ(anv_hashset_add(set, &values[i]), 0);
+    }
+    ASSERT_EQ(anv_hashset_memory_usage(set), tracker.bytes_in_flight);
+    anv_hashset_destroy(set, false);
+    ASSERT_EQ(tracker.bytes_in_flight, 0);
+
+    ANVBinarySearchTree* tree = anv_bst_create(&alloc, int_cmp);
+    ASSERT_NOT_NULL(tree);
+    for (int i = 0; i < ITEM_COUNT; i++)
+    {
+        ASSERT_EQ(anv_bst_insert(tree, &values[i]), 0);
+    }
+    ASSERT_EQ(anv_bst_memory_usage(tree), tracker.bytes_in_flight);
+    anv_bst_destroy(tree, false);
+    ASSERT_EQ(tracker.bytes_in_flight, 0);
+
+    return TEST_SUCCESS;
+}
+
+// Test memory_usage for the linked containers and strings
+int test_tracking_linked_usage(void)
+{
+    ANVAllocator inner = anv_alloc_default();
+    ANVTrackingAllocator tracker;
+    ASSERT_EQ(anv_tracking_init(&tracker, &inner), 0);
+    ANVAllocator alloc = anv_tracking_allocator(&tracker);
+    fill_values();
+
+    ANVSinglyLinkedList* sll = anv_sll_create(&alloc);
+    ANVDoublyLinkedList* dll = anv_dll_create(&alloc);
+    ANVStack* stack = anv_stack_create(&alloc);
+    ANVQueue* queue = anv_queue_create(&alloc);
+    ASSERT_NOT_NULL(sll);
+    ASSERT_NOT_NULL(dll);
+    ASSERT_NOT_NULL(stack);
+    ASSERT_NOT_NULL(queue);
+
+    for (int i = 0; i < ITEM_COUNT; i++)
+    {
+        ASSERT_EQ(anv_sll_push_back(sll, &values[i]), 0);
+        ASSERT_EQ(anv_dll_push_back(dll, &values[i]), 0);
+        ASSERT_EQ(anv_stack_push(stack, &values[i]), 0);
+        ASSERT_EQ(anv_queue_enqueue(queue, &values[i]), 0);
+    }
+
+    const size_t total = anv_sll_memory_usage(sll) + anv_dll_memory_usage(dll) +
+                         anv_stack_memory_usage(stack) + anv_queue_memory_usage(queue);
+    ASSERT_EQ(total, tracker.bytes_in_flight);
+    ASSERT_EQ(anv_sll_memory_usage(NULL), 0);
+
+    anv_sll_destroy(sll, false);
+    anv_dll_destroy(dll, false);
+    anv_stack_destroy(stack, false);
+    anv_queue_destroy(queue, false);
+    ASSERT_EQ(tracker.bytes_in_flight, 0);
+    ASSERT_EQ(tracker.allocations, tracker.frees);
+
+    ANVString small = anv_str_create_from_cstring("short");
+    ASSERT_EQ(anv_str_memory_usage(&small), 0);
+    anv_str_destroy(&small);
+
+    ANVString large = anv_str_create_from_cstring("a string that no longer fits the inline buffer");
+    ASSERT_EQ(anv_str_memory_usage(&large), anv_str_capacity(&large));
+    anv_str_destroy(&large);
+
+    return TEST_SUCCESS;
+}
+
+typedef struct
+{
+    int (*func)(void);
+    const char* name;
+} TestCase;
+
+int main(void)
+{
+    const TestCase tests[] = {
+        {test_tracking_counters, "test_tracking_counters"},
+        {test_tracking_container_usage, "test_tracking_container_usage"},
+        {test_tracking_linked_usage, "test_tracking_linked_usage"},
+    };
+
+    printf("Running TrackingAllocator tests...\n");
+
+    int failed = 0;
+    const int num_tests = sizeof(tests) / sizeof(tests[0]);
+    for (int i = 0; i < num_tests; i++)
+    {
+        if (tests[i].func() != TEST_SUCCESS)
+        {
+            printf("%s failed\n", tests[i].name);
+            failed++;
+        }
+    }
+
+    if (failed == 0)
+    {
+        printf("All TrackingAllocator tests passed!\n");
+        return 0;
+    }
+
+    printf("%d TrackingAllocator tests failed.\n", failed);
+    return 1;
+}